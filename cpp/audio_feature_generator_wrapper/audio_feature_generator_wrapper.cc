@@ -1,4 +1,6 @@
 #include <algorithm>
+#include <atomic>
+#include <thread>
 #include "microfrontend/lib/frontend_util.h"
 #include "audio_feature_generator_wrapper.hpp"
 
@@ -23,6 +25,7 @@ static void* populate_int8_slice(AudioFeatureGeneratorWrapper *self, const struc
 static void* populate_uint16_slice(AudioFeatureGeneratorWrapper *self, const struct FrontendOutput& frontend_output, void* output);
 static void* populate_float_slice(AudioFeatureGeneratorWrapper *self, const struct FrontendOutput& frontend_output, void* output);
 static void dynamic_scale_int8_spectrogram(const uint16_t* src, int8_t* dst, int length, int dynamic_quantize_range);
+static PopulateFunc get_populate_func(const std::string& dtype);
 
 
 /*************************************************************************************************/
@@ -91,6 +94,14 @@ AudioFeatureGeneratorWrapper::AudioFeatureGeneratorWrapper(const py::dict& setti
   {
     throw std::invalid_argument("Failed to populate frontend state");
   }
+
+  // The config is retained so that process_batch() can 
+  // create additional frontend states for each thread
+  _frontend_config = config;
+  _sample_rate_hz = sample_rate_hz;
+
+  _feature_buffer.resize(_n_features * _n_channels);
+  reset();
 }
 
 /*************************************************************************************************/
@@ -106,7 +117,6 @@ void AudioFeatureGeneratorWrapper::process_sample(const py::array_t<int16_t>& in
   auto output_buf = output.request();
   const auto shape = output_buf.shape;
   const auto dtype = output_buf.format;
-  PopulateFunc populate_func;
 
   if(input_buf.ndim != 1)
   {
@@ -125,52 +135,140 @@ void AudioFeatureGeneratorWrapper::process_sample(const py::array_t<int16_t>& in
     throw std::invalid_argument("Output must have shape" + std::to_string(_n_features) + "x" + std::to_string(_n_channels));
   }
 
-  auto audio_ptr = static_cast<int16_t*>(input_buf.ptr);
-  void* output_ptr = output_buf.ptr;
-  void* quantize_tmp_buffer = nullptr;
+  // Verify the data type before releasing the GIL
+  get_populate_func(dtype);
 
+  // Release the Python Global Interpreter Lock (GIL)
+  // While generating the spectrogram
+  // This way, other Python threads may execute concurrently
+  py::gil_scoped_release release;
 
-  if(dtype == int8_dtype)
+  // NOTE: This also discards any streaming state
+  reset();
+
+  generate_spectrogram(&_frontend_state, static_cast<const int16_t*>(input_buf.ptr), output_buf.ptr, dtype);
+}
+
+/*************************************************************************************************/
+void AudioFeatureGeneratorWrapper::process_batch(const py::array_t<int16_t>& inputs, py::array& outputs, int n_threads)
+{
+  const auto inputs_buf = inputs.request();
+  auto outputs_buf = outputs.request();
+  const auto shape = outputs_buf.shape;
+  const auto dtype = outputs_buf.format;
+
+  if(inputs_buf.ndim != 2 || inputs_buf.shape[1] != _sample_length)
+  {
+    throw std::invalid_argument("Input batch must have shape Nx" + std::to_string(_sample_length));
+  }
+  if(outputs_buf.ndim != 3 || shape[0] != inputs_buf.shape[0] || shape[1] != _n_features || shape[2] != _n_channels)
   {
-    // If we're using dynamic quantization, 
-    // then populated each slice as uint16 and at the end do the quantization
-    if(_dynamic_quantize_range > 0)
+    throw std::invalid_argument("Output must have shape Nx" + std::to_string(_n_features) + "x" + std::to_string(_n_channels));
+  }
+  if(inputs_buf.strides[1] != sizeof(int16_t) || inputs_buf.strides[0] != (ssize_t)(_sample_length * sizeof(int16_t)))
+  {
+    throw std::invalid_argument("Input batch must be a contiguous array");
+  }
+  if(!(outputs.flags() & py::array::c_style))
+  {
+    throw std::invalid_argument("Output must be a contiguous array");
+  }
+  get_populate_func(dtype);
+
+  const ssize_t batch_size = inputs_buf.shape[0];
+  if(n_threads <= 0)
+  {
+    n_threads = std::max((int)std::thread::hardware_concurrency(), 1);
+  }
+  n_threads = (int)std::min((ssize_t)n_threads, std::max(batch_size, (ssize_t)1));
+
+  const auto audio_base = static_cast<const int16_t*>(inputs_buf.ptr);
+  const auto output_base = static_cast<uint8_t*>(outputs_buf.ptr);
+  const ssize_t output_stride = _n_features * _n_channels * outputs_buf.itemsize;
+  std::atomic<ssize_t> next_index(0);
+  std::atomic<bool> success(true);
+
+  // Release the Python Global Interpreter Lock (GIL)
+  // while the threads generate the spectrograms
+  py::gil_scoped_release release;
+
+  auto worker = [&](FrontendState* state)
+  {
+    for(;;)
     {
-      populate_func = &populate_uint16_slice;
-      output_ptr = quantize_tmp_buffer = malloc(sizeof(uint16_t) * _n_features * _n_channels);
+      const ssize_t index = next_index++;
+      if(index >= batch_size)
+      {
+        break;
+      }
+      FrontendReset(state);
+      generate_spectrogram(state, audio_base + index*_sample_length, output_base + index*output_stride, dtype);
     }
-    else 
+  };
+
+  // Each thread requires its own frontend state,
+  // the calling thread uses this wrapper's state
+  std::vector<FrontendState> states(n_threads - 1);
+  std::vector<std::thread> threads;
+  for(auto& state : states)
+  {
+    if(!FrontendPopulateState(&_frontend_config, &state, _sample_rate_hz))
     {
-      populate_func = &populate_int8_slice;
+      success = false;
+      break;
     }
-    
+    threads.emplace_back(worker, &state);
   }
-  else if(dtype == uint16_dtype)
+  if(success)
   {
-    populate_func = &populate_uint16_slice;
+    worker(&_frontend_state);
   }
-  else if(dtype == float_dtype)
+  for(auto& t : threads)
   {
-    populate_func = &populate_float_slice;
+    t.join();
   }
-  else
+  // The states are value-initialized so this also releases
+  // a partially populated state and the states that were never populated
+  for(auto& state : states)
   {
-    throw std::invalid_argument("Output data type must be a int8, uint16, or float32");
+    FrontendFreeStateContents(&state);
   }
 
-  // Release the Python Global Interpreter Lock (GIL)
-  // While generating the spectrogram
-  // This way, other Python threads may execute concurrently
-  py::gil_scoped_release release;
+  // The wrapper's state was used for the batch
+  reset();
 
-  FrontendReset(&_frontend_state);
+  if(!success)
+  {
+    throw std::runtime_error("Failed to populate frontend state");
+  }
+}
+
+/*************************************************************************************************/
+void AudioFeatureGeneratorWrapper::generate_spectrogram(
+  FrontendState* state, 
+  const int16_t* audio_ptr, 
+  void* output, 
+  const std::string& dtype
+)
+{
+  PopulateFunc populate_func = get_populate_func(dtype);
+  void* output_ptr = output;
+  void* quantize_tmp_buffer = nullptr;
+
+  // If we're using dynamic quantization, 
+  // then populated each slice as uint16 and at the end do the quantization
+  if(dtype == int8_dtype && _dynamic_quantize_range > 0)
+  {
+    populate_func = &populate_uint16_slice;
+    output_ptr = quantize_tmp_buffer = malloc(sizeof(uint16_t) * _n_features * _n_channels);
+  }
 
   int samples_processed = 0;
   for(int i = _n_features; i > 0; --i)
   {
     size_t num_samples_read;
     const auto frontend_output = FrontendProcessSamples(
-      &_frontend_state, 
+      state, 
       audio_ptr, 
       _sample_length - samples_processed, 
       &num_samples_read
@@ -187,13 +285,12 @@ void AudioFeatureGeneratorWrapper::process_sample(const py::array_t<int16_t>& in
   {
     dynamic_scale_int8_spectrogram(
       (const uint16_t*)quantize_tmp_buffer, 
-      (int8_t*)output_buf.ptr, 
+      (int8_t*)output, 
       _n_features * _n_channels, 
       this->_dynamic_quantize_range
     );
     free(quantize_tmp_buffer);
   }
-
 }
 
 /*************************************************************************************************/
@@ -202,6 +299,131 @@ bool AudioFeatureGeneratorWrapper::activity_was_detected()
   return ActivityDetectionTripped(&_frontend_state.activity_detection);
 }
 
+/*************************************************************************************************/
+void AudioFeatureGeneratorWrapper::reset()
+{
+  FrontendReset(&_frontend_state);
+  std::fill(_feature_buffer.begin(), _feature_buffer.end(), 0);
+  _feature_buffer_start = 0;
+}
+
+/*************************************************************************************************/
+py::array AudioFeatureGeneratorWrapper::push(const py::array_t<int16_t>& samples, const py::dtype& dtype)
+{
+  const auto samples_buf = samples.request();
+
+  if(samples_buf.ndim != 1)
+  {
+    throw std::invalid_argument("Input samples must be 1D array");
+  }
+
+  std::string format;
+  if(dtype.kind() == 'i' && dtype.itemsize() == 1)
+  {
+    format = int8_dtype;
+  }
+  else if(dtype.kind() == 'u' && dtype.itemsize() == 2)
+  {
+    format = uint16_dtype;
+  }
+  else if(dtype.kind() == 'f' && dtype.itemsize() == 4)
+  {
+    format = float_dtype;
+  }
+  const auto populate_func = get_populate_func(format);
+  if(format == int8_dtype && _dynamic_quantize_range > 0)
+  {
+    // Dynamic quantization is calculated across the entire spectrogram,
+    // so it cannot be applied to individual slices
+    throw std::invalid_argument("Dynamic int8 quantization is enabled, use get_features() to retrieve the quantized spectrogram");
+  }
+
+  auto audio_ptr = static_cast<const int16_t*>(samples_buf.ptr);
+  size_t remaining = samples_buf.size;
+  std::vector<uint16_t> new_slices;
+
+  {
+    // Release the Python Global Interpreter Lock (GIL)
+    // While generating the spectrogram slices
+    py::gil_scoped_release release;
+
+    // The frontend internally buffers the samples
+    // until a complete window is available, 
+    // so the previously pushed samples are never processed again
+    while(remaining > 0)
+    {
+      size_t num_samples_read;
+      const auto frontend_output = FrontendProcessSamples(
+        &_frontend_state, 
+        audio_ptr, 
+        remaining, 
+        &num_samples_read
+      );
+      audio_ptr += num_samples_read;
+      remaining -= num_samples_read;
+
+      if(frontend_output.values != nullptr && frontend_output.size > 0)
+      {
+        new_slices.insert(new_slices.end(), frontend_output.values, frontend_output.values + frontend_output.size);
+        std::copy_n(frontend_output.values, _n_channels, &_feature_buffer[_feature_buffer_start * _n_channels]);
+        _feature_buffer_start = (_feature_buffer_start + 1) % _n_features;
+      }
+    }
+  }
+
+  const int n_slices = (int)new_slices.size() / _n_channels;
+  py::array output(dtype, std::vector<ssize_t>{(ssize_t)n_slices, (ssize_t)_n_channels});
+  void* output_ptr = output.mutable_data();
+  for(int i = 0; i < n_slices; ++i)
+  {
+    const struct FrontendOutput slice = { &new_slices[i * _n_channels], (size_t)_n_channels };
+    output_ptr = populate_func(this, slice, output_ptr);
+  }
+
+  return output;
+}
+
+/*************************************************************************************************/
+void AudioFeatureGeneratorWrapper::get_features(py::array& output)
+{
+  auto output_buf = output.request();
+  const auto shape = output_buf.shape;
+  const auto populate_func = get_populate_func(output_buf.format);
+
+  if(output_buf.ndim != 2)
+  {
+    throw std::invalid_argument("Output must be 2D array");
+  }
+  if(shape[0] != _n_features || shape[1] != _n_channels)
+  {
+    throw std::invalid_argument("Output must have shape" + std::to_string(_n_features) + "x" + std::to_string(_n_channels));
+  }
+
+  // Copy the ring buffer to a contiguous spectrogram, oldest slice first
+  std::vector<uint16_t> spectrogram(_feature_buffer.size());
+  const auto start = _feature_buffer.begin() + _feature_buffer_start * _n_channels;
+  std::copy(start, _feature_buffer.end(), spectrogram.begin());
+  std::copy(_feature_buffer.begin(), start, spectrogram.begin() + (_feature_buffer.end() - start));
+
+  if(output_buf.format == int8_dtype && _dynamic_quantize_range > 0)
+  {
+    dynamic_scale_int8_spectrogram(
+      spectrogram.data(), 
+      (int8_t*)output_buf.ptr, 
+      _n_features * _n_channels, 
+      this->_dynamic_quantize_range
+    );
+    return;
+  }
+
+  void* output_ptr = output_buf.ptr;
+  for(int i = 0; i < _n_features; ++i)
+  {
+    const struct FrontendOutput slice = { &spectrogram[i * _n_channels], (size_t)_n_channels };
+    output_ptr = populate_func(this, slice, output_ptr);
+  }
+}
+
 
 
 /*************************************************************************************************/
@@ -213,6 +435,27 @@ static void verify_setting(const py::dict& settings, const std::string& name)
   }
 }
 
+/*************************************************************************************************/
+static PopulateFunc get_populate_func(const std::string& dtype)
+{
+  if(dtype == int8_dtype)
+  {
+    return &populate_int8_slice;
+  }
+  else if(dtype == uint16_dtype)
+  {
+    return &populate_uint16_slice;
+  }
+  else if(dtype == float_dtype)
+  {
+    return &populate_float_slice;
+  }
+  else
+  {
+    throw std::invalid_argument("Output data type must be a int8, uint16, or float32");
+  }
+}
+
 /*************************************************************************************************
  * Refer to:
  * https://github.com/tensorflow/tflite-micro/blob/main/tensorflow/lite/micro/examples/micro_speech/micro_features/micro_features_generator.cc#L84
@@ -1,5 +1,6 @@
 
 
+#include <vector>
 #include <pybind11/stl.h>
 #include <pybind11/numpy.h>
 
@@ -17,15 +18,31 @@ public:
     AudioFeatureGeneratorWrapper(const py::dict& settings);
     ~AudioFeatureGeneratorWrapper();
     void process_sample(const py::array_t<int16_t>& input, py::array& output);
+    void process_batch(const py::array_t<int16_t>& inputs, py::array& outputs, int n_threads);
     bool activity_was_detected();
 
+    // Streaming API
+    // This mirrors the embedded AudioFeatureGenerator component:
+    // audio is processed as it is pushed, and the generated slices
+    // are stored in a ring buffer of _n_features slices
+    void reset();
+    py::array push(const py::array_t<int16_t>& samples, const py::dtype& dtype);
+    void get_features(py::array& output);
+
+    FrontendConfig _frontend_config;
     FrontendState _frontend_state;
+    int _sample_rate_hz;
     int _sample_length;
     int _n_channels;
     int _n_features;
     int _window_step;
     int _window_size;
     int _dynamic_quantize_range;
+    std::vector<uint16_t> _feature_buffer;
+    int _feature_buffer_start;
+
+private:
+    void generate_spectrogram(FrontendState* state, const int16_t* audio, void* output, const std::string& dtype);
 };
 
 
@@ -31,6 +31,14 @@ PYBIND11_MODULE(MODULE_NAME, m)
     py::class_<mltk::AudioFeatureGeneratorWrapper>(m, "AudioFeatureGeneratorWrapper")
     .def(py::init<const py::dict&>())
     .def("process_sample", &mltk::AudioFeatureGeneratorWrapper::process_sample)
+    .def("process_batch", &mltk::AudioFeatureGeneratorWrapper::process_batch, 
+        py::arg("inputs"), 
+        py::arg("outputs"), 
+        py::arg("n_threads") = 0
+    )
     .def("activity_was_detected", &mltk::AudioFeatureGeneratorWrapper::activity_was_detected)
+    .def("reset", &mltk::AudioFeatureGeneratorWrapper::reset)
+    .def("push", &mltk::AudioFeatureGeneratorWrapper::push)
+    .def("get_features", &mltk::AudioFeatureGeneratorWrapper::get_features)
     ;
 }
\ No newline at end of file
@@ -30,6 +30,7 @@
 #include "tensorflow/lite/micro/all_ops_resolver.h"
 #include "tflite_micro_model/tflite_micro_model.hpp"
 #include "mltk_tflite_micro_helper.hpp"
+#include "profiling/profiler_trace.hpp"
 
 #include "cli_opts.hpp"
 
@@ -47,6 +48,13 @@ static void audio_classifier_task(void *arg);
 static sl_sleeptimer_timer_handle_t inference_timer;
 #endif
 
+#ifndef __arm__
+// Size of the profiler trace ring buffer when the --trace option is given
+#define TRACE_MAX_EVENTS (64*1024)
+// Write the profiler trace file every this many inferences
+#define TRACE_EXPORT_INTERVAL 50
+#endif
+
 #if SL_SIMPLE_LED_COUNT < 2
   #error "Sample application requires two leds"
 #endif
@@ -114,6 +122,14 @@ void audio_classifier_init(void)
   // Register the accelerator if the TFLM lib was built with one
   mltk::mltk_tflite_micro_register_accelerator();
 
+#ifndef __arm__
+  // The profiler must be enabled before loading the model to record a trace
+  if(!cli_opts.trace_path.empty())
+  {
+    model.enable_profiler();
+  }
+#endif
+
   // Attempt to load the model using the arena size specified in the .tflite
   if(!model.load(cli_opts.model_flatbuffer, op_resolver))
   {
@@ -122,6 +138,19 @@ void audio_classifier_init(void)
       ;
   }
 
+#ifndef __arm__
+  if(!cli_opts.trace_path.empty())
+  {
+    if(!profiling::trace_enable(model.profiler(), TRACE_MAX_EVENTS))
+    {
+      printf("ERROR: Failed to allocate profiler trace buffer\n");
+      while(1)
+        ;
+    }
+    printf("Writing profiler trace to %s\n", cli_opts.trace_path.c_str());
+  }
+#endif
+
   model.print_summary();
 
   // Initialize the audio feature generation using the parameters
@@ -332,6 +361,18 @@ static sl_status_t run_inference()
     return SL_STATUS_FAIL;
   }
 
+#ifndef __arm__
+  // Periodically overwrite the trace file with the latest events in the trace ring buffer
+  static uint32_t inference_count = 0;
+  if(!cli_opts.trace_path.empty() && (++inference_count % TRACE_EXPORT_INTERVAL) == 0)
+  {
+    if(!profiling::trace_export_chrome_json(cli_opts.trace_path.c_str()))
+    {
+      printf("WARNING: Failed to write profiler trace to %s\n", cli_opts.trace_path.c_str());
+    }
+  }
+#endif
+
   return SL_STATUS_OK;
 }
 
@@ -38,6 +38,7 @@ void parse_cli_opts()
         ("r,dump_raw_spectrograms", "Dump the raw (i.e. unquantized) generated spectorgrams to the given directory", cxxopts::value<std::string>())
         ("z,dump_spectrograms", "Dump the quantized generated spectorgrams to the given directory", cxxopts::value<std::string>())
         ("i,sensitivity", "Sensitivity of the activity indicator", cxxopts::value<float>())
+        ("T,trace", "Record the model profiler events and periodically write them as Chrome trace JSON to the given file path (view with chrome://tracing or ui.perfetto.dev)", cxxopts::value<std::string>())
         ("h,help", "Print usage")
     ;
 
@@ -66,27 +67,15 @@ void parse_cli_opts()
 
         if(result.count("model"))
         {
-            const char* path = result["model"].as<std::string>().c_str();
-            auto fp = fopen(path,"rb");
-            if(fp == nullptr)
-            {
-                MLTK_ERROR("Failed to open model file: %s", path);
-                exit(-1);
-            }
+            const auto path = result["model"].as<std::string>();
 
-            fseek(fp, 0, SEEK_END); 
-            auto file_size = ftell(fp); 
-            fseek(fp, 0, SEEK_SET); 
-            auto buffer = malloc(file_size); 
-            auto result = fread(buffer, 1, file_size, fp);
-            fclose(fp);
-            if(result != file_size)
+            // Memory-map the model file instead of reading it into the heap
+            if(!mltk::map_model_flatbuffer(path.c_str(), &cli_opts.model_flatbuffer, &cli_opts.model_flatbuffer_len))
             {
-                MLTK_ERROR("Failed to read model file: %s", path);
+                MLTK_ERROR("Failed to load model file: %s", path.c_str());
                 exit(-1);
             }
 
-            cli_opts.model_flatbuffer = (uint8_t*)buffer;
             cli_opts.model_flatbuffer_provided = true;
         }
 
@@ -126,6 +115,11 @@ void parse_cli_opts()
             cli_opts.sensitivity_provided = true;
         }
 
+        if(result.count("trace"))
+        {
+            cli_opts.trace_path = result["trace"].as<std::string>();
+        }
+
         if(result.count("dump_audio"))
         {
             cli_opts.dump_audio = true;
@@ -158,7 +152,7 @@ CliOpts::~CliOpts()
 {
     if(model_flatbuffer_provided)
     {
-        free((void*)model_flatbuffer);
+        mltk::unmap_model_flatbuffer(model_flatbuffer, model_flatbuffer_len);
     }
 }
 
@@ -75,6 +75,7 @@ struct CliOpts
     int32_t volume_gain = VOLUME_GAIN;
     float sensitivity = SENSITIVITY;
     const uint8_t* model_flatbuffer = nullptr;
+    uint32_t model_flatbuffer_len = 0;
     bool verbose_provided = VERBOSE_PROVIDED;
     bool average_window_duration_ms_provided = WINDOW_MS_PROVIDED;
     bool detection_threshold_provided = THRESHOLD_PROVIDED;
@@ -89,6 +90,8 @@ struct CliOpts
     bool dump_spectrograms = false;
 
 #ifndef __arm__
+    std::string trace_path;
+
     ~CliOpts();
 #endif
 };
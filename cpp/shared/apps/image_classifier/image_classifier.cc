@@ -27,6 +27,7 @@
 #include "tflite_micro_model/tflite_micro_model.hpp"
 #include "tflite_micro_model/tflite_micro_utils.hpp"
 #include "mltk_tflite_micro_helper.hpp"
+#include "profiling/profiler_trace.hpp"
 #include "arducam/arducam.h"
 #include "jlink_stream/jlink_stream.hpp"
 
@@ -82,6 +83,7 @@ static void standardize_image_data(uint8_t* image_data, uint32_t image_size);
 static void process_inference_output();
 static void handle_result(int32_t current_time, int result, uint8_t score, bool is_new_command);
 static void dump_image(const uint8_t* image_data, uint32_t image_length);
+static void dump_trace_if_necessary();
 
 
 
@@ -110,6 +112,20 @@ void image_classifier_init(void)
     // Register the accelerator if the TFLM lib was built with one
     mltk::mltk_tflite_micro_register_accelerator();
 
+    // The profiler must be enabled before loading the model to record a trace,
+    // so the trace_events parameter is retrieved before the other parameters
+    {
+        mltk::TfliteModelParameters parameters;
+        if(mltk::TfliteModelParameters::load_from_tflite_flatbuffer(model_flatbuffer, parameters))
+        {
+            parameters.get("trace_events", app_settings.trace_events);
+        }
+    }
+    if(app_settings.trace_events > 0)
+    {
+        model.enable_profiler();
+    }
+
     // Attempt to load the model using the arena size specified in the .tflite
     if(!model.load(model_flatbuffer, op_resolver))
     {
@@ -118,6 +134,13 @@ void image_classifier_init(void)
         ;
     }
 
+    if(app_settings.trace_events > 0 && !profiling::trace_enable(model.profiler(), app_settings.trace_events))
+    {
+        printf("ERROR: Failed to allocate profiler trace buffer\n");
+        while(1)
+        ;
+    }
+
     model.print_summary();
 
     // Load the settings embedded into the .tflite model flatbuffer
@@ -255,9 +278,46 @@ void app_process_action()
 
         // Process the inference results
         process_inference_output();
+
+        dump_trace_if_necessary();
     }
 }
 
+/***************************************************************************//**
+ * Print the profiler trace to the console once the trace ring buffer
+ * does not have room for another inference
+ ******************************************************************************/
+static void dump_trace_if_necessary()
+{
+    static uint32_t events_per_inference = 0;
+    static uint32_t prev_event_count = 0;
+
+    if(app_settings.trace_events == 0)
+    {
+        return;
+    }
+
+    const uint32_t event_count = profiling::trace_event_count();
+    if(events_per_inference == 0)
+    {
+        events_per_inference = event_count - prev_event_count;
+    }
+    prev_event_count = event_count;
+
+    if(event_count + events_per_inference <= profiling::trace_capacity())
+    {
+        return;
+    }
+
+    printf("Profiler trace (Chrome trace JSON):\n");
+    profiling::trace_export_chrome_json([](const char* data, uint32_t length, void* arg) -> bool
+    {
+        return fwrite(data, 1, length, stdout) == length;
+    });
+    profiling::trace_clear();
+    prev_event_count = 0;
+}
+
 /***************************************************************************//**
  * Load the parameters embedded into the .tflite model file
  ******************************************************************************/
@@ -320,6 +380,7 @@ static bool load_model_parameters()
     printf("Supression count: %d samples\n", app_settings.suppression_count);
     printf("Minimum loop latency: %dms\n", app_settings.latency_ms);
     printf("Activity sensitivity: %f\n", app_settings.activity_sensitivity);
+    printf("Profiler trace events: %d\n", app_settings.trace_events);
 
 
     return true;
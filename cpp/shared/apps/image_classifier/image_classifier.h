@@ -18,6 +18,7 @@ struct AppSettings
     uint32_t suppression_count = 1; // The number of samples that are different than the last detected sample for a new detection to occur
     uint32_t latency_ms = 0; // This the amount of time in milliseconds between processing loop
     float activity_sensitivity = .5f;
+    uint32_t trace_events = 0; // Size of the profiler trace ring buffer, 0 disables tracing
 };
 
 
@@ -0,0 +1,371 @@
+#include <algorithm>
+#include <atomic>
+#include <cinttypes>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "profiling/host_timer.hpp"
+#include "benchmark.hpp"
+#include "cli_opts.hpp"
+
+
+using namespace mltk;
+
+
+struct LatencyStats
+{
+    uint64_t p50 = 0;
+    uint64_t p90 = 0;
+    uint64_t p99 = 0;
+    uint64_t max = 0;
+    uint64_t mean = 0;
+};
+
+struct BenchmarkInstance
+{
+    TfliteMicroModel* model = nullptr;
+    std::vector<profiling::Profiler*> layer_profilers;
+    std::vector<uint64_t> inference_latencies;
+    // layer_latencies[layer_index][iteration]
+    std::vector<std::vector<uint64_t>> layer_latencies;
+    // Timestamps of the measured inferences, i.e. excluding the warmup
+    uint64_t start_time_ns = 0;
+    uint64_t end_time_ns = 0;
+    bool success = true;
+};
+
+
+static void run_instance(BenchmarkInstance& instance, std::atomic<int>& ready_count, int n_threads);
+static LatencyStats calculate_latency_stats(std::vector<uint64_t>& latencies_ns);
+static std::string format_ns(uint64_t ns);
+static void write_json_string(FILE* fp, const char* str);
+static bool write_json(
+    const std::vector<std::unique_ptr<BenchmarkInstance>>& instances,
+    const LatencyStats& inference_stats,
+    const std::vector<LatencyStats>& layer_stats,
+    double throughput,
+    uint64_t total_time_ns
+);
+
+
+
+/*************************************************************************************************/
+bool run_benchmark(
+    TfliteMicroModel& model,
+    const std::function<bool(TfliteMicroModel&)>& load_model,
+    logging::Logger& logger
+)
+{
+    int n_threads = cli_opts.threads;
+
+#ifdef TFLITE_MICRO_ACCELERATOR
+    // The accelerator simulator only supports one model at a time
+    if(n_threads > 1)
+    {
+        logger.warn("Only 1 thread is supported when using an accelerator, ignoring --threads %d", n_threads);
+        n_threads = 1;
+    }
+#endif
+
+    logger.info("Benchmarking: warmup=%d, iterations=%d, threads=%d", cli_opts.warmup, cli_opts.iterations, n_threads);
+
+    // Load an additional instance of the model for each extra thread
+    std::vector<std::unique_ptr<TfliteMicroModel>> extra_models;
+    std::vector<std::unique_ptr<BenchmarkInstance>> instances;
+    for(int i = 0; i < n_threads; ++i)
+    {
+        auto instance = std::unique_ptr<BenchmarkInstance>(new BenchmarkInstance());
+        if(i == 0)
+        {
+            instance->model = &model;
+        }
+        else 
+        {
+            extra_models.emplace_back(new TfliteMicroModel());
+            if(!load_model(*extra_models.back()))
+            {
+                logger.error("Failed to load model instance for thread %d", i);
+                return false;
+            }
+            instance->model = extra_models.back().get();
+        }
+
+        auto inference_profiler = instance->model->profiler();
+        if(inference_profiler != nullptr)
+        {
+            for(auto layer_profiler : inference_profiler->children())
+            {
+                instance->layer_profilers.push_back(layer_profiler);
+            }
+        }
+        instance->inference_latencies.reserve(cli_opts.iterations);
+        instance->layer_latencies.resize(instance->layer_profilers.size());
+        for(auto& latencies : instance->layer_latencies)
+        {
+            latencies.reserve(cli_opts.iterations);
+        }
+        instances.push_back(std::move(instance));
+    }
+
+    // Start all the threads at the same time
+    // The first instance is executed on this thread
+    std::atomic<int> ready_count(0);
+    std::vector<std::thread> threads;
+    for(int i = 1; i < n_threads; ++i)
+    {
+        threads.emplace_back(run_instance, std::ref(*instances[i]), std::ref(ready_count), n_threads);
+    }
+    run_instance(*instances[0], ready_count, n_threads);
+    for(auto& t : threads)
+    {
+        t.join();
+    }
+
+    // The total time spans the measured inferences of all the threads,
+    // the warmup inferences are excluded
+    uint64_t start_time_ns = UINT64_MAX;
+    uint64_t end_time_ns = 0;
+    for(const auto& instance : instances)
+    {
+        if(!instance->success)
+        {
+            logger.error("Error while running inference");
+            return false;
+        }
+        start_time_ns = std::min(start_time_ns, instance->start_time_ns);
+        end_time_ns = std::max(end_time_ns, instance->end_time_ns);
+    }
+    const uint64_t total_time_ns = end_time_ns - start_time_ns;
+
+    // Combine the measurements from all the threads
+    std::vector<uint64_t> inference_latencies;
+    const int n_layers = instances[0]->layer_profilers.size();
+    std::vector<std::vector<uint64_t>> layer_latencies(n_layers);
+    for(const auto& instance : instances)
+    {
+        inference_latencies.insert(inference_latencies.end(), instance->inference_latencies.begin(), instance->inference_latencies.end());
+        for(int layer_index = 0; layer_index < n_layers; ++layer_index)
+        {
+            const auto& src = instance->layer_latencies[layer_index];
+            layer_latencies[layer_index].insert(layer_latencies[layer_index].end(), src.begin(), src.end());
+        }
+    }
+
+    const auto inference_stats = calculate_latency_stats(inference_latencies);
+    std::vector<LatencyStats> layer_stats;
+    for(auto& latencies : layer_latencies)
+    {
+        layer_stats.push_back(calculate_latency_stats(latencies));
+    }
+    const double throughput = (double)inference_latencies.size() * 1e9 / (double)std::max(total_time_ns, (uint64_t)1);
+
+    logger.info("Benchmark results (%d inferences):", (int)inference_latencies.size());
+    logger.info("  Throughput: %.2f inferences/s", throughput);
+    logger.info("  Inference latency: p50=%s p90=%s p99=%s max=%s",
+        format_ns(inference_stats.p50).c_str(),
+        format_ns(inference_stats.p90).c_str(),
+        format_ns(inference_stats.p99).c_str(),
+        format_ns(inference_stats.max).c_str()
+    );
+    logger.info("  Layer latency:");
+    for(int layer_index = 0; layer_index < n_layers; ++layer_index)
+    {
+        const auto& stats = layer_stats[layer_index];
+        logger.info("    %-32s p50=%s p90=%s p99=%s max=%s",
+            instances[0]->layer_profilers[layer_index]->name(),
+            format_ns(stats.p50).c_str(),
+            format_ns(stats.p90).c_str(),
+            format_ns(stats.p99).c_str(),
+            format_ns(stats.max).c_str()
+        );
+    }
+
+    return write_json(instances, inference_stats, layer_stats, throughput, total_time_ns);
+}
+
+/*************************************************************************************************/
+static void run_instance(BenchmarkInstance& instance, std::atomic<int>& ready_count, int n_threads)
+{
+    auto& model = *instance.model;
+
+    for(uint32_t i = 0; i < cli_opts.warmup; ++i)
+    {
+        if(!model.invoke())
+        {
+            instance.success = false;
+            break;
+        }
+    }
+
+    // Wait for all the threads to finish their warmup
+    // so the measured inferences run concurrently
+    ready_count.fetch_add(1);
+    while(ready_count.load() < n_threads)
+    {
+        std::this_thread::yield();
+    }
+
+    if(!instance.success)
+    {
+        return;
+    }
+
+    instance.start_time_ns = profiling::host_timer_get_timestamp_ns();
+    for(uint32_t i = 0; i < cli_opts.iterations; ++i)
+    {
+        const uint64_t start = profiling::host_timer_get_timestamp_ns();
+        if(!model.invoke())
+        {
+            instance.success = false;
+            return;
+        }
+        instance.inference_latencies.push_back(profiling::host_timer_get_timestamp_ns() - start);
+
+        for(size_t layer_index = 0; layer_index < instance.layer_profilers.size(); ++layer_index)
+        {
+            instance.layer_latencies[layer_index].push_back(instance.layer_profilers[layer_index]->stats().time_ns);
+        }
+    }
+    instance.end_time_ns = profiling::host_timer_get_timestamp_ns();
+}
+
+/*************************************************************************************************
+ * Calculate the latency percentiles using the nearest-rank method
+ */
+static LatencyStats calculate_latency_stats(std::vector<uint64_t>& latencies_ns)
+{
+    LatencyStats stats;
+    const size_t n = latencies_ns.size();
+    if(n == 0)
+    {
+        return stats;
+    }
+
+    std::sort(latencies_ns.begin(), latencies_ns.end());
+
+    const auto percentile = [&latencies_ns, n](int p) -> uint64_t
+    {
+        const size_t rank = (p * n + 99) / 100;
+        return latencies_ns[std::max(rank, (size_t)1) - 1];
+    };
+
+    uint64_t total = 0;
+    for(auto latency : latencies_ns)
+    {
+        total += latency;
+    }
+
+    stats.p50 = percentile(50);
+    stats.p90 = percentile(90);
+    stats.p99 = percentile(99);
+    stats.max = latencies_ns[n-1];
+    stats.mean = total / n;
+
+    return stats;
+}
+
+/*************************************************************************************************/
+static std::string format_ns(uint64_t ns)
+{
+    char buffer[32];
+    if(ns >= 1000000)
+    {
+        snprintf(buffer, sizeof(buffer), "%.3fms", ns / 1e6);
+    }
+    else 
+    {
+        snprintf(buffer, sizeof(buffer), "%.3fus", ns / 1e3);
+    }
+    return std::string(buffer);
+}
+
+/*************************************************************************************************/
+static void write_json_stats(FILE* fp, const LatencyStats& stats)
+{
+    fprintf(fp, "{\"p50\": %" PRIu64 ", \"p90\": %" PRIu64 ", \"p99\": %" PRIu64 ", \"max\": %" PRIu64 ", \"mean\": %" PRIu64 "}",
+        stats.p50, stats.p90, stats.p99, stats.max, stats.mean);
+}
+
+/*************************************************************************************************
+ * Write the results as JSON
+ *
+ * All latencies are in nanoseconds
+ */
+static bool write_json(
+    const std::vector<std::unique_ptr<BenchmarkInstance>>& instances,
+    const LatencyStats& inference_stats,
+    const std::vector<LatencyStats>& layer_stats,
+    double throughput,
+    uint64_t total_time_ns
+)
+{
+    // The JSON is always written to a file
+    // so it is not interleaved with the logger's output on stdout
+    FILE* fp = fopen(cli_opts.json_path.c_str(), "w");
+    if(fp == nullptr)
+    {
+        get_logger().error("Failed to open %s", cli_opts.json_path.c_str());
+        return false;
+    }
+
+    const auto& layer_profilers = instances[0]->layer_profilers;
+
+    fprintf(fp, "{\n");
+    fprintf(fp, "  \"warmup\": %u,\n", (unsigned)cli_opts.warmup);
+    fprintf(fp, "  \"iterations\": %u,\n", (unsigned)cli_opts.iterations);
+    fprintf(fp, "  \"threads\": %u,\n", (unsigned)instances.size());
+    fprintf(fp, "  \"total_time_ns\": %" PRIu64 ",\n", total_time_ns);
+    fprintf(fp, "  \"throughput\": %.3f,\n", throughput);
+    fprintf(fp, "  \"inference_latency_ns\": ");
+    write_json_stats(fp, inference_stats);
+    fprintf(fp, ",\n  \"layers\": [\n");
+    for(size_t layer_index = 0; layer_index < layer_stats.size(); ++layer_index)
+    {
+        fprintf(fp, "    {\"index\": %u, \"name\": ", (unsigned)layer_index);
+        write_json_string(fp, layer_profilers[layer_index]->name());
+        fprintf(fp, ", \"latency_ns\": ");
+        write_json_stats(fp, layer_stats[layer_index]);
+        fprintf(fp, "}%s\n", (layer_index < layer_stats.size() - 1) ? "," : "");
+    }
+    fprintf(fp, "  ]\n");
+    fprintf(fp, "}\n");
+
+    const bool success = (ferror(fp) == 0);
+    if(fclose(fp) != 0 || !success)
+    {
+        get_logger().error("Failed to write %s", cli_opts.json_path.c_str());
+        return false;
+    }
+    get_logger().info("Benchmark results written to %s", cli_opts.json_path.c_str());
+
+    return true;
+}
+
+/*************************************************************************************************
+ * Write the given string as a quoted and escaped JSON string
+ */
+static void write_json_string(FILE* fp, const char* str)
+{
+    fputc('"', fp);
+    for(; *str != 0; ++str)
+    {
+        const unsigned char c = static_cast<unsigned char>(*str);
+        if(c == '"' || c == '\\')
+        {
+            fputc('\\', fp);
+            fputc(c, fp);
+        }
+        else if(c < 0x20)
+        {
+            fprintf(fp, "\\u%04x", c);
+        }
+        else
+        {
+            fputc(c, fp);
+        }
+    }
+    fputc('"', fp);
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <functional>
+
+#include "logging/logger.hpp"
+#include "tflite_micro_model/tflite_micro_model.hpp"
+
+
+/**
+ * Benchmark mode for the model profiler (Windows/Linux only)
+ *
+ * This runs --warmup un-measured inferences followed by --iterations measured inferences
+ * on each of --threads threads. Each thread invokes its own instance of the model.
+ * The latency percentiles of each inference and each layer are then printed
+ * and written as JSON to the --json file.
+ *
+ * @param model The already loaded model
+ * @param load_model Callback to load additional instances of the model, one per extra thread
+ * @param logger Logger to print the results
+ * @return true if the benchmark successfully completed, false else
+ */
+bool run_benchmark(
+    mltk::TfliteMicroModel& model,
+    const std::function<bool(mltk::TfliteMicroModel&)>& load_model,
+    logging::Logger& logger
+);
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <string>
 #include <cstdio>
 #include <unistd.h>
@@ -21,6 +22,11 @@ void parse_cli_opts()
     options.add_options()
         ("v,verbose", "Enable verbose logging")
         ("m,model", "Path to .tflite model file. Use built-in, default model if omitted", cxxopts::value<std::string>())
+        ("b,benchmark", "Run the model multiple times and report the latency percentiles instead of a single profiling run")
+        ("warmup", "Benchmark mode: number of un-measured inferences to run first", cxxopts::value<uint32_t>()->default_value("5"))
+        ("iterations", "Benchmark mode: number of measured inferences to run on each thread", cxxopts::value<uint32_t>()->default_value("100"))
+        ("threads", "Benchmark mode: number of threads, each thread invokes its own instance of the model", cxxopts::value<uint32_t>()->default_value("1"))
+        ("json", "Benchmark mode: path of the JSON results file", cxxopts::value<std::string>()->default_value("benchmark_results.json"))
         ("h,help", "Print usage")
     ;
 
@@ -40,30 +46,26 @@ void parse_cli_opts()
             cli_opts.verbose_provided = true;
         }
 
+        if(result.count("benchmark"))
+        {
+            cli_opts.benchmark = true;
+        }
+        cli_opts.warmup = result["warmup"].as<uint32_t>();
+        cli_opts.iterations = std::max(result["iterations"].as<uint32_t>(), 1U);
+        cli_opts.threads = std::max(result["threads"].as<uint32_t>(), 1U);
+        cli_opts.json_path = result["json"].as<std::string>();
+
         if(result.count("model"))
         {
-            const char* path = result["model"].as<std::string>().c_str();
-            auto fp = fopen(path,"rb");
-            if(fp == nullptr)
-            {
-                MLTK_ERROR("Failed to open model file: %s", path);
-                exit(-1);
-            }
+            const auto path = result["model"].as<std::string>();
 
-            fseek(fp, 0, SEEK_END); 
-            auto file_size = ftell(fp); 
-            fseek(fp, 0, SEEK_SET); 
-            auto buffer = malloc(file_size); 
-            auto result = fread(buffer, 1, file_size, fp);
-            fclose(fp);
-            if(result != file_size)
+            // Memory-map the model file instead of reading it into the heap
+            if(!mltk::map_model_flatbuffer(path.c_str(), &cli_opts.model_flatbuffer, &cli_opts.model_flatbuffer_len))
             {
-                MLTK_ERROR("Failed to read model file: %s", path);
+                MLTK_ERROR("Failed to load model file: %s", path.c_str());
                 exit(-1);
             }
 
-            cli_opts.model_flatbuffer = (uint8_t*)buffer;
-            cli_opts.model_flatbuffer_len = file_size;
             cli_opts.model_flatbuffer_provided = true;
         }
     } 
@@ -80,6 +82,6 @@ CliOpts::~CliOpts()
 {
     if(model_flatbuffer_provided)
     {
-        free((void*)model_flatbuffer);
+        mltk::unmap_model_flatbuffer(model_flatbuffer, model_flatbuffer_len);
     }
 }
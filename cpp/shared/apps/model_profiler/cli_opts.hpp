@@ -21,6 +21,13 @@ struct CliOpts
     bool verbose_provided = VERBOSE_PROVIDED;
     bool model_flatbuffer_provided = false;
 
+    // Benchmark mode (see benchmark.hpp)
+    bool benchmark = false;
+    uint32_t warmup = 5;
+    uint32_t iterations = 100;
+    uint32_t threads = 1;
+    std::string json_path = "benchmark_results.json";
+
 
     ~CliOpts();
 };
@@ -11,6 +11,7 @@
 #ifndef __arm__
 // CLI parsing only supported on Windows/Linux
 #include "cli_opts.hpp"
+#include "benchmark.hpp"
 #endif
 
 
@@ -87,6 +88,23 @@ extern "C" int main(void)
     auto profiler = model.profiler();
     profiling::print_metrics(profiler, &logger);
 
+#ifndef __arm__
+    if(cli_opts.benchmark)
+    {
+        const auto load_model_instance = [&logger](TfliteMicroModel& instance) -> bool
+        {
+            return load_model(instance, logger, cli_opts.model_flatbuffer, cli_opts.model_flatbuffer_len);
+        };
+        if(!run_benchmark(model, load_model_instance, logger))
+        {
+            logger.error("Error while running benchmark");
+            return -1;
+        }
+        logger.info("done");
+        return 0;
+    }
+#endif // ifndef __arm__
+
     if(!model.invoke())
     {
         logger.error("Error while running inference");
@@ -189,7 +207,7 @@ static void dump_recorded_data(TfliteMicroModel &model, logging::Logger& logger)
          logger.error("No recorded data available");
         return;
     }
-    if(msgpack_deserialize_with_buffer(&root_obj, buffer, buffer_length, MSGPACK_FLAGS_NONE) != 0)
+    if(msgpack_deserialize_with_buffer(&root_obj, buffer, buffer_length, MSGPACK_DESERIALIZE_SINGLE_ALLOCATION) != 0)
     {
          logger.error("Failed to de-serialize recorded data");
         return;
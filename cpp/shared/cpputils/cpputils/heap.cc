@@ -1,6 +1,7 @@
 #ifndef MLTK_DLL_IMPORT
 
 #include <cstring>
+#include <cstddef>
 #include <cassert>
 
 
@@ -11,11 +12,6 @@
 using namespace cpputils;
 
 
-#if INTPTR_MAX == INT64_MAX
-#define STRUCT_PADDING uint8_t padding[4];
-#else
-#define STRUCT_PADDING
-#endif
 #ifdef __arm__
 #define acquire_lock()
 #define release_lock()
@@ -24,24 +20,78 @@ void acquire_lock();
 void release_lock();
 #endif
 
-#pragma pack(1)
-struct pool;
-typedef struct header
+
+/*
+ * Two-Level Segregated Fit (TLSF) allocator
+ *
+ * Free blocks are kept in segregated lists indexed by a first level (power-of-2 size class)
+ * and a second level (linear subdivision of the size class).
+ * Bitmaps of the non-empty lists allow for finding a suitable free block with two "find first set" instructions,
+ * so malloc and free are O(1).
+ *
+ * All blocks are ALIGN_SIZE aligned and their sizes are multiples of ALIGN_SIZE.
+ */
+#define ALIGN_SIZE_LOG2 3
+#define ALIGN_SIZE (1 << ALIGN_SIZE_LOG2)
+
+#ifdef __arm__
+// Embedded heaps are small, so use smaller control structure
+#define SL_INDEX_COUNT_LOG2 4
+#define FL_INDEX_MAX 24         /* Maximum block size of 16MB */
+#else
+#define SL_INDEX_COUNT_LOG2 5
+#define FL_INDEX_MAX 31         /* Maximum block size of 2GB */
+#endif
+
+#define SL_INDEX_COUNT (1 << SL_INDEX_COUNT_LOG2)
+#define FL_INDEX_SHIFT (SL_INDEX_COUNT_LOG2 + ALIGN_SIZE_LOG2)
+#define FL_INDEX_COUNT (FL_INDEX_MAX - FL_INDEX_SHIFT + 1)
+#define SMALL_BLOCK_SIZE (1 << FL_INDEX_SHIFT)
+#define BLOCK_SIZE_MAX ((uintptr_t)1 << FL_INDEX_MAX)
+
+
+#if INTPTR_MAX == INT64_MAX
+#define WORD_PADDING(name)
+#else
+// Pad the header words to 8 bytes so that blocks remain 8-byte aligned
+#define WORD_PADDING(name) uint32_t name;
+#endif
+
+typedef struct block_header
 {
-    struct header *ptr;         /* Pointer to circular successor */
-    uint32_t size;              /* Size in units of blocks */
-    STRUCT_PADDING
-} header_t;
+    struct block_header *prev_phys_block;   /* Only valid if the previous block is free,
+                                               this overlaps the last word of the previous block */
+    WORD_PADDING(padding0)
+    uintptr_t size;                         /* Size of the block's data, bit0: block is free, bit1: previous block is free */
+    WORD_PADDING(padding1)
+    struct block_header *next_free;         /* Only valid if the block is free */
+    struct block_header *prev_free;
+} block_header_t;
 
 typedef struct pool
 {
-    header_t base;
-    header_t *freep;            /* Current entry point to free list */
+    block_header_t block_null;                                  /* Empty free lists point to this */
+    uint32_t fl_bitmap;
+    uint32_t sl_bitmap[FL_INDEX_COUNT];
+    block_header_t *blocks[FL_INDEX_COUNT][SL_INDEX_COUNT];
     uint32_t total_size;
-    STRUCT_PADDING
+    uint32_t used;
+    uint32_t max_used;
+    uint32_t allocations;
 } pool_t;
 
-#pragma pack()
+
+#define BLOCK_FREE_BIT (1 << 0)
+#define BLOCK_PREV_FREE_BIT (1 << 1)
+#define BLOCK_HEADER_OVERHEAD (offsetof(block_header_t, next_free) - offsetof(block_header_t, size))
+#define BLOCK_START_OFFSET offsetof(block_header_t, next_free)
+#define BLOCK_SIZE_MIN (sizeof(block_header_t) - offsetof(block_header_t, size))
+
+static_assert(BLOCK_HEADER_OVERHEAD == ALIGN_SIZE, "Block header must keep blocks aligned");
+static_assert(BLOCK_START_OFFSET % ALIGN_SIZE == 0, "Block data must be aligned");
+static_assert(BLOCK_SIZE_MIN % ALIGN_SIZE == 0, "Minimum block size must be aligned");
+static_assert(SL_INDEX_COUNT <= 32, "Second level bitmap must fit in 32-bits");
+static_assert(FL_INDEX_COUNT <= 32, "First level bitmap must fit in 32-bits");
 
 
 
@@ -50,10 +100,11 @@ typedef struct pool
 #define MDEBUG(msg, ptr, length) debug_malloc_printf(msg, ptr, length)
 static void debug_malloc_printf(const char* msg, const void* ptr, unsigned length);
 #else
-#define MDEBUG(...) 
-#endif 
+#define MDEBUG(...)
+#endif
 static void* _malloc(uint32_t size, uint32_t alignment);
 static void _free(void *p);
+static uint32_t _usable_size(const void *p);
 
 
 static pool_t *memory_pool = nullptr;
@@ -62,27 +113,43 @@ static pool_t *memory_pool = nullptr;
 /*************************************************************************************************/
 extern "C" void* heap_malloc(uint32_t size)
 {
-    return heap_malloc_aligned(size, sizeof(uint32_t)); // always align to a word
+    return heap_malloc_aligned(size, ALIGN_SIZE);
 }
 
 /*************************************************************************************************/
 extern "C" void* heap_malloc_aligned(uint32_t size, uint32_t alignment)
 {
-    assert(alignment != 0);
-
-    void* ptr = _malloc(size, alignment);
+    void* ptr = heap_malloc_aligned_uninitialized(size, alignment);
 
-    // TODO: actually align ptr to specified alignement ...
-    
     if(ptr != nullptr)
     {
         memset(ptr, 0, size);
-    } 
-    else
+    }
+
+    return ptr;
+}
+
+/*************************************************************************************************/
+extern "C" void* heap_malloc_uninitialized(uint32_t size)
+{
+    return heap_malloc_aligned_uninitialized(size, ALIGN_SIZE);
+}
+
+/*************************************************************************************************/
+extern "C" void* heap_malloc_aligned_uninitialized(uint32_t size, uint32_t alignment)
+{
+    if(alignment == 0 || (alignment & (alignment - 1)) != 0)
+    {
+        assert(!"Alignment must be a power of 2");
+        return nullptr;
+    }
+
+    void* ptr = _malloc(size, alignment);
+    if(ptr == nullptr)
     {
        assert(!"Malloc failed");
     }
-    
+
     return ptr;
 }
 
@@ -99,41 +166,424 @@ extern "C" void heap_free(void* ptr)
     }
 }
 
+/*************************************************************************************************/
+extern "C" void* heap_realloc(void* ptr, uint32_t size)
+{
+    if(ptr == nullptr)
+    {
+        return heap_malloc(size);
+    }
+    else if(size == 0)
+    {
+        heap_free(ptr);
+        return nullptr;
+    }
+
+    const uint32_t usable_size = _usable_size(ptr);
+    if(size <= usable_size)
+    {
+        return ptr;
+    }
+
+    void* new_ptr = _malloc(size, ALIGN_SIZE);
+    if(new_ptr == nullptr)
+    {
+        return nullptr;
+    }
+
+    memcpy(new_ptr, ptr, usable_size);
+    _free(ptr);
+
+    return new_ptr;
+}
+
+/*************************************************************************************************/
+static inline int _ffs(uint32_t word)
+{
+    return __builtin_ctz(word);
+}
+
+/*************************************************************************************************/
+static inline int _fls(uint32_t word)
+{
+    return 31 - __builtin_clz(word);
+}
+
+/*************************************************************************************************/
+static inline uintptr_t align_up_ptr(uintptr_t value, uintptr_t align)
+{
+    return (value + (align - 1)) & ~(align - 1);
+}
+
+/*************************************************************************************************/
+static inline uintptr_t block_size(const block_header_t *block)
+{
+    return block->size & ~(uintptr_t)(BLOCK_FREE_BIT | BLOCK_PREV_FREE_BIT);
+}
+
+/*************************************************************************************************/
+static inline void block_set_size(block_header_t *block, uintptr_t size)
+{
+    block->size = size | (block->size & (BLOCK_FREE_BIT | BLOCK_PREV_FREE_BIT));
+}
+
+/*************************************************************************************************/
+static inline bool block_is_free(const block_header_t *block)
+{
+    return (block->size & BLOCK_FREE_BIT) != 0;
+}
+
+/*************************************************************************************************/
+static inline void block_set_free(block_header_t *block, bool free)
+{
+    block->size = free ? (block->size | BLOCK_FREE_BIT) : (block->size & ~(uintptr_t)BLOCK_FREE_BIT);
+}
+
+/*************************************************************************************************/
+static inline bool block_is_prev_free(const block_header_t *block)
+{
+    return (block->size & BLOCK_PREV_FREE_BIT) != 0;
+}
+
+/*************************************************************************************************/
+static inline void block_set_prev_free(block_header_t *block, bool free)
+{
+    block->size = free ? (block->size | BLOCK_PREV_FREE_BIT) : (block->size & ~(uintptr_t)BLOCK_PREV_FREE_BIT);
+}
+
+/*************************************************************************************************/
+static inline void* block_to_ptr(const block_header_t *block)
+{
+    return (uint8_t*)block + BLOCK_START_OFFSET;
+}
+
+/*************************************************************************************************/
+static inline block_header_t* block_from_ptr(const void *ptr)
+{
+    return (block_header_t*)((uint8_t*)ptr - BLOCK_START_OFFSET);
+}
+
+/*************************************************************************************************/
+static inline block_header_t* block_next(const block_header_t *block)
+{
+    return (block_header_t*)((uint8_t*)block_to_ptr(block) + block_size(block) - BLOCK_HEADER_OVERHEAD);
+}
+
+/*************************************************************************************************/
+static inline block_header_t* block_link_next(block_header_t *block)
+{
+    block_header_t *next = block_next(block);
+    next->prev_phys_block = block;
+    return next;
+}
+
+/*************************************************************************************************/
+static inline void block_mark_as_free(block_header_t *block)
+{
+    block_header_t *next = block_link_next(block);
+    block_set_prev_free(next, true);
+    block_set_free(block, true);
+}
+
+/*************************************************************************************************/
+static inline void block_mark_as_used(block_header_t *block)
+{
+    block_header_t *next = block_next(block);
+    block_set_prev_free(next, false);
+    block_set_free(block, false);
+}
+
+/*************************************************************************************************/
+static inline uintptr_t adjust_request_size(uintptr_t size)
+{
+    const uintptr_t aligned = align_up_ptr(size, ALIGN_SIZE);
+    if(size >= BLOCK_SIZE_MAX || aligned >= BLOCK_SIZE_MAX)
+    {
+        return 0;
+    }
+    return (aligned < BLOCK_SIZE_MIN) ? BLOCK_SIZE_MIN : aligned;
+}
+
+/*************************************************************************************************/
+static inline void mapping_insert(uintptr_t size, int *fli, int *sli)
+{
+    if(size < SMALL_BLOCK_SIZE)
+    {
+        *fli = 0;
+        *sli = (int)size / (SMALL_BLOCK_SIZE / SL_INDEX_COUNT);
+    }
+    else
+    {
+        const int fl = _fls((uint32_t)size);
+        *sli = (int)(size >> (fl - SL_INDEX_COUNT_LOG2)) ^ (1 << SL_INDEX_COUNT_LOG2);
+        *fli = fl - (FL_INDEX_SHIFT - 1);
+    }
+}
+
+/*************************************************************************************************/
+static inline void mapping_search(uintptr_t size, int *fli, int *sli)
+{
+    // Round up to the next list so that any block in the list is large enough
+    if(size >= SMALL_BLOCK_SIZE)
+    {
+        size += ((uintptr_t)1 << (_fls((uint32_t)size) - SL_INDEX_COUNT_LOG2)) - 1;
+    }
+    mapping_insert(size, fli, sli);
+}
+
+/*************************************************************************************************/
+static block_header_t* search_suitable_block(pool_t *pool, int *fli, int *sli)
+{
+    int fl = *fli;
+    int sl = *sli;
+
+    if(fl >= FL_INDEX_COUNT)
+    {
+        return nullptr;
+    }
+
+    uint32_t sl_map = pool->sl_bitmap[fl] & (~0U << sl);
+    if(sl_map == 0)
+    {
+        const uint32_t fl_map = (fl + 1 < 32) ? pool->fl_bitmap & (~0U << (fl + 1)) : 0;
+        if(fl_map == 0)
+        {
+            return nullptr;
+        }
+
+        fl = _ffs(fl_map);
+        sl_map = pool->sl_bitmap[fl];
+    }
+
+    sl = _ffs(sl_map);
+    *fli = fl;
+    *sli = sl;
+
+    return pool->blocks[fl][sl];
+}
+
+/*************************************************************************************************/
+static void remove_free_block(pool_t *pool, block_header_t *block, int fl, int sl)
+{
+    block_header_t *prev = block->prev_free;
+    block_header_t *next = block->next_free;
+    next->prev_free = prev;
+    prev->next_free = next;
+
+    if(pool->blocks[fl][sl] == block)
+    {
+        pool->blocks[fl][sl] = next;
+
+        if(next == &pool->block_null)
+        {
+            pool->sl_bitmap[fl] &= ~(1U << sl);
+            if(pool->sl_bitmap[fl] == 0)
+            {
+                pool->fl_bitmap &= ~(1U << fl);
+            }
+        }
+    }
+}
+
+/*************************************************************************************************/
+static void insert_free_block(pool_t *pool, block_header_t *block, int fl, int sl)
+{
+    block_header_t *current = pool->blocks[fl][sl];
+    block->next_free = current;
+    block->prev_free = &pool->block_null;
+    current->prev_free = block;
+
+    pool->blocks[fl][sl] = block;
+    pool->fl_bitmap |= (1U << fl);
+    pool->sl_bitmap[fl] |= (1U << sl);
+}
+
+/*************************************************************************************************/
+static void block_remove(pool_t *pool, block_header_t *block)
+{
+    int fl, sl;
+    mapping_insert(block_size(block), &fl, &sl);
+    remove_free_block(pool, block, fl, sl);
+}
+
+/*************************************************************************************************/
+static void block_insert(pool_t *pool, block_header_t *block)
+{
+    int fl, sl;
+    mapping_insert(block_size(block), &fl, &sl);
+    insert_free_block(pool, block, fl, sl);
+}
+
+/*************************************************************************************************/
+static inline bool block_can_split(const block_header_t *block, uintptr_t size)
+{
+    return block_size(block) >= sizeof(block_header_t) + size;
+}
+
+/*************************************************************************************************/
+static block_header_t* block_split(block_header_t *block, uintptr_t size)
+{
+    // The remaining block starts at the end of the given size,
+    // its prev_phys_block overlaps the last word of the split block
+    block_header_t *remaining = (block_header_t*)((uint8_t*)block_to_ptr(block) + size - BLOCK_HEADER_OVERHEAD);
+    const uintptr_t remaining_size = block_size(block) - (size + BLOCK_HEADER_OVERHEAD);
+
+    remaining->size = remaining_size;
+    block_set_size(block, size);
+    block_mark_as_free(remaining);
+
+    return remaining;
+}
+
+/*************************************************************************************************/
+static block_header_t* block_absorb(block_header_t *prev, block_header_t *block)
+{
+    prev->size += block_size(block) + BLOCK_HEADER_OVERHEAD;
+    block_link_next(prev);
+    return prev;
+}
+
+/*************************************************************************************************/
+static block_header_t* block_merge_prev(pool_t *pool, block_header_t *block)
+{
+    if(block_is_prev_free(block))
+    {
+        block_header_t *prev = block->prev_phys_block;
+        block_remove(pool, prev);
+        block = block_absorb(prev, block);
+    }
+
+    return block;
+}
+
+/*************************************************************************************************/
+static block_header_t* block_merge_next(pool_t *pool, block_header_t *block)
+{
+    block_header_t *next = block_next(block);
+
+    if(block_is_free(next))
+    {
+        block_remove(pool, next);
+        block = block_absorb(block, next);
+    }
+
+    return block;
+}
+
+/*************************************************************************************************/
+static void block_trim_free(pool_t *pool, block_header_t *block, uintptr_t size)
+{
+    // Return any trailing space to the free lists
+    if(block_can_split(block, size))
+    {
+        block_header_t *remaining = block_split(block, size);
+        block_link_next(block);
+        block_set_prev_free(remaining, true);
+        block_insert(pool, remaining);
+    }
+}
+
+/*************************************************************************************************/
+static block_header_t* block_trim_free_leading(pool_t *pool, block_header_t *block, uintptr_t size)
+{
+    // Return the leading space to the free lists,
+    // the remaining block's data starts at the given offset
+    block_header_t *remaining = block;
+
+    if(block_can_split(block, size))
+    {
+        remaining = block_split(block, size - BLOCK_HEADER_OVERHEAD);
+        block_set_prev_free(remaining, true);
+        block_link_next(block);
+        block_insert(pool, block);
+    }
+
+    return remaining;
+}
+
+/*************************************************************************************************/
+static block_header_t* block_locate_free(pool_t *pool, uintptr_t size)
+{
+    int fl = 0, sl = 0;
+    block_header_t *block = nullptr;
+
+    if(size != 0)
+    {
+        mapping_search(size, &fl, &sl);
+        block = search_suitable_block(pool, &fl, &sl);
+    }
+
+    if(block != nullptr && block != &pool->block_null)
+    {
+        remove_free_block(pool, block, fl, sl);
+        return block;
+    }
+
+    return nullptr;
+}
+
+/*************************************************************************************************/
+static void* block_prepare_used(pool_t *pool, block_header_t *block, uintptr_t size)
+{
+    block_trim_free(pool, block, size);
+    block_mark_as_used(block);
+
+    pool->used += block_size(block) + BLOCK_HEADER_OVERHEAD;
+    pool->max_used = (pool->used > pool->max_used) ? pool->used : pool->max_used;
+    pool->allocations += 1;
+
+    return block_to_ptr(block);
+}
+
 /*************************************************************************************************/
 extern "C" void heap_set_buffer(void* buffer, uint32_t length)
 {
     if(length != 0)
     {
-        uintptr_t buffer_addr = (uintptr_t)buffer;
-        uintptr_t start_addr = uintptr_t(buffer_addr) + sizeof(pool_t);
-        auto start_alignment_required = sizeof(header_t);  // required by _free(start[1]) invocation        
-        while(start_addr & (start_alignment_required-1)) {
-            ++start_addr;
-            ++buffer_addr;
-            --length;
+        // The pool's control structure is at the beginning of the buffer,
+        // followed by a word that holds the (unused) prev_phys_block of the first block
+        const uintptr_t buffer_addr = (uintptr_t)buffer;
+        const uintptr_t pool_addr = align_up_ptr(buffer_addr, alignof(pool_t));
+        const uintptr_t mem_addr = align_up_ptr(pool_addr + sizeof(pool_t), ALIGN_SIZE) + BLOCK_HEADER_OVERHEAD;
+        const uintptr_t end_addr = buffer_addr + length;
+
+        assert(end_addr > mem_addr + BLOCK_SIZE_MIN + 2*BLOCK_HEADER_OVERHEAD);
+
+        // Reserve space for the first block's header and the sentinel block's header
+        uintptr_t pool_bytes = ((end_addr - mem_addr - 2*BLOCK_HEADER_OVERHEAD) / ALIGN_SIZE) * ALIGN_SIZE;
+        if(pool_bytes >= BLOCK_SIZE_MAX)
+        {
+            pool_bytes = BLOCK_SIZE_MAX - ALIGN_SIZE;
         }
-        uint8_t* buffer_ptr = reinterpret_cast<uint8_t*>(buffer_addr);
-
-        uint8_t unaligned_amount = (buffer_addr & (sizeof(uintptr_t)-1));
-        assert(unaligned_amount == 0);  // since now aligning based on header_t, just check that this old alignment requirement is already met
-        uint8_t align_amount = (unaligned_amount > 0) ? sizeof(uintptr_t) - unaligned_amount : 0;
-        buffer_ptr += align_amount;
-        length -= align_amount;
 
-        auto pool = reinterpret_cast<pool_t*>(buffer_ptr);
+        auto pool = reinterpret_cast<pool_t*>(pool_addr);
+        memset(pool, 0, sizeof(pool_t));
+        pool->block_null.next_free = &pool->block_null;
+        pool->block_null.prev_free = &pool->block_null;
+        for(int fl = 0; fl < FL_INDEX_COUNT; ++fl)
+        {
+            for(int sl = 0; sl < SL_INDEX_COUNT; ++sl)
+            {
+                pool->blocks[fl][sl] = &pool->block_null;
+            }
+        }
 
-        memset(buffer_ptr, 0, length);
+        // Create one large free block
+        auto block = reinterpret_cast<block_header_t*>(mem_addr - BLOCK_HEADER_OVERHEAD);
+        block->size = pool_bytes;
+        block_set_free(block, true);
+        block_set_prev_free(block, false);
+        block_insert(pool, block);
 
-        pool->base.size = 0;
-        pool->base.ptr = pool->freep = &pool->base;
+        // Followed by a zero-size, used sentinel block
+        block_header_t *sentinel = block_link_next(block);
+        sentinel->size = 0;
+        block_set_free(sentinel, false);
+        block_set_prev_free(sentinel, true);
 
-        auto start = (header_t*)((uint8_t*)pool + sizeof(pool_t));
-        start->size = (length - sizeof(pool_t)) / sizeof(header_t);
-        pool->total_size = start->size * sizeof(header_t);
+        pool->total_size = pool_bytes + BLOCK_HEADER_OVERHEAD;
 
         memory_pool = pool;
-
-        _free(&start[1]);
     }
     else
     {
@@ -157,8 +607,8 @@ bool heap_get_buffer(void** buffer_ptr)
 /*************************************************************************************************/
 bool heap_get_stats(HeapStats *stats)
 {
-    header_t *p, *prevp;
-    uint32_t available_blocks = 0;
+    uint32_t free_blocks = 0;
+    uint32_t largest_free = 0;
 
     if(memory_pool == nullptr)
     {
@@ -168,23 +618,33 @@ bool heap_get_stats(HeapStats *stats)
 
     acquire_lock();
 
-    prevp = memory_pool->freep;
-
-    for (p = prevp->ptr;; prevp = p, p = p->ptr)
+    for(int fl = 0; fl < FL_INDEX_COUNT; ++fl)
     {
-        available_blocks += p->size;
+        if((memory_pool->fl_bitmap & (1U << fl)) == 0)
+        {
+            continue;
+        }
 
-        if (p == memory_pool->freep)
+        for(int sl = 0; sl < SL_INDEX_COUNT; ++sl)
         {
-            break;
+            for(auto block = memory_pool->blocks[fl][sl]; block != &memory_pool->block_null; block = block->next_free)
+            {
+                const uint32_t size = (uint32_t)block_size(block);
+                largest_free = (size > largest_free) ? size : largest_free;
+                free_blocks += 1;
+            }
         }
     }
 
-    release_lock();
-
     stats->size = memory_pool->total_size;
-    stats->remaining = available_blocks * sizeof(header_t);
-    stats->used = stats->size - stats->remaining;
+    stats->used = memory_pool->used;
+    stats->remaining = stats->size - stats->used;
+    stats->max_used = memory_pool->max_used;
+    stats->largest_free = largest_free;
+    stats->free_blocks = free_blocks;
+    stats->allocations = memory_pool->allocations;
+
+    release_lock();
 
     return true;
 }
@@ -192,59 +652,64 @@ bool heap_get_stats(HeapStats *stats)
 /*************************************************************************************************/
 static void* _malloc(uint32_t length, uint32_t alignment)
 {
-    header_t *p, *prevp;
     void* retval = nullptr;
 
-    unsigned aligned_length = align_up(length, sizeof (header_t));
-    assert(alignment <= sizeof (header_t));
-
-    /*
-     * Smallest multiple of sizeof (headers), which the
-     * can contain required number of bytes, plus 1 for the header itself:
-     */
-    unsigned num_blocks = aligned_length / sizeof (header_t) + 1;
-
-
     if(memory_pool == nullptr)
     {
         assert(!"Must call heap_set_buffer() first");
         return nullptr;
     }
 
-    acquire_lock();
-
-    prevp = memory_pool->freep;
+    const uintptr_t adjusted_length = adjust_request_size(length);
+    if(adjusted_length == 0)
+    {
+        MDEBUG("malloc failed", nullptr, length);
+        return nullptr;
+    }
 
-    for (p = prevp->ptr;; prevp = p, p = p->ptr)
+    // Blocks are always ALIGN_SIZE aligned.
+    // For larger alignments, allocate enough extra space so that the
+    // leading gap can be returned to the free lists as its own block
+    const uintptr_t gap_min = sizeof(block_header_t);
+    uintptr_t search_length = adjusted_length;
+    if(alignment > ALIGN_SIZE)
     {
-        /*
-         * P mesh opening the free-list, followed by prevp, no
-         * Termination condition!
-         */
+        search_length = adjust_request_size((uintptr_t)adjusted_length + alignment + gap_min);
+        if(search_length == 0)
+        {
+            MDEBUG("malloc failed", nullptr, length);
+            return nullptr;
+        }
+    }
+
+    acquire_lock();
 
-        if (p->size >= num_blocks)          /* If p is large enough? */
+    block_header_t *block = block_locate_free(memory_pool, search_length);
+    if(block != nullptr)
+    {
+        if(alignment > ALIGN_SIZE)
         {
-            if (p->size == num_blocks)     /* If exactly, he is ... */
+            const uintptr_t ptr = (uintptr_t)block_to_ptr(block);
+            uintptr_t aligned = align_up_ptr(ptr, alignment);
+            uintptr_t gap = aligned - ptr;
+
+            // The leading gap must be large enough to hold a free block
+            if(gap != 0 && gap < gap_min)
             {
-                prevp->ptr = p->ptr ;      /* ... the list */
+                const uintptr_t gap_remain = gap_min - gap;
+                const uintptr_t offset = (gap_remain > alignment) ? gap_remain : alignment;
+                aligned = align_up_ptr(aligned + offset, alignment);
+                gap = aligned - ptr;
             }
-            else                                /* otherwise ... */
+
+            if(gap != 0)
             {
-                p->size -= num_blocks;     /* P is reduced */
-                p += p->size;                /* ... And the last part */
-                p->size = num_blocks;      /* ... The block ... */
+                block = block_trim_free_leading(memory_pool, block, gap);
             }
-            memory_pool->freep = prevp;
-            MDEBUG("malloc", &p[1], length);
-            retval = (void *) &p[1];              /* return but at the address of p + sizeof(header_t),
-                                                   since p points to the header. */
-            break;
         }
 
-        if (p == memory_pool->freep)                   /* the list does not contain a block big enough */
-        {
-            break;
-        }
+        retval = block_prepare_used(memory_pool, block, adjusted_length);
+        MDEBUG("malloc", retval, length);
     }
 
     release_lock();
@@ -260,74 +725,54 @@ static void* _malloc(uint32_t length, uint32_t alignment)
 /*************************************************************************************************/
 void _free (void * ap)
 {
-    header_t *bp, *p;
-    int max_scans = 1000000;
-
     // Ensure the pointer is a valid RAM address
     if(ap == nullptr)
     {
         return;
     }
 
-    acquire_lock();
-
-    bp = (header_t*)(((uint8_t*)ap) - sizeof(header_t)); /* Here is the header of the block */
-
-    // Ensure the header pointer is aligned
-    if(((uintptr_t)bp & (sizeof(header_t)-1)) != 0)
+    // Ensure the pointer is aligned
+    if(((uintptr_t)ap & (ALIGN_SIZE-1)) != 0)
     {
         assert(!"Invalid address given to free()");
-        goto exit;
+        return;
     }
 
-    /* The list is scanned, the block is to the Address size are inserted
-     * after properly for userspace defragmentation.
-     */
+    acquire_lock();
 
-    for(p = memory_pool->freep; !(bp> p && bp <p->ptr); p = p->ptr, --max_scans)
-    {
-        if(p >= p->ptr && (bp > p || bp < p->ptr))
-        {
-            break; /* Bp is present block with the smallest or behind  Largest block address */
-        }
-            
-        if(max_scans <= 0)
-        {
-            assert(!"Heap corruption");
-            goto exit;
-        }
-    }
+    block_header_t *block = block_from_ptr(ap);
 
-    /* Association with upper neighbors */
-    if(bp + bp->size == p->ptr)
-    {
-        bp->size += p->ptr->size;
-        bp->ptr = p->ptr->ptr;
-    }
-    else
+    if(block_is_free(block))
     {
-        bp->ptr = p->ptr;
+        assert(!"Heap corruption or double free");
+        goto exit;
     }
 
-    /* Union with lower neighbor */
-    if (p + p->size == bp)
-    {
-        p->size += bp->size;
-        p->ptr = bp->ptr;
-    }
-    else
-    {
-        p->ptr = bp;
-    }
+    MDEBUG("free", ap, block_size(block));
 
-    memory_pool->freep = p;
+    memory_pool->used -= block_size(block) + BLOCK_HEADER_OVERHEAD;
+    memory_pool->allocations -= 1;
 
-    MDEBUG("free", ap, bp->size*sizeof(header_t));
+    // Coalesce with the physically adjacent free blocks
+    block_mark_as_free(block);
+    block = block_merge_prev(memory_pool, block);
+    block = block_merge_next(memory_pool, block);
+    block_insert(memory_pool, block);
 
-    exit: 
+    exit:
     release_lock();
 }
 
+/*************************************************************************************************/
+static uint32_t _usable_size(const void *ap)
+{
+    acquire_lock();
+    const uint32_t size = (uint32_t)block_size(block_from_ptr(ap));
+    release_lock();
+
+    return size;
+}
+
 
 #ifndef __arm__
 #include <mutex>
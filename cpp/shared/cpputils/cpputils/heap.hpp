@@ -25,6 +25,10 @@ extern "C" {
 #define HEAP_MALLOC_OBJECT(type) (type*)heap_malloc_aligned(sizeof(type), alignof(type))
 #endif
 
+#ifndef HEAP_MALLOC_UNINITIALIZED
+#define HEAP_MALLOC_UNINITIALIZED(size) heap_malloc_uninitialized(size)
+#endif
+
 #ifndef HEAP_FREE
 #define HEAP_FREE(p) heap_free((void*)p)
 #endif
@@ -32,14 +36,39 @@ extern "C" {
 
 struct HeapStats
 {
-    uint32_t used;
-    uint32_t remaining;
-    uint32_t size;
+    uint32_t used;              /* Number of bytes currently allocated, including the block headers */
+    uint32_t remaining;         /* Number of bytes currently free, including the block headers */
+    uint32_t size;              /* Total number of bytes managed by the heap */
+    uint32_t max_used;          /* The maximum value "used" has reached since heap_set_buffer() */
+    uint32_t largest_free;      /* The largest allocation that can currently succeed */
+    uint32_t free_blocks;       /* Number of free blocks, i.e. the fragmentation of the free memory */
+    uint32_t allocations;       /* Number of currently allocated blocks */
 };
 
+
+/**
+ * The heap is a two-level segregated fit (TLSF) allocator:
+ * heap_malloc*() and heap_free() are O(1) and do not depend on the number of allocated or free blocks.
+ *
+ * heap_malloc() and heap_malloc_aligned() zero the returned memory,
+ * heap_malloc_uninitialized() and heap_malloc_aligned_uninitialized() do not.
+ *
+ * The returned memory is at least 8-byte aligned.
+ * heap_malloc_aligned() supports any power-of-2 alignment.
+ */
 DLL_EXPORT void* heap_malloc_aligned(uint32_t size, uint32_t alignment);
 DLL_EXPORT void* heap_malloc(uint32_t size); 
+DLL_EXPORT void* heap_malloc_aligned_uninitialized(uint32_t size, uint32_t alignment);
+DLL_EXPORT void* heap_malloc_uninitialized(uint32_t size); 
 DLL_EXPORT void heap_free(void* ptr);
+/**
+ * Resize the given block, with the same semantics as the C library's realloc():
+ * The contents are preserved up to the lesser of the old and new sizes, any additional memory is NOT zeroed.
+ * If the block is large enough, it is returned as-is, otherwise a new block is allocated and the old block is freed.
+ * The returned memory is 8-byte aligned, the alignment of a heap_malloc_aligned() block is NOT preserved.
+ * Returns nullptr (and the given block is NOT freed) if the new block could not be allocated.
+ */
+DLL_EXPORT void* heap_realloc(void* ptr, uint32_t size);
 
 DLL_EXPORT void heap_set_buffer(void* buffer, uint32_t length);
 DLL_EXPORT bool heap_get_buffer(void** buffer_ptr);
@@ -12,15 +12,22 @@ namespace cpputils
 
 
 /*************************************************************************************************/
-char* format_units(uint32_t number, uint8_t precision, char *buffer)
+char* format_units(uint64_t number, uint8_t precision, char *buffer)
 {
     static char default_buffer[24];
     const char *unit;
-    uint32_t divisor;
+    uint64_t divisor;
 
     buffer = (buffer == nullptr) ? default_buffer : buffer;
 
-    if(number > 1000*1000*1000)
+    // NOTE: The "T" unit keeps the whole part within 32-bits
+    // so it can be printed with %u (newlib-nano has no %llu)
+    if(number > 1000ULL*1000*1000*1000)
+    {
+        unit = "T";
+        divisor = 1000ULL*1000*1000*1000;
+    }
+    else if(number > 1000*1000*1000)
     {
         unit = "G";
         divisor = 1000*1000*1000;
@@ -57,8 +64,11 @@ char* format_units(uint32_t number, uint8_t precision, char *buffer)
             precision_factor *= 10;
         }
 
-        const uint32_t scaled = ((uint64_t)number * precision_factor) / divisor;
-        sprintf(buffer, fmt, scaled / precision_factor, scaled % precision_factor, unit);
+        // Scale the whole and fractional parts separately
+        // so that number*precision_factor cannot overflow
+        const uint32_t whole = (uint32_t)(number / divisor);
+        const uint32_t fraction = (uint32_t)(((number % divisor) * precision_factor) / divisor);
+        sprintf(buffer, fmt, (unsigned int)whole, (unsigned int)fraction, unit);
     }
 
     return buffer;
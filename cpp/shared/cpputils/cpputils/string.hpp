@@ -8,7 +8,7 @@
 namespace cpputils
 {
 
-char* format_units(uint32_t number, uint8_t precision = 2, char *buffer = nullptr);
+char* format_units(uint64_t number, uint8_t precision = 2, char *buffer = nullptr);
 const char* format_microseconds_to_milliseconds(uint32_t time_us, char *buffer = nullptr);
 const char* format_rate(uint32_t total, uint32_t elapsed_time_us, uint8_t precision = 2, char *buffer = nullptr);
 
@@ -0,0 +1,307 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+
+#include "cpputils/heap.hpp"
+#include "cpputils/prng.hpp"
+
+
+/**
+ * Randomized stress test and benchmark of the cpputils heap
+ *
+ * The stress test randomly allocates and frees blocks of various sizes and alignments,
+ * fills each block with a pattern and verifies the pattern before the block is freed.
+ * The heap statistics are also verified throughout.
+ *
+ * The benchmark replays the same random sequence of allocations with the heap and with the system malloc().
+ *
+ * Usage: mltk_cpputils_heap_test [number of operations, default: 200000]
+ */
+
+
+#define HEAP_SIZE (32*1024*1024)
+#define N_SLOTS 1024
+#define BLOCK_HEADER_OVERHEAD 8
+
+#define CHECK(expr) if(!(expr)) { printf("%s:%d: Check failed: %s\n", __FILE__, __LINE__, #expr); return false; }
+
+
+struct Operation
+{
+    uint32_t slot;
+    uint32_t size;
+    uint32_t alignment;
+};
+
+struct Slot
+{
+    uint8_t *ptr;
+    uint32_t size;
+};
+
+
+/*************************************************************************************************/
+static void generate_operations(Operation *ops, uint32_t count)
+{
+    cpputils::pseudo_rand(42);
+
+    for(uint32_t i = 0; i < count; ++i)
+    {
+        const uint32_t r = cpputils::pseudo_rand();
+        const uint32_t size_class = r % 100;
+        auto &op = ops[i];
+
+        op.slot = (r >> 8) % N_SLOTS;
+        if(size_class < 75)
+        {
+            op.size = 1 + cpputils::pseudo_rand() % 256;
+        }
+        else if(size_class < 95)
+        {
+            op.size = 1 + cpputils::pseudo_rand() % 4096;
+        }
+        else
+        {
+            op.size = 1 + cpputils::pseudo_rand() % (64*1024);
+        }
+
+        op.alignment = ((r >> 24) % 8 == 0) ? (16 << ((r >> 28) % 8)) : 0;
+    }
+}
+
+/*************************************************************************************************/
+static uint8_t pattern_value(uint32_t slot, uint32_t offset)
+{
+    return (uint8_t)(slot * 31 + offset * 7 + 1);
+}
+
+/*************************************************************************************************/
+static bool verify_stats(uint32_t expected_allocations)
+{
+    HeapStats stats;
+
+    CHECK(heap_get_stats(&stats));
+    CHECK(stats.used + stats.remaining == stats.size);
+    CHECK(stats.allocations == expected_allocations);
+    CHECK(stats.max_used >= stats.used);
+    CHECK(stats.largest_free <= stats.remaining);
+    CHECK((stats.free_blocks == 0) == (stats.remaining == 0));
+
+    return true;
+}
+
+/*************************************************************************************************/
+static bool run_stress_test(const Operation *ops, uint32_t count)
+{
+    static Slot slots[N_SLOTS];
+    uint32_t allocations = 0;
+    HeapStats initial_stats;
+
+    memset(slots, 0, sizeof(slots));
+    CHECK(heap_get_stats(&initial_stats));
+    CHECK(initial_stats.used == 0 && initial_stats.free_blocks == 1);
+
+    for(uint32_t i = 0; i < count; ++i)
+    {
+        const auto &op = ops[i];
+        auto &slot = slots[op.slot];
+
+        if(slot.ptr != nullptr)
+        {
+            for(uint32_t offset = 0; offset < slot.size; ++offset)
+            {
+                CHECK(slot.ptr[offset] == pattern_value(op.slot, offset));
+            }
+            heap_free(slot.ptr);
+            slot.ptr = nullptr;
+            allocations -= 1;
+            continue;
+        }
+
+        if(op.alignment == 0)
+        {
+            slot.ptr = (uint8_t*)heap_malloc_uninitialized(op.size);
+            CHECK(slot.ptr != nullptr);
+            CHECK(((uintptr_t)slot.ptr & 7) == 0);
+        }
+        else
+        {
+            slot.ptr = (uint8_t*)heap_malloc_aligned_uninitialized(op.size, op.alignment);
+            CHECK(slot.ptr != nullptr);
+            CHECK(((uintptr_t)slot.ptr & (op.alignment - 1)) == 0);
+        }
+        slot.size = op.size;
+        allocations += 1;
+
+        for(uint32_t offset = 0; offset < slot.size; ++offset)
+        {
+            slot.ptr[offset] = pattern_value(op.slot, offset);
+        }
+
+        if((i % 4096) == 0 && !verify_stats(allocations))
+        {
+            return false;
+        }
+    }
+
+    CHECK(verify_stats(allocations));
+
+    HeapStats stats;
+    heap_get_stats(&stats);
+    printf("Stress test: %u operations, max used: %u of %u bytes, %u allocations, %u free blocks\n",
+        count, stats.max_used, stats.size, stats.allocations, stats.free_blocks);
+
+    for(uint32_t i = 0; i < N_SLOTS; ++i)
+    {
+        heap_free(slots[i].ptr);
+        slots[i].ptr = nullptr;
+    }
+
+    // All of the free blocks should have been coalesced back into one block
+    CHECK(heap_get_stats(&stats));
+    CHECK(stats.used == 0);
+    CHECK(stats.allocations == 0);
+    CHECK(stats.free_blocks == 1);
+    CHECK(stats.largest_free == stats.size - BLOCK_HEADER_OVERHEAD);
+
+    // heap_malloc() must return zeroed memory, even if the block was previously used
+    auto p = (uint8_t*)heap_malloc_uninitialized(1024);
+    memset(p, 0xA5, 1024);
+    heap_free(p);
+    p = (uint8_t*)heap_malloc(1024);
+    for(int i = 0; i < 1024; ++i)
+    {
+        CHECK(p[i] == 0);
+    }
+    heap_free(p);
+
+    return true;
+}
+
+/*************************************************************************************************/
+static bool run_realloc_test()
+{
+    // realloc(nullptr) allocates zeroed memory
+    auto p = (uint8_t*)heap_realloc(nullptr, 100);
+    CHECK(p != nullptr);
+    for(uint32_t i = 0; i < 100; ++i)
+    {
+        CHECK(p[i] == 0);
+        p[i] = pattern_value(0, i);
+    }
+
+    // Shrinking and growing within the block returns the same block
+    CHECK(heap_realloc(p, 10) == p);
+    CHECK(heap_realloc(p, 100) == p);
+
+    // Growing moves the contents to a new block,
+    // block the space after it so it cannot be grown in-place
+    auto blocker = heap_malloc(16);
+    auto larger = (uint8_t*)heap_realloc(p, 64*1024);
+    CHECK(larger != nullptr);
+    CHECK(((uintptr_t)larger & 7) == 0);
+    for(uint32_t i = 0; i < 100; ++i)
+    {
+        CHECK(larger[i] == pattern_value(0, i));
+    }
+    memset(larger + 100, 0xA5, 64*1024 - 100);
+    CHECK(verify_stats(2));
+
+    // A failed realloc keeps the original block
+    CHECK(heap_realloc(larger, HEAP_SIZE) == nullptr);
+    CHECK(larger[0] == pattern_value(0, 0));
+    CHECK(verify_stats(2));
+
+    // A size of 0 frees the block
+    CHECK(heap_realloc(larger, 0) == nullptr);
+    heap_free(blocker);
+    CHECK(verify_stats(0));
+
+    HeapStats stats;
+    CHECK(heap_get_stats(&stats));
+    CHECK(stats.used == 0);
+    CHECK(stats.free_blocks == 1);
+
+    return true;
+}
+
+/*************************************************************************************************/
+template<typename AllocFunc, typename FreeFunc>
+static double run_benchmark(const Operation *ops, uint32_t count, AllocFunc alloc_func, FreeFunc free_func)
+{
+    static void* ptrs[N_SLOTS];
+
+    memset(ptrs, 0, sizeof(ptrs));
+
+    const auto start = std::chrono::high_resolution_clock::now();
+    for(uint32_t i = 0; i < count; ++i)
+    {
+        const auto &op = ops[i];
+        if(ptrs[op.slot] != nullptr)
+        {
+            free_func(ptrs[op.slot]);
+            ptrs[op.slot] = nullptr;
+        }
+        else
+        {
+            ptrs[op.slot] = alloc_func(op.size);
+        }
+    }
+    const auto end = std::chrono::high_resolution_clock::now();
+
+    for(uint32_t i = 0; i < N_SLOTS; ++i)
+    {
+        if(ptrs[i] != nullptr)
+        {
+            free_func(ptrs[i]);
+        }
+    }
+
+    return std::chrono::duration<double, std::nano>(end - start).count() / count;
+}
+
+/*************************************************************************************************/
+int main(int argc, char** argv)
+{
+    const uint32_t count = (argc > 1) ? (uint32_t)atoi(argv[1]) : 200000;
+
+    auto heap_buffer = malloc(HEAP_SIZE);
+    auto ops = (Operation*)malloc(sizeof(Operation) * count);
+    if(heap_buffer == nullptr || ops == nullptr)
+    {
+        printf("Failed to allocate test buffers\n");
+        return -1;
+    }
+
+    heap_set_buffer(heap_buffer, HEAP_SIZE);
+    generate_operations(ops, count);
+
+    if(!run_stress_test(ops, count))
+    {
+        printf("Stress test failed\n");
+        return -1;
+    }
+
+    if(!run_realloc_test())
+    {
+        printf("Realloc test failed\n");
+        return -1;
+    }
+
+    const double heap_ns = run_benchmark(ops, count,
+        [](uint32_t size) { return heap_malloc_uninitialized(size); },
+        [](void* ptr) { heap_free(ptr); }
+    );
+    const double system_ns = run_benchmark(ops, count,
+        [](uint32_t size) { return malloc(size); },
+        [](void* ptr) { free(ptr); }
+    );
+
+    printf("Benchmark: heap: %.1f ns/op, system malloc: %.1f ns/op\n", heap_ns, system_ns);
+
+    free(ops);
+    free(heap_buffer);
+
+    return 0;
+}
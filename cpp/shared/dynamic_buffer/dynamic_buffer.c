@@ -7,8 +7,17 @@
 #include "dynamic_buffer.h"
 
 
+#ifndef MIN
+#define MIN(x,y)  ((x) < (y) ? (x) : (y))
+#endif /* ifndef MIN */
+#ifndef MAX
+#define MAX(x,y)  ((x) > (y) ? (x) : (y))
+#endif /* ifndef MAX */
+
+
 
 static int allocate_larger_buffer(dynamic_buffer_t *buffer, uint32_t additional_length);
+static dynamic_buffer_chunk_t* allocate_chunk(dynamic_buffer_chain_t *chain);
 
 
 
@@ -16,17 +25,15 @@ static int allocate_larger_buffer(dynamic_buffer_t *buffer, uint32_t additional_
 /*************************************************************************************************/
 int dynamic_buffer_alloc(dynamic_buffer_t *buffer, uint32_t length)
 {
-    int result;
-
     buffer->buffer = malloc(length);
 
     if(buffer->buffer == NULL)
     {
         return -1;
     }
-    memset(buffer->buffer, 0, length);
     buffer->buffer_end = buffer->buffer + length;
     buffer->prepend = buffer->append = buffer->buffer;
+    memset(&buffer->growth_policy, 0, sizeof(buffer->growth_policy));
 
     return 0;
 }
@@ -34,34 +41,18 @@ int dynamic_buffer_alloc(dynamic_buffer_t *buffer, uint32_t length)
 /*************************************************************************************************/
 int dynamic_buffer_realloc(dynamic_buffer_t *buffer, uint32_t additional_length)
 {
-    int result = 0;
-    const uint32_t remaining_len = dynamic_buffer_get_remaining_length(buffer);
-
-    if(remaining_len < additional_length)
+    if(dynamic_buffer_get_remaining_length(buffer) < additional_length)
     {
-        uint8_t *new_buffer;
-        const uint32_t new_length = dynamic_buffer_get_total_size(buffer) + additional_length;
-
-        new_buffer = malloc(new_length);
-        if(new_buffer == NULL)
-        {
-            return -1;
-        }
-        memset(new_buffer, 0, new_length);
-
-        const uint32_t prepend_offset = (uint32_t)(buffer->prepend - buffer->buffer);
-        const uint32_t append_offset = (uint32_t)(buffer->append - buffer->buffer);
-        memcpy(new_buffer, buffer->buffer, append_offset);
-
-        free(buffer->buffer);
-
-        buffer->buffer = new_buffer;
-        buffer->buffer_end = new_buffer + new_length;
-        buffer->prepend = new_buffer + prepend_offset;
-        buffer->append = new_buffer + append_offset;
+        return allocate_larger_buffer(buffer, additional_length);
     }
 
-    return result;
+    return 0;
+}
+
+/*************************************************************************************************/
+void dynamic_buffer_set_growth_policy(dynamic_buffer_t *buffer, const dynamic_buffer_growth_policy_t *policy)
+{
+    buffer->growth_policy = *policy;
 }
 
 /*************************************************************************************************/
@@ -127,13 +118,22 @@ int dynamic_buffer_vwrite(dynamic_buffer_t *buffer, const char *fmt, va_list arg
 
     for(;;)
     {
-        const int remaining = (buffer->buffer_end - buffer->append);
+        const uint32_t remaining = dynamic_buffer_get_remaining_length(buffer);
+        va_list args_copy;
 
-        length = vsnprintf((char*)buffer->append, remaining-1, fmt, args);
+        // The args may only be used once, so use a copy for each attempt
+        va_copy(args_copy, args);
+        length = vsnprintf((char*)buffer->append, remaining, fmt, args_copy);
+        va_end(args_copy);
 
-        if(length >= remaining)
+        if(length < 0)
+        {
+            return -1;
+        }
+        else if((uint32_t)length >= remaining)
         {
-            int result = allocate_larger_buffer(buffer, length);
+            // Also make room for the null-terminator
+            int result = allocate_larger_buffer(buffer, length + 1);
 
             if(result != 0)
             {
@@ -212,40 +212,131 @@ int dynamic_buffer_adjust_data_start(dynamic_buffer_t *buffer, int32_t adjust_am
     }
 }
 
+/*************************************************************************************************/
+void dynamic_buffer_chain_init(dynamic_buffer_chain_t *chain, uint32_t chunk_size)
+{
+    chain->head = chain->tail = NULL;
+    chain->length = 0;
+    chain->chunk_size = (chunk_size > 0) ? chunk_size : DYNAMIC_BUFFER_DEFAULT_CHUNK_SIZE;
+}
+
+/*************************************************************************************************/
+int dynamic_buffer_chain_write(dynamic_buffer_chain_t *chain, const void *data, uint32_t data_length)
+{
+    const uint8_t *src = data;
+
+    while(data_length > 0)
+    {
+        dynamic_buffer_chunk_t *chunk = chain->tail;
+
+        if(chunk == NULL || chunk->length == chunk->size)
+        {
+            chunk = allocate_chunk(chain);
+            if(chunk == NULL)
+            {
+                return -1;
+            }
+        }
+
+        const uint32_t n = MIN(data_length, chunk->size - chunk->length);
+        memcpy(&chunk->data[chunk->length], src, n);
+        chunk->length += n;
+        chain->length += n;
+        src += n;
+        data_length -= n;
+    }
+
+    return 0;
+}
+
+/*************************************************************************************************/
+uint32_t dynamic_buffer_chain_copy(const dynamic_buffer_chain_t *chain, void *dst, uint32_t max_length)
+{
+    uint8_t *ptr = dst;
+    uint32_t copied = 0;
+
+    for(const dynamic_buffer_chunk_t *chunk = chain->head; chunk != NULL && copied < max_length; chunk = chunk->next)
+    {
+        const uint32_t n = MIN(chunk->length, max_length - copied);
+        memcpy(&ptr[copied], chunk->data, n);
+        copied += n;
+    }
+
+    return copied;
+}
+
+/*************************************************************************************************/
+void dynamic_buffer_chain_reset(dynamic_buffer_chain_t *chain)
+{
+    dynamic_buffer_chunk_t *head = chain->head;
+
+    if(head != NULL)
+    {
+        chain->head = head->next;
+        dynamic_buffer_chain_free(chain);
+        head->next = NULL;
+        head->length = 0;
+        chain->head = chain->tail = head;
+    }
+
+    chain->length = 0;
+}
+
+/*************************************************************************************************/
+void dynamic_buffer_chain_free(dynamic_buffer_chain_t *chain)
+{
+    dynamic_buffer_chunk_t *chunk = chain->head;
+
+    while(chunk != NULL)
+    {
+        dynamic_buffer_chunk_t *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+
+    chain->head = chain->tail = NULL;
+    chain->length = 0;
+}
+
 
 /** --------------------------------------------------------------------------------------------
  *  Internal functions
  * -------------------------------------------------------------------------------------------- **/
 
-#ifndef MAX
-#define MAX(x,y)  ((x) > (y) ? (x) : (y))
-#endif /* ifndef MAX */
-#define ALIGN_n(x, n) ((((uint32_t)x) + ((n)-1)) & ~((n)-1))
-
-
 /*************************************************************************************************/
 static int allocate_larger_buffer(dynamic_buffer_t *buffer, uint32_t additional_length)
 {
     uint8_t *larger_buffer;
+    const dynamic_buffer_growth_policy_t *policy = &buffer->growth_policy;
     const uint32_t prepend_offset = (uint32_t)(buffer->prepend - buffer->buffer);
     const uint32_t append_offset = (uint32_t)(buffer->append - buffer->buffer);
-    uint32_t alloc_size = dynamic_buffer_get_total_size(buffer);
-    const uint32_t alloc_chunk_size = MAX(ALIGN_n(additional_length, 128), alloc_size / 2);
+    const uint32_t total_size = dynamic_buffer_get_total_size(buffer);
+    const uint32_t growth_percent = (policy->growth_percent > 0) ? policy->growth_percent : DYNAMIC_BUFFER_DEFAULT_GROWTH_PERCENT;
+    const uint32_t min_growth = (policy->min_growth > 0) ? policy->min_growth : DYNAMIC_BUFFER_DEFAULT_MIN_GROWTH;
+    const uint64_t required_size = (uint64_t)append_offset + additional_length;
+
+    if(required_size > UINT32_MAX)
+    {
+        return -1;
+    }
 
-    while(alloc_size < append_offset + additional_length)
+    // Grow by a fraction of the current size so that appending is amortized O(1)
+    uint64_t growth = MAX((uint64_t)total_size * growth_percent / 100, min_growth);
+    if(policy->max_growth > 0)
     {
-        alloc_size += alloc_chunk_size;
+        growth = MIN(growth, policy->max_growth);
     }
+    const uint64_t alloc_size = MIN(MAX((uint64_t)total_size + growth, required_size), UINT32_MAX);
 
-    larger_buffer = malloc(alloc_size);
+    // NOTE: The allocator may extend the buffer in-place,
+    // otherwise it copies the existing contents to the new buffer.
+    // The additional space is NOT zeroed.
+    // On embedded targets, realloc() is wrapped by the cpputils heap (see clib_wrappers)
+    larger_buffer = realloc(buffer->buffer, (size_t)alloc_size);
     if(larger_buffer == NULL)
     {
         return -1;
     }
-    memset(&larger_buffer[append_offset], 0, alloc_size-append_offset);
-    memcpy(larger_buffer, buffer->buffer, append_offset);
-
-    free(buffer->buffer);
 
     buffer->buffer = larger_buffer;
     buffer->buffer_end = larger_buffer + alloc_size;
@@ -253,4 +344,34 @@ static int allocate_larger_buffer(dynamic_buffer_t *buffer, uint32_t additional_
     buffer->append = larger_buffer + append_offset;
 
     return 0;
-}
\ No newline at end of file
+}
+
+/*************************************************************************************************/
+static dynamic_buffer_chunk_t* allocate_chunk(dynamic_buffer_chain_t *chain)
+{
+    // Each new chunk is at least half the size of the data already in the chain
+    // so the number of chunks grows logarithmically with the data length
+    const uint32_t chunk_size = MAX(chain->chunk_size, chain->length / 2);
+    dynamic_buffer_chunk_t *chunk = malloc(sizeof(dynamic_buffer_chunk_t) + chunk_size);
+
+    if(chunk == NULL)
+    {
+        return NULL;
+    }
+
+    chunk->next = NULL;
+    chunk->length = 0;
+    chunk->size = chunk_size;
+
+    if(chain->tail == NULL)
+    {
+        chain->head = chunk;
+    }
+    else
+    {
+        chain->tail->next = chunk;
+    }
+    chain->tail = chunk;
+
+    return chunk;
+}
@@ -7,20 +7,85 @@
 extern "C" {
 #endif
 
+/**
+ * Default growth of a @ref dynamic_buffer_t as a percentage of its current size
+ */
+#define DYNAMIC_BUFFER_DEFAULT_GROWTH_PERCENT 50
+/**
+ * Default minimum growth of a @ref dynamic_buffer_t in bytes
+ */
+#define DYNAMIC_BUFFER_DEFAULT_MIN_GROWTH 128
+/**
+ * Default minimum chunk size of a @ref dynamic_buffer_chain_t in bytes
+ */
+#define DYNAMIC_BUFFER_DEFAULT_CHUNK_SIZE 1024
+
+
+/**
+ * Dynamic buffer growth policy
+ *
+ * When more space is required, the buffer grows by:
+ * @code{.c}
+ * MIN(MAX(total_size * growth_percent / 100, min_growth), max_growth)
+ * @endcode
+ * or by the required length if that is larger.
+ * Growing by a percentage of the current size makes appending amortized O(1).
+ *
+ * A zero value uses the default.
+ */
+typedef struct
+{
+    uint16_t growth_percent;        ///< Percentage of the current size to grow by, default: @ref DYNAMIC_BUFFER_DEFAULT_GROWTH_PERCENT
+    uint32_t min_growth;            ///< Minimum number of bytes to grow by, default: @ref DYNAMIC_BUFFER_DEFAULT_MIN_GROWTH
+    uint32_t max_growth;            ///< Maximum number of bytes to grow by (unless more is required), default: unlimited
+} dynamic_buffer_growth_policy_t;
+
+
 typedef struct
 {
     uint8_t *buffer;                ///< Pointer to allocated buffer
     const uint8_t *buffer_end;      ///< Pointer to end of allocated buffer
     uint8_t *append;                ///< Pointer to where data should be appended to the buffer
     uint8_t *prepend;               ///< Pointer to where data should be prepended to the buffer
+    dynamic_buffer_growth_policy_t growth_policy; ///< How the buffer grows, see @ref dynamic_buffer_set_growth_policy()
 } dynamic_buffer_t;
 
 
+/**
+ * A chunk of a @ref dynamic_buffer_chain_t
+ */
+typedef struct dynamic_buffer_chunk
+{
+    struct dynamic_buffer_chunk *next;  ///< Next chunk in the chain, NULL if this is the last chunk
+    uint32_t length;                    ///< Number of bytes populated in `data`
+    uint32_t size;                      ///< Number of bytes allocated for `data`
+    uint8_t data[];                     ///< Chunk data
+} dynamic_buffer_chunk_t;
+
+/**
+ * Chain of buffer chunks
+ *
+ * This is a scatter/gather alternative to @ref dynamic_buffer_t.
+ * When more space is required, a new chunk is appended to the chain,
+ * so the previously written data is never copied (and its address never changes).
+ * The data is NOT contiguous, iterate the chunks starting at `head`
+ * or use @ref dynamic_buffer_chain_copy() to gather the data into a contiguous buffer.
+ */
+typedef struct
+{
+    dynamic_buffer_chunk_t *head;       ///< First chunk in the chain
+    dynamic_buffer_chunk_t *tail;       ///< Last chunk in the chain, data is appended to this chunk
+    uint32_t length;                    ///< Total number of bytes populated in all the chunks
+    uint32_t chunk_size;                ///< Minimum size of each allocated chunk
+} dynamic_buffer_chain_t;
+
+
 
 /**
  * Allocate dynamic buffer
  *
- * This allocates a dynamic buffer of the specified length
+ * This allocates a dynamic buffer of the specified length.
+ * The buffer contents are NOT zeroed.
  *
  * @param[in] buffer @ref dynamic_buffer_t object to allocate a buffer for
  * @param[in] length Length in bytes of allocated buffer
@@ -33,8 +98,10 @@ int dynamic_buffer_alloc(dynamic_buffer_t *buffer, uint32_t length);
  *
  * This allocates a larger buffer if necessary. After this API returns,
  * the given buffer will have at least `additional_length` of additional space.
+ * The buffer grows according to its @ref dynamic_buffer_growth_policy_t
+ * and is re-allocated in-place if possible.
  *
- * @note The contents of the previous buffer will remain unchanged.
+ * @note The contents of the previous buffer will remain unchanged, the additional space is NOT zeroed.
  *
  * @param[in] buffer @ref dynamic_buffer_t object to allocate a larger buffer (if necessary)
  * @param[in] additional_length Additional required size
@@ -42,6 +109,16 @@ int dynamic_buffer_alloc(dynamic_buffer_t *buffer, uint32_t length);
  */
 int dynamic_buffer_realloc(dynamic_buffer_t *buffer, uint32_t additional_length);
 
+/**
+ * Set the growth policy of a dynamic buffer
+ *
+ * @note This should be called after @ref dynamic_buffer_alloc()
+ *
+ * @param[in] buffer @ref dynamic_buffer_t to configure
+ * @param[in] policy @ref dynamic_buffer_growth_policy_t, zero values use the default
+ */
+void dynamic_buffer_set_growth_policy(dynamic_buffer_t *buffer, const dynamic_buffer_growth_policy_t *policy);
+
 /**
  * Copy dynamic buffer
  *
@@ -205,6 +282,61 @@ static inline uint8_t* dynamic_buffer_get_data_start(const dynamic_buffer_t *buf
 
 
 
+/**
+ * Initialize a chain of buffer chunks
+ *
+ * No memory is allocated until data is written to the chain.
+ *
+ * @param[in] chain @ref dynamic_buffer_chain_t to initialize
+ * @param[in] chunk_size Minimum size in bytes of each chunk, 0 uses @ref DYNAMIC_BUFFER_DEFAULT_CHUNK_SIZE.
+ *   Subsequent chunks are larger as the chain grows so that the number of chunks stays small.
+ */
+void dynamic_buffer_chain_init(dynamic_buffer_chain_t *chain, uint32_t chunk_size);
+
+/**
+ * Write data to a chain of buffer chunks
+ *
+ * The data is appended to the last chunk.
+ * If it does not fit, then the remainder is written to a new chunk.
+ * The previously written data is never copied.
+ *
+ * @param[in] chain @ref dynamic_buffer_chain_t
+ * @param[in] data Data to write
+ * @param[in] data_length Size in bytes of `data`
+ * @return @ref 0 on success
+ */
+int dynamic_buffer_chain_write(dynamic_buffer_chain_t *chain, const void *data, uint32_t data_length);
+
+/**
+ * Gather the data of a chain of buffer chunks
+ *
+ * This copies up to `max_length` bytes of the chain's data into the contiguous `dst` buffer.
+ *
+ * @param[in] chain @ref dynamic_buffer_chain_t
+ * @param[out] dst Buffer to hold the chain's data
+ * @param[in] max_length Size of `dst` in bytes
+ * @return Number of bytes copied to `dst`
+ */
+uint32_t dynamic_buffer_chain_copy(const dynamic_buffer_chain_t *chain, void *dst, uint32_t max_length);
+
+/**
+ * Reset a chain of buffer chunks
+ *
+ * This discards all the written data.
+ * The first chunk is kept for re-use, all the other chunks are de-allocated.
+ *
+ * @param[in] chain @ref dynamic_buffer_chain_t to reset
+ */
+void dynamic_buffer_chain_reset(dynamic_buffer_chain_t *chain);
+
+/**
+ * De-allocate a chain of buffer chunks
+ *
+ * @param[in] chain @ref dynamic_buffer_chain_t to de-allocate
+ */
+void dynamic_buffer_chain_free(dynamic_buffer_chain_t *chain);
+
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
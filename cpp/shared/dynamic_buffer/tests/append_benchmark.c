@@ -0,0 +1,181 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "dynamic_buffer.h"
+
+
+/**
+ * Microbenchmark of the append throughput of a dynamic_buffer_t with various growth policies
+ * and of a dynamic_buffer_chain_t.
+ *
+ * Many small records (16-80 bytes) are appended, similar to the msgpack buffered writer
+ * used by the tensor recorder. The written data is verified after each run.
+ *
+ * Usage: mltk_dynamic_buffer_append_benchmark [total MB, default: 16]
+ */
+
+
+#define RECORD_MAX_LENGTH 80
+#define N_ITERATIONS 3
+
+
+typedef int (*append_func_t)(void *ctx, const void *data, uint32_t length);
+typedef int (*verify_func_t)(void *ctx, uint32_t total_length);
+
+
+static uint8_t pattern[256];
+
+
+/*************************************************************************************************/
+static uint32_t record_length(uint32_t i)
+{
+    return 16 + (i * 7) % (RECORD_MAX_LENGTH - 16);
+}
+
+/*************************************************************************************************/
+static int verify_data(const uint8_t *data, uint32_t length)
+{
+    uint32_t offset = 0;
+
+    for(uint32_t i = 0; offset < length; ++i)
+    {
+        const uint32_t n = record_length(i);
+        if(memcmp(&data[offset], &pattern[i % 128], n) != 0)
+        {
+            return -1;
+        }
+        offset += n;
+    }
+
+    return 0;
+}
+
+/*************************************************************************************************/
+static int buffer_append(void *ctx, const void *data, uint32_t length)
+{
+    return dynamic_buffer_write((dynamic_buffer_t*)ctx, data, length);
+}
+
+/*************************************************************************************************/
+static int buffer_verify(void *ctx, uint32_t total_length)
+{
+    const dynamic_buffer_t *buffer = ctx;
+    if(dynamic_buffer_get_length(buffer) != total_length)
+    {
+        return -1;
+    }
+    return verify_data(dynamic_buffer_get_data_start(buffer), total_length);
+}
+
+/*************************************************************************************************/
+static int chain_append(void *ctx, const void *data, uint32_t length)
+{
+    return dynamic_buffer_chain_write((dynamic_buffer_chain_t*)ctx, data, length);
+}
+
+/*************************************************************************************************/
+static int chain_verify(void *ctx, uint32_t total_length)
+{
+    const dynamic_buffer_chain_t *chain = ctx;
+    int result;
+    uint8_t *data = malloc(total_length);
+
+    if(data == NULL)
+    {
+        return -1;
+    }
+    result = (chain->length == total_length && dynamic_buffer_chain_copy(chain, data, total_length) == total_length) ? 
+        verify_data(data, total_length) : -1;
+    free(data);
+
+    return result;
+}
+
+/*************************************************************************************************/
+static int run_benchmark(const char *name, void *ctx, append_func_t append, verify_func_t verify, uint32_t total_length)
+{
+    uint32_t written = 0;
+    uint32_t i;
+    const clock_t start = clock();
+
+    for(i = 0; written < total_length; ++i)
+    {
+        const uint32_t n = record_length(i);
+        if(written + n > total_length)
+        {
+            break;
+        }
+        if(append(ctx, &pattern[i % 128], n) != 0)
+        {
+            printf("%-24s: Failed to append data\n", name);
+            return -1;
+        }
+        written += n;
+    }
+
+    const double elapsed = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    if(verify(ctx, written) != 0)
+    {
+        printf("%-24s: Data verification failed\n", name);
+        return -1;
+    }
+
+    printf("%-24s: %8.1f MB/s (%u records, %.3fs)\n", 
+        name, 
+        (elapsed > 0) ? (written / (1024.0*1024.0)) / elapsed : 0.0, 
+        i, 
+        elapsed
+    );
+
+    return 0;
+}
+
+/*************************************************************************************************/
+int main(int argc, char *argv[])
+{
+    int result = 0;
+    const uint32_t total_length = ((argc > 1) ? (uint32_t)atoi(argv[1]) : 16) * 1024 * 1024;
+
+    struct 
+    {
+        const char *name;
+        dynamic_buffer_growth_policy_t policy;
+    } policies[] = 
+    {
+        { "buffer (default policy)", { 0, 0, 0 } },
+        { "buffer (double)",         { 100, 0, 0 } },
+        { "buffer (linear 64k)",     { 1, 64*1024, 64*1024 } },
+    };
+
+    for(int i = 0; i < (int)sizeof(pattern); ++i)
+    {
+        pattern[i] = (uint8_t)(i * 31 + 7);
+    }
+
+    printf("Appending %u MB of %d-%d byte records\n", total_length / (1024*1024), 16, RECORD_MAX_LENGTH);
+
+    for(int iter = 0; iter < N_ITERATIONS; ++iter)
+    {
+        for(int p = 0; p < (int)(sizeof(policies)/sizeof(policies[0])); ++p)
+        {
+            dynamic_buffer_t buffer;
+            if(dynamic_buffer_alloc(&buffer, 1024) != 0)
+            {
+                return -1;
+            }
+            dynamic_buffer_set_growth_policy(&buffer, &policies[p].policy);
+            result |= run_benchmark(policies[p].name, &buffer, buffer_append, buffer_verify, total_length);
+            dynamic_buffer_free(&buffer);
+        }
+
+        dynamic_buffer_chain_t chain;
+        dynamic_buffer_chain_init(&chain, 1024);
+        result |= run_benchmark("chain", &chain, chain_append, chain_verify, total_length);
+        dynamic_buffer_chain_free(&chain);
+    }
+
+    return result;
+}
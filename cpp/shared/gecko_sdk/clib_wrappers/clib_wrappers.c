@@ -58,7 +58,19 @@
 
 
 extern void* heap_malloc(uint32_t size); 
+extern void* heap_malloc_uninitialized(uint32_t size); 
 extern void heap_free(void* ptr);
+extern void* heap_realloc(void* ptr, uint32_t size);
+
+// malloc() zeros the allocated memory by default, as it always has,
+// since existing code may depend on it.
+// Enable the GECKO_SDK_MALLOC_UNINITIALIZED option to skip the zero fill.
+// calloc() always zeros the allocated memory
+#ifdef CLIB_WRAPPERS_MALLOC_UNINITIALIZED
+#define CLIB_WRAPPERS_MALLOC(size) heap_malloc_uninitialized(size)
+#else
+#define CLIB_WRAPPERS_MALLOC(size) heap_malloc(size)
+#endif
 
 
 
@@ -123,25 +135,41 @@ void __assert_func( const char * file, int line, const char * func, const char *
 /*************************************************************************************************/
 void* __wrap_malloc(uint32_t size)
 {
-  return heap_malloc(size);
+  return CLIB_WRAPPERS_MALLOC(size);
 }
 
 /*************************************************************************************************/
 void* __wrap__malloc_r(void *v, uint32_t size)
 {
-  return heap_malloc(size);
+  return CLIB_WRAPPERS_MALLOC(size);
 }
 
 /*************************************************************************************************/
 void* __wrap_calloc(uint32_t count, uint32_t size)
 {
+  if(size != 0 && count > UINT32_MAX / size)
+  {
+    return NULL;
+  }
   return heap_malloc(count*size);
 }
 
 /*************************************************************************************************/
 void* __wrap__calloc_r(void* x, uint32_t count, uint32_t size)
 {
-  return heap_malloc(count*size);
+  return __wrap_calloc(count, size);
+}
+
+/*************************************************************************************************/
+void* __wrap_realloc(void* p, uint32_t size)
+{
+  return heap_realloc(p, size);
+}
+
+/*************************************************************************************************/
+void* __wrap__realloc_r(void* x, void* p, uint32_t size)
+{
+  return heap_realloc(p, size);
 }
 
 /*************************************************************************************************/
@@ -14,4 +14,8 @@ mltk_define(GECKO_SDK_IO_STREAM_SERVICE_SOURCES
 
 mltk_define(GECKO_SDK_ENABLE_FREERTOS
 "Enable the FreeRTOS component"
-)
\ No newline at end of file
+)
+
+mltk_define(GECKO_SDK_MALLOC_UNINITIALIZED
+"Do NOT zero the memory returned by malloc(), by default malloc() zeros the memory. calloc() always zeros the memory"
+)
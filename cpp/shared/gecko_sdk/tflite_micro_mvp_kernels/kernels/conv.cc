@@ -7,6 +7,7 @@
 #include "tensorflow/lite/kernels/padding.h"
 #include "tensorflow/lite/micro/kernels/kernel_util.h"
 #include "CMSIS/NN/Include/arm_nnfunctions.h"
+#include "mltk_tflite_micro_host_kernels.hpp"
 
 #include "sl_mvp_config.h"
 #include "sl_mvp_ml_conv2d.h"
@@ -32,6 +33,7 @@ struct OpData {
   float       activation_max_f32;
   int         scratch_buffer_index;
   sli_mvp_ml_conv2d_s8_params_t op_params;
+  sli_mvp_program_cache_t program_cache;
 
   // CMSIS-NN per channel output multiplier and shift.
   int32_t     *per_channel_output_multiplier;
@@ -182,6 +184,21 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node)
         reinterpret_cast<int32_t*>(&data->op_params.output_activation_max),
         scaler_data, num_channels, SLI_MVP_ACCUMULATOR_MULTIPLIER));
 
+#if SL_MVP_PROGRAM_CACHE_MAX_PROGRAMS > 0
+      // Allocate the buffer to cache the MVP programs of this layer.
+      // The programs are built on the first Eval and replayed on subsequent Evals
+      const int program_count = sli_mvp_ml_conv2d_s8_get_program_count(&data->op_params);
+      sli_mvp_program_t *programs = nullptr;
+      if (program_count > 0 && program_count <= SL_MVP_PROGRAM_CACHE_MAX_PROGRAMS) {
+        programs = static_cast<sli_mvp_program_t*>(context->AllocatePersistentBuffer(
+                   context, program_count * sizeof(sli_mvp_program_t)));
+      }
+      sli_mvp_program_cache_init(&data->program_cache, programs, program_count);
+#else
+      // The program cache is disabled, skip the dry run that counts the programs
+      sli_mvp_program_cache_init(&data->program_cache, nullptr, 0);
+#endif
+
     } else {
       data->per_channel_output_multiplier = static_cast<int32_t*>(context->AllocatePersistentBuffer(
                                             context, num_channels * sizeof(int32_t)));
@@ -291,7 +308,7 @@ TfLiteStatus eval_mvp_int8(TfLiteContext* context,
     data->op_params.scratch_buffer = (float16_t*)context->GetScratchBuffer(context, data->scratch_buffer_index);
   }
 
-  TF_LITE_ENSURE_EQ(context, SL_STATUS_OK, sli_mvp_ml_conv2d_s8(&data->op_params));
+  TF_LITE_ENSURE_EQ(context, SL_STATUS_OK, sli_mvp_ml_conv2d_s8_cached(&data->op_params, &data->program_cache));
 
   return kTfLiteOk;
 }
@@ -382,7 +399,7 @@ TfLiteStatus eval_tflm_int8(OpData* data,
   op_params.quantized_activation_min = data->op_params.output_activation_min;
   op_params.quantized_activation_max = data->op_params.output_activation_max;
 
-  reference_integer_ops::ConvPerChannel(
+  mltk::host_kernels::ConvPerChannel(
     op_params,
     data->per_channel_output_multiplier,
     data->per_channel_output_shift,
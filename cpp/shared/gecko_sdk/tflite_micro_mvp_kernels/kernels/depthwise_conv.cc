@@ -5,6 +5,7 @@
 #include "tensorflow/lite/kernels/padding.h"
 #include "tensorflow/lite/micro/kernels/kernel_util.h"
 #include "CMSIS/NN/Include/arm_nnfunctions.h"
+#include "mltk_tflite_micro_host_kernels.hpp"
 
 #include "sl_mvp_ml_depthwise_conv2d.h"
 
@@ -369,7 +370,7 @@ TfLiteStatus eval_tflm_int8(OpData* data,
   dw_op_params.quantized_activation_max = data->op_params.output_activation_max;
   dw_op_params.depth_multiplier         = data->op_params.out_channels / data->op_params.in_channels;
 
-  reference_integer_ops::DepthwiseConvPerChannel(
+  mltk::host_kernels::DepthwiseConvPerChannel(
     dw_op_params,
     data->per_channel_output_multiplier,
     data->per_channel_output_shift,
@@ -9,6 +9,7 @@
 #include "tensorflow/lite/kernels/kernel_util.h"
 #include "tensorflow/lite/micro/kernels/fully_connected.h"
 #include "tensorflow/lite/micro/kernels/kernel_util.h"
+#include "mltk_tflite_micro_host_kernels.hpp"
 #include "sl_mvp_ml_fully_connected.h"
 
 namespace tflite {
@@ -249,7 +250,7 @@ TfLiteStatus EvalQuantizedInt8(TfLiteContext* context, TfLiteNode* node,
     op_params.quantized_activation_min = data.op_params.activation_min;
     op_params.quantized_activation_max = data.op_params.activation_max;
 
-    reference_integer_ops::FullyConnected(
+    mltk::host_kernels::FullyConnected(
         op_params, tflite::micro::GetTensorShape(input),
         tflite::micro::GetTensorData<int8_t>(input),
         tflite::micro::GetTensorShape(filter),
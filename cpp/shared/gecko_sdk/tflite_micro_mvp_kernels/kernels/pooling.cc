@@ -7,6 +7,7 @@
 #include "tensorflow/lite/kernels/padding.h"
 #include "tensorflow/lite/micro/kernels/kernel_util.h"
 #include "CMSIS/NN/Include/arm_nnfunctions.h"
+#include "mltk_tflite_micro_host_kernels.hpp"
 
 
 #include "sl_mvp_ml_pooling.h"
@@ -242,7 +243,7 @@ TfLiteStatus AverageEval(TfLiteContext* context, TfLiteNode* node)
     op_params.padding_values.width  = data->op_params.pad_width;
     op_params.quantized_activation_min  = data->op_params.output_activation_min;
     op_params.quantized_activation_max  = data->op_params.output_activation_max;
-    reference_integer_ops::AveragePool(op_params,
+    mltk::host_kernels::AveragePool(op_params,
                                tflite::micro::GetTensorShape(input),
                                tflite::micro::GetTensorData<int8_t>(input),
                                tflite::micro::GetTensorShape(output),
@@ -343,7 +344,7 @@ TfLiteStatus MaxEval(TfLiteContext* context, TfLiteNode* node)
     op_params.padding_values.width  = data->op_params.pad_width;
     op_params.quantized_activation_min  = data->op_params.output_activation_min;
     op_params.quantized_activation_max  = data->op_params.output_activation_max;
-    reference_integer_ops::MaxPool(op_params,
+    mltk::host_kernels::MaxPool(op_params,
                            tflite::micro::GetTensorShape(input),
                            tflite::micro::GetTensorData<int8_t>(input),
                            tflite::micro::GetTensorShape(output),
@@ -72,6 +72,22 @@
 // <i> Default: 0
 #define SL_MVP_OPTIMIZE_SPEED  0
 
+// <o SL_MVP_PROGRAM_CACHE_MAX_PROGRAMS> Maximum number of cached MVP programs per operation
+// <i> Supported operations (currently only Conv2D) build their MVP programs once
+// <i> and replay them on subsequent executions.
+// <i> Each cached program uses sizeof(sli_mvp_program_t), about 280 bytes, of
+// <i> persistent tensor arena, so each cached Conv2D layer increases the model's
+// <i> runtime memory size by up to this limit times 280 bytes (e.g. 16 -> 4.5 KB).
+// <i> The runtime_memory_size stored in a .tflite model must be re-calculated
+// <i> when this is changed.
+// <i> Operations generating more programs than this limit are not cached and
+// <i> re-build their programs on every execution.
+// <i> Set to 0 to disable the program cache.
+// <i> Default: 0
+#ifndef SL_MVP_PROGRAM_CACHE_MAX_PROGRAMS
+#define SL_MVP_PROGRAM_CACHE_MAX_PROGRAMS  0
+#endif
+
 #endif /* SL_MVP_CONFIG_H */
 
 // <<< end of configuration section >>>
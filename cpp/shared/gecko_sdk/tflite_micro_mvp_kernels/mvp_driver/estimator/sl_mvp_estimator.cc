@@ -0,0 +1,199 @@
+/***************************************************************************//**
+ * @file
+ * @brief MVP driver backend for the analytic cost model.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#include <algorithm>
+#include <cstring>
+
+#include "sl_mvp.h"
+#include "sl_mvp_cost_model.h"
+#include "sl_mvp_simulator.hpp"
+#include "profiling/profiler.hpp"
+
+
+#define NUM_PERF_CNT 2
+
+
+namespace mltk
+{
+bool mvpv1_calculate_accelerator_cycles_only = true;
+}
+
+static bool backend_enabled = true;
+static uint32_t program_count = 0;
+static sli_mvp_perfcnt_t perfcnt_type[NUM_PERF_CNT] = { SLI_MVP_PERFCNT_CYCLES, SLI_MVP_PERFCNT_INSTRUCTIONS };
+static profiling::Profiler* current_profiler = nullptr;
+// The names of sli_mvp_profiling_stat_t, in the same order
+static const char* const profiling_stat_names[SLI_MVP_PROFILING_STAT_COUNT] =
+{
+  "accelerator_parallel_loads",
+  "accelerator_optimized_loads"
+};
+// The profiling_stat_names interned as profiler custom stat IDs, see sli_mvp_set_current_profiler()
+static profiling::CustomStatId profiling_stat_ids[SLI_MVP_PROFILING_STAT_COUNT] =
+{
+  profiling::INVALID_CUSTOM_STAT_ID,
+  profiling::INVALID_CUSTOM_STAT_ID
+};
+
+
+/*************************************************************************************************/
+static uint32_t get_counter(unsigned index)
+{
+  const uint64_t value = sli_mvp_cost_model_get()->counters[index];
+  return (uint32_t)std::min(value, (uint64_t)UINT32_MAX);
+}
+
+/*************************************************************************************************/
+sl_status_t sli_mvp_init(void)
+{
+  return SL_STATUS_OK;
+}
+
+/*************************************************************************************************/
+sl_status_t sli_mvp_deinit(void)
+{
+  return SL_STATUS_OK;
+}
+
+/*************************************************************************************************/
+sl_status_t sli_mvp_config(sli_mvp_config_t *config)
+{
+  (void)config;
+  return SL_STATUS_OK;
+}
+
+/*************************************************************************************************/
+sl_status_t sli_mvp_execute(sli_mvp_program_t *program, bool wait)
+{
+  (void)wait;
+  program->CMD = MVP_CMD_INIT | MVP_CMD_START;
+  program_count++;
+  if(backend_enabled)
+  {
+    sli_mvp_cost_model_accumulate(program);
+  }
+  return SL_STATUS_OK;
+}
+
+/*************************************************************************************************/
+void sli_mvp_wait_for_completion(void)
+{
+}
+
+/*************************************************************************************************/
+void sli_mvp_perfcnt_conf(unsigned id, sli_mvp_perfcnt_t type)
+{
+  if(id < NUM_PERF_CNT && (unsigned)type < SLI_MVP_COST_PERFCNT_COUNT)
+  {
+    perfcnt_type[id] = type;
+  }
+}
+
+/*************************************************************************************************/
+void sli_mvp_perfcnt_reset_all(void)
+{
+  sli_mvp_cost_model_reset();
+}
+
+/*************************************************************************************************/
+uint32_t sli_mvp_perfcnt_get(unsigned id)
+{
+  if(id >= NUM_PERF_CNT)
+  {
+    return 0;
+  }
+  return get_counter(perfcnt_type[id]);
+}
+
+/*************************************************************************************************/
+uint32_t sli_mvp_perfcnt_get_all(uint32_t *values, uint32_t count)
+{
+  count = std::min(count, (uint32_t)SLI_MVP_COST_PERFCNT_COUNT);
+  for(uint32_t i = 0; i < count; ++i)
+  {
+    values[i] = get_counter(i);
+  }
+  return count;
+}
+
+/*************************************************************************************************/
+void sli_mvp_progcnt_reset(void)
+{
+  program_count = 0;
+}
+
+/*************************************************************************************************/
+uint32_t sli_mvp_progcnt_get(void)
+{
+  return program_count;
+}
+
+/*************************************************************************************************/
+bool sli_mvp_set_simulator_memory(const char* region, void* base_address, uint32_t length)
+{
+  (void)region;
+  (void)base_address;
+  (void)length;
+  return true;
+}
+
+/*************************************************************************************************/
+bool sli_mvp_invoke_in_simulator(const std::function<bool()>& func)
+{
+  return func();
+}
+
+/*************************************************************************************************/
+void sli_mvp_set_current_profiler(profiling::Profiler* profiler)
+{
+  // Intern the stat names once, so the kernels increment them by ID
+  if(profiler != nullptr && profiling_stat_ids[0] == profiling::INVALID_CUSTOM_STAT_ID)
+  {
+    for(int i = 0; i < SLI_MVP_PROFILING_STAT_COUNT; ++i)
+    {
+      profiling_stat_ids[i] = profiling::register_custom_stat(profiling_stat_names[i]);
+    }
+  }
+  current_profiler = profiler;
+}
+
+/*************************************************************************************************/
+extern "C" void sli_mvp_increment_profiling_stat(sli_mvp_profiling_stat_t stat, int32_t amount)
+{
+  if(current_profiler != nullptr && (unsigned)stat < SLI_MVP_PROFILING_STAT_COUNT)
+  {
+    current_profiler->increment_custom_stat(profiling_stat_ids[stat], amount);
+  }
+}
+
+/*************************************************************************************************/
+extern "C" void sli_mvp_set_simulator_backend_enabled(bool enabled)
+{
+  backend_enabled = enabled;
+}
@@ -0,0 +1,90 @@
+/***************************************************************************//**
+ * @file
+ * @brief MVP simulator API implemented with the analytic cost model.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#pragma once
+
+// This provides the same API as the pre-built MVP simulator library
+// but instead of executing the MVP programs, their cost is estimated
+// with the analytic cost model, see sl_mvp_cost_model.h.
+// The contents of the MVP output buffers are undefined.
+//
+// This is used when TFLITE_MICRO_MVP_ANALYTIC_ESTIMATOR_ENABLED is set,
+// e.g. to estimate the accelerator cycles of many models
+// on a build machine without network access.
+
+#include <cstdint>
+#include <functional>
+
+// The MVP register definitions
+#ifndef __IM
+#define __IM volatile const
+#endif
+#ifndef __OM
+#define __OM volatile
+#endif
+#ifndef __IOM
+#define __IOM volatile
+#endif
+#include "efr32mg24_mvp.h"
+
+
+namespace profiling 
+{
+    class Profiler;
+}
+
+namespace mltk
+{
+// This is ignored, the analytic estimator only ever calculates accelerator cycles
+extern bool mvpv1_calculate_accelerator_cycles_only;
+}
+
+
+/**
+ * The estimator does not access any memory so this just returns true
+ */
+bool sli_mvp_set_simulator_memory(const char* region, void* base_address, uint32_t length);
+
+/**
+ * Invoke the given function, the estimator runs on the calling thread
+ */
+bool sli_mvp_invoke_in_simulator(const std::function<bool()>& func);
+
+/**
+ * Set the profiler that receives the stats generated by the kernels
+ */
+void sli_mvp_set_current_profiler(profiling::Profiler* profiler);
+
+/**
+ * Return the counters accumulated since sli_mvp_perfcnt_reset_all()
+ * in the same order as the simulator's performance counters
+ */
+uint32_t sli_mvp_perfcnt_get_all(uint32_t *values, uint32_t count);
+
+extern "C" void sli_mvp_set_simulator_backend_enabled(bool enabled);
@@ -0,0 +1,153 @@
+/***************************************************************************//**
+ * @file
+ * @brief MVP analytic cost model.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#ifndef SL_MVP_COST_MODEL_H
+#define SL_MVP_COST_MODEL_H
+
+#include "sl_mvp.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @cond DO_NOT_INCLUDE_WITH_DOXYGEN
+/***************************************************************************//**
+ * @addtogroup mvp MVP API
+ * @{
+ ******************************************************************************/
+
+/**
+ * Counters estimated by the cost model.
+ *
+ * The first SLI_MVP_COST_PERFCNT_COUNT entries use the same order as the
+ * MVP simulator's performance counters so they can be used as a drop-in
+ * replacement, i.e. the value of sli_mvp_perfcnt_conf() type N is counters[N].
+ */
+typedef enum {
+  SLI_MVP_COST_RUN = 0,               ///< MVP cycles, including stalls
+  SLI_MVP_COST_CMD,                   ///< Executed instructions
+  SLI_MVP_COST_STALL,                 ///< Stall cycles
+  SLI_MVP_COST_NOOP,                  ///< Executed NOOP instructions
+  SLI_MVP_COST_ALU_ACTIVE,            ///< Cycles with an active ALU operation
+  SLI_MVP_COST_PIPE_STALL,            ///< Pipeline fill/drain cycles
+  SLI_MVP_COST_IO_FENCE_STALL,        ///< Not modeled, always 0
+  SLI_MVP_COST_LOAD0_STALL,           ///< Stall cycles attributed to load stream 0
+  SLI_MVP_COST_LOAD1_STALL,           ///< Stall cycles attributed to load stream 1
+  SLI_MVP_COST_STORE_STALL,           ///< Stall cycles attributed to the store stream
+  SLI_MVP_COST_BUS_STALL,             ///< Stall cycles due to exceeding the memory bandwidth
+  SLI_MVP_COST_LOAD0_AHB_STALL,       ///< Not modeled, always 0
+  SLI_MVP_COST_LOAD1_AHB_STALL,       ///< Not modeled, always 0
+  SLI_MVP_COST_LOAD0_FENCE_STALL,     ///< Not modeled, always 0
+  SLI_MVP_COST_LOAD1_FENCE_STALL,     ///< Not modeled, always 0
+  SLI_MVP_COST_PERFCNT_COUNT,
+  SLI_MVP_COST_LOAD0 = SLI_MVP_COST_PERFCNT_COUNT, ///< Elements loaded by load stream 0
+  SLI_MVP_COST_LOAD1,                 ///< Elements loaded by load stream 1
+  SLI_MVP_COST_STORE,                 ///< Elements stored by the store stream
+  SLI_MVP_COST_PROGRAMS,              ///< Executed programs
+  SLI_MVP_COST_COUNT
+} sli_mvp_cost_counter_t;
+
+/**
+ * Estimated cost of one or more MVP programs.
+ */
+typedef struct {
+  uint64_t counters[SLI_MVP_COST_COUNT]; ///< Counter values, indexed by sli_mvp_cost_counter_t
+} sli_mvp_cost_t;
+
+/**
+ * Parameters of the cost model.
+ *
+ * The defaults are a first-order model of the MVP pipeline:
+ * one instruction issues per cycle unless its load/store streams
+ * need more memory accesses than the bus can complete in a cycle.
+ * The default values are rough estimates, they have NOT been calibrated
+ * against the MVP simulator or hardware. They may be calibrated
+ * with sli_mvp_cost_model_set_params().
+ */
+typedef struct {
+  uint32_t program_overhead_cycles;  ///< Cycles to fill and drain the pipeline for each program
+  uint32_t instruction_cycles;       ///< Cycles to issue one instruction
+  uint32_t accesses_per_cycle;       ///< Stream accesses (loads + stores) the bus completes each cycle
+} sli_mvp_cost_model_params_t;
+
+/**
+ * @brief
+ *   Estimate the cost of a single MVP program.
+ *
+ * @details
+ *   The cost is calculated from the program's instruction and loop
+ *   descriptors: each instruction executes once per iteration of every loop
+ *   whose begin/end instructions enclose it. No data is accessed, so the
+ *   estimate only depends on the program and takes constant time regardless
+ *   of the number of loop iterations.
+ *
+ * @param[in] program Program to estimate, as given to sli_mvp_execute().
+ * @param[out] cost Estimated cost, this is overwritten.
+ */
+void sli_mvp_cost_model_estimate(const sli_mvp_program_t *program, sli_mvp_cost_t *cost);
+
+/**
+ * @brief
+ *   Add the estimated cost of the given program to the accumulated cost.
+ */
+void sli_mvp_cost_model_accumulate(const sli_mvp_program_t *program);
+
+/**
+ * @brief
+ *   Clear the accumulated cost.
+ */
+void sli_mvp_cost_model_reset(void);
+
+/**
+ * @brief
+ *   Return the accumulated cost since the last call to sli_mvp_cost_model_reset().
+ */
+const sli_mvp_cost_t* sli_mvp_cost_model_get(void);
+
+/**
+ * @brief
+ *   Set the cost model parameters.
+ */
+void sli_mvp_cost_model_set_params(const sli_mvp_cost_model_params_t *params);
+
+/**
+ * @brief
+ *   Return the current cost model parameters.
+ */
+const sli_mvp_cost_model_params_t* sli_mvp_cost_model_get_params(void);
+
+/** @} (end addtogroup mvp) */
+/// @endcond
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SL_MVP_COST_MODEL_H
@@ -33,6 +33,7 @@
 
 #include "sl_status.h"
 #include "sl_mvp.h"
+#include "sl_mvp_program_cache.h"
 #include <stdbool.h>
 
 #ifdef __cplusplus
@@ -93,6 +94,45 @@ typedef struct {
  ******************************************************************************/
 sl_status_t sli_mvp_ml_conv2d_s8(const sli_mvp_ml_conv2d_s8_params_t *params);
 
+/***************************************************************************//**
+ * @brief
+ *    Perform 2D convolution using cached MVP programs.
+ *
+ * @details
+ *    The first call records the generated MVP programs into the given cache,
+ *    subsequent calls replay the cached programs without re-building them.
+ *    If the cache is disabled or too small then this behaves the same as
+ *    @ref sli_mvp_ml_conv2d_s8.
+ *
+ * @param[in] params Pointer to a data structure containing information on
+ *                   all input parameters, refer to
+ *                   @ref sli_mvp_ml_conv2d_s8_params_t.
+ * @param[in] cache  Program cache of this operation, see
+ *                   @ref sli_mvp_ml_conv2d_s8_get_program_count.
+ *
+ * @return
+ *    @ref SL_STATUS_OK on success. On failure, an appropriate sl_status_t
+ *    errorcode is returned.
+ ******************************************************************************/
+sl_status_t sli_mvp_ml_conv2d_s8_cached(const sli_mvp_ml_conv2d_s8_params_t *params,
+                                        sli_mvp_program_cache_t *cache);
+
+/***************************************************************************//**
+ * @brief
+ *    Return the number of MVP programs generated by the Conv2D operation.
+ *
+ * @details
+ *    This is used to size the operation's program cache.
+ *
+ * @param[in] params Pointer to a data structure containing information on
+ *                   all input parameters, refer to
+ *                   @ref sli_mvp_ml_conv2d_s8_params_t.
+ *
+ * @return
+ *    Number of programs, 0 if the operation is not supported.
+ ******************************************************************************/
+int sli_mvp_ml_conv2d_s8_get_program_count(const sli_mvp_ml_conv2d_s8_params_t *params);
+
 /***************************************************************************//**
  * @brief
  *    Check if Conv2D is supported.
@@ -0,0 +1,157 @@
+/***************************************************************************//**
+ * @file
+ * @brief MVP program cache.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#ifndef SL_MVP_PROGRAM_CACHE_H
+#define SL_MVP_PROGRAM_CACHE_H
+
+#include "sl_mvp.h"
+#include "sl_status.h"
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @cond DO_NOT_INCLUDE_WITH_DOXYGEN
+/***************************************************************************//**
+ * @addtogroup mvp MVP API
+ * @{
+ ******************************************************************************/
+
+/** Maximum number of buffer base addresses a cached operation may depend on. */
+#define SLI_MVP_PROGRAM_CACHE_MAX_BASES 6
+
+/**
+ * Cache of the MVP programs generated by one operation (e.g. one model layer).
+ *
+ * The programs of an operation only depend on the operation's shapes and
+ * quantization parameters, plus the base addresses of its buffers.
+ * The programs are recorded the first time the operation executes and then
+ * replayed as-is on subsequent executions, skipping the program builder.
+ * If any of the buffer base addresses change, the programs are recorded again.
+ */
+typedef struct {
+  sli_mvp_program_t *programs;    ///< Buffer holding the recorded programs.
+  int capacity;                   ///< Number of programs that fit in the buffer.
+  int count;                      ///< Number of recorded programs.
+  bool valid;                     ///< True if all the programs of the operation were recorded.
+  int32_t parallel_loads;         ///< Number of recorded programs that use the parallel MACs.
+  int n_bases;                    ///< Number of recorded base addresses.
+  const void *bases[SLI_MVP_PROGRAM_CACHE_MAX_BASES]; ///< Base addresses used by the recorded programs.
+} sli_mvp_program_cache_t;
+
+/**
+ * @brief
+ *   Initialize a program cache with the given buffer.
+ *
+ * @param[in] cache Cache to initialize.
+ * @param[in] buffer Buffer to hold the programs, typically allocated from
+ *            persistent memory when the operation is prepared. May be NULL
+ *            in which case the cache is disabled.
+ * @param[in] capacity Number of programs that fit in the buffer.
+ */
+void sli_mvp_program_cache_init(sli_mvp_program_cache_t *cache, sli_mvp_program_t *buffer, int capacity);
+
+/**
+ * @brief
+ *   Start counting the programs generated by an operation.
+ *
+ * @details
+ *   While counting, every program committed with sli_mvp_pb_commit_program()
+ *   increments a counter instead of executing. This is used when preparing
+ *   an operation to determine the size of its cache buffer.
+ */
+void sli_mvp_program_cache_begin_count(void);
+
+/**
+ * @brief
+ *   Stop counting programs and return the number of counted programs.
+ */
+int sli_mvp_program_cache_end_count(void);
+
+/**
+ * @brief
+ *   Execute an operation's programs from the cache, if possible.
+ *
+ * @param[in] cache Operation's program cache.
+ * @param[in] bases Base addresses of the operation's buffers.
+ * @param[in] n_bases Number of entries in bases.
+ *
+ * @return
+ *   True if the cached programs were executed, false if the operation must
+ *   be executed with the program builder (see sli_mvp_program_cache_begin_record()).
+ */
+bool sli_mvp_program_cache_replay(sli_mvp_program_cache_t *cache, const void *const *bases, int n_bases);
+
+/**
+ * @brief
+ *   Start recording the programs committed by an operation into the given cache.
+ */
+void sli_mvp_program_cache_begin_record(sli_mvp_program_cache_t *cache, const void *const *bases, int n_bases);
+
+/**
+ * @brief
+ *   Stop recording programs.
+ *
+ * @param[in] status Status returned by the operation. The cache is only
+ *            marked valid if the operation succeeded and all of its programs
+ *            fit in the cache.
+ */
+void sli_mvp_program_cache_end_record(sl_status_t status);
+
+/**
+ * @brief
+ *   Record the number of parallel MAC programs of the operation being recorded.
+ *   This is used to restore the profiling statistics when the programs are replayed.
+ */
+void sli_mvp_program_cache_add_parallel_loads(int32_t amount);
+
+/**
+ * @brief
+ *   Commit the current MVP program.
+ *
+ * @details
+ *   This is a drop-in replacement for sli_mvp_pb_execute_program() that
+ *   also supports program counting and recording.
+ *   If execute is false then the program is only counted (if counting is active).
+ *   Otherwise the program is recorded (if recording is active) and executed.
+ *
+ * @param[in] p Pointer to MVP program context.
+ * @param[in] execute Execute the program.
+ */
+void sli_mvp_pb_commit_program(sli_mvp_program_context_t *p, bool execute);
+
+/** @} (end addtogroup mvp) */
+/// @endcond
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SL_MVP_PROGRAM_CACHE_H
@@ -82,9 +82,16 @@ typedef struct {
 #define MLTK_PROFILER_INCREMENT_OPT_PROG_COUNT(amount);
 #else 
 
-extern void sli_mvp_increment_profiling_stat(const char* name, int32_t amount);
-#define MLTK_PROFILER_INCREMENT_PARALLEL_PROG_COUNT(amount) sli_mvp_increment_profiling_stat("accelerator_parallel_loads", amount);
-#define MLTK_PROFILER_INCREMENT_OPT_PROG_COUNT(amount) sli_mvp_increment_profiling_stat("accelerator_optimized_loads", amount);
+// Profiler custom stats incremented by the MVP driver
+typedef enum {
+  SLI_MVP_PROFILING_STAT_PARALLEL_LOADS,   // "accelerator_parallel_loads"
+  SLI_MVP_PROFILING_STAT_OPTIMIZED_LOADS,  // "accelerator_optimized_loads"
+  SLI_MVP_PROFILING_STAT_COUNT
+} sli_mvp_profiling_stat_t;
+
+extern void sli_mvp_increment_profiling_stat(sli_mvp_profiling_stat_t stat, int32_t amount);
+#define MLTK_PROFILER_INCREMENT_PARALLEL_PROG_COUNT(amount) sli_mvp_increment_profiling_stat(SLI_MVP_PROFILING_STAT_PARALLEL_LOADS, amount);
+#define MLTK_PROFILER_INCREMENT_OPT_PROG_COUNT(amount) sli_mvp_increment_profiling_stat(SLI_MVP_PROFILING_STAT_OPTIMIZED_LOADS, amount);
 #endif
 
 
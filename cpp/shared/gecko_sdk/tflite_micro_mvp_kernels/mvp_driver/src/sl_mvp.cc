@@ -28,11 +28,16 @@
  *
  ******************************************************************************/
 #include "sl_mvp.h"
+#include "sl_assert.h"
+// When building the analytic estimator for Windows/Linux,
+// only the program builder functions are used from this file.
+// The hardware interface is provided by sl_mvp_estimator.cc
+#ifndef SL_MVP_ESTIMATOR_BUILD
 #include "sl_mvp_power.h"
 #include "em_device.h"
-#include "sl_assert.h"
 #include "em_ldma.h"
 #include "sl_mvp_config.h"
+#endif
 #include <stddef.h>
 #include <string.h>
 
@@ -46,6 +51,8 @@
 #define MIN_ARRAY_STRIDE_SIZE -2048
 #define MAX_LOOP_COUNT         1024
 
+#ifndef SL_MVP_ESTIMATOR_BUILD
+
 static LDMA_Descriptor_t ldma_descriptor = LDMA_DESCRIPTOR_SINGLE_M2M_WORD(
   0,
   &(MVP->ALU[0]),
@@ -148,6 +155,8 @@ void sli_mvp_wait_for_completion(void)
   sli_mvp_power_program_wait();
 }
 
+#endif // SL_MVP_ESTIMATOR_BUILD
+
 void sli_mvp_prog_set_reg_s8(sli_mvp_program_t *prog, uint8_t reg, int8_t value)
 {
   sli_mvp_prog_set_reg_f16c(prog, reg, value, 0);
@@ -237,7 +246,7 @@ void sli_mvp_prog_set_array_full(sli_mvp_program_t *prog,
   }
 
   // Program array base address
-  prog->ARRAY[index].ADDRCFG = (uint32_t)addr;
+  prog->ARRAY[index].ADDRCFG = (uint32_t)(uintptr_t)addr;
 }
 
 void sli_mvp_prog_set_array(sli_mvp_program_t *prog,
@@ -321,6 +330,8 @@ void sli_mvp_prog_set_loop(sli_mvp_program_t *prog,
   }
 }
 
+#ifndef SL_MVP_ESTIMATOR_BUILD
+
 void sli_mvp_perfcnt_conf(unsigned id, sli_mvp_perfcnt_t type)
 {
   if (id >= NUM_PERF_CNT) {
@@ -362,6 +373,8 @@ uint32_t sli_mvp_progcnt_get(void)
   return mvp.program_count;
 }
 
+#endif // SL_MVP_ESTIMATOR_BUILD
+
 void sli_mvp_pb_begin_loop(sli_mvp_program_context_t *p,
                            int iterations,
                            sl_status_t *status)
@@ -548,6 +561,8 @@ void sli_mvp_pb_postloop_reset_dim(sli_mvp_program_context_t *p,
     |= dimension << ((array_index * 4) + _MVP_LOOPRST_ARRAY0RESETDIM0_SHIFT);
 }
 
+#ifndef SL_MVP_ESTIMATOR_BUILD
+
 // Loading program using LDMA
 static void dma_load(sli_mvp_program_t *program, bool wait)
 {
@@ -603,3 +618,5 @@ void MVP_IRQHandler(void)
     perfcnt[1] += (_MVP_PERFCNT_COUNT_MASK + 1);
   }
 }
+
+#endif // SL_MVP_ESTIMATOR_BUILD
@@ -0,0 +1,176 @@
+/***************************************************************************//**
+ * @file
+ * @brief MVP analytic cost model.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#include "sl_mvp_cost_model.h"
+#include <string.h>
+
+/// @cond DO_NOT_INCLUDE_WITH_DOXYGEN
+
+#define MAX_NUM_LOOPS         8
+#define MAX_NUM_INSTRUCTIONS  8
+
+// Rough, uncalibrated defaults, see sli_mvp_cost_model_params_t
+static sli_mvp_cost_model_params_t params = {
+  .program_overhead_cycles = 4,
+  .instruction_cycles = 1,
+  .accesses_per_cycle = 2
+};
+static sli_mvp_cost_t accumulated_cost;
+
+// Return the index of the last instruction of the program
+static int get_last_instruction(const sli_mvp_program_t *program)
+{
+  for (int i = 0; i < MAX_NUM_INSTRUCTIONS; i++) {
+    if (program->INSTR[i].cfg2.endprog) {
+      return i;
+    }
+  }
+  return MAX_NUM_INSTRUCTIONS - 1;
+}
+
+// Return the number of times each instruction executes.
+// An instruction executes once per iteration of every loop
+// whose begin and end instructions enclose it.
+static void get_instruction_counts(const sli_mvp_program_t *program,
+                                   int last_instr,
+                                   uint64_t *counts)
+{
+  for (int i = 0; i <= last_instr; i++) {
+    counts[i] = 1;
+  }
+
+  for (int loop = 0; loop < MAX_NUM_LOOPS; loop++) {
+    const uint32_t begin_mask = 1U << (2 * loop);
+    const uint32_t end_mask = 2U << (2 * loop);
+    int begin = -1;
+    int end = -1;
+
+    for (int i = 0; i <= last_instr; i++) {
+      const uint32_t cfg2 = program->INSTR[i].CFG2;
+      if (begin == -1 && (cfg2 & begin_mask)) {
+        begin = i;
+      }
+      if (begin != -1 && (cfg2 & end_mask)) {
+        end = i;
+        break;
+      }
+    }
+
+    if (begin == -1 || end == -1) {
+      continue;
+    }
+
+    const uint64_t iterations = (uint64_t)program->LOOP[loop].cfg.numiters + 1;
+    for (int i = begin; i <= end; i++) {
+      counts[i] *= iterations;
+    }
+  }
+}
+
+void sli_mvp_cost_model_estimate(const sli_mvp_program_t *program, sli_mvp_cost_t *cost)
+{
+  uint64_t counts[MAX_NUM_INSTRUCTIONS];
+  uint64_t *c = cost->counters;
+  const int last_instr = get_last_instruction(program);
+  const uint32_t accesses_per_cycle = (params.accesses_per_cycle > 0) ? params.accesses_per_cycle : 1;
+
+  memset(cost, 0, sizeof(*cost));
+  get_instruction_counts(program, last_instr, counts);
+
+  for (int i = 0; i <= last_instr; i++) {
+    const sli_mvp_instr_reg_t *instr = &program->INSTR[i];
+    const uint64_t n = counts[i];
+    const uint32_t load0 = instr->cfg1.istream0load;
+    const uint32_t load1 = instr->cfg1.istream1load;
+    const uint32_t store = instr->cfg1.ostreamstore;
+    const uint32_t accesses = load0 + load1 + store;
+
+    c[SLI_MVP_COST_CMD] += n;
+    c[SLI_MVP_COST_LOAD0] += n * load0;
+    c[SLI_MVP_COST_LOAD1] += n * load1;
+    c[SLI_MVP_COST_STORE] += n * store;
+    if (instr->cfg2.aluop == _MVP_INSTRCFG2_ALUOP_NOOP) {
+      c[SLI_MVP_COST_NOOP] += n;
+    }
+
+    // If the streams need more accesses than the bus can complete in one cycle
+    // then the instruction stalls. The stall is attributed to the
+    // store stream first, then load stream 1, then load stream 0.
+    if (accesses > accesses_per_cycle) {
+      uint32_t stalls = (accesses + accesses_per_cycle - 1) / accesses_per_cycle - 1;
+      const uint32_t store_stalls = (stalls < store) ? stalls : store;
+      stalls -= store_stalls;
+      const uint32_t load1_stalls = (stalls < load1) ? stalls : load1;
+      const uint32_t load0_stalls = stalls - load1_stalls;
+
+      c[SLI_MVP_COST_STORE_STALL] += n * store_stalls;
+      c[SLI_MVP_COST_LOAD1_STALL] += n * load1_stalls;
+      c[SLI_MVP_COST_LOAD0_STALL] += n * load0_stalls;
+      c[SLI_MVP_COST_BUS_STALL] += n * (store_stalls + load1_stalls + load0_stalls);
+    }
+  }
+
+  c[SLI_MVP_COST_PIPE_STALL] = params.program_overhead_cycles;
+  c[SLI_MVP_COST_STALL] = c[SLI_MVP_COST_PIPE_STALL] + c[SLI_MVP_COST_BUS_STALL];
+  c[SLI_MVP_COST_ALU_ACTIVE] = (c[SLI_MVP_COST_CMD] - c[SLI_MVP_COST_NOOP]) * params.instruction_cycles;
+  c[SLI_MVP_COST_RUN] = c[SLI_MVP_COST_CMD] * params.instruction_cycles + c[SLI_MVP_COST_STALL];
+  c[SLI_MVP_COST_PROGRAMS] = 1;
+}
+
+void sli_mvp_cost_model_accumulate(const sli_mvp_program_t *program)
+{
+  sli_mvp_cost_t cost;
+
+  sli_mvp_cost_model_estimate(program, &cost);
+  for (int i = 0; i < SLI_MVP_COST_COUNT; i++) {
+    accumulated_cost.counters[i] += cost.counters[i];
+  }
+}
+
+void sli_mvp_cost_model_reset(void)
+{
+  memset(&accumulated_cost, 0, sizeof(accumulated_cost));
+}
+
+const sli_mvp_cost_t* sli_mvp_cost_model_get(void)
+{
+  return &accumulated_cost;
+}
+
+void sli_mvp_cost_model_set_params(const sli_mvp_cost_model_params_t *new_params)
+{
+  params = *new_params;
+}
+
+const sli_mvp_cost_model_params_t* sli_mvp_cost_model_get_params(void)
+{
+  return &params;
+}
+
+/// @endcond
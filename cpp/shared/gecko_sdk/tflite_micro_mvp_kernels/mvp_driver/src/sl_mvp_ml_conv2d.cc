@@ -34,6 +34,7 @@
 #include "sl_mvp_util.h"
 #include "sl_mvp_math.h"
 #include "sl_mvp_program_area.h"
+#include "sl_mvp_program_cache.h"
 #include "sl_common.h"
 #include <stdbool.h>
 
@@ -69,6 +70,54 @@ sl_status_t sli_mvp_ml_conv2d_s8(const sli_mvp_ml_conv2d_s8_params_t *params)
   return conv2d(params, true);
 }
 
+/***************************************************************************//**
+ *
+ * 2D Convolution using cached MVP programs.
+ *
+ ******************************************************************************/
+sl_status_t sli_mvp_ml_conv2d_s8_cached(const sli_mvp_ml_conv2d_s8_params_t *params,
+                                        sli_mvp_program_cache_t *cache)
+{
+  const void *bases[] = {
+    params->input,
+    params->output,
+    params->filter,
+    params->bias,
+    params->output_scaler,
+    params->scratch_buffer
+  };
+  const int n_bases = sizeof(bases) / sizeof(bases[0]);
+
+  if (sli_mvp_program_cache_replay(cache, bases, n_bases)) {
+    sli_mvp_wait_for_completion();
+    sli_mvp_math_clamp_i8(params->output,
+                          params->batches * params->output_height * params->output_width * params->out_channels,
+                          params->output_activation_min,
+                          params->output_activation_max);
+    return SL_STATUS_OK;
+  }
+
+  sli_mvp_program_cache_begin_record(cache, bases, n_bases);
+  sl_status_t status = conv2d(params, true);
+  sli_mvp_program_cache_end_record(status);
+
+  return status;
+}
+
+/***************************************************************************//**
+ *
+ * Return the number of MVP programs generated by Conv2D.
+ *
+ ******************************************************************************/
+int sli_mvp_ml_conv2d_s8_get_program_count(const sli_mvp_ml_conv2d_s8_params_t *params)
+{
+  sli_mvp_program_cache_begin_count();
+  sl_status_t status = conv2d(params, false);
+  int count = sli_mvp_program_cache_end_count();
+
+  return (status == SL_STATUS_OK) ? count : 0;
+}
+
 /***************************************************************************//**
  *
  * Check if MVP supports Conv2D on given matrix.
@@ -280,9 +329,7 @@ static sl_status_t conv2d(const sli_mvp_ml_conv2d_s8_params_t *params, bool exec
       return status;
     }
 
-    if (execute) {
-      sli_mvp_pb_execute_program(p);
-    }
+    sli_mvp_pb_commit_program(p, execute);
   }
 #endif
 
@@ -777,8 +824,9 @@ static sl_status_t conv2d(const sli_mvp_ml_conv2d_s8_params_t *params, bool exec
 
           if (execute) {
             MLTK_PROFILER_INCREMENT_PARALLEL_PROG_COUNT(use_parallel_mac ? 1 : 0)
-            sli_mvp_pb_execute_program(p);
+            sli_mvp_program_cache_add_parallel_loads(use_parallel_mac ? 1 : 0);
           }
+          sli_mvp_pb_commit_program(p, execute);
         } // batches
       } // out_y_offset
     } // out_y_range
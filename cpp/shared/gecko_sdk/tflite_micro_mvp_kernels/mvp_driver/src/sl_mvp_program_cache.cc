@@ -0,0 +1,150 @@
+/***************************************************************************//**
+ * @file
+ * @brief MVP program cache.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#include "sl_mvp_program_cache.h"
+#include <string.h>
+
+/// @cond DO_NOT_INCLUDE_WITH_DOXYGEN
+
+// The counting and recording state is only active for the duration of a single
+// operation, the same as the program context in sl_mvp_program_area.cc.
+// The cached programs themselves are held by each operation (i.e. each model layer)
+static bool counting = false;
+static int counted_programs = 0;
+static sli_mvp_program_cache_t *recording_cache = NULL;
+
+void sli_mvp_program_cache_init(sli_mvp_program_cache_t *cache, sli_mvp_program_t *buffer, int capacity)
+{
+  cache->programs = buffer;
+  cache->capacity = (buffer == NULL) ? 0 : capacity;
+  cache->count = 0;
+  cache->valid = false;
+  cache->parallel_loads = 0;
+  cache->n_bases = 0;
+}
+
+void sli_mvp_program_cache_begin_count(void)
+{
+  counting = true;
+  counted_programs = 0;
+}
+
+int sli_mvp_program_cache_end_count(void)
+{
+  counting = false;
+  return counted_programs;
+}
+
+bool sli_mvp_program_cache_replay(sli_mvp_program_cache_t *cache, const void *const *bases, int n_bases)
+{
+  if (cache == NULL || !cache->valid || cache->n_bases != n_bases) {
+    return false;
+  }
+
+  // The recorded programs contain the absolute buffer addresses.
+  // If any buffer moved then the programs must be recorded again.
+  for (int i = 0; i < n_bases; ++i) {
+    if (cache->bases[i] != bases[i]) {
+      cache->valid = false;
+      return false;
+    }
+  }
+
+  for (int i = 0; i < cache->count; ++i) {
+    sli_mvp_execute(&cache->programs[i], false);
+  }
+  MLTK_PROFILER_INCREMENT_PARALLEL_PROG_COUNT(cache->parallel_loads)
+
+  return true;
+}
+
+void sli_mvp_program_cache_begin_record(sli_mvp_program_cache_t *cache, const void *const *bases, int n_bases)
+{
+  if (cache == NULL || cache->capacity == 0 || n_bases > SLI_MVP_PROGRAM_CACHE_MAX_BASES) {
+    recording_cache = NULL;
+    return;
+  }
+
+  cache->count = 0;
+  cache->valid = false;
+  cache->parallel_loads = 0;
+  cache->n_bases = n_bases;
+  for (int i = 0; i < n_bases; ++i) {
+    cache->bases[i] = bases[i];
+  }
+  recording_cache = cache;
+}
+
+void sli_mvp_program_cache_end_record(sl_status_t status)
+{
+  sli_mvp_program_cache_t *cache = recording_cache;
+  recording_cache = NULL;
+
+  if (cache == NULL) {
+    return;
+  }
+
+  // If the programs overflowed the cache then count > capacity
+  cache->valid = (status == SL_STATUS_OK) && (cache->count <= cache->capacity);
+}
+
+void sli_mvp_program_cache_add_parallel_loads(int32_t amount)
+{
+  if (recording_cache != NULL) {
+    recording_cache->parallel_loads += amount;
+  }
+}
+
+void sli_mvp_pb_commit_program(sli_mvp_program_context_t *p, bool execute)
+{
+  if (!execute) {
+    if (counting) {
+      counted_programs++;
+    }
+    return;
+  }
+
+  sli_mvp_program_cache_t *cache = recording_cache;
+  if (cache != NULL) {
+    if (cache->count < cache->capacity) {
+      // Finalize the program the same way sli_mvp_pb_execute_program() does
+      // then save a copy of it in the cache
+      for (int i = 0; i <= p->last_instr; i++) {
+        p->p->INSTR[i].CFG2 = (p->p->INSTR[i].CFG2 & 0xFFFF0000U) | p->loop_begin_end[i];
+      }
+      p->p->INSTR[p->last_instr].cfg2.endprog = 1;
+      memcpy(&cache->programs[cache->count], p->p, sizeof(sli_mvp_program_t));
+    }
+    cache->count++;
+  }
+
+  sli_mvp_pb_execute_program(p);
+}
+
+/// @endcond
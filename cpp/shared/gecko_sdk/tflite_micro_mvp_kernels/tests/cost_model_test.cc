@@ -0,0 +1,155 @@
+#include <cstring>
+
+#include "gtest/gtest.h"
+#include "sl_mvp.h"
+#include "sl_mvp_cost_model.h"
+
+
+namespace {
+
+
+class MvpCostModel : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        _saved_params = *sli_mvp_cost_model_get_params();
+        const sli_mvp_cost_model_params_t params = { 
+            /*program_overhead_cycles*/4,
+            /*instruction_cycles*/1,
+            /*accesses_per_cycle*/2
+        };
+        sli_mvp_cost_model_set_params(&params);
+        sli_mvp_cost_model_reset();
+        memset(&program, 0, sizeof(program));
+    }
+
+    void TearDown() override
+    {
+        sli_mvp_cost_model_set_params(&_saved_params);
+        sli_mvp_cost_model_reset();
+    }
+
+    // Z = A + X*Y, loading X and Y from arrays 0 and 1
+    void set_macc(uint8_t index, bool end)
+    {
+        sli_mvp_prog_set_instr(&program, index, SLI_MVP_OP(MACC),
+            SLI_MVP_ALU_X(SLI_MVP_R1) | SLI_MVP_ALU_Y(SLI_MVP_R2) | SLI_MVP_ALU_A(SLI_MVP_R0) | SLI_MVP_ALU_Z(SLI_MVP_R0),
+            SLI_MVP_LOAD(0, SLI_MVP_R1, SLI_MVP_ARRAY(0), SLI_MVP_INCRDIM_COL) | SLI_MVP_LOAD(1, SLI_MVP_R2, SLI_MVP_ARRAY(1), SLI_MVP_INCRDIM_COL),
+            0, end);
+    }
+
+    // Store R0 to array 2
+    void set_store(uint8_t index, bool end)
+    {
+        sli_mvp_prog_set_instr(&program, index, SLI_MVP_OP(NOOP),
+            0, 0, SLI_MVP_STORE(SLI_MVP_R0, SLI_MVP_ARRAY(2), SLI_MVP_INCRDIM_COL), end);
+    }
+
+    sli_mvp_program_t program;
+
+private:
+    sli_mvp_cost_model_params_t _saved_params;
+};
+
+
+// A single instruction in two nested loops
+TEST_F(MvpCostModel, NestedLoopsSingleInstruction)
+{
+    set_macc(0, true);
+    sli_mvp_prog_set_loop(&program, SLI_MVP_LOOP(0), 10, SLI_MVP_INSTR(0), SLI_MVP_INSTR(0), 0);
+    sli_mvp_prog_set_loop(&program, SLI_MVP_LOOP(1), 20, SLI_MVP_INSTR(0), SLI_MVP_INSTR(0), 0);
+
+    sli_mvp_cost_t cost;
+    sli_mvp_cost_model_estimate(&program, &cost);
+
+    EXPECT_EQ(200U, cost.counters[SLI_MVP_COST_CMD]);
+    EXPECT_EQ(200U, cost.counters[SLI_MVP_COST_ALU_ACTIVE]);
+    EXPECT_EQ(0U, cost.counters[SLI_MVP_COST_NOOP]);
+    EXPECT_EQ(200U, cost.counters[SLI_MVP_COST_LOAD0]);
+    EXPECT_EQ(200U, cost.counters[SLI_MVP_COST_LOAD1]);
+    EXPECT_EQ(0U, cost.counters[SLI_MVP_COST_STORE]);
+    EXPECT_EQ(0U, cost.counters[SLI_MVP_COST_BUS_STALL]);
+    EXPECT_EQ(4U, cost.counters[SLI_MVP_COST_STALL]);
+    EXPECT_EQ(204U, cost.counters[SLI_MVP_COST_RUN]);
+}
+
+// Instructions are only repeated by the loops that enclose them,
+// and the instructions that need more memory accesses than the bus allows stall
+TEST_F(MvpCostModel, PartialLoopsAndStalls)
+{
+    // for 4:
+    //   NOOP
+    //   for 8:
+    //     MACC + store
+    //   store
+    sli_mvp_prog_set_instr(&program, 0, SLI_MVP_OP(NOOP), 0, 0, 0, false);
+    set_macc(1, false);
+    program.INSTR[1].CFG1 |= SLI_MVP_STORE(SLI_MVP_R0, SLI_MVP_ARRAY(2), SLI_MVP_INCRDIM_COL);
+    set_store(2, true);
+    sli_mvp_prog_set_loop(&program, SLI_MVP_LOOP(0), 4, SLI_MVP_INSTR(0), SLI_MVP_INSTR(2), 0);
+    sli_mvp_prog_set_loop(&program, SLI_MVP_LOOP(1), 8, SLI_MVP_INSTR(1), SLI_MVP_INSTR(1), 0);
+
+    sli_mvp_cost_t cost;
+    sli_mvp_cost_model_estimate(&program, &cost);
+
+    EXPECT_EQ(4U + 32U + 4U, cost.counters[SLI_MVP_COST_CMD]);
+    EXPECT_EQ(4U + 4U, cost.counters[SLI_MVP_COST_NOOP]);
+    EXPECT_EQ(32U, cost.counters[SLI_MVP_COST_ALU_ACTIVE]);
+    EXPECT_EQ(32U, cost.counters[SLI_MVP_COST_LOAD0]);
+    EXPECT_EQ(32U + 4U, cost.counters[SLI_MVP_COST_STORE]);
+    EXPECT_EQ(32U, cost.counters[SLI_MVP_COST_STORE_STALL]);
+    EXPECT_EQ(0U, cost.counters[SLI_MVP_COST_LOAD0_STALL]);
+    EXPECT_EQ(0U, cost.counters[SLI_MVP_COST_LOAD1_STALL]);
+    EXPECT_EQ(32U, cost.counters[SLI_MVP_COST_BUS_STALL]);
+    EXPECT_EQ(4U + 32U, cost.counters[SLI_MVP_COST_STALL]);
+    EXPECT_EQ(40U + 4U + 32U, cost.counters[SLI_MVP_COST_RUN]);
+}
+
+// The instructions after the end of the program are ignored
+TEST_F(MvpCostModel, EndOfProgram)
+{
+    set_macc(0, true);
+    set_macc(1, false);
+    sli_mvp_prog_set_loop(&program, SLI_MVP_LOOP(0), 16, SLI_MVP_INSTR(0), SLI_MVP_INSTR(1), 0);
+
+    sli_mvp_cost_t cost;
+    sli_mvp_cost_model_estimate(&program, &cost);
+
+    // The loop's end instruction is after the end of the program, so it never repeats
+    EXPECT_EQ(1U, cost.counters[SLI_MVP_COST_CMD]);
+}
+
+// The estimate only depends on the loop descriptors, not the iteration count
+TEST_F(MvpCostModel, MaximumIterations)
+{
+    set_macc(0, true);
+    for(int i = 0; i < 4; ++i)
+    {
+        sli_mvp_prog_set_loop(&program, SLI_MVP_LOOP(i), 1024, SLI_MVP_INSTR(0), SLI_MVP_INSTR(0), 0);
+    }
+
+    sli_mvp_cost_t cost;
+    sli_mvp_cost_model_estimate(&program, &cost);
+    EXPECT_EQ(1024ULL*1024*1024*1024, cost.counters[SLI_MVP_COST_CMD]);
+}
+
+TEST_F(MvpCostModel, Accumulate)
+{
+    set_macc(0, true);
+    sli_mvp_prog_set_loop(&program, SLI_MVP_LOOP(0), 100, SLI_MVP_INSTR(0), SLI_MVP_INSTR(0), 0);
+
+    sli_mvp_cost_model_accumulate(&program);
+    sli_mvp_cost_model_accumulate(&program);
+    sli_mvp_cost_model_accumulate(&program);
+
+    const sli_mvp_cost_t* cost = sli_mvp_cost_model_get();
+    EXPECT_EQ(3U, cost->counters[SLI_MVP_COST_PROGRAMS]);
+    EXPECT_EQ(300U, cost->counters[SLI_MVP_COST_CMD]);
+    EXPECT_EQ(3U*104U, cost->counters[SLI_MVP_COST_RUN]);
+
+    sli_mvp_cost_model_reset();
+    EXPECT_EQ(0U, sli_mvp_cost_model_get()->counters[SLI_MVP_COST_RUN]);
+}
+
+} // namespace
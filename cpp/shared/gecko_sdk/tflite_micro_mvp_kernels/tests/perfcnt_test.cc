@@ -0,0 +1,87 @@
+#include <cstring>
+
+#include "gtest/gtest.h"
+#include "sl_mvp.h"
+#include "sl_mvp_cost_model.h"
+#include "sl_mvp_simulator.hpp"
+
+
+namespace {
+
+
+constexpr int PERFCNT_COUNT = SLI_MVP_COST_PERFCNT_COUNT;
+// Number of times the accelerator profiler executes the model
+// when only 2 counters are available at a time
+constexpr int PERFCNT_PASS_COUNT = 7;
+
+
+class MvpPerfcnt : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        memset(&program, 0, sizeof(program));
+
+        // for 4:
+        //   NOOP
+        //   for 8:
+        //     MACC + store
+        sli_mvp_prog_set_instr(&program, 0, SLI_MVP_OP(NOOP), 0, 0, 0, false);
+        sli_mvp_prog_set_instr(&program, 1, SLI_MVP_OP(MACC),
+            SLI_MVP_ALU_X(SLI_MVP_R1) | SLI_MVP_ALU_Y(SLI_MVP_R2) | SLI_MVP_ALU_A(SLI_MVP_R0) | SLI_MVP_ALU_Z(SLI_MVP_R0),
+            SLI_MVP_LOAD(0, SLI_MVP_R1, SLI_MVP_ARRAY(0), SLI_MVP_INCRDIM_COL) | SLI_MVP_LOAD(1, SLI_MVP_R2, SLI_MVP_ARRAY(1), SLI_MVP_INCRDIM_COL),
+            SLI_MVP_STORE(SLI_MVP_R0, SLI_MVP_ARRAY(2), SLI_MVP_INCRDIM_COL), true);
+        sli_mvp_prog_set_loop(&program, SLI_MVP_LOOP(0), 4, SLI_MVP_INSTR(0), SLI_MVP_INSTR(1), 0);
+        sli_mvp_prog_set_loop(&program, SLI_MVP_LOOP(1), 8, SLI_MVP_INSTR(1), SLI_MVP_INSTR(1), 0);
+    }
+
+    void execute_layer()
+    {
+        sli_mvp_perfcnt_reset_all();
+        for(int i = 0; i < 3; ++i)
+        {
+            sli_mvp_execute(&program, true);
+        }
+    }
+
+    sli_mvp_program_t program;
+};
+
+
+// Reading all of the counters after a single execution gives the same values
+// as executing once per pair of counters with the 2 hardware counters
+TEST_F(MvpPerfcnt, SinglePassMatchesCounterPairs)
+{
+    uint32_t all_counters[PERFCNT_COUNT] = { 0 };
+    execute_layer();
+    ASSERT_EQ((uint32_t)PERFCNT_COUNT, sli_mvp_perfcnt_get_all(all_counters, PERFCNT_COUNT));
+    EXPECT_GT(all_counters[SLI_MVP_PERFCNT_CYCLES], 0U);
+
+    for(int pass = 0; pass < PERFCNT_PASS_COUNT; ++pass)
+    {
+        sli_mvp_perfcnt_conf(0, (sli_mvp_perfcnt_t)(pass*2));
+        sli_mvp_perfcnt_conf(1, (sli_mvp_perfcnt_t)(pass*2+1));
+        execute_layer();
+        EXPECT_EQ(all_counters[pass*2], sli_mvp_perfcnt_get(0)) << "counter " << pass*2;
+        EXPECT_EQ(all_counters[pass*2+1], sli_mvp_perfcnt_get(1)) << "counter " << pass*2+1;
+    }
+
+    sli_mvp_perfcnt_conf(0, SLI_MVP_PERFCNT_CYCLES);
+    sli_mvp_perfcnt_conf(1, SLI_MVP_PERFCNT_INSTRUCTIONS);
+}
+
+// Only the requested number of counters are returned
+TEST_F(MvpPerfcnt, GetAllCount)
+{
+    uint32_t counters[PERFCNT_COUNT + 1];
+    memset(counters, 0xFF, sizeof(counters));
+    execute_layer();
+
+    EXPECT_EQ(2U, sli_mvp_perfcnt_get_all(counters, 2));
+    EXPECT_EQ(0xFFFFFFFFU, counters[2]);
+    EXPECT_EQ((uint32_t)PERFCNT_COUNT, sli_mvp_perfcnt_get_all(counters, PERFCNT_COUNT + 1));
+    EXPECT_EQ(0xFFFFFFFFU, counters[PERFCNT_COUNT]);
+}
+
+
+} // namespace
@@ -0,0 +1,227 @@
+#include <cstring>
+#include <chrono>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "sl_mvp_ml_conv2d.h"
+#include "sl_mvp_program_cache.h"
+#include "sl_mvp_simulator.hpp"
+
+
+namespace {
+
+// Each layer is invoked this many times when measuring the execution time
+constexpr int kIterations = 20;
+
+// All of the buffers used by the MVP must be in the simulator's "sram" region
+constexpr int kSramSize = 4*1024*1024;
+
+
+struct Conv2dLayer
+{
+    const char* name;
+    int input_height;
+    int input_width;
+    int in_channels;
+    int out_channels;
+    int filter_size;
+    int stride;
+    bool padding;
+};
+
+const Conv2dLayer kLayers[] = 
+{
+    { "pointwise 1x1",       32, 32, 16, 32, 1, 1, false },
+    { "3x3 same",            32, 32,  8, 16, 3, 1, true  },
+    { "3x3 valid stride=2",  33, 33,  8, 16, 3, 2, false },
+    { "5x5 same stride=2",   24, 24,  4,  8, 5, 2, true  },
+};
+
+
+class Conv2dBuffers
+{
+public:
+    Conv2dBuffers(const Conv2dLayer& layer)
+    {
+        _sram.resize(kSramSize);
+        sli_mvp_set_simulator_memory("sram", _sram.data(), _sram.size());
+
+        params.batches = 1;
+        params.in_channels = layer.in_channels;
+        params.input_height = layer.input_height;
+        params.input_width = layer.input_width;
+        params.out_channels = layer.out_channels;
+        params.filter_height = layer.filter_size;
+        params.filter_width = layer.filter_size;
+        params.stride_height = layer.stride;
+        params.stride_width = layer.stride;
+        params.dilation_height = 1;
+        params.dilation_width = 1;
+        params.padding = layer.padding;
+        params.pad_height = layer.padding ? (layer.filter_size - 1) / 2 : 0;
+        params.pad_width = params.pad_height;
+        params.output_height = layer.padding 
+            ? (layer.input_height + layer.stride - 1) / layer.stride
+            : (layer.input_height - layer.filter_size) / layer.stride + 1;
+        params.output_width = layer.padding 
+            ? (layer.input_width + layer.stride - 1) / layer.stride
+            : (layer.input_width - layer.filter_size) / layer.stride + 1;
+        params.input_offset = 3;
+        params.output_offset = -2;
+        params.output_activation_min = -128;
+        params.output_activation_max = 127;
+
+        const int input_size = params.input_height * params.input_width * params.in_channels;
+        const int filter_size = params.out_channels * params.filter_height * params.filter_width * params.in_channels;
+        output_size = params.output_height * params.output_width * params.out_channels;
+
+        auto input = (int8_t*)allocate(input_size);
+        auto filter = (int8_t*)allocate(filter_size);
+        auto bias = (float16_t*)allocate(params.out_channels * sizeof(float16_t));
+        auto output_scaler = (float16_t*)allocate(params.out_channels * sizeof(float16_t));
+        for(int i = 0; i < input_size; ++i)
+        {
+            input[i] = (int8_t)((i * 7) % 255 - 127);
+        }
+        for(int i = 0; i < filter_size; ++i)
+        {
+            filter[i] = (int8_t)((i * 13) % 255 - 127);
+        }
+        for(int i = 0; i < params.out_channels; ++i)
+        {
+            bias[i] = float16_t(i * SLI_MVP_ACCUMULATOR_SCALER);
+            output_scaler[i] = float16_t(0.001f * SLI_MVP_ACCUMULATOR_MULTIPLIER);
+        }
+
+        params.input = input;
+        params.filter = filter;
+        params.bias = bias;
+        params.output_scaler = output_scaler;
+        params.output = (int8_t*)allocate(output_size);
+        params.scratch_buffer = (float16_t*)allocate(sli_mvp_ml_conv2d_s8_get_scratch_buffer_size(&params));
+
+        program_count = sli_mvp_ml_conv2d_s8_get_program_count(&params);
+        programs = (sli_mvp_program_t*)allocate(program_count * sizeof(sli_mvp_program_t));
+    }
+
+    void* allocate(int size)
+    {
+        auto ptr = &_sram[_used];
+        _used += (size + 15) & ~15;
+        EXPECT_LE(_used, kSramSize);
+        return ptr;
+    }
+
+    sli_mvp_ml_conv2d_s8_params_t params = {};
+    int output_size;
+    int program_count;
+    sli_mvp_program_t* programs;
+
+private:
+    std::vector<uint8_t> _sram;
+    int _used = 0;
+};
+
+
+template<typename Func>
+double time_us(Func func)
+{
+    const auto start = std::chrono::high_resolution_clock::now();
+    for(int i = 0; i < kIterations; ++i)
+    {
+        func();
+    }
+    const auto elapsed = std::chrono::high_resolution_clock::now() - start;
+    return std::chrono::duration<double, std::micro>(elapsed).count() / kIterations;
+}
+
+
+// Verify the replayed programs generate the same output as the program builder
+// and print the time spent in each for the various Conv2D layer types.
+// NOTE: The times include the simulated MVP execution which is the same for both
+TEST(MvpProgramCache, Conv2dReplayMatchesBuilder)
+{
+    for(const auto& layer : kLayers)
+    {
+        Conv2dBuffers buffers(layer);
+        ASSERT_GT(buffers.program_count, 0) << layer.name;
+
+        sli_mvp_program_cache_t cache;
+        sli_mvp_program_cache_init(&cache, buffers.programs, buffers.program_count);
+
+        std::vector<int8_t> expected(buffers.output_size);
+        double builder_us = 0;
+        double replay_us = 0;
+
+        sli_mvp_invoke_in_simulator([&]() -> bool
+        {
+            builder_us = time_us([&]()
+            {
+                EXPECT_EQ(SL_STATUS_OK, sli_mvp_ml_conv2d_s8(&buffers.params));
+            });
+            memcpy(expected.data(), buffers.params.output, buffers.output_size);
+            memset(buffers.params.output, 0, buffers.output_size);
+
+            // The first call records the programs
+            EXPECT_EQ(SL_STATUS_OK, sli_mvp_ml_conv2d_s8_cached(&buffers.params, &cache));
+            EXPECT_TRUE(cache.valid);
+            EXPECT_EQ(buffers.program_count, cache.count);
+
+            replay_us = time_us([&]()
+            {
+                EXPECT_EQ(SL_STATUS_OK, sli_mvp_ml_conv2d_s8_cached(&buffers.params, &cache));
+            });
+            return true;
+        });
+
+        EXPECT_EQ(0, memcmp(expected.data(), buffers.params.output, buffers.output_size)) << layer.name;
+
+        printf("%-20s programs=%-3d builder=%9.1fus replay=%9.1fus\n",
+            layer.name, buffers.program_count, builder_us, replay_us);
+    }
+}
+
+// If a buffer moves, the programs must be recorded again
+TEST(MvpProgramCache, RecordAgainWhenBufferMoves)
+{
+    Conv2dBuffers buffers(kLayers[0]);
+    sli_mvp_program_cache_t cache;
+    sli_mvp_program_cache_init(&cache, buffers.programs, buffers.program_count);
+
+    auto first_output = buffers.params.output;
+    auto second_output = (int8_t*)buffers.allocate(buffers.output_size);
+
+    sli_mvp_invoke_in_simulator([&]() -> bool
+    {
+        EXPECT_EQ(SL_STATUS_OK, sli_mvp_ml_conv2d_s8_cached(&buffers.params, &cache));
+        EXPECT_TRUE(cache.valid);
+        EXPECT_EQ(first_output, cache.bases[1]);
+
+        buffers.params.output = second_output;
+        EXPECT_EQ(SL_STATUS_OK, sli_mvp_ml_conv2d_s8_cached(&buffers.params, &cache));
+        EXPECT_TRUE(cache.valid);
+        EXPECT_EQ(second_output, cache.bases[1]);
+        return true;
+    });
+
+    EXPECT_EQ(0, memcmp(first_output, second_output, buffers.output_size));
+}
+
+// An operation that does not fit in the cache is not cached
+TEST(MvpProgramCache, CacheTooSmall)
+{
+    Conv2dBuffers buffers(kLayers[1]);
+    ASSERT_GT(buffers.program_count, 1);
+
+    sli_mvp_program_cache_t cache;
+    sli_mvp_program_cache_init(&cache, buffers.programs, buffers.program_count - 1);
+
+    sli_mvp_invoke_in_simulator([&]() -> bool
+    {
+        EXPECT_EQ(SL_STATUS_OK, sli_mvp_ml_conv2d_s8_cached(&buffers.params, &cache));
+        EXPECT_FALSE(cache.valid);
+        return true;
+    });
+}
+
+} // namespace
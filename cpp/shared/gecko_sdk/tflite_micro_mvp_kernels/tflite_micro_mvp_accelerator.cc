@@ -1,10 +1,15 @@
 
 
+#include <algorithm>
+
 #include "sl_mvp.h"
 
 #ifdef TFLITE_MICRO_SIMULATOR_ENABLED
 #include "sl_mvp_simulator.hpp"
 #endif
+#ifdef SL_MVP_ESTIMATOR_BUILD
+#include "sl_mvp_cost_model.h"
+#endif
 
 #include "mltk_tflite_micro_helper.hpp"
 #include "mltk_tflite_micro_accelerator_recorder.hpp"
@@ -34,12 +39,50 @@ static const char* perfcnt_names[] =
     "load0-fence-stall",
     "load1-fence-stall"
 };
+static constexpr int perfcnt_count = sizeof(perfcnt_names) / sizeof(perfcnt_names[0]);
+// The perfcnt_names interned as profiler custom stat IDs, see init_accelerator()
+static profiling::CustomStatId perfcnt_ids[perfcnt_count];
 static int current_loop_index = 0;
 
+// The MVP hardware only has 2 performance counters,
+// so the model must be executed multiple times to collect all of the counters.
+// The MVP simulator models the same 2 counters.
+// The analytic estimator (see sl_mvp_cost_model.h) calculates all of the counters at once
+// and provides:
+//   uint32_t sli_mvp_perfcnt_get_all(uint32_t *values, uint32_t count)
+// which returns the counters accumulated since sli_mvp_perfcnt_reset_all(),
+// in the same order as perfcnt_names.
+// In this case, the model only needs to be executed once
+#if defined(TFLITE_MICRO_SIMULATOR_ENABLED) && defined(SL_MVP_ESTIMATOR_BUILD)
+#define PERFCNT_SINGLE_PASS
+#endif
+
 
 /*************************************************************************************************/
 static void init_accelerator()
 {
+    for(int i = 0; i < perfcnt_count; ++i)
+    {
+        perfcnt_ids[i] = profiling::register_custom_stat(perfcnt_names[i]);
+    }
+
+#ifdef SL_MVP_ESTIMATOR_BUILD
+    // The default cost model parameters have not been calibrated
+    // against the MVP hardware, so make it clear the cycles are only estimates
+    static bool estimator_warning_printed = false;
+    if(!estimator_warning_printed)
+    {
+        const auto params = sli_mvp_cost_model_get_params();
+        estimator_warning_printed = true;
+        MLTK_WARN("MVP accelerator cycles are rough estimates of the analytic cost model, they are NOT calibrated against the MVP hardware "
+                  "(program overhead=%u cycles, instruction=%u cycles, %u accesses/cycle)",
+            (unsigned)params->program_overhead_cycles,
+            (unsigned)params->instruction_cycles,
+            (unsigned)params->accesses_per_cycle
+        );
+    }
+#endif
+
 #ifdef __arm__
     sli_mvp_init();
 #else 
@@ -58,13 +101,17 @@ static void deinit_accelerator()
 /*************************************************************************************************/
 static int get_profiler_loop_count()
 {
+#ifdef PERFCNT_SINGLE_PASS
+    return 1;
+#else
     return 7;
+#endif
 }
 
 /*************************************************************************************************/
 static void start_profiler(int loop_index)
 {
-#ifdef TFLITE_MICRO_ACCELERATOR_PROFILER_ENABLED
+#if defined(TFLITE_MICRO_ACCELERATOR_PROFILER_ENABLED) && !defined(PERFCNT_SINGLE_PASS)
     current_loop_index = loop_index;
     sli_mvp_perfcnt_conf(0, (sli_mvp_perfcnt_t)(loop_index*2));
     sli_mvp_perfcnt_conf(1, (sli_mvp_perfcnt_t)(loop_index*2+1));
@@ -95,17 +142,28 @@ static void stop_op_profiler(int op_idx, profiling::Profiler* profiler)
 
     if(profiler != nullptr)
     {
-#ifdef TFLITE_MICRO_ACCELERATOR_PROFILER_ENABLED
+#if defined(TFLITE_MICRO_ACCELERATOR_PROFILER_ENABLED) && defined(PERFCNT_SINGLE_PASS)
+        uint32_t values[perfcnt_count] = { 0 };
+        const int n_values = std::min((int)sli_mvp_perfcnt_get_all(values, perfcnt_count), perfcnt_count);
+        profiler->stats().accelerator_cycles = values[0];
+        for(int i = 0; i < n_values; ++i)
+        {
+            profiler->parent()->increment_custom_stat(perfcnt_ids[i], values[i]);
+            profiler->increment_custom_stat(perfcnt_ids[i], values[i]);
+        }
+#elif defined(TFLITE_MICRO_ACCELERATOR_PROFILER_ENABLED)
         const uint32_t percnt0 = sli_mvp_perfcnt_get(0);
         const uint32_t percnt1 = sli_mvp_perfcnt_get(1);
         if(current_loop_index == 0)
         {
             profiler->stats().accelerator_cycles = percnt0;
         }
-        profiler->parent()->increment_custom_stat(perfcnt_names[current_loop_index*2], percnt0);
-        profiler->parent()->increment_custom_stat(perfcnt_names[current_loop_index*2+1], percnt1);
-        profiler->increment_custom_stat(perfcnt_names[current_loop_index*2], percnt0);
-        profiler->increment_custom_stat(perfcnt_names[current_loop_index*2+1], percnt1);
+        const auto id0 = perfcnt_ids[current_loop_index*2];
+        const auto id1 = perfcnt_ids[current_loop_index*2+1];
+        profiler->parent()->increment_custom_stat(id0, percnt0);
+        profiler->parent()->increment_custom_stat(id1, percnt1);
+        profiler->increment_custom_stat(id0, percnt0);
+        profiler->increment_custom_stat(id1, percnt1);
 #else
         profiler->stats().accelerator_cycles = sli_mvp_perfcnt_get(0);
 #endif 
@@ -19,10 +19,32 @@ This file has been modified by Silicon Labs.
 #include <string.h>
 
 #include "microfrontend/lib/bits.h"
+#include "microfrontend/lib/filterbank_simd.h"
 
 void FilterbankConvertFftComplexToEnergy(struct FilterbankState* state,
                                          struct complex_int16_t* fft_output,
                                          int32_t* energy) {
+  const struct FilterbankSimdKernels* kernels = FilterbankGetSimdKernels();
+  if (kernels != NULL) {
+    kernels->convert_fft_complex_to_energy(state, fft_output, energy);
+  } else {
+    FilterbankConvertFftComplexToEnergyReference(state, fft_output, energy);
+  }
+}
+
+void FilterbankAccumulateChannels(struct FilterbankState* state,
+                                  const int32_t* energy) {
+  const struct FilterbankSimdKernels* kernels = FilterbankGetSimdKernels();
+  if (kernels != NULL) {
+    kernels->accumulate_channels(state, energy);
+  } else {
+    FilterbankAccumulateChannelsReference(state, energy);
+  }
+}
+
+void FilterbankConvertFftComplexToEnergyReference(struct FilterbankState* state,
+                                                  struct complex_int16_t* fft_output,
+                                                  int32_t* energy) {
   const int end_index = state->end_index;
   int i;
   energy += state->start_index;
@@ -36,8 +58,8 @@ void FilterbankConvertFftComplexToEnergy(struct FilterbankState* state,
   }
 }
 
-void FilterbankAccumulateChannels(struct FilterbankState* state,
-                                  const int32_t* energy) {
+void FilterbankAccumulateChannelsReference(struct FilterbankState* state,
+                                           const int32_t* energy) {
   uint64_t* work = state->work;
   uint64_t weight_accumulator = 0;
   uint64_t unweight_accumulator = 0;
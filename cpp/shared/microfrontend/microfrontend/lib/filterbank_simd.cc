@@ -0,0 +1,290 @@
+/***************************************************************************//**
+ * @file
+ * @brief Microfrontend filterbank SIMD kernels
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#include "microfrontend/lib/filterbank_simd.h"
+
+#include <string.h>
+
+#include <atomic>
+
+// x86 hosts: AVX2 and SSE4.1 kernels, selected at runtime based on the CPU
+#if (defined(__x86_64__) || defined(__i386__) || defined(_M_X64)) && \
+    (defined(__GNUC__) || defined(_MSC_VER))
+#define FILTERBANK_SIMD_X86
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define FILTERBANK_TARGET(isa)
+#else
+#define FILTERBANK_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+// ARM hosts (e.g. Linux aarch64, Apple silicon): NEON kernels
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define FILTERBANK_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+// NOTE: The reference implementation computes:
+//   energy = (int32)(real * real + imag * imag)
+//   work  += (uint64)weight * (uint64)magnitude
+// where the magnitude is a sign-extended int32.
+// The SIMD kernels compute the same values using signed
+// 16x16->32 and 32x32->64 multiplies which wrap identically.
+
+#ifdef FILTERBANK_SIMD_X86
+
+FILTERBANK_TARGET("avx2")
+static void ConvertFftComplexToEnergyAvx2(struct FilterbankState* state,
+                                          struct complex_int16_t* fft_output,
+                                          int32_t* energy) {
+  int i = state->start_index;
+  const int end_index = state->end_index;
+  // NOTE: energy may alias fft_output,
+  // each element is loaded before it is overwritten
+  for (; i + 8 <= end_index; i += 8) {
+    const __m256i v = _mm256_loadu_si256((const __m256i*)&fft_output[i]);
+    _mm256_storeu_si256((__m256i*)&energy[i], _mm256_madd_epi16(v, v));
+  }
+  for (; i < end_index; ++i) {
+    const int32_t real = fft_output[i].real;
+    const int32_t imag = fft_output[i].imag;
+    energy[i] = (uint32_t)(real * real) + (uint32_t)(imag * imag);
+  }
+}
+
+FILTERBANK_TARGET("avx2")
+static uint64_t DotProductAvx2(const int16_t* weights,
+                               const int32_t* magnitudes, int width) {
+  __m256i acc = _mm256_setzero_si256();
+  int j = 0;
+  for (; j + 4 <= width; j += 4) {
+    const __m256i w = _mm256_cvtepi16_epi64(_mm_loadl_epi64((const __m128i*)&weights[j]));
+    const __m256i m = _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i*)&magnitudes[j]));
+    acc = _mm256_add_epi64(acc, _mm256_mul_epi32(w, m));
+  }
+  uint64_t lanes[4];
+  _mm256_storeu_si256((__m256i*)lanes, acc);
+  uint64_t result = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+  for (; j < width; ++j) {
+    result += weights[j] * ((uint64_t)magnitudes[j]);
+  }
+  return result;
+}
+
+FILTERBANK_TARGET("sse4.1")
+static void ConvertFftComplexToEnergySse41(struct FilterbankState* state,
+                                           struct complex_int16_t* fft_output,
+                                           int32_t* energy) {
+  int i = state->start_index;
+  const int end_index = state->end_index;
+  for (; i + 4 <= end_index; i += 4) {
+    const __m128i v = _mm_loadu_si128((const __m128i*)&fft_output[i]);
+    _mm_storeu_si128((__m128i*)&energy[i], _mm_madd_epi16(v, v));
+  }
+  for (; i < end_index; ++i) {
+    const int32_t real = fft_output[i].real;
+    const int32_t imag = fft_output[i].imag;
+    energy[i] = (uint32_t)(real * real) + (uint32_t)(imag * imag);
+  }
+}
+
+FILTERBANK_TARGET("sse4.1")
+static uint64_t DotProductSse41(const int16_t* weights,
+                                const int32_t* magnitudes, int width) {
+  __m128i acc = _mm_setzero_si128();
+  int j = 0;
+  for (; j + 2 <= width; j += 2) {
+    int32_t w32;
+    memcpy(&w32, &weights[j], sizeof(w32));
+    const __m128i w = _mm_cvtepi16_epi64(_mm_cvtsi32_si128(w32));
+    const __m128i m = _mm_cvtepi32_epi64(_mm_loadl_epi64((const __m128i*)&magnitudes[j]));
+    acc = _mm_add_epi64(acc, _mm_mul_epi32(w, m));
+  }
+  uint64_t lanes[2];
+  _mm_storeu_si128((__m128i*)lanes, acc);
+  uint64_t result = lanes[0] + lanes[1];
+  for (; j < width; ++j) {
+    result += weights[j] * ((uint64_t)magnitudes[j]);
+  }
+  return result;
+}
+
+#define DOT_PRODUCT_AVX2 DotProductAvx2
+#define DOT_PRODUCT_SSE41 DotProductSse41
+
+#elif defined(FILTERBANK_SIMD_NEON)
+
+static void ConvertFftComplexToEnergyNeon(struct FilterbankState* state,
+                                          struct complex_int16_t* fft_output,
+                                          int32_t* energy) {
+  int i = state->start_index;
+  const int end_index = state->end_index;
+  for (; i + 4 <= end_index; i += 4) {
+    const int16x4x2_t v = vld2_s16((const int16_t*)&fft_output[i]);
+    const int32x4_t e = vmlal_s16(vmull_s16(v.val[0], v.val[0]), v.val[1], v.val[1]);
+    vst1q_s32(&energy[i], e);
+  }
+  for (; i < end_index; ++i) {
+    const int32_t real = fft_output[i].real;
+    const int32_t imag = fft_output[i].imag;
+    energy[i] = (uint32_t)(real * real) + (uint32_t)(imag * imag);
+  }
+}
+
+static uint64_t DotProductNeon(const int16_t* weights,
+                               const int32_t* magnitudes, int width) {
+  int64x2_t acc = vdupq_n_s64(0);
+  int j = 0;
+  for (; j + 4 <= width; j += 4) {
+    const int32x4_t w = vmovl_s16(vld1_s16(&weights[j]));
+    const int32x4_t m = vld1q_s32(&magnitudes[j]);
+    acc = vmlal_s32(acc, vget_low_s32(w), vget_low_s32(m));
+    acc = vmlal_high_s32(acc, w, m);
+  }
+  uint64_t result = (uint64_t)vgetq_lane_s64(acc, 0) + (uint64_t)vgetq_lane_s64(acc, 1);
+  for (; j < width; ++j) {
+    result += weights[j] * ((uint64_t)magnitudes[j]);
+  }
+  return result;
+}
+
+#endif
+
+// Generate a FilterbankAccumulateChannels() implementation
+// around the given dot product kernel.
+// The channel bookkeeping is the same as the reference implementation.
+#define DEFINE_ACCUMULATE_CHANNELS(name, target, dot_product)                  \
+  target static void name(struct FilterbankState* state,                       \
+                          const int32_t* energy) {                             \
+    uint64_t* work = state->work;                                              \
+    uint64_t weight_accumulator = 0;                                           \
+    const int num_channels_plus_1 = state->num_channels + 1;                   \
+    int i;                                                                     \
+    for (i = 0; i < num_channels_plus_1; ++i) {                                \
+      const int32_t* magnitudes = energy + state->channel_frequency_starts[i]; \
+      const int weight_start = state->channel_weight_starts[i];               \
+      const int width = state->channel_widths[i];                              \
+      weight_accumulator += dot_product(state->weights + weight_start,         \
+                                        magnitudes, width);                    \
+      *work++ = weight_accumulator;                                            \
+      weight_accumulator = dot_product(state->unweights + weight_start,        \
+                                       magnitudes, width);                     \
+    }                                                                          \
+  }
+
+#ifdef FILTERBANK_SIMD_X86
+
+DEFINE_ACCUMULATE_CHANNELS(AccumulateChannelsAvx2, FILTERBANK_TARGET("avx2"), DotProductAvx2)
+DEFINE_ACCUMULATE_CHANNELS(AccumulateChannelsSse41, FILTERBANK_TARGET("sse4.1"), DotProductSse41)
+
+static const struct FilterbankSimdKernels kAvx2Kernels = {
+    "avx2", ConvertFftComplexToEnergyAvx2, AccumulateChannelsAvx2};
+static const struct FilterbankSimdKernels kSse41Kernels = {
+    "sse4.1", ConvertFftComplexToEnergySse41, AccumulateChannelsSse41};
+
+// Returns the kernels supported by the current CPU, best first
+static void DetectSupportedSimdKernels(const struct FilterbankSimdKernels** kernels) {
+  int has_avx2 = 0;
+  int has_sse41 = 0;
+#if defined(_MSC_VER) && !defined(__clang__)
+  int info[4];
+  __cpuid(info, 0);
+  const int max_leaf = info[0];
+  __cpuid(info, 1);
+  has_sse41 = (info[2] & (1 << 19)) != 0;
+  if (max_leaf >= 7) {
+    const int has_avx = (info[2] & (1 << 28)) && (info[2] & (1 << 27)) &&
+                        ((_xgetbv(0) & 0x6) == 0x6);
+    __cpuidex(info, 7, 0);
+    has_avx2 = has_avx && (info[1] & (1 << 5));
+  }
+#else
+  __builtin_cpu_init();
+  has_avx2 = __builtin_cpu_supports("avx2");
+  has_sse41 = __builtin_cpu_supports("sse4.1");
+#endif
+  if (has_avx2) {
+    *kernels++ = &kAvx2Kernels;
+  }
+  if (has_sse41) {
+    *kernels++ = &kSse41Kernels;
+  }
+}
+
+#elif defined(FILTERBANK_SIMD_NEON)
+
+DEFINE_ACCUMULATE_CHANNELS(AccumulateChannelsNeon, , DotProductNeon)
+
+static const struct FilterbankSimdKernels kNeonKernels = {
+    "neon", ConvertFftComplexToEnergyNeon, AccumulateChannelsNeon};
+
+static void DetectSupportedSimdKernels(const struct FilterbankSimdKernels** kernels) {
+  // NEON is always available on aarch64
+  *kernels = &kNeonKernels;
+}
+
+#else
+
+static void DetectSupportedSimdKernels(const struct FilterbankSimdKernels**) {
+}
+
+#endif
+
+namespace {
+
+struct SupportedSimdKernels {
+  const struct FilterbankSimdKernels* kernels[FILTERBANK_MAX_SIMD_KERNELS + 1];
+
+  SupportedSimdKernels() : kernels() {
+    DetectSupportedSimdKernels(kernels);
+  }
+};
+
+std::atomic<int> simd_enabled(1);
+
+}  // namespace
+
+const struct FilterbankSimdKernels* const* FilterbankGetSupportedSimdKernels(void) {
+  // The first caller queries the CPU,
+  // concurrent callers wait for the static to be initialized
+  static const SupportedSimdKernels supported;
+  return supported.kernels;
+}
+
+const struct FilterbankSimdKernels* FilterbankGetSimdKernels(void) {
+  if (!simd_enabled.load(std::memory_order_relaxed)) {
+    return NULL;
+  }
+  return FilterbankGetSupportedSimdKernels()[0];
+}
+
+void FilterbankSetSimdEnabled(int enabled) {
+  simd_enabled.store(enabled, std::memory_order_relaxed);
+}
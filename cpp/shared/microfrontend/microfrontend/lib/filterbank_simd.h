@@ -0,0 +1,79 @@
+/***************************************************************************//**
+ * @file
+ * @brief Microfrontend filterbank SIMD kernels
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2022 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+#ifndef MICROFRONTEND_LIB_FILTERBANK_SIMD_H_
+#define MICROFRONTEND_LIB_FILTERBANK_SIMD_H_
+
+#include "microfrontend/lib/filterbank.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// SIMD implementations of the filterbank kernels.
+// These are bit-exact with the reference C implementations.
+struct FilterbankSimdKernels {
+  const char* name;
+  void (*convert_fft_complex_to_energy)(struct FilterbankState* state,
+                                        struct complex_int16_t* fft_output,
+                                        int32_t* energy);
+  void (*accumulate_channels)(struct FilterbankState* state,
+                              const int32_t* energy);
+};
+
+// Maximum number of SIMD kernels supported by a single CPU
+#define FILTERBANK_MAX_SIMD_KERNELS 2
+
+// Returns the best SIMD kernels supported by the current CPU,
+// or NULL if none are available or SIMD has been disabled.
+// The CPU is only queried on the first call.
+DLL_EXPORT const struct FilterbankSimdKernels* FilterbankGetSimdKernels(void);
+
+// Returns a NULL-terminated list of all the SIMD kernels supported
+// by the current CPU, best first. e.g. ["avx2", "sse4.1", NULL]
+// This is not affected by FilterbankSetSimdEnabled().
+DLL_EXPORT const struct FilterbankSimdKernels* const* FilterbankGetSupportedSimdKernels(void);
+
+// Enable/disable the SIMD kernels, they are enabled by default.
+// When disabled, the reference C implementations are used.
+DLL_EXPORT void FilterbankSetSimdEnabled(int enabled);
+
+// Reference C implementations of the filterbank kernels
+DLL_EXPORT void FilterbankConvertFftComplexToEnergyReference(struct FilterbankState* state,
+                                                             struct complex_int16_t* fft_output,
+                                                             int32_t* energy);
+DLL_EXPORT void FilterbankAccumulateChannelsReference(struct FilterbankState* state,
+                                                      const int32_t* energy);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // MICROFRONTEND_LIB_FILTERBANK_SIMD_H_
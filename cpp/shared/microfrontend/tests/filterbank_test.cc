@@ -14,9 +14,12 @@ limitations under the License.
 ==============================================================================*/
 
 #include <cstring>
+#include <random>
+#include <vector>
 
 #include "microfrontend/lib/filterbank.h"
 #include "microfrontend/lib/filterbank_util.h"
+#include "microfrontend/lib/filterbank_simd.h"
 #include "gtest/gtest.h"
 
 
@@ -215,3 +218,83 @@ TEST(Filterbank, CheckSqrt) {
 
   FilterbankFreeStateContents(&state);
 }
+
+TEST(Filterbank, CheckReferenceImplementation) {
+  FilterbankTestConfig config;
+  struct FilterbankState state;
+  EXPECT_TRUE(FilterbankPopulateState(&config.config_, &state,
+                                               kSampleRate, kSpectrumSize));
+
+  FilterbankAccumulateChannelsReference(&state, kEnergy);
+  int i;
+  for (i = 0; i <= state.num_channels; ++i) {
+    EXPECT_EQ(state.work[i], kWork[i]);
+  }
+
+  FilterbankFreeStateContents(&state);
+}
+
+// Verify the given SIMD kernels are bit-exact with the reference implementation
+static void CheckSimdMatchesReference(const struct FilterbankSimdKernels* kernels) {
+  const int kRealSampleRate = 16000;
+  const int kRealSpectrumSize = 257;
+  const int channel_counts[] = {2, 10, 32, 40, 64};
+  std::mt19937 rng(42);
+  std::uniform_int_distribution<int> dist(-32768, 32767);
+
+  for (const int num_channels : channel_counts) {
+    struct FilterbankConfig config;
+    FilterbankFillConfigWithDefaults(&config);
+    config.num_channels = num_channels;
+    config.lower_band_limit = 125.0;
+    config.upper_band_limit = 7500.0;
+
+    struct FilterbankState ref_state;
+    struct FilterbankState simd_state;
+    ASSERT_TRUE(FilterbankPopulateState(&config, &ref_state,
+                                        kRealSampleRate, kRealSpectrumSize));
+    ASSERT_TRUE(FilterbankPopulateState(&config, &simd_state,
+                                        kRealSampleRate, kRealSpectrumSize));
+
+    for (int iteration = 0; iteration < 100; ++iteration) {
+      std::vector<struct complex_int16_t> fft(kRealSpectrumSize);
+      for (auto& value : fft) {
+        // Include the extreme values that overflow the int32 energy
+        value.real = (iteration % 10 == 0) ? -32768 : dist(rng);
+        value.imag = (iteration % 10 == 0) ? -32768 : dist(rng);
+      }
+      std::vector<struct complex_int16_t> simd_fft(fft);
+      std::vector<int32_t> ref_energy(kRealSpectrumSize, 0);
+      std::vector<int32_t> simd_energy(kRealSpectrumSize, 0);
+
+      FilterbankConvertFftComplexToEnergyReference(&ref_state, fft.data(), ref_energy.data());
+      kernels->convert_fft_complex_to_energy(&simd_state, simd_fft.data(), simd_energy.data());
+      ASSERT_EQ(ref_energy, simd_energy);
+
+      FilterbankAccumulateChannelsReference(&ref_state, ref_energy.data());
+      kernels->accumulate_channels(&simd_state, simd_energy.data());
+      for (int i = 0; i <= num_channels; ++i) {
+        ASSERT_EQ(ref_state.work[i], simd_state.work[i]);
+      }
+    }
+
+    FilterbankFreeStateContents(&ref_state);
+    FilterbankFreeStateContents(&simd_state);
+  }
+}
+
+// Verify every SIMD kernel supported by this CPU (if any),
+// e.g. the SSE4.1 kernels are also checked on an AVX2 CPU
+TEST(Filterbank, CheckSimdMatchesReference) {
+  const struct FilterbankSimdKernels* const* kernels =
+      FilterbankGetSupportedSimdKernels();
+  if (kernels[0] == nullptr) {
+    GTEST_SKIP() << "No SIMD kernels available for this CPU";
+  }
+  EXPECT_EQ(FilterbankGetSimdKernels(), kernels[0]);
+
+  for (; *kernels != nullptr; ++kernels) {
+    SCOPED_TRACE((*kernels)->name);
+    CheckSimdMatchesReference(*kernels);
+  }
+}
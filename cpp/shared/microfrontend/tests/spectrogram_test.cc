@@ -1,5 +1,7 @@
 #include "microfrontend/lib/frontend.h"
 #include "microfrontend/lib/frontend_util.h"
+#include "microfrontend/lib/filterbank_simd.h"
+#include <vector>
 #include "gtest/gtest.h"
 
 
@@ -85,6 +87,41 @@ TEST(Spectrogram, CheckConsecutiveWindow) {
   FrontendFreeStateContents(&state);
 }
 
+// Generate the spectrogram with the filterbank SIMD kernels
+// and the reference implementation, they must be identical
+TEST(Spectrogram, CheckSimdMatchesReference) {
+  FrontendTestConfig config;
+  const size_t kNumSamples = sizeof(kFakeAudioData) / sizeof(kFakeAudioData[0]);
+  std::vector<uint16_t> spectrograms[2];
+
+  for (int simd_enabled = 0; simd_enabled <= 1; ++simd_enabled) {
+    FilterbankSetSimdEnabled(simd_enabled);
+    struct FrontendState state;
+    EXPECT_TRUE(
+        FrontendPopulateState(&config.config_, &state, kSampleRate));
+
+    const int16_t* pointer = kFakeAudioData;
+    size_t length = kNumSamples;
+    while (length > 0) {
+      size_t num_samples_read;
+      struct FrontendOutput output = FrontendProcessSamples(
+          &state, pointer, length, &num_samples_read);
+      pointer += num_samples_read;
+      length -= num_samples_read;
+      if (output.values != nullptr) {
+        spectrograms[simd_enabled].insert(spectrograms[simd_enabled].end(),
+                                          output.values, output.values + output.size);
+      }
+    }
+
+    FrontendFreeStateContents(&state);
+  }
+  FilterbankSetSimdEnabled(1);
+
+  EXPECT_GT(spectrograms[0].size(), 0);
+  EXPECT_EQ(spectrograms[0], spectrograms[1]);
+}
+
 
 namespace {
 
@@ -587,8 +587,10 @@ enum msgpack_flag_enum
     MSGPACK_FLAGS_NONE = 0,                                 //!< No flags
     MSGPACK_DESERIALIZE_WITH_PERSISTENT_STRINGS = (1 << 0), //!< If specified, strings within the de-serialize objects will persist after the provided buffer is freed
                                                             //!< If NOT specified, then strings will NOT be valid after the provided buffer is freed
-    MSGPACK_PACK_16BIT_DICTS                    = (1 << 1)  //!< If specified, the dictionary length is always 16bits
+    MSGPACK_PACK_16BIT_DICTS                    = (1 << 1), //!< If specified, the dictionary length is always 16bits
                                                             //!< If NOT specified, the dictionary length is variable based on the provided element count
+    MSGPACK_DESERIALIZE_SINGLE_ALLOCATION       = (1 << 2)  //!< If specified, all de-serialized objects are placed in a single heap allocation
+                                                            //!< If NOT specified, each de-serialized object is individually allocated
 };
 
 
@@ -701,6 +703,41 @@ static inline void msgpack_set_writer(msgpack_context_t *context, msgpack_writer
 }
 
 
+/**
+ * MessagePack cursor
+ *
+ * @see @ref msgpack_cursor_init()
+ */
+typedef struct
+{
+    msgpack_context_t context;
+} msgpack_cursor_t;
+
+/**
+ * Object read by a @ref msgpack_cursor_t
+ *
+ * This holds a single object so the existing accessor macros may be used with `&obj.obj`,
+ * e.g. @ref MSGPACK_INT(), @ref MSGPACK_DICT_LENGTH().
+ * Dictionaries and arrays only contain their entry count,
+ * their entries are the subsequent objects read by the cursor.
+ */
+typedef union
+{
+    msgpack_object_t obj;
+    msgpack_object8_t obj8;
+    msgpack_object16_t obj16;
+    msgpack_object32_t obj32;
+    msgpack_object64_t obj64;
+    msgpack_object_str_t str;
+    msgpack_object_bin_t bin;
+    struct
+    {
+        msgpack_object_t obj;
+        uint32_t count;
+    } dict, array;
+} msgpack_cursor_object_t;
+
+
 /**
  * Convert a 'packed' MessagePack binary string to a linked list of @ref msgpack_object_t
  *
@@ -714,6 +751,11 @@ static inline void msgpack_set_writer(msgpack_context_t *context, msgpack_writer
  * If the given `buffer` is released, the memory a @ref MSGPACK_TYPE_STR or @ref MSGPACK_TYPE_BIN
  * object references will be invalid.
  * Use the flag @ref MSGPACK_DESERIALIZE_WITH_PERSISTENT_STRINGS to ensure that the object data persists after the given `buffer` is de-allocated.
+ *
+ * Use the flag @ref MSGPACK_DESERIALIZE_SINGLE_ALLOCATION to place all of the objects in a single heap allocation
+ * (the buffer is first walked to determine the required size). This greatly reduces the number of allocations
+ * for large buffers. @ref msgpack_free_objects() should still be used to release the memory.
+ * @see @ref msgpack_deserialize_with_arena() to use a caller-supplied buffer instead
 
  * @note The returned root object will be a @ref msgpack_object_array_t OR @ref msgpack_object_dict_t
  *
@@ -725,6 +767,110 @@ static inline void msgpack_set_writer(msgpack_context_t *context, msgpack_writer
  */
 int msgpack_deserialize_with_buffer(msgpack_object_t **root_ptr, const void *buffer, uint32_t length, msgpack_flag_t flags);
 
+/**
+ * Convert a 'packed' MessagePack binary string to @ref msgpack_object_t placed in the given arena
+ *
+ * This has the same functionality as @ref msgpack_deserialize_with_buffer() except
+ * all of the objects are placed in the supplied `arena` buffer, no heap memory is allocated.
+ * Use @ref msgpack_deserialize_get_arena_size() to determine the required size of the `arena`.
+ *
+ * The returned objects are valid for as long as the `arena` (and `buffer` unless @ref MSGPACK_DESERIALIZE_WITH_PERSISTENT_STRINGS is used) persists.
+ * The objects do NOT need to be released with @ref msgpack_free_objects().
+ *
+ * @param root_ptr Pointer to hold the root object, this points to the beginning of the `arena`
+ * @param buffer Buffer containing 'packed' MessagePack data
+ * @param length Length of buffer to parse
+ * @param arena Buffer to hold the de-serialized objects, this should be aligned to a pointer
+ * @param arena_length Length of the `arena` in bytes
+ * @param flags @ref msgpack_flag_t
+ * @return 0 on success, else failure
+ */
+int msgpack_deserialize_with_arena(
+    msgpack_object_t **root_ptr, 
+    const void *buffer, 
+    uint32_t length, 
+    void *arena, 
+    uint32_t arena_length, 
+    msgpack_flag_t flags
+);
+
+/**
+ * Return the arena size required to de-serialize a 'packed' MessagePack binary string
+ *
+ * This walks the given `buffer` without allocating any memory.
+ *
+ * @param buffer Buffer containing 'packed' MessagePack data
+ * @param length Length of buffer to parse
+ * @param flags @ref msgpack_flag_t, these should be the same flags given to @ref msgpack_deserialize_with_arena()
+ * @param arena_size_ptr Pointer to hold the required arena size in bytes
+ * @return 0 on success, else failure
+ */
+int msgpack_deserialize_get_arena_size(const void *buffer, uint32_t length, msgpack_flag_t flags, uint32_t *arena_size_ptr);
+
+/**
+ * Initialize a MessagePack cursor
+ *
+ * A cursor walks a 'packed' MessagePack binary string without de-serializing it into @ref msgpack_object_t,
+ * i.e. no memory is allocated. Use @ref msgpack_cursor_next() to read each object.
+ *
+ * The given `buffer` may contain multiple consecutive MessagePack objects,
+ * use @ref msgpack_cursor_is_end() to determine if all of them have been read.
+ *
+ * @param cursor Cursor to initialize
+ * @param buffer Buffer containing 'packed' MessagePack data, this MUST persist while the cursor is used
+ * @param length Length of buffer
+ */
+void msgpack_cursor_init(msgpack_cursor_t *cursor, const void *buffer, uint32_t length);
+
+/**
+ * Read the next object at the cursor
+ *
+ * If the object is a dictionary then the next `MSGPACK_DICT_LENGTH(&obj->obj)*2` objects
+ * read by the cursor are its keys and values.
+ * If the object is an array then the next `MSGPACK_ARRAY_LENGTH(&obj->obj)` objects
+ * read by the cursor are its entries.
+ *
+ * @param cursor Previously initialized cursor
+ * @param obj Object to populate, string and binary string objects reference the cursor's buffer
+ * @return 0 on success, else failure
+ */
+int msgpack_cursor_next(msgpack_cursor_t *cursor, msgpack_cursor_object_t *obj);
+
+/**
+ * Skip the next object at the cursor
+ *
+ * If the object is a dictionary or array then all of its entries are also skipped.
+ *
+ * @param cursor Previously initialized cursor
+ * @return 0 on success, else failure
+ */
+int msgpack_cursor_skip(msgpack_cursor_t *cursor);
+
+/**
+ * Advance the cursor to the value of a dictionary key
+ *
+ * This should be called immediately after @ref msgpack_cursor_next() returns a dictionary
+ * (or after a previous call to this function has consumed the found value).
+ * The `count` is the number of dictionary entries that have yet to be read.
+ *
+ * If the `key` is found, then the next object read by the cursor is its value.
+ * Any entries following it have NOT been read.
+ *
+ * @param cursor Previously initialized cursor
+ * @param count Number of remaining key/value pairs in the dictionary
+ * @param key Dictionary key to find
+ * @return 0 if found, else the key was not found or the data is invalid
+ */
+int msgpack_cursor_find_dict_key(msgpack_cursor_t *cursor, uint32_t count, const char *key);
+
+/**
+ * Return if all of the cursor's buffer has been read
+ *
+ * @param cursor Previously initialized cursor
+ * @return true if there are no more objects to read
+ */
+bool msgpack_cursor_is_end(const msgpack_cursor_t *cursor);
+
 /**
  * Release all @ref msgpack_object_t the supplied object references
  *
@@ -1416,6 +1562,19 @@ int msgpack_buffered_writer_deinit(msgpack_context_t *context, bool free_buffer)
 int msgpack_buffered_writer_get_buffer(const msgpack_context_t *context, uint8_t** buffer_ptr, uint32_t* length_ptr);
 
 
+/**
+ * Reset buffered msgpack writer context
+ *
+ * This discards all data written to a buffered msgpack writer
+ * but keeps the internal buffer allocated so that it may be re-used
+ * without re-allocating.
+ *
+ * @param[in] context Buffered msgpack writer context
+ * @return 0 on success
+ */
+int msgpack_buffered_writer_reset(msgpack_context_t *context);
+
+
 
 #ifdef __cplusplus
 }
@@ -510,7 +510,7 @@ static msgpack_user_context_t* get_user_context(const msgpack_object_t *obj)
     else if(obj->type == MSGPACK_TYPE_ARRAY)
     {
         const msgpack_object_array_t *array_obj = (msgpack_object_array_t*)obj;
-        retval = (msgpack_user_context_t*)((uint8_t*)array_obj + sizeof(msgpack_object_array_t) + sizeof(msgpack_object_t)*array_obj->count);
+        retval = (msgpack_user_context_t*)((uint8_t*)array_obj + sizeof(msgpack_object_array_t) + sizeof(msgpack_object_t*)*array_obj->count);
     }
 
     return retval;
@@ -85,6 +85,26 @@ int msgpack_buffered_writer_get_buffer(const msgpack_context_t *context, uint8_t
 }
 
 
+/*************************************************************************************************/
+int msgpack_buffered_writer_reset(msgpack_context_t *context)
+{
+    buffered_writer_context_t *buf_context = (buffered_writer_context_t*)context;
+
+    if(buf_context == NULL || buf_context->dynamic_buffer.buffer == NULL)
+    {
+        return -1;
+    }
+
+    dynamic_buffer_reset(&buf_context->dynamic_buffer);
+
+    buf_context->msgpack.buffer.buffer = buf_context->dynamic_buffer.buffer;
+    buf_context->msgpack.buffer.ptr = buf_context->dynamic_buffer.append;
+    buf_context->msgpack.buffer.end = (uint8_t*)buf_context->dynamic_buffer.buffer_end;
+    buf_context->msgpack.container_index = -1;
+
+    return 0;
+}
+
 
 /** --------------------------------------------------------------------------------------------
  *  Internal functions
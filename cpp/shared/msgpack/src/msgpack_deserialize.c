@@ -1,9 +1,26 @@
 #include "msgpack_internal.h"
 
 
-static int deserialize_dict(msgpack_context_t *context, msgpack_object_dict_t *dict);
-static int deserialize_array(msgpack_context_t *context, msgpack_object_array_t *array);
-static int deserialize_next_object(msgpack_context_t *context, msgpack_object_t **obj_ptr);
+// Objects allocated from an arena are aligned to the size of a pointer
+#define ARENA_ALIGN(size) (((size) + sizeof(void*) - 1) & ~(sizeof(void*) - 1))
+
+
+typedef struct
+{
+    msgpack_context_t msgpack;
+    uint8_t *arena;             // If not NULL, then the objects are allocated from this buffer instead of the heap
+    uint32_t arena_length;
+    uint32_t arena_used;
+} deserialize_context_t;
+
+
+static int deserialize_root(deserialize_context_t *context, msgpack_object_t **root_ptr);
+static int deserialize_dict(deserialize_context_t *context, msgpack_object_dict_t *dict);
+static int deserialize_array(deserialize_context_t *context, msgpack_object_array_t *array);
+static int deserialize_next_object(deserialize_context_t *context, msgpack_object_t **obj_ptr);
+static int read_object(msgpack_context_t *context, msgpack_cursor_object_t *obj, uint32_t *alloc_size_ptr);
+static void* allocate_object(deserialize_context_t *context, uint32_t size);
+static void free_object(deserialize_context_t *context, msgpack_object_t *obj);
 static int read_and_convert_endian(msgpack_context_t *context, uint8_t *data, uint32_t length);
 static int read_bytes(msgpack_context_t *context, uint8_t *data, uint32_t length);
 static int skip_bytes(msgpack_context_t *context, uint32_t length);
@@ -14,22 +31,204 @@ static int skip_bytes(msgpack_context_t *context, uint32_t length);
 /*************************************************************************************************/
 int msgpack_deserialize_with_buffer(msgpack_object_t **root_ptr, const void *buffer, uint32_t length, msgpack_flag_t flags)
 {
-    int result = 0;
+    int result;
+    deserialize_context_t context;
+
+    memset(&context, 0, sizeof(context));
+    context.msgpack = msgpack_init_with_buffer((uint8_t*)buffer, length);
+    context.msgpack.flags = flags;
+
+    *root_ptr = NULL;
+
+    if(flags & MSGPACK_DESERIALIZE_SINGLE_ALLOCATION)
+    {
+        // Size the object tree, then place all the objects in a single allocation.
+        // The root object is at the start of the allocation,
+        // so msgpack_free_objects() releases the entire tree with one free()
+        if(CHECK_FAILURE(result, msgpack_deserialize_get_arena_size(buffer, length, flags, &context.arena_length)))
+        {
+            return result;
+        }
+
+        context.arena = malloc(context.arena_length);
+        if(context.arena == NULL)
+        {
+            return -1;
+        }
+
+        if(CHECK_FAILURE(result, deserialize_root(&context, root_ptr)))
+        {
+            free(context.arena);
+        }
+        else 
+        {
+            (*root_ptr)->flags |= MSGPACK_OBJECT_FLAG_WAS_ALLOCATED;
+        }
+
+        return result;
+    }
+
+    return deserialize_root(&context, root_ptr);
+}
+
+/*************************************************************************************************/
+int msgpack_deserialize_with_arena(
+    msgpack_object_t **root_ptr, 
+    const void *buffer, 
+    uint32_t length, 
+    void *arena, 
+    uint32_t arena_length, 
+    msgpack_flag_t flags
+)
+{
+    deserialize_context_t context;
+
+    *root_ptr = NULL;
+
+    if(arena == NULL)
+    {
+        return -1;
+    }
+
+    memset(&context, 0, sizeof(context));
+    context.msgpack = msgpack_init_with_buffer((uint8_t*)buffer, length);
+    context.msgpack.flags = flags;
+    context.arena = arena;
+    context.arena_length = arena_length;
+
+    return deserialize_root(&context, root_ptr);
+}
+
+/*************************************************************************************************/
+int msgpack_deserialize_get_arena_size(const void *buffer, uint32_t length, msgpack_flag_t flags, uint32_t *arena_size_ptr)
+{
     msgpack_context_t context = msgpack_init_with_buffer((uint8_t*)buffer, length);
+    msgpack_cursor_object_t obj;
+    uint32_t alloc_size;
+    uint64_t arena_size = 0;
+    uint64_t remaining = 1;
+
     context.flags = flags;
+    *arena_size_ptr = 0;
+
+    // Walk the buffer without recursion.
+    // Each dict/array adds its entries to the number of objects remaining to be read
+    while(remaining > 0)
+    {
+        RETURN_ON_FAILURE(read_object(&context, &obj, &alloc_size));
+        remaining -= 1;
+
+        if(arena_size == 0 && !(obj.obj.type == MSGPACK_TYPE_DICT || obj.obj.type == MSGPACK_TYPE_ARRAY))
+        {
+            // The root object must be a DICT or ARRAY
+            return -1;
+        }
+
+        arena_size += ARENA_ALIGN(alloc_size);
+
+        if(obj.obj.type == MSGPACK_TYPE_DICT)
+        {
+            remaining += (uint64_t)obj.dict.count * 2;
+        }
+        else if(obj.obj.type == MSGPACK_TYPE_ARRAY)
+        {
+            remaining += obj.array.count;
+        }
+    }
+
+    if(arena_size > UINT32_MAX)
+    {
+        return -1;
+    }
+
+    *arena_size_ptr = (uint32_t)arena_size;
+
+    return 0;
+}
+
+/*************************************************************************************************/
+void msgpack_cursor_init(msgpack_cursor_t *cursor, const void *buffer, uint32_t length)
+{
+    cursor->context = msgpack_init_with_buffer((uint8_t*)buffer, length);
+}
+
+/*************************************************************************************************/
+int msgpack_cursor_next(msgpack_cursor_t *cursor, msgpack_cursor_object_t *obj)
+{
+    uint32_t alloc_size;
+    return read_object(&cursor->context, obj, &alloc_size);
+}
+
+/*************************************************************************************************/
+int msgpack_cursor_skip(msgpack_cursor_t *cursor)
+{
+    msgpack_cursor_object_t obj;
+    uint64_t remaining = 1;
+
+    while(remaining > 0)
+    {
+        RETURN_ON_FAILURE(msgpack_cursor_next(cursor, &obj));
+        remaining -= 1;
+
+        if(obj.obj.type == MSGPACK_TYPE_DICT)
+        {
+            remaining += (uint64_t)obj.dict.count * 2;
+        }
+        else if(obj.obj.type == MSGPACK_TYPE_ARRAY)
+        {
+            remaining += obj.array.count;
+        }
+    }
+
+    return 0;
+}
+
+/*************************************************************************************************/
+int msgpack_cursor_find_dict_key(msgpack_cursor_t *cursor, uint32_t count, const char *key)
+{
+    msgpack_cursor_object_t key_obj;
+
+    for(uint32_t i = 0; i < count; ++i)
+    {
+        RETURN_ON_FAILURE(msgpack_cursor_next(cursor, &key_obj));
+        if(msgpack_str_cmp(&key_obj.obj, key) == 0)
+        {
+            return 0;
+        }
+        RETURN_ON_FAILURE(msgpack_cursor_skip(cursor));
+    }
+
+    return -1;
+}
+
+/*************************************************************************************************/
+bool msgpack_cursor_is_end(const msgpack_cursor_t *cursor)
+{
+    return MSGPACK_BUFFER_REMAINING(&cursor->context) == 0;
+}
 
-    *root_ptr = NULL;
 
-    if(CHECK_FAILURE(result, deserialize_next_object(&context, root_ptr)))
+
+/** --------------------------------------------------------------------------------------------
+ *  Internal functions
+ * -------------------------------------------------------------------------------------------- **/
+
+
+/*************************************************************************************************/
+static int deserialize_root(deserialize_context_t *context, msgpack_object_t **root_ptr)
+{
+    int result = 0;
+
+    if(CHECK_FAILURE(result, deserialize_next_object(context, root_ptr)))
     {
     }
     else if(MSGPACK_IS_DICT(*root_ptr))
     {
-        result = deserialize_dict(&context, (msgpack_object_dict_t*)*root_ptr);
+        result = deserialize_dict(context, (msgpack_object_dict_t*)*root_ptr);
     }
     else if(MSGPACK_IS_ARRAY(*root_ptr))
     {
-        result = deserialize_array(&context, (msgpack_object_array_t*)*root_ptr);
+        result = deserialize_array(context, (msgpack_object_array_t*)*root_ptr);
     }
     else
     {
@@ -40,17 +239,15 @@ int msgpack_deserialize_with_buffer(msgpack_object_t **root_ptr, const void *buf
 
     if(result != 0)
     {
-        msgpack_free_objects(*root_ptr);
+        free_object(context, *root_ptr);
         *root_ptr = NULL;
     }
 
     return result;
 }
 
-
-
 /*************************************************************************************************/
-static int deserialize_dict(msgpack_context_t *context, msgpack_object_dict_t *dict)
+static int deserialize_dict(deserialize_context_t *context, msgpack_object_dict_t *dict)
 {
     int result = 0;
     msgpack_object_t *key_obj;
@@ -95,15 +292,15 @@ static int deserialize_dict(msgpack_context_t *context, msgpack_object_dict_t *d
 
     if(result != 0)
     {
-        msgpack_free_objects(key_obj);
-        msgpack_free_objects(value_obj);
+        free_object(context, key_obj);
+        free_object(context, value_obj);
     }
 
     return result;
 }
 
 /*************************************************************************************************/
-static int deserialize_array(msgpack_context_t *context, msgpack_object_array_t *array)
+static int deserialize_array(deserialize_context_t *context, msgpack_object_array_t *array)
 {
     int result = 0;
     msgpack_object_t *value_obj;
@@ -135,21 +332,66 @@ static int deserialize_array(msgpack_context_t *context, msgpack_object_array_t
 
     if(result != 0)
     {
-        msgpack_free_objects(value_obj);
+        free_object(context, value_obj);
     }
 
     return result;
 }
 
 /*************************************************************************************************/
-static int deserialize_next_object(msgpack_context_t *context, msgpack_object_t **obj_ptr)
+static int deserialize_next_object(deserialize_context_t *context, msgpack_object_t **obj_ptr)
 {
-    uint8_t temp_obj_buffer[sizeof(msgpack_object_bin_t)];
-    uint16_t obj_size;
+    msgpack_cursor_object_t tmp_obj;
+    uint32_t obj_size;
+    msgpack_object_t *obj;
+
+    RETURN_ON_FAILURE(read_object(&context->msgpack, &tmp_obj, &obj_size));
+
+    obj = allocate_object(context, obj_size);
+    if(obj == NULL)
+    {
+        return -1;
+    }
+    memset(obj, 0, obj_size);
+
+    memcpy(obj, &tmp_obj, MIN(obj_size, sizeof(tmp_obj)));
+    if(context->arena == NULL)
+    {
+        obj->flags |= MSGPACK_OBJECT_FLAG_WAS_ALLOCATED;
+    }
+
+    if(context->msgpack.flags & MSGPACK_DESERIALIZE_WITH_PERSISTENT_STRINGS)
+    {
+        if(obj->type == MSGPACK_TYPE_STR)
+        {
+            msgpack_object_str_t *str_obj = (msgpack_object_str_t*)obj;
+            const char *source = str_obj->data;
+            str_obj->data = (char*)&str_obj[1];
+            memcpy(str_obj->data, source, str_obj->length);
+        }
+        else if(obj->type == MSGPACK_TYPE_BIN)
+        {
+            msgpack_object_bin_t *bin_obj = (msgpack_object_bin_t*)obj;
+            const uint8_t *source = bin_obj->data;
+            bin_obj->data = (char*)&bin_obj[1];
+            memcpy(bin_obj->data, source, bin_obj->length);
+        }
+    }
+
+    *obj_ptr = obj;
+
+    return 0;
+}
+
+/*************************************************************************************************/
+static int read_object(msgpack_context_t *context, msgpack_cursor_object_t *tmp_obj, uint32_t *alloc_size_ptr)
+{
+    uint8_t *temp_obj_buffer = (uint8_t*)tmp_obj;
+    uint32_t obj_size;
     msgpack_marker_t type_marker;
     bool is_dict_or_array = false;
 
-    memset(temp_obj_buffer, 0, sizeof(temp_obj_buffer));
+    memset(temp_obj_buffer, 0, sizeof(msgpack_cursor_object_t));
 
     RETURN_ON_FAILURE(read_bytes(context, &type_marker, sizeof(msgpack_marker_t)));
 
@@ -276,6 +518,12 @@ static int deserialize_next_object(msgpack_context_t *context, msgpack_object_t
             RETURN_ON_FAILURE(read_and_convert_endian(context, (uint8_t*)&obj->count, read_len));
         }
 
+        // Each entry requires at least 2 bytes (key and value)
+        if(obj->count > MSGPACK_BUFFER_REMAINING(context) / 2)
+        {
+            return -1;
+        }
+
         is_dict_or_array = true;
         obj->obj.type = MSGPACK_TYPE_DICT;
         obj_size = sizeof(msgpack_object_dict_t) + sizeof(msgpack_dict_entry_t)*obj->count;
@@ -299,6 +547,12 @@ static int deserialize_next_object(msgpack_context_t *context, msgpack_object_t
             RETURN_ON_FAILURE(read_and_convert_endian(context, (uint8_t*)&obj->count, read_len));
         }
 
+        // Each entry requires at least 1 byte
+        if(obj->count > MSGPACK_BUFFER_REMAINING(context))
+        {
+            return -1;
+        }
+
         is_dict_or_array = true;
         obj->obj.type = MSGPACK_TYPE_ARRAY;
         obj_size = sizeof(msgpack_object_array_t) + sizeof(msgpack_object_t*)*obj->count;
@@ -344,45 +598,45 @@ static int deserialize_next_object(msgpack_context_t *context, msgpack_object_t
     }
 
 
-    msgpack_object_t *obj;
-
     // If this is a dictionary or array then allocate space for user context pointer
     if(is_dict_or_array)
     {
         obj_size += sizeof(msgpack_user_context_t);
     }
 
-    obj = malloc(obj_size);
-    if(obj == NULL)
+    *alloc_size_ptr = obj_size;
+
+    return 0;
+}
+
+/*************************************************************************************************/
+static void* allocate_object(deserialize_context_t *context, uint32_t size)
+{
+    if(context->arena == NULL)
     {
-        return -1;
+        return malloc(size);
     }
-    memset(obj, 0, obj_size);
-
-    memcpy(obj, temp_obj_buffer, MIN(obj_size, sizeof(temp_obj_buffer)));
-    obj->flags |= MSGPACK_OBJECT_FLAG_WAS_ALLOCATED;
 
-    if(context->flags & MSGPACK_DESERIALIZE_WITH_PERSISTENT_STRINGS)
+    size = ARENA_ALIGN(size);
+    if(size > context->arena_length - context->arena_used)
     {
-        if(obj->type == MSGPACK_TYPE_STR)
-        {
-            msgpack_object_str_t *str_obj = (msgpack_object_str_t*)obj;
-            const char *source = str_obj->data;
-            str_obj->data = (char*)&str_obj[1];
-            memcpy(str_obj->data, source, str_obj->length);
-        }
-        else if(obj->type == MSGPACK_TYPE_BIN)
-        {
-            msgpack_object_bin_t *bin_obj = (msgpack_object_bin_t*)obj;
-            const uint8_t *source = bin_obj->data;
-            bin_obj->data = (char*)&bin_obj[1];
-            memcpy(bin_obj->data, source, bin_obj->length);
-        }
+        return NULL;
     }
 
-    *obj_ptr = obj;
+    void *obj = &context->arena[context->arena_used];
+    context->arena_used += size;
 
-    return 0;
+    return obj;
+}
+
+/*************************************************************************************************/
+static void free_object(deserialize_context_t *context, msgpack_object_t *obj)
+{
+    // Objects allocated from an arena are released with the arena
+    if(context->arena == NULL)
+    {
+        msgpack_free_objects(obj);
+    }
 }
 
 /*************************************************************************************************/
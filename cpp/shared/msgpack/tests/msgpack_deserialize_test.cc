@@ -0,0 +1,315 @@
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "msgpack.h"
+
+
+/**
+ * Verify the msgpack deserializer and cursor
+ *
+ * The test data is hand-encoded so each test controls the exact bytes
+ * the deserializer sees, including malformed headers.
+ */
+namespace {
+
+
+// {"name": "model", "values": [1, -2, 300], "nested": {"flag": true}}
+const uint8_t DICT_DATA[] =
+{
+    0x83,
+        0xA4, 'n', 'a', 'm', 'e',
+        0xA5, 'm', 'o', 'd', 'e', 'l',
+        0xA6, 'v', 'a', 'l', 'u', 'e', 's',
+        0x93, 0x01, 0xFE, 0xCD, 0x01, 0x2C,
+        0xA6, 'n', 'e', 's', 't', 'e', 'd',
+        0x81,
+            0xA4, 'f', 'l', 'a', 'g',
+            0xC3,
+};
+
+// ["a", 7]
+const uint8_t ARRAY_DATA[] =
+{
+    0x92,
+        0xA1, 'a',
+        0x07,
+};
+
+// Arrays and maps whose entry counts exceed the data that follows them
+const std::vector<std::vector<uint8_t>> MALFORMED_DATA =
+{
+    {0x93, 0x01},                                   // fixarray, 3 entries, 1 byte
+    {0xDC, 0x00, 0x10, 0x01, 0x02},                 // array16, 16 entries, 2 bytes
+    {0xDD, 0xFF, 0xFF, 0xFF, 0xFF, 0x01},           // array32, 4G entries, 1 byte
+    {0x82, 0xA1, 'a', 0x01},                        // fixmap, 2 entries, 1 entry
+    {0xDE, 0x00, 0x08, 0xA1, 'a', 0x01},            // map16, 8 entries, 1 entry
+    {0xDF, 0xFF, 0xFF, 0xFF, 0xFF, 0xA1, 'a', 0x01},// map32, 4G entries, 1 entry
+    {0x91, 0x92, 0x01},                             // Nested array truncated
+    {0x81, 0xA1, 'a', 0x82, 0x01, 0x02},            // Nested map truncated
+};
+
+
+std::vector<uint8_t> consecutive_objects()
+{
+    std::vector<uint8_t> buffer(DICT_DATA, DICT_DATA + sizeof(DICT_DATA));
+    buffer.insert(buffer.end(), ARRAY_DATA, ARRAY_DATA + sizeof(ARRAY_DATA));
+    buffer.insert(buffer.end(), DICT_DATA, DICT_DATA + sizeof(DICT_DATA));
+    return buffer;
+}
+
+void expect_dict_data(const msgpack_object_t* root)
+{
+    ASSERT_NE(root, nullptr);
+    ASSERT_TRUE(MSGPACK_IS_DICT(root));
+    EXPECT_EQ(MSGPACK_DICT_LENGTH(root), 3U);
+
+    auto name = MSGPACK_DICT_STR(root, "name");
+    ASSERT_NE(name, nullptr);
+    EXPECT_EQ(MSGPACK_STR_CMP(name, "model"), 0);
+
+    auto values = MSGPACK_DICT_ARRAY(root, "values");
+    ASSERT_NE(values, nullptr);
+    ASSERT_EQ(MSGPACK_ARRAY_LENGTH(values), 3U);
+    EXPECT_EQ(MSGPACK_INT(MSGPACK_ARRAY(values, 0)), 1);
+    EXPECT_EQ(MSGPACK_INT(MSGPACK_ARRAY(values, 1)), -2);
+    EXPECT_EQ(MSGPACK_INT(MSGPACK_ARRAY(values, 2)), 300);
+
+    auto nested = MSGPACK_DICT_DICT(root, "nested");
+    ASSERT_NE(nested, nullptr);
+    auto flag = MSGPACK_DICT(nested, "flag");
+    ASSERT_TRUE(MSGPACK_IS_BOOL(flag));
+    EXPECT_TRUE(MSGPACK_BOOL(flag));
+}
+
+uint32_t get_arena_size(const void* buffer, uint32_t length, msgpack_flag_t flags)
+{
+    uint32_t arena_size = 0;
+    EXPECT_EQ(msgpack_deserialize_get_arena_size(buffer, length, flags, &arena_size), 0);
+    EXPECT_GT(arena_size, 0U);
+    return arena_size;
+}
+
+
+TEST(MsgpackDeserialize, Heap)
+{
+    msgpack_object_t* root;
+    ASSERT_EQ(msgpack_deserialize_with_buffer(&root, DICT_DATA, sizeof(DICT_DATA), MSGPACK_FLAGS_NONE), 0);
+    expect_dict_data(root);
+    msgpack_free_objects(root);
+}
+
+TEST(MsgpackDeserialize, SingleAllocation)
+{
+    msgpack_object_t* root;
+    ASSERT_EQ(msgpack_deserialize_with_buffer(&root, DICT_DATA, sizeof(DICT_DATA), MSGPACK_DESERIALIZE_SINGLE_ALLOCATION), 0);
+    expect_dict_data(root);
+    msgpack_free_objects(root);
+}
+
+TEST(MsgpackDeserialize, Arena)
+{
+    const uint32_t arena_size = get_arena_size(DICT_DATA, sizeof(DICT_DATA), MSGPACK_FLAGS_NONE);
+    std::vector<uint8_t> arena(arena_size);
+
+    msgpack_object_t* root;
+    ASSERT_EQ(msgpack_deserialize_with_arena(&root, DICT_DATA, sizeof(DICT_DATA), arena.data(), arena_size, MSGPACK_FLAGS_NONE), 0);
+    expect_dict_data(root);
+
+    // Every object was placed in the arena
+    EXPECT_EQ((void*)root, (void*)arena.data());
+    auto values = MSGPACK_DICT_ARRAY(root, "values");
+    EXPECT_GE((uint8_t*)values, arena.data());
+    EXPECT_LT((uint8_t*)values, arena.data() + arena_size);
+
+    // Releasing arena objects is a no-op
+    msgpack_free_objects(root);
+}
+
+TEST(MsgpackDeserialize, ArenaOneByteTooSmall)
+{
+    for(msgpack_flag_t flags : {MSGPACK_FLAGS_NONE, MSGPACK_DESERIALIZE_WITH_PERSISTENT_STRINGS})
+    {
+        SCOPED_TRACE(testing::Message() << "flags=" << flags);
+        const uint32_t arena_size = get_arena_size(DICT_DATA, sizeof(DICT_DATA), flags);
+        std::vector<uint8_t> arena(arena_size);
+
+        msgpack_object_t* root;
+        EXPECT_NE(msgpack_deserialize_with_arena(&root, DICT_DATA, sizeof(DICT_DATA), arena.data(), arena_size-1, flags), 0);
+        EXPECT_EQ(root, nullptr);
+
+        EXPECT_EQ(msgpack_deserialize_with_arena(&root, DICT_DATA, sizeof(DICT_DATA), arena.data(), arena_size, flags), 0);
+        expect_dict_data(root);
+    }
+}
+
+TEST(MsgpackDeserialize, NullArena)
+{
+    msgpack_object_t* root;
+    EXPECT_NE(msgpack_deserialize_with_arena(&root, DICT_DATA, sizeof(DICT_DATA), nullptr, 1024, MSGPACK_FLAGS_NONE), 0);
+    EXPECT_EQ(root, nullptr);
+}
+
+TEST(MsgpackDeserialize, PersistentStrings)
+{
+    const msgpack_flag_t persistent = MSGPACK_DESERIALIZE_WITH_PERSISTENT_STRINGS;
+    EXPECT_GT(get_arena_size(DICT_DATA, sizeof(DICT_DATA), persistent),
+              get_arena_size(DICT_DATA, sizeof(DICT_DATA), MSGPACK_FLAGS_NONE));
+
+    for(msgpack_flag_t flags : {persistent, persistent | MSGPACK_DESERIALIZE_SINGLE_ALLOCATION})
+    {
+        SCOPED_TRACE(testing::Message() << "flags=" << flags);
+        auto buffer = new uint8_t[sizeof(DICT_DATA)];
+        memcpy(buffer, DICT_DATA, sizeof(DICT_DATA));
+
+        msgpack_object_t* root;
+        ASSERT_EQ(msgpack_deserialize_with_buffer(&root, buffer, sizeof(DICT_DATA), flags), 0);
+
+        // The strings are copied out of the source buffer
+        memset(buffer, 0, sizeof(DICT_DATA));
+        delete[] buffer;
+
+        expect_dict_data(root);
+        msgpack_free_objects(root);
+    }
+
+    // Without the flag, the strings point into the source buffer
+    msgpack_object_t* root;
+    ASSERT_EQ(msgpack_deserialize_with_buffer(&root, DICT_DATA, sizeof(DICT_DATA), MSGPACK_FLAGS_NONE), 0);
+    auto name = MSGPACK_DICT_STR(root, "name");
+    ASSERT_NE(name, nullptr);
+    EXPECT_GE((const uint8_t*)MSGPACK_STR_VALUE(name), DICT_DATA);
+    EXPECT_LT((const uint8_t*)MSGPACK_STR_VALUE(name), DICT_DATA + sizeof(DICT_DATA));
+    msgpack_free_objects(root);
+}
+
+TEST(MsgpackDeserialize, RootMustBeDictOrArray)
+{
+    const uint8_t data[] = {0xA3, 'a', 'b', 'c'};
+    msgpack_object_t* root;
+    uint32_t arena_size;
+    uint8_t arena[64];
+
+    EXPECT_NE(msgpack_deserialize_with_buffer(&root, data, sizeof(data), MSGPACK_FLAGS_NONE), 0);
+    EXPECT_NE(msgpack_deserialize_with_buffer(&root, data, sizeof(data), MSGPACK_DESERIALIZE_SINGLE_ALLOCATION), 0);
+    EXPECT_NE(msgpack_deserialize_with_arena(&root, data, sizeof(data), arena, sizeof(arena), MSGPACK_FLAGS_NONE), 0);
+    EXPECT_NE(msgpack_deserialize_get_arena_size(data, sizeof(data), MSGPACK_FLAGS_NONE, &arena_size), 0);
+}
+
+TEST(MsgpackDeserialize, MalformedCounts)
+{
+    for(size_t i = 0; i < MALFORMED_DATA.size(); ++i)
+    {
+        SCOPED_TRACE(testing::Message() << "MALFORMED_DATA[" << i << "]");
+        const auto& data = MALFORMED_DATA[i];
+        const uint32_t length = data.size();
+        msgpack_object_t* root;
+        uint32_t arena_size;
+        std::vector<uint8_t> arena(4096);
+        msgpack_cursor_t cursor;
+
+        EXPECT_NE(msgpack_deserialize_with_buffer(&root, data.data(), length, MSGPACK_FLAGS_NONE), 0);
+        EXPECT_EQ(root, nullptr);
+        EXPECT_NE(msgpack_deserialize_with_buffer(&root, data.data(), length, MSGPACK_DESERIALIZE_SINGLE_ALLOCATION), 0);
+        EXPECT_EQ(root, nullptr);
+        EXPECT_NE(msgpack_deserialize_with_arena(&root, data.data(), length, arena.data(), arena.size(), MSGPACK_FLAGS_NONE), 0);
+        EXPECT_EQ(root, nullptr);
+        EXPECT_NE(msgpack_deserialize_get_arena_size(data.data(), length, MSGPACK_FLAGS_NONE, &arena_size), 0);
+        EXPECT_EQ(arena_size, 0U);
+
+        msgpack_cursor_init(&cursor, data.data(), length);
+        EXPECT_NE(msgpack_cursor_skip(&cursor), 0);
+    }
+}
+
+TEST(MsgpackCursor, ConsecutiveObjects)
+{
+    const auto buffer = consecutive_objects();
+    msgpack_cursor_t cursor;
+    msgpack_cursor_object_t obj;
+
+    msgpack_cursor_init(&cursor, buffer.data(), buffer.size());
+
+    // First object: read the dict header then look up a key
+    ASSERT_EQ(msgpack_cursor_next(&cursor, &obj), 0);
+    ASSERT_TRUE(MSGPACK_IS_DICT(&obj.obj));
+    ASSERT_EQ(obj.dict.count, 3U);
+
+    ASSERT_EQ(msgpack_cursor_find_dict_key(&cursor, obj.dict.count, "values"), 0);
+    ASSERT_EQ(msgpack_cursor_next(&cursor, &obj), 0);
+    ASSERT_TRUE(MSGPACK_IS_ARRAY(&obj.obj));
+    ASSERT_EQ(obj.array.count, 3U);
+    for(int expected : {1, -2, 300})
+    {
+        ASSERT_EQ(msgpack_cursor_next(&cursor, &obj), 0);
+        EXPECT_EQ(MSGPACK_INT(&obj.obj), expected);
+    }
+
+    // Skip the remaining "nested" entry
+    ASSERT_EQ(msgpack_cursor_next(&cursor, &obj), 0);
+    EXPECT_EQ(MSGPACK_STR_CMP(&obj.str, "nested"), 0);
+    ASSERT_EQ(msgpack_cursor_skip(&cursor), 0);
+    EXPECT_FALSE(msgpack_cursor_is_end(&cursor));
+
+    // Second object: the array is read entry by entry
+    ASSERT_EQ(msgpack_cursor_next(&cursor, &obj), 0);
+    ASSERT_TRUE(MSGPACK_IS_ARRAY(&obj.obj));
+    ASSERT_EQ(obj.array.count, 2U);
+    ASSERT_EQ(msgpack_cursor_next(&cursor, &obj), 0);
+    ASSERT_TRUE(MSGPACK_IS_STR(&obj.obj));
+    EXPECT_EQ(MSGPACK_STR_LENGTH(&obj.str), 1U);
+    EXPECT_EQ(MSGPACK_STR_VALUE(&obj.str)[0], 'a');
+    ASSERT_EQ(msgpack_cursor_next(&cursor, &obj), 0);
+    EXPECT_EQ(MSGPACK_UINT(&obj.obj), 7U);
+    EXPECT_FALSE(msgpack_cursor_is_end(&cursor));
+
+    // Third object: skipped whole
+    ASSERT_EQ(msgpack_cursor_skip(&cursor), 0);
+    EXPECT_TRUE(msgpack_cursor_is_end(&cursor));
+    EXPECT_NE(msgpack_cursor_next(&cursor, &obj), 0);
+    EXPECT_NE(msgpack_cursor_skip(&cursor), 0);
+}
+
+TEST(MsgpackCursor, FindDictKeyNotFound)
+{
+    const auto buffer = consecutive_objects();
+    msgpack_cursor_t cursor;
+    msgpack_cursor_object_t obj;
+
+    msgpack_cursor_init(&cursor, buffer.data(), buffer.size());
+    ASSERT_EQ(msgpack_cursor_next(&cursor, &obj), 0);
+    ASSERT_TRUE(MSGPACK_IS_DICT(&obj.obj));
+
+    // A missing key consumes the whole dict,
+    // leaving the cursor at the next top-level object
+    EXPECT_NE(msgpack_cursor_find_dict_key(&cursor, obj.dict.count, "missing"), 0);
+    ASSERT_EQ(msgpack_cursor_next(&cursor, &obj), 0);
+    ASSERT_TRUE(MSGPACK_IS_ARRAY(&obj.obj));
+    EXPECT_EQ(obj.array.count, 2U);
+}
+
+TEST(MsgpackCursor, MatchesDeserializer)
+{
+    // Each top-level object skipped by the cursor deserializes on its own
+    const auto buffer = consecutive_objects();
+    const uint32_t lengths[] = {sizeof(DICT_DATA), sizeof(ARRAY_DATA), sizeof(DICT_DATA)};
+    msgpack_cursor_t cursor;
+    uint32_t offset = 0;
+
+    msgpack_cursor_init(&cursor, buffer.data(), buffer.size());
+    for(uint32_t length : lengths)
+    {
+        ASSERT_EQ(msgpack_cursor_skip(&cursor), 0);
+        EXPECT_EQ(MSGPACK_BUFFER_USED(&cursor.context), offset + length);
+
+        msgpack_object_t* root;
+        ASSERT_EQ(msgpack_deserialize_with_buffer(&root, &buffer[offset], length, MSGPACK_FLAGS_NONE), 0);
+        msgpack_free_objects(root);
+        offset += length;
+    }
+    EXPECT_TRUE(msgpack_cursor_is_end(&cursor));
+}
+
+
+} // namespace
@@ -59,11 +59,16 @@ uint32_t microsecond_timer_get_timestamp()
 uint32_t microsecond_timer_get_timestamp()
 {
     static uint32_t base_time = 0;
-    struct timeval te;
+    struct timespec ts;
 
-    gettimeofday(&te, NULL); // get current time
+    // Use the monotonic clock so the timestamp is not affected by NTP/wall-clock adjustments
+#ifdef CLOCK_MONOTONIC_RAW
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+#else 
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#endif
 
-    const uint32_t t = (uint32_t)(te.tv_sec*1000000ULL + te.tv_usec);
+    const uint32_t t = (uint32_t)(ts.tv_sec*1000000ULL + ts.tv_nsec/1000);
     if(base_time == 0)
     {
         base_time = t;
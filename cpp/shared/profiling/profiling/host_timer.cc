@@ -0,0 +1,261 @@
+#ifndef __arm__
+
+#include <atomic>
+
+#if defined(_WIN32)
+    #include <windows.h>
+    #include <intrin.h>
+#elif defined(__unix__)
+    #include <time.h>
+    #include <unistd.h>
+    #include <sys/ioctl.h>
+    #include <sys/syscall.h>
+#endif
+
+#if defined(__linux__)
+    #include <linux/perf_event.h>
+    #define HOST_TIMER_PERF_EVENT_SUPPORTED
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <x86intrin.h>
+    #define HOST_TIMER_TSC_SUPPORTED
+#elif defined(_M_X64) || defined(_M_IX86)
+    #define HOST_TIMER_TSC_SUPPORTED
+#endif
+
+#include "profiling/host_timer.hpp"
+
+
+namespace profiling
+{
+
+static std::atomic<HostCycleCounter> cycle_counter(HostCycleCounter::Auto);
+
+
+#ifdef HOST_TIMER_PERF_EVENT_SUPPORTED
+
+/*************************************************************************************************
+ * The perf_event_open() counters of the calling thread
+ *
+ * The CPU cycles counter is the group leader so both counters are read with a single read()
+ */
+struct PerfEventCounters
+{
+    int cycles_fd = -1;
+    int instructions_fd = -1;
+    bool is_opened = false;
+
+    ~PerfEventCounters()
+    {
+        if(instructions_fd != -1)
+        {
+            close(instructions_fd);
+        }
+        if(cycles_fd != -1)
+        {
+            close(cycles_fd);
+        }
+    }
+
+    static int open_counter(uint64_t config, int group_fd)
+    {
+        struct perf_event_attr attr = {};
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = config;
+        attr.disabled = (group_fd == -1) ? 1 : 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP;
+        // Measure the calling thread on any CPU
+        return (int)syscall(__NR_perf_event_open, &attr, 0, -1, group_fd, 0);
+    }
+
+    bool open()
+    {
+        if(is_opened)
+        {
+            return cycles_fd != -1;
+        }
+        is_opened = true;
+
+        cycles_fd = open_counter(PERF_COUNT_HW_CPU_CYCLES, -1);
+        if(cycles_fd == -1)
+        {
+            return false;
+        }
+
+        // The instruction counter is optional
+        instructions_fd = open_counter(PERF_COUNT_HW_INSTRUCTIONS, cycles_fd);
+
+        ioctl(cycles_fd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(cycles_fd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        return true;
+    }
+
+    void read_counters(uint64_t& cpu_cycles, uint64_t& instructions)
+    {
+        // Format: <number of counters> <cycles> <instructions>
+        uint64_t values[3] = {0, 0, 0};
+
+        if(!open() || read(cycles_fd, values, sizeof(values)) <= 0)
+        {
+            cpu_cycles = 0;
+            instructions = 0;
+            return;
+        }
+
+        cpu_cycles = values[1];
+        instructions = (values[0] > 1) ? values[2] : 0;
+    }
+};
+
+static thread_local PerfEventCounters perf_event_counters;
+
+#endif // HOST_TIMER_PERF_EVENT_SUPPORTED
+
+
+/*************************************************************************************************/
+static inline uint64_t read_tsc()
+{
+#ifdef HOST_TIMER_TSC_SUPPORTED
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+/*************************************************************************************************/
+static HostCycleCounter resolve_cycle_counter()
+{
+    auto counter = cycle_counter.load(std::memory_order_relaxed);
+    if(counter == HostCycleCounter::Auto)
+    {
+        if(host_timer_set_cycle_counter(HostCycleCounter::PerfEvent) || 
+           host_timer_set_cycle_counter(HostCycleCounter::Tsc))
+        {
+            counter = cycle_counter.load(std::memory_order_relaxed);
+        }
+        else 
+        {
+            counter = HostCycleCounter::None;
+            cycle_counter.store(counter, std::memory_order_relaxed);
+        }
+    }
+
+    return counter;
+}
+
+/*************************************************************************************************/
+uint64_t host_timer_get_timestamp_ns()
+{
+#if defined(_WIN32)
+    static LARGE_INTEGER frequency = {0ULL};
+    LARGE_INTEGER current_time;
+    if(frequency.QuadPart == 0ULL)
+    {
+        QueryPerformanceFrequency(&frequency);
+    }
+
+    QueryPerformanceCounter(&current_time);
+    const uint64_t seconds = current_time.QuadPart / frequency.QuadPart;
+    const uint64_t remainder = current_time.QuadPart % frequency.QuadPart;
+    return seconds * 1000000000ULL + (remainder * 1000000000ULL) / frequency.QuadPart;
+
+#else
+    struct timespec ts;
+#ifdef CLOCK_MONOTONIC_RAW
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+#else
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#endif
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+/*************************************************************************************************/
+uint64_t host_timer_get_cpu_cycles()
+{
+    uint64_t cpu_cycles, instructions;
+    host_timer_get_counters(cpu_cycles, instructions);
+    return cpu_cycles;
+}
+
+/*************************************************************************************************/
+uint64_t host_timer_get_instructions()
+{
+    uint64_t cpu_cycles, instructions;
+    host_timer_get_counters(cpu_cycles, instructions);
+    return instructions;
+}
+
+/*************************************************************************************************/
+void host_timer_get_counters(uint64_t& cpu_cycles, uint64_t& instructions)
+{
+    switch(resolve_cycle_counter())
+    {
+#ifdef HOST_TIMER_PERF_EVENT_SUPPORTED
+    case HostCycleCounter::PerfEvent:
+        perf_event_counters.read_counters(cpu_cycles, instructions);
+        break;
+#endif
+    case HostCycleCounter::Tsc:
+        cpu_cycles = read_tsc();
+        instructions = 0;
+        break;
+    default:
+        cpu_cycles = 0;
+        instructions = 0;
+        break;
+    }
+}
+
+/*************************************************************************************************/
+bool host_timer_set_cycle_counter(HostCycleCounter counter)
+{
+    switch(counter)
+    {
+    case HostCycleCounter::Auto:
+    case HostCycleCounter::None:
+        break;
+
+    case HostCycleCounter::Tsc:
+#ifdef HOST_TIMER_TSC_SUPPORTED
+        break;
+#else 
+        return false;
+#endif
+
+    case HostCycleCounter::PerfEvent:
+#ifdef HOST_TIMER_PERF_EVENT_SUPPORTED
+        // The counters are opened per thread,
+        // so just verify that they can be opened on the calling thread
+        // (e.g. /proc/sys/kernel/perf_event_paranoid may prevent access)
+        if(!perf_event_counters.open())
+        {
+            return false;
+        }
+        break;
+#else 
+        return false;
+#endif
+
+    default:
+        return false;
+    }
+
+    cycle_counter.store(counter, std::memory_order_relaxed);
+    return true;
+}
+
+/*************************************************************************************************/
+HostCycleCounter host_timer_get_cycle_counter()
+{
+    return resolve_cycle_counter();
+}
+
+
+} // namespace profiling
+
+#endif // __arm__
@@ -0,0 +1,70 @@
+#pragma once
+
+#ifndef __arm__
+
+#include <cstdint>
+
+#include "cpputils/helpers.hpp"
+
+
+namespace profiling
+{
+
+/**
+ * The source of the CPU cycle count on Windows/Linux
+ */
+enum class HostCycleCounter : uint8_t
+{
+    /** Use perf_event_open() if available, otherwise rdtsc if available, otherwise none */
+    Auto,
+    /** Do not measure CPU cycles */
+    None,
+    /** Use the x86 time-stamp counter. NOTE: This increments at a constant rate regardless of the core frequency */
+    Tsc,
+    /** Use the Linux perf_event_open() hardware counters. This also measures the retired instructions */
+    PerfEvent,
+};
+
+
+/**
+ * Return a monotonic timestamp in nanoseconds
+ *
+ * On Linux this uses clock_gettime(CLOCK_MONOTONIC_RAW),
+ * on Windows this uses QueryPerformanceCounter()
+ */
+DLL_EXPORT uint64_t host_timer_get_timestamp_ns();
+
+/**
+ * Return the current CPU cycle count, or 0 if no counter is available
+ */
+DLL_EXPORT uint64_t host_timer_get_cpu_cycles();
+
+/**
+ * Return the number of retired instructions of the calling thread,
+ * or 0 if the perf_event_open() counters are not available
+ */
+DLL_EXPORT uint64_t host_timer_get_instructions();
+
+/**
+ * Read the CPU cycle and instruction counters with a single call
+ */
+DLL_EXPORT void host_timer_get_counters(uint64_t& cpu_cycles, uint64_t& instructions);
+
+/**
+ * Set the CPU cycle counter source
+ *
+ * Returns false if the given counter is not supported on this host,
+ * in which case the counter source is not modified
+ */
+DLL_EXPORT bool host_timer_set_cycle_counter(HostCycleCounter counter);
+
+/**
+ * Return the CPU cycle counter source that is currently used
+ *
+ * NOTE: This never returns HostCycleCounter::Auto
+ */
+DLL_EXPORT HostCycleCounter host_timer_get_cycle_counter();
+
+} // namespace profiling
+
+#endif // __arm__
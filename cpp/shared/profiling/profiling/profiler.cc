@@ -2,13 +2,114 @@
 #include <cassert>
 #include <cstring>
 #include <cstdlib>
+#ifndef __arm__
+#include <mutex>
+#endif
 
 #include "profiling/profiler.hpp"
+#include "profiling/profiler_trace.hpp"
 
 
 namespace profiling
 {
 
+#ifndef MLTK_DLL_IMPORT
+
+// Process-wide table of the interned custom stat names,
+// the index into this table is the CustomStatId
+static const char* custom_stat_names[MLTK_PROFILING_MAX_CUSTOM_STATS];
+static int custom_stat_count = 0;
+
+#ifndef __arm__
+// On Windows/Linux, multiple models may be profiled in parallel
+static std::mutex custom_stat_lock;
+#define CUSTOM_STAT_LOCK() std::lock_guard<std::mutex> _custom_stat_lock_guard(custom_stat_lock)
+#else 
+#define CUSTOM_STAT_LOCK()
+#endif
+
+#define PROFILER_ERROR(msg, ...) get_logger().error(msg, ## __VA_ARGS__)
+
+static logging::Logger& get_logger();
+
+
+/*************************************************************************************************/
+static CustomStatId find_custom_stat_unlocked(const char* name)
+{
+    for(int i = 0; i < custom_stat_count; ++i)
+    {
+        if(strcmp(custom_stat_names[i], name) == 0)
+        {
+            return (CustomStatId)i;
+        }
+    }
+    return INVALID_CUSTOM_STAT_ID;
+}
+
+/*************************************************************************************************/
+CustomStatId register_custom_stat(const char* name)
+{
+    CUSTOM_STAT_LOCK();
+
+    auto id = find_custom_stat_unlocked(name);
+    if(id != INVALID_CUSTOM_STAT_ID)
+    {
+        return id;
+    }
+    if(custom_stat_count >= MLTK_PROFILING_MAX_CUSTOM_STATS)
+    {
+        PROFILER_ERROR("Profiler: Failed to register custom stat: %s, all %d custom stats are used (MLTK_PROFILING_MAX_CUSTOM_STATS)", 
+            name, MLTK_PROFILING_MAX_CUSTOM_STATS);
+        assert(!"Too many custom profiler stats, increase MLTK_PROFILING_MAX_CUSTOM_STATS");
+        return INVALID_CUSTOM_STAT_ID;
+    }
+
+    auto name_copy = static_cast<char*>(malloc(strlen(name) + 1));
+    if(name_copy == nullptr)
+    {
+        PROFILER_ERROR("Profiler: Failed to register custom stat: %s, failed to alloc memory", name);
+        return INVALID_CUSTOM_STAT_ID;
+    }
+    strcpy(name_copy, name);
+
+    custom_stat_names[custom_stat_count] = name_copy;
+    return (CustomStatId)custom_stat_count++;
+}
+
+/*************************************************************************************************/
+CustomStatId find_custom_stat(const char* name)
+{
+    CUSTOM_STAT_LOCK();
+    return find_custom_stat_unlocked(name);
+}
+
+/*************************************************************************************************/
+const char* get_custom_stat_name(CustomStatId id)
+{
+    CUSTOM_STAT_LOCK();
+    return (id >= 0 && id < custom_stat_count) ? custom_stat_names[id] : nullptr;
+}
+
+/*************************************************************************************************/
+int get_custom_stat_count()
+{
+    CUSTOM_STAT_LOCK();
+    return custom_stat_count;
+}
+
+/*************************************************************************************************/
+static logging::Logger& get_logger()
+{
+    auto logger = logging::get("MltkProfiler");
+    if(logger == nullptr)
+    {
+        logger = logging::create("MltkProfiler");
+    }
+    return *logger;
+}
+
+#endif // MLTK_DLL_IMPORT
+
 
 
 /*************************************************************************************************/
@@ -35,8 +136,14 @@ void Profiler::unlink()
 {
     assert(this->_object_buffer != nullptr);
     reset();
+    if(_flags.isSet(Flag::RecordTraceEvents))
+    {
+        trace_forget_profiler(this);
+    }
     _children.clear();
-    custom_stats.clear();
+    free(_custom_stats);
+    _custom_stats = nullptr;
+    _custom_stats_mask = 0;
 
     void *ptr = this->_object_buffer;
     this->_object_buffer = nullptr;
@@ -79,31 +186,29 @@ void Profiler::custom_stats_printer(CustomStatsPrinter* printer)
     _custom_stats_printer = printer;
 }
 
-/*************************************************************************************************/
+/*************************************************************************************************
+ * String-keyed API, this interns the name on every call.
+ * Hot paths should use register_custom_stat() once and then the CustomStatId APIs.
+ */
 int32_t Profiler::increment_custom_stat(const char* name, int32_t amount)
 {
-    if(!custom_stats.contains(name))
-    {
-        int32_t initial_value = 0;
-        custom_stats.put(name, &initial_value);
-    }
-
-    int32_t* new_amount = custom_stats.get(name);
-    *new_amount += amount;
-    return *new_amount;
+    return increment_custom_stat(register_custom_stat(name), amount);
 }
 
 /*************************************************************************************************/
 int32_t Profiler::get_custom_stat(const char* name) const
 {
-    if(!custom_stats.contains(name))
-    {
-        return 0;
-    }
-    else 
-    {
-        return *custom_stats.get(name);
-    }
+    return get_custom_stat(find_custom_stat(name));
+}
+
+/*************************************************************************************************
+ * Allocate the stat values the first time a custom stat is incremented.
+ * Profilers that never use custom stats do not allocate anything.
+ */
+bool Profiler::allocate_custom_stats()
+{
+    _custom_stats = static_cast<int32_t*>(calloc(MLTK_PROFILING_MAX_CUSTOM_STATS, sizeof(int32_t)));
+    return _custom_stats != nullptr;
 }
 
 /*************************************************************************************************/
@@ -123,17 +228,16 @@ const char* Profiler::fullname(Fullname& fullname) const
 void Profiler::reset(void)
 {
     _state = State::Stopped;
-    _cpu_accumulator.reset();
-    _time_accumulator.reset();
+    reset_accumulators();
     _stats.reset();
     if(_msg != nullptr)
     {
         free((void*)_msg);
         _msg = nullptr;
     }
-    for(auto e : custom_stats)
+    if(_custom_stats != nullptr)
     {
-        *e = 0;
+        memset(_custom_stats, 0, sizeof(int32_t) * MLTK_PROFILING_MAX_CUSTOM_STATS);
     }
 }
 
@@ -187,10 +291,35 @@ void Profiler::get_child_metrics(const Profiler *profiler, Metrics &metrics) con
     }
 }
 
+/*************************************************************************************************
+ * Add the counter differences since the last start to the accumulators
+ */
+void Profiler::accumulate_stats(const Counters& counters)
+{
+    const counter_t cpu_diff = counters.cpu_cycles - _cpu_accumulator.start_marker;
+    _cpu_accumulator.accumulator += cpu_diff;
+    const counter_t time_diff = counters.time - _time_accumulator.start_marker;
+    _time_accumulator.accumulator += time_diff;
+#ifndef __arm__
+    const counter_t instruction_diff = counters.instructions - _instruction_accumulator.start_marker;
+    _instruction_accumulator.accumulator += instruction_diff;
+#endif
+}
+
+/*************************************************************************************************/
+void Profiler::reset_accumulators()
+{
+    _cpu_accumulator.reset();
+    _time_accumulator.reset();
+#ifndef __arm__
+    _instruction_accumulator.reset();
+#endif
+}
+
 /*************************************************************************************************
  * Update this profiler's stats after stopping or pausing
  */
-void Profiler::update_stats(bool stop, uint32_t stop_cpu_cycle, uint32_t stop_time_us)
+void Profiler::update_stats(bool stop, const Counters& counters)
 {
     // If the profiler was already stopped
     // then just return
@@ -204,33 +333,37 @@ void Profiler::update_stats(bool stop, uint32_t stop_cpu_cycle, uint32_t stop_ti
     {
         // Then update the accumulation now that we're
         // pausing or stopping
-        const uint32_t cpu_diff = stop_cpu_cycle - _cpu_accumulator.start_marker;
-        _cpu_accumulator.accumulator += cpu_diff;
-        const uint32_t time_diff = stop_time_us - _time_accumulator.start_marker;
-        _time_accumulator.accumulator += time_diff;
+        accumulate_stats(counters);
     }
 
     // If we're stopping the profiler
     if(stop)
     {
         _state = State::Stopped;
-#ifdef __arm__
         _stats.cpu_cycles = _cpu_accumulator.accumulator;
 
         // Either the time is measure between the start and stop of the profiler
         // OR the time is measured as the accumlation between start/pause and start/stop
+        counter_t elapsed_time;
         if(_flags.isSet(Flag::TimeMeasuredBetweenStartAndStop))
         {
-            _stats.time_us = stop_time_us - _time_accumulator.start_base;
+            elapsed_time = counters.time - _time_accumulator.start_base;
         }
         else 
         {
-            _stats.time_us = _time_accumulator.accumulator;
+            elapsed_time = _time_accumulator.accumulator;
         }
-#endif // __arm__
+
+#ifdef __arm__
+        _stats.time_us = elapsed_time;
+#else 
+        // On Windows/Linux the time is measured in nanoseconds
+        _stats.time_ns = elapsed_time;
+        _stats.time_us = (uint32_t)(elapsed_time / 1000);
+        _stats.instructions = _instruction_accumulator.accumulator;
+#endif
         
-        _cpu_accumulator.reset();
-        _time_accumulator.reset();
+        reset_accumulators();
     }
     else
     {
@@ -239,16 +372,13 @@ void Profiler::update_stats(bool stop, uint32_t stop_cpu_cycle, uint32_t stop_ti
 }
 
 /*************************************************************************************************/
-void AveragedProfiler::update_stats(bool stop, uint32_t stop_cpu_cycle, uint32_t stop_time_us)
+void AveragedProfiler::update_stats(bool stop, const Counters& counters)
 {
     if(_state != State::Stopped)
     {
         if(_state == State::Started)
         {
-            const uint32_t cpu_diff = stop_cpu_cycle - _cpu_accumulator.start_marker;
-            _cpu_accumulator.accumulator += cpu_diff;
-            const uint32_t time_diff = stop_time_us - _time_accumulator.start_marker;
-            _time_accumulator.accumulator += time_diff;
+            accumulate_stats(counters);
         }
 
         if(stop)
@@ -256,11 +386,18 @@ void AveragedProfiler::update_stats(bool stop, uint32_t stop_cpu_cycle, uint32_t
             _state = State::Stopped;
             ++total_count;
             total_cpu_cycles += _cpu_accumulator.accumulator;
-            total_time_us += _time_accumulator.accumulator;
             _stats.cpu_cycles = total_cpu_cycles / total_count;
+#ifdef __arm__
+            total_time_us += _time_accumulator.accumulator;
+#else 
+            total_time_ns += _time_accumulator.accumulator;
+            total_time_us = total_time_ns / 1000;
+            total_instructions += _instruction_accumulator.accumulator;
+            _stats.time_ns = total_time_ns / total_count;
+            _stats.instructions = total_instructions / total_count;
+#endif
             _stats.time_us = total_time_us / total_count;
-            _cpu_accumulator.reset();
-            _time_accumulator.reset();
+            reset_accumulators();
         }
         else
         {
@@ -276,6 +413,10 @@ void AveragedProfiler::reset(void)
     total_count = 0;
     total_cpu_cycles = 0;
     total_time_us = 0;
+#ifndef __arm__
+    total_time_ns = 0;
+    total_instructions = 0;
+#endif
 }
 
 
@@ -6,11 +6,11 @@
 #include "em_device.h"
 #include "cpputils/typed_linked_list.hpp"
 #include "cpputils/typed_list.hpp"
-#include "cpputils/typed_dict.hpp"
 #include "cpputils/flags_helper.hpp"
 #include "logging/logger.hpp"
 #include "profiling/profiling.hpp"
 #include "microsecond_timer.h"
+#include "profiling/host_timer.hpp"
 
 
 namespace profiling 
@@ -32,14 +32,22 @@ struct Metrics
 struct Stats
 {
     uint32_t time_us = 0;
-    uint32_t cpu_cycles = 0;
+    counter_t cpu_cycles = 0;
     uint32_t accelerator_cycles = 0;
+#ifndef __arm__
+    uint64_t time_ns = 0;
+    uint64_t instructions = 0;
+#endif
 
     void reset()
     {
         time_us = 0;
         cpu_cycles = 0;
         accelerator_cycles = 0;
+#ifndef __arm__
+        time_ns = 0;
+        instructions = 0;
+#endif
     }
 
 
@@ -48,14 +56,18 @@ struct Stats
         time_us += other.time_us;
         cpu_cycles += other.cpu_cycles;
         accelerator_cycles = other.accelerator_cycles;
+#ifndef __arm__
+        time_ns += other.time_ns;
+        instructions += other.instructions;
+#endif
     }
 };
 
 struct StatsAccumulator
 {
-    volatile uint32_t start_base = 0;
-    volatile uint32_t start_marker = 0;
-    uint32_t accumulator = 0;
+    volatile counter_t start_base = 0;
+    volatile counter_t start_marker = 0;
+    counter_t accumulator = 0;
 
     void reset()
     {
@@ -73,6 +85,7 @@ enum class Flag  : uint16_t
     ReportsFreeRunningCpuCycles             = (1 << 2),
     ExcludeStatsFromReport                  = (1 << 3),
     TimeMeasuredBetweenStartAndStop         = (1 << 4),
+    RecordTraceEvents                       = (1 << 5),
 };
 DEFINE_ENUM_CLASS_BITMASK_OPERATORS(Flag, uint16_t)
 
@@ -81,6 +94,51 @@ typedef cpputils::FlagsHelper<Flag> Flags;
 typedef void (CustomStatsPrinter)(Profiler& profiler, logging::Logger& logger, const char* level_str);
 
 
+#ifndef MLTK_PROFILING_MAX_CUSTOM_STATS
+#define MLTK_PROFILING_MAX_CUSTOM_STATS 32
+#endif
+static_assert(MLTK_PROFILING_MAX_CUSTOM_STATS <= 32, "The profiler tracks the used custom stats with a 32-bit mask");
+
+/**
+ * ID of a custom profiler stat
+ *
+ * Custom stat names are interned into a process-wide table,
+ * the returned ID indexes the stat's value in each profiler.
+ * Hot paths should register their stats once (e.g. during init)
+ * and then use the ID-based Profiler APIs.
+ */
+typedef int16_t CustomStatId;
+constexpr CustomStatId INVALID_CUSTOM_STAT_ID = -1;
+
+/**
+ * Return the ID of the given custom stat name, registering it if necessary
+ * The name is copied into the table.
+ * Returns INVALID_CUSTOM_STAT_ID and logs an error if MLTK_PROFILING_MAX_CUSTOM_STATS names are already registered
+ */
+DLL_EXPORT CustomStatId register_custom_stat(const char* name);
+/**
+ * Return the ID of a previously registered custom stat name, INVALID_CUSTOM_STAT_ID if not found
+ */
+DLL_EXPORT CustomStatId find_custom_stat(const char* name);
+/**
+ * Return the name of the given custom stat ID, nullptr if invalid
+ */
+DLL_EXPORT const char* get_custom_stat_name(CustomStatId id);
+/**
+ * Return the number of registered custom stats,
+ * valid IDs are in the range [0, get_custom_stat_count())
+ */
+DLL_EXPORT int get_custom_stat_count();
+
+// See profiler_trace.hpp
+enum class TraceEventType : uint8_t
+{
+    Begin,
+    End
+};
+DLL_EXPORT void trace_record_event(const Profiler* profiler, TraceEventType type, counter_t timestamp);
+
+
 static inline void start_cpu_cycle_counter()
 {
 #ifdef __arm__
@@ -91,7 +149,7 @@ static inline void start_cpu_cycle_counter()
 }
 
 
-static inline uint32_t get_cpu_cycles() 
+static inline counter_t get_cpu_cycles() 
 {
 #ifdef __arm__
     auto DWT_CYCCNT_REG ((const volatile uint32_t*)0xE0001004UL); // DWT->CYCCNT
@@ -99,18 +157,44 @@ static inline uint32_t get_cpu_cycles()
     *CORE_DEBUG_DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
     return *DWT_CYCCNT_REG; 
 #else 
-    return 0; // CPU cycles on Windows/Linux don't make sense, so just return 0
+    return host_timer_get_cpu_cycles();
 #endif
 }
 
 
+/**
+ * Snapshot of the counters used by the profiler
+ *
+ * On the embedded device, the time is in microseconds.
+ * On Windows/Linux, the time is in nanoseconds and the
+ * instruction count is also available (see host_timer.hpp)
+ */
+struct Counters
+{
+    counter_t cpu_cycles;
+    counter_t time;
+#ifndef __arm__
+    counter_t instructions;
+#endif
+
+    static inline void read(Counters& counters)
+    {
+#ifdef __arm__
+        counters.cpu_cycles = get_cpu_cycles();
+        counters.time = microsecond_timer_get_timestamp();
+#else 
+        host_timer_get_counters(counters.cpu_cycles, counters.instructions);
+        counters.time = host_timer_get_timestamp_ns();
+#endif
+    }
+};
+
+
 
 
 class Profiler : public cpputils::LinkedListItem
 {
 public:
-    cpputils::TypedDict<int32_t> custom_stats;
-
     const char* name() const;
     const char* fullname(Fullname& fullname) const;
     virtual void reset(void);
@@ -136,37 +220,72 @@ public:
     int32_t increment_custom_stat(const char* name, int32_t amount=1);
     int32_t get_custom_stat(const char* name) const;
 
+    int32_t inline increment_custom_stat(CustomStatId id, int32_t amount=1)
+    {
+        if((uint16_t)id >= MLTK_PROFILING_MAX_CUSTOM_STATS || 
+          (_custom_stats == nullptr && !allocate_custom_stats()))
+        {
+            return 0;
+        }
+        _custom_stats_mask |= (1UL << id);
+        _custom_stats[id] += amount;
+        return _custom_stats[id];
+    }
+
+    int32_t inline get_custom_stat(CustomStatId id) const
+    {
+        return has_custom_stat(id) ? _custom_stats[id] : 0;
+    }
+
+    /** Return true if the given stat was incremented on this profiler */
+    bool inline has_custom_stat(CustomStatId id) const
+    {
+        return (uint16_t)id < MLTK_PROFILING_MAX_CUSTOM_STATS && (_custom_stats_mask & (1UL << id)) != 0;
+    }
+
    
     void inline start(void)
     {
         if(_state != State::Started)
         {
             start_cpu_cycle_counter();
-            const uint32_t current_cycle = get_cpu_cycles();
-            const uint32_t current_time_us = microsecond_timer_get_timestamp();
+            Counters current;
+            Counters::read(current);
             if(_state == State::Stopped)
             {
-                _cpu_accumulator.start_base = current_cycle;
-                _time_accumulator.start_base = current_time_us;
+                _cpu_accumulator.start_base = current.cpu_cycles;
+                _time_accumulator.start_base = current.time;
+#ifndef __arm__
+                _instruction_accumulator.start_base = current.instructions;
+#endif
             }
             _state = State::Started;
-            _cpu_accumulator.start_marker = current_cycle;
-            _time_accumulator.start_marker = current_time_us;
+            if(_flags.isSet(Flag::RecordTraceEvents))
+            {
+                trace_record_event(this, TraceEventType::Begin, current.time);
+            }
+            _cpu_accumulator.start_marker = current.cpu_cycles;
+            _time_accumulator.start_marker = current.time;
+#ifndef __arm__
+            _instruction_accumulator.start_marker = current.instructions;
+#endif
         }
     }
 
     void inline stop(void)
     {
-        const volatile uint32_t stop_cpu_cycle = get_cpu_cycles();
-        const volatile uint32_t stop_time_us = microsecond_timer_get_timestamp();
-        update_stats(true, stop_cpu_cycle, stop_time_us);
+        Counters current;
+        Counters::read(current);
+        record_end_trace_event(current);
+        update_stats(true, current);
     }
 
     void inline pause(void)
     {
-        const volatile uint32_t stop_cpu_cycle = get_cpu_cycles();
-        const volatile uint32_t stop_time_us = microsecond_timer_get_timestamp();
-        update_stats(false, stop_cpu_cycle, stop_time_us);
+        Counters current;
+        Counters::read(current);
+        record_end_trace_event(current);
+        update_stats(false, current);
     }
 
 
@@ -185,11 +304,16 @@ public:
 
     StatsAccumulator _cpu_accumulator;
     StatsAccumulator _time_accumulator;
+#ifndef __arm__
+    StatsAccumulator _instruction_accumulator;
+#endif
     Flags _flags;
     const char* _msg = nullptr;
     cpputils::LinkedListItem *_linked_list_next = nullptr;
     Profiler *_parent = nullptr;
     CustomStatsPrinter* _custom_stats_printer = nullptr;
+    int32_t* _custom_stats = nullptr;
+    uint32_t _custom_stats_mask = 0;
     const char* _name = nullptr;
     bool _was_visited = false;
     void* _object_buffer = nullptr;
@@ -203,7 +327,18 @@ public:
         return sizeof(Profiler) + strlen(name) + 1;
     }
 
-    virtual void update_stats(bool stop, uint32_t stop_cpu_cycle, uint32_t stop_time_us);
+    virtual void update_stats(bool stop, const Counters& counters);
+    void accumulate_stats(const Counters& counters);
+    void reset_accumulators();
+    bool allocate_custom_stats();
+
+    void inline record_end_trace_event(const Counters& counters)
+    {
+        if(_state == State::Started && _flags.isSet(Flag::RecordTraceEvents))
+        {
+            trace_record_event(this, TraceEventType::End, counters.time);
+        }
+    }
     void get_child_metrics(const Profiler *profiler, Metrics &metrics) const;
     void next(cpputils::LinkedListItem* next) override;
     cpputils::LinkedListItem* next() override;
@@ -219,11 +354,15 @@ class AveragedProfiler : public Profiler
 {
 public:
     void reset(void) override;
-    void update_stats(bool stop, uint32_t stop_cpu_cycle, uint32_t stop_time_us) override;
+    void update_stats(bool stop, const Counters& counters) override;
 
 
     uint64_t total_time_us = 0;
     uint64_t total_cpu_cycles = 0;
+#ifndef __arm__
+    uint64_t total_time_ns = 0;
+    uint64_t total_instructions = 0;
+#endif
     uint32_t total_count = 0;
 
     AveragedProfiler(void* object_buffer, const char* name) : Profiler(object_buffer, name){}
@@ -0,0 +1,407 @@
+#ifndef MLTK_DLL_IMPORT
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#ifndef __arm__
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#endif
+
+#include "profiling/profiler_trace.hpp"
+
+
+namespace profiling
+{
+
+
+static TraceEvent* _trace_events = nullptr;
+static uint32_t _trace_capacity = 0;
+// Total number of events recorded since the last clear,
+// the ring buffer index is this count masked by the capacity
+#ifndef __arm__
+// On Windows/Linux, multiple models may be profiled in parallel
+static std::atomic<counter_t> _trace_total_count(0);
+#else
+static volatile counter_t _trace_total_count = 0;
+#endif
+// Number of events that were dropped before the ring buffer was last grown
+static uint32_t _trace_dropped_before_resize = 0;
+
+#ifndef __arm__
+static std::atomic<uint32_t> _trace_thread_count(0);
+
+// Recording an event takes a shared lock so the threads do not serialize each other.
+// Growing, freeing or clearing the ring buffer takes an exclusive lock,
+// so the buffer is never freed while another thread is recording into it
+static std::shared_mutex _trace_lock;
+#define TRACE_SHARED_LOCK() std::shared_lock<std::shared_mutex> _trace_lock_guard(_trace_lock)
+#define TRACE_EXCLUSIVE_LOCK() std::unique_lock<std::shared_mutex> _trace_lock_guard(_trace_lock)
+#else
+#define TRACE_SHARED_LOCK()
+#define TRACE_EXCLUSIVE_LOCK()
+#endif
+
+
+static uint32_t event_count_unlocked();
+static uint32_t dropped_count_unlocked();
+static void clear_unlocked();
+static uint16_t get_thread_id();
+static bool write_chrome_json(TraceWriter* writer, void* arg, counter_t start_index, uint32_t count, uint32_t* depths);
+static void set_trace_flag(Profiler* profiler, bool include_children);
+static bool write_json_string(TraceWriter* writer, void* arg, const char* str);
+
+
+
+/*************************************************************************************************/
+bool trace_enable(Profiler* profiler, uint32_t max_events, bool include_children)
+{
+    if(profiler == nullptr || max_events == 0)
+    {
+        return false;
+    }
+
+    uint32_t capacity = 1;
+    while(capacity < max_events)
+    {
+        capacity <<= 1;
+    }
+
+    // The ring buffer is shared by all the traced profilers (e.g. multiple models)
+    // so it is only ever grown and the recorded events are kept
+    TRACE_EXCLUSIVE_LOCK();
+    if(capacity > _trace_capacity)
+    {
+        auto events = static_cast<TraceEvent*>(malloc(sizeof(TraceEvent) * capacity));
+        if(events == nullptr)
+        {
+            return false;
+        }
+
+        const uint32_t count = event_count_unlocked();
+        const counter_t start_index = _trace_total_count - count;
+        for(uint32_t i = 0; i < count; ++i)
+        {
+            events[i] = _trace_events[(start_index + i) & (_trace_capacity - 1)];
+        }
+        _trace_dropped_before_resize = dropped_count_unlocked();
+        _trace_total_count = count;
+
+        free(_trace_events);
+        _trace_events = events;
+        _trace_capacity = capacity;
+    }
+
+    set_trace_flag(profiler, include_children);
+
+    return true;
+}
+
+/*************************************************************************************************/
+void trace_disable()
+{
+    for(auto profiler : get_profilers())
+    {
+        profiler->flags().clear(Flag::RecordTraceEvents);
+    }
+
+    TRACE_EXCLUSIVE_LOCK();
+    free(_trace_events);
+    _trace_events = nullptr;
+    _trace_capacity = 0;
+    clear_unlocked();
+}
+
+/*************************************************************************************************/
+bool trace_is_enabled()
+{
+    TRACE_SHARED_LOCK();
+    return _trace_events != nullptr;
+}
+
+/*************************************************************************************************/
+void trace_clear()
+{
+    TRACE_EXCLUSIVE_LOCK();
+    clear_unlocked();
+}
+
+/*************************************************************************************************/
+uint32_t trace_event_count()
+{
+    TRACE_SHARED_LOCK();
+    return event_count_unlocked();
+}
+
+/*************************************************************************************************/
+uint32_t trace_capacity()
+{
+    TRACE_SHARED_LOCK();
+    return _trace_capacity;
+}
+
+/*************************************************************************************************/
+uint32_t trace_dropped_count()
+{
+    TRACE_SHARED_LOCK();
+    return dropped_count_unlocked();
+}
+
+/*************************************************************************************************/
+void trace_record_event(const Profiler* profiler, TraceEventType type, counter_t timestamp)
+{
+    TRACE_SHARED_LOCK();
+    if(_trace_events == nullptr)
+    {
+        return;
+    }
+
+    const counter_t index = _trace_total_count++;
+    auto& event = _trace_events[index & (_trace_capacity - 1)];
+    event.profiler = profiler;
+    event.timestamp = timestamp;
+    event.type = type;
+    event.thread_id = get_thread_id();
+}
+
+/*************************************************************************************************/
+void trace_forget_profiler(const Profiler* profiler)
+{
+    TRACE_EXCLUSIVE_LOCK();
+    const uint32_t count = event_count_unlocked();
+    for(uint32_t i = 0; i < count; ++i)
+    {
+        if(_trace_events[i].profiler == profiler)
+        {
+            _trace_events[i].profiler = nullptr;
+        }
+    }
+}
+
+/*************************************************************************************************/
+bool trace_export_chrome_json(TraceWriter* writer, void* arg)
+{
+    TRACE_SHARED_LOCK();
+    const uint32_t count = event_count_unlocked();
+    const counter_t start_index = _trace_total_count - count;
+
+    // The events of each thread are nested independently,
+    // so track the begin/end depth of each thread
+    uint16_t max_thread_id = 0;
+    for(uint32_t i = 0; i < count; ++i)
+    {
+        const auto& event = _trace_events[(start_index + i) & (_trace_capacity - 1)];
+        max_thread_id = (event.thread_id > max_thread_id) ? event.thread_id : max_thread_id;
+    }
+    auto depths = static_cast<uint32_t*>(calloc(max_thread_id + 1, sizeof(uint32_t)));
+    if(depths == nullptr)
+    {
+        return false;
+    }
+
+    const bool retval = write_chrome_json(writer, arg, start_index, count, depths);
+    free(depths);
+
+    return retval;
+}
+
+#ifndef __arm__
+/*************************************************************************************************/
+bool trace_export_chrome_json(const char* path)
+{
+    auto fp = fopen(path, "w");
+    if(fp == nullptr)
+    {
+        return false;
+    }
+
+    const bool retval = trace_export_chrome_json([](const char* data, uint32_t length, void* arg) -> bool
+    {
+        return fwrite(data, 1, length, (FILE*)arg) == length;
+    }, fp);
+
+    fclose(fp);
+    return retval;
+}
+#endif
+
+/*************************************************************************************************
+ * Write the given range of the ring buffer as Chrome trace JSON
+ *
+ * depths is the zeroed begin/end depth of each thread ID
+ */
+static bool write_chrome_json(TraceWriter* writer, void* arg, counter_t start_index, uint32_t count, uint32_t* depths)
+{
+    char buffer[96];
+    bool is_first = true;
+
+    static const char header[] = "{\"traceEvents\":[\n";
+    if(!writer(header, sizeof(header)-1, arg))
+    {
+        return false;
+    }
+
+#ifdef __arm__
+    // The microsecond timer is 32-bit and wraps,
+    // so accumulate the deltas between the events
+    uint32_t elapsed_us = 0;
+    uint32_t prev_timestamp = (count > 0) ? _trace_events[start_index & (_trace_capacity - 1)].timestamp : 0;
+#else
+    const counter_t base_timestamp = (count > 0) ? _trace_events[start_index & (_trace_capacity - 1)].timestamp : 0;
+#endif
+
+    for(uint32_t i = 0; i < count; ++i)
+    {
+        const auto& event = _trace_events[(start_index + i) & (_trace_capacity - 1)];
+
+#ifdef __arm__
+        elapsed_us += (uint32_t)(event.timestamp - prev_timestamp);
+        prev_timestamp = event.timestamp;
+#endif
+
+        // Skip the events of unregistered profilers
+        // and the end events whose begin event was overwritten
+        if(event.profiler == nullptr)
+        {
+            continue;
+        }
+        auto& depth = depths[event.thread_id];
+        if(event.type == TraceEventType::Begin)
+        {
+            ++depth;
+        }
+        else if(depth == 0)
+        {
+            continue;
+        }
+        else
+        {
+            --depth;
+        }
+
+        int length = snprintf(buffer, sizeof(buffer), "%s{\"name\":", is_first ? "" : ",\n");
+        if(!writer(buffer, length, arg) || !write_json_string(writer, arg, event.profiler->name()))
+        {
+            return false;
+        }
+
+#ifdef __arm__
+        length = snprintf(buffer, sizeof(buffer), ",\"ph\":\"%c\",\"ts\":%lu,\"pid\":1,\"tid\":%u}",
+            (event.type == TraceEventType::Begin) ? 'B' : 'E', (unsigned long)elapsed_us, (unsigned)event.thread_id);
+#else
+        const int64_t elapsed_ns = (int64_t)(event.timestamp - base_timestamp);
+        length = snprintf(buffer, sizeof(buffer), ",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%u}",
+            (event.type == TraceEventType::Begin) ? 'B' : 'E', (double)elapsed_ns / 1000.0, (unsigned)event.thread_id);
+#endif
+        if(!writer(buffer, length, arg))
+        {
+            return false;
+        }
+        is_first = false;
+    }
+
+#ifdef __arm__
+    static const char footer[] = "\n],\"displayTimeUnit\":\"ms\"}\n";
+#else
+    static const char footer[] = "\n],\"displayTimeUnit\":\"ns\"}\n";
+#endif
+    return writer(footer, sizeof(footer)-1, arg);
+}
+
+/*************************************************************************************************/
+static uint32_t event_count_unlocked()
+{
+    const counter_t total = _trace_total_count;
+    return (total < _trace_capacity) ? (uint32_t)total : _trace_capacity;
+}
+
+/*************************************************************************************************/
+static uint32_t dropped_count_unlocked()
+{
+    const counter_t total = _trace_total_count;
+    return _trace_dropped_before_resize + ((total > _trace_capacity) ? (uint32_t)(total - _trace_capacity) : 0);
+}
+
+/*************************************************************************************************/
+static void clear_unlocked()
+{
+    _trace_total_count = 0;
+    _trace_dropped_before_resize = 0;
+}
+
+/*************************************************************************************************
+ * Return the ID of the calling thread, this is the "tid" of the exported events
+ *
+ * IDs are assigned in the order the threads record their first event, starting at 1
+ */
+static uint16_t get_thread_id()
+{
+#ifndef __arm__
+    static thread_local uint16_t thread_id = 0;
+    if(thread_id == 0)
+    {
+        thread_id = (uint16_t)(_trace_thread_count++ % UINT16_MAX) + 1;
+    }
+    return thread_id;
+#else
+    return 1;
+#endif
+}
+
+/*************************************************************************************************/
+static void set_trace_flag(Profiler* profiler, bool include_children)
+{
+    profiler->flags().set(Flag::RecordTraceEvents);
+
+    if(include_children)
+    {
+        for(auto child : profiler->children())
+        {
+            set_trace_flag(child, true);
+        }
+    }
+}
+
+/*************************************************************************************************/
+static bool write_json_string(TraceWriter* writer, void* arg, const char* str)
+{
+    char buffer[64];
+    uint32_t length = 0;
+
+    buffer[length++] = '"';
+    for(; *str != 0; ++str)
+    {
+        // Leave room for the longest escape sequence and the closing quote
+        if(length >= sizeof(buffer) - 8)
+        {
+            if(!writer(buffer, length, arg))
+            {
+                return false;
+            }
+            length = 0;
+        }
+        const unsigned char c = static_cast<unsigned char>(*str);
+        if(c == '"' || c == '\\')
+        {
+            buffer[length++] = '\\';
+            buffer[length++] = c;
+        }
+        else if(c < 0x20)
+        {
+            length += snprintf(&buffer[length], sizeof(buffer) - length, "\\u%04x", c);
+        }
+        else
+        {
+            buffer[length++] = c;
+        }
+    }
+    buffer[length++] = '"';
+
+    return writer(buffer, length, arg);
+}
+
+
+} // namespace profiling
+
+#endif // MLTK_DLL_IMPORT
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstdint>
+
+#include "profiling/profiler.hpp"
+
+
+namespace profiling
+{
+
+/**
+ * Profiler event trace
+ *
+ * When enabled, each traced profiler appends a timestamped begin event when it is started
+ * and an end event when it is stopped or paused. The events are stored in a ring buffer
+ * that is allocated by trace_enable(), so recording an event does not allocate.
+ * Once the ring buffer is full, the oldest events are overwritten.
+ *
+ * The ring buffer is shared by all of the traced profilers, e.g. multiple models
+ * profiled in parallel. Each event records the ID of the thread that recorded it,
+ * and the exported events of each thread use that ID as their "tid".
+ * On Windows/Linux, the ring buffer may be grown, cleared or freed while other threads are recording events.
+ *
+ * The recorded events may be exported as a Chrome trace JSON file which can be viewed
+ * in chrome://tracing or https://ui.perfetto.dev
+ *
+ * On the embedded device, the timestamps have a microsecond resolution.
+ * On Windows/Linux, the timestamps have a nanosecond resolution.
+ */
+
+struct TraceEvent
+{
+    const Profiler* profiler;
+    counter_t timestamp;
+    TraceEventType type;
+    /** ID of the thread that recorded the event, starting at 1 (always 1 on the embedded device) */
+    uint16_t thread_id;
+};
+
+/**
+ * Write callback used by the trace exporter,
+ * return false to abort the export
+ */
+typedef bool (TraceWriter)(const char* data, uint32_t length, void* arg);
+
+
+/**
+ * Enable event tracing for the given profiler
+ *
+ * @param profiler The profiler to trace, e.g. TfliteMicroModel::profiler()
+ * @param max_events Size of the ring buffer, this is rounded up to a power of 2.
+ *        If the ring buffer was previously allocated with a smaller size then it is grown.
+ *        The already recorded events are always kept, use trace_clear() to discard them
+ * @param include_children If true, then also trace all of the profiler's children
+ * @return true if tracing was enabled, false if the ring buffer could not be allocated
+ */
+DLL_EXPORT bool trace_enable(Profiler* profiler, uint32_t max_events, bool include_children=true);
+/**
+ * Disable tracing for all profilers and free the ring buffer
+ */
+DLL_EXPORT void trace_disable();
+/**
+ * Return true if the trace ring buffer is allocated
+ */
+DLL_EXPORT bool trace_is_enabled();
+/**
+ * Discard all of the recorded events
+ */
+DLL_EXPORT void trace_clear();
+/**
+ * Return the number of events currently in the ring buffer
+ */
+DLL_EXPORT uint32_t trace_event_count();
+/**
+ * Return the capacity of the ring buffer
+ */
+DLL_EXPORT uint32_t trace_capacity();
+/**
+ * Return the number of events that were overwritten or dropped since the last trace_clear()
+ */
+DLL_EXPORT uint32_t trace_dropped_count();
+/**
+ * Append an event to the ring buffer
+ * This is called by the Profiler for profilers with Flag::RecordTraceEvents
+ */
+DLL_EXPORT void trace_record_event(const Profiler* profiler, TraceEventType type, counter_t timestamp);
+/**
+ * Remove the given profiler's events from the ring buffer
+ * This is called when a traced profiler is unregistered
+ */
+DLL_EXPORT void trace_forget_profiler(const Profiler* profiler);
+
+/**
+ * Export the recorded events as Chrome trace JSON
+ *
+ * The events are exported oldest first. End events whose begin event was overwritten
+ * are skipped, the begin/end events are matched separately for each thread.
+ * This should not be called while a traced profiler is running.
+ *
+ * @param writer Callback invoked with each chunk of JSON
+ * @param arg Argument passed to the writer
+ * @return true if all of the events were written
+ */
+DLL_EXPORT bool trace_export_chrome_json(TraceWriter* writer, void* arg = nullptr);
+
+#ifndef __arm__
+/**
+ * Export the recorded events as Chrome trace JSON to the given file path
+ */
+DLL_EXPORT bool trace_export_chrome_json(const char* path);
+#endif
+
+} // namespace profiling
@@ -316,9 +316,9 @@ void print_stats(const Profiler* profiler, logging::Logger *optional_logger, boo
 
 
 /*************************************************************************************************/
-uint32_t calculate_total_children_cpu_cycles(const Profiler* profiler, bool is_root)
+counter_t calculate_total_children_cpu_cycles(const Profiler* profiler, bool is_root)
 {
-    uint32_t total_cycles = 0;
+    counter_t total_cycles = 0;
 
     if(!is_root && !profiler->flags().isSet(Flag::ExcludeFromTotalChildrenCyclesReport))
     {
@@ -334,9 +334,9 @@ uint32_t calculate_total_children_cpu_cycles(const Profiler* profiler, bool is_r
 }
 
 /*************************************************************************************************/
-uint32_t calculate_total_children_accelerator_cycles(const Profiler* profiler, bool is_root)
+counter_t calculate_total_children_accelerator_cycles(const Profiler* profiler, bool is_root)
 {
-    uint32_t total_cycles = 0;
+    counter_t total_cycles = 0;
 
     if(!is_root && !profiler->flags().isSet(Flag::ExcludeFromTotalChildrenCyclesReport))
     {
@@ -460,11 +460,14 @@ static void print_profiler_statistics(
             }
         }
 
-        for(auto item_it = profiler->custom_stats.items(); item_it != profiler->custom_stats.enditems(); ++item_it)
+        const int custom_stat_count = get_custom_stat_count();
+        for(CustomStatId id = 0; id < custom_stat_count; ++id)
         {
-            print_profiler_name_if_necessary();
-            const auto item = item_it.current;
-            logger.info("%s %s=%d", level_str, item->key, *item->value);
+            if(profiler->has_custom_stat(id))
+            {
+                print_profiler_name_if_necessary();
+                logger.info("%s %s=%d", level_str, get_custom_stat_name(id), profiler->get_custom_stat(id));
+            }
         }
     }
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include "cpputils/helpers.hpp"
 #include "cpputils/typed_list.hpp"
 #include "cpputils/typed_linked_list.hpp"
@@ -10,6 +11,15 @@
 namespace profiling
 {
 
+// The embedded counters are 32-bit and wrap,
+// on Windows/Linux 64-bit counters are used
+#ifdef __arm__
+typedef uint32_t counter_t;
+#else
+typedef uint64_t counter_t;
+#endif
+
+
 class Profiler;
 class AveragedProfiler;
 using ProfilerList = cpputils::TypedLinkedList<Profiler>;
@@ -35,7 +45,7 @@ void print_metrics(const char* name, logging::Logger *logger = nullptr, bool pre
 void print_metrics(const Profiler* profiler, logging::Logger *logger = nullptr, bool pretty_print = true);
 void print_stats(const char* name, logging::Logger *logger = nullptr, bool pretty_print = true);
 void print_stats(const Profiler* profiler, logging::Logger *logger = nullptr, bool pretty_print = true);
-uint32_t calculate_total_children_cpu_cycles(const Profiler* profiler, bool is_root = true);
-uint32_t calculate_total_children_accelerator_cycles(const Profiler* profiler, bool is_root = true);
+counter_t calculate_total_children_cpu_cycles(const Profiler* profiler, bool is_root = true);
+counter_t calculate_total_children_accelerator_cycles(const Profiler* profiler, bool is_root = true);
 
 } // namespace profiling
@@ -0,0 +1,353 @@
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "profiling/profiling.hpp"
+#include "profiling/profiler_trace.hpp"
+
+
+using namespace profiling;
+
+
+namespace {
+
+
+struct ParsedEvent
+{
+    std::string name;
+    char phase;
+    double ts;
+    unsigned tid;
+};
+
+
+bool append_to_string(const char* data, uint32_t length, void* arg)
+{
+    static_cast<std::string*>(arg)->append(data, length);
+    return true;
+}
+
+std::string export_json()
+{
+    std::string json;
+    EXPECT_TRUE(trace_export_chrome_json(append_to_string, &json));
+    return json;
+}
+
+// Parse the events of the exported JSON,
+// each event is on its own line and the names do not need escaping
+std::vector<ParsedEvent> export_events()
+{
+    const auto json = export_json();
+    std::vector<ParsedEvent> events;
+
+    size_t pos = 0;
+    while((pos = json.find("{\"name\":\"", pos)) != std::string::npos)
+    {
+        char name[64];
+        ParsedEvent event;
+        const int n = sscanf(&json[pos], "{\"name\":\"%63[^\"]\",\"ph\":\"%c\",\"ts\":%lf,\"pid\":1,\"tid\":%u}",
+            name, &event.phase, &event.ts, &event.tid);
+        EXPECT_EQ(n, 4) << &json[pos];
+        event.name = name;
+        events.push_back(event);
+        ++pos;
+    }
+
+    return events;
+}
+
+
+class ProfilerTrace : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        ASSERT_TRUE(register_profiler("trace_root", root));
+        ASSERT_TRUE(register_profiler("trace_child", child, root));
+    }
+
+    void TearDown() override
+    {
+        trace_disable();
+        unregister(root);
+    }
+
+    Profiler* root = nullptr;
+    Profiler* child = nullptr;
+};
+
+
+TEST_F(ProfilerTrace, JsonOutput)
+{
+    ASSERT_TRUE(trace_enable(root, 16));
+    trace_record_event(root, TraceEventType::Begin, 1000);
+    trace_record_event(child, TraceEventType::Begin, 1500);
+    trace_record_event(child, TraceEventType::End, 2500);
+    trace_record_event(root, TraceEventType::End, 4000);
+
+    const auto json = export_json();
+    unsigned tid = 0;
+    ASSERT_EQ(sscanf(strstr(json.c_str(), "\"tid\":"), "\"tid\":%u", &tid), 1);
+    EXPECT_GT(tid, 0U);
+
+    char expected[512];
+    snprintf(expected, sizeof(expected),
+        "{\"traceEvents\":[\n"
+        "{\"name\":\"trace_root\",\"ph\":\"B\",\"ts\":0.000,\"pid\":1,\"tid\":%u},\n"
+        "{\"name\":\"trace_child\",\"ph\":\"B\",\"ts\":0.500,\"pid\":1,\"tid\":%u},\n"
+        "{\"name\":\"trace_child\",\"ph\":\"E\",\"ts\":1.500,\"pid\":1,\"tid\":%u},\n"
+        "{\"name\":\"trace_root\",\"ph\":\"E\",\"ts\":3.000,\"pid\":1,\"tid\":%u}\n"
+        "],\"displayTimeUnit\":\"ns\"}\n",
+        tid, tid, tid, tid
+    );
+    EXPECT_EQ(json, expected);
+}
+
+TEST_F(ProfilerTrace, EmptyJsonOutput)
+{
+    ASSERT_TRUE(trace_enable(root, 16));
+    EXPECT_EQ(export_json(), "{\"traceEvents\":[\n\n],\"displayTimeUnit\":\"ns\"}\n");
+}
+
+TEST_F(ProfilerTrace, NamesAreEscaped)
+{
+    Profiler* profiler;
+    ASSERT_TRUE(register_profiler("layer \"0\"\\\t", profiler, root));
+    ASSERT_TRUE(trace_enable(root, 16));
+    trace_record_event(profiler, TraceEventType::Begin, 0);
+    trace_record_event(profiler, TraceEventType::End, 1000);
+
+    const auto json = export_json();
+    EXPECT_NE(json.find("{\"name\":\"layer \\\"0\\\"\\\\\\u0009\",\"ph\":\"B\""), std::string::npos) << json;
+    EXPECT_NE(json.find("{\"name\":\"layer \\\"0\\\"\\\\\\u0009\",\"ph\":\"E\""), std::string::npos) << json;
+}
+
+TEST_F(ProfilerTrace, RingBufferWrapsAround)
+{
+    ASSERT_TRUE(trace_enable(root, 3));
+    EXPECT_EQ(trace_capacity(), 4U);
+
+    for(int i = 0; i < 10; ++i)
+    {
+        trace_record_event(child, (i % 2 == 0) ? TraceEventType::Begin : TraceEventType::End, i * 1000);
+    }
+    EXPECT_EQ(trace_event_count(), 4U);
+    EXPECT_EQ(trace_dropped_count(), 6U);
+
+    // Only the newest events are exported, oldest first
+    const auto events = export_events();
+    ASSERT_EQ(events.size(), 4U);
+    for(int i = 0; i < 4; ++i)
+    {
+        EXPECT_EQ(events[i].name, "trace_child");
+        EXPECT_EQ(events[i].phase, (i % 2 == 0) ? 'B' : 'E');
+        EXPECT_DOUBLE_EQ(events[i].ts, (double)i);
+    }
+
+    trace_clear();
+    EXPECT_EQ(trace_event_count(), 0U);
+    EXPECT_EQ(trace_dropped_count(), 0U);
+    EXPECT_TRUE(export_events().empty());
+}
+
+TEST_F(ProfilerTrace, OrphanEndEventsAreSkipped)
+{
+    Profiler* sibling;
+    ASSERT_TRUE(register_profiler("trace_sibling", sibling, root));
+    ASSERT_TRUE(trace_enable(root, 4));
+
+    // The begin events of root and child are overwritten
+    trace_record_event(root, TraceEventType::Begin, 0);
+    trace_record_event(child, TraceEventType::Begin, 1000);
+    trace_record_event(child, TraceEventType::End, 2000);
+    trace_record_event(sibling, TraceEventType::Begin, 3000);
+    trace_record_event(sibling, TraceEventType::End, 4000);
+    trace_record_event(root, TraceEventType::End, 5000);
+    EXPECT_EQ(trace_dropped_count(), 2U);
+
+    const auto events = export_events();
+    ASSERT_EQ(events.size(), 2U);
+    EXPECT_EQ(events[0].name, "trace_sibling");
+    EXPECT_EQ(events[0].phase, 'B');
+    EXPECT_DOUBLE_EQ(events[0].ts, 1.0);
+    EXPECT_EQ(events[1].name, "trace_sibling");
+    EXPECT_EQ(events[1].phase, 'E');
+    EXPECT_DOUBLE_EQ(events[1].ts, 2.0);
+}
+
+// The begin/end events of each thread are matched separately,
+// e.g. when multiple models are profiled in parallel
+TEST_F(ProfilerTrace, DepthIsTrackedPerThread)
+{
+    ASSERT_TRUE(trace_enable(root, 16));
+
+    trace_record_event(root, TraceEventType::Begin, 0);
+    std::thread thread([this]()
+    {
+        // This end event has no begin event on this thread
+        trace_record_event(child, TraceEventType::End, 1000);
+        trace_record_event(child, TraceEventType::Begin, 2000);
+        trace_record_event(child, TraceEventType::End, 3000);
+    });
+    thread.join();
+    trace_record_event(root, TraceEventType::End, 4000);
+
+    const auto events = export_events();
+    ASSERT_EQ(events.size(), 4U);
+    EXPECT_EQ(events[0].name, "trace_root");
+    EXPECT_EQ(events[0].phase, 'B');
+    EXPECT_EQ(events[1].name, "trace_child");
+    EXPECT_EQ(events[1].phase, 'B');
+    EXPECT_EQ(events[2].name, "trace_child");
+    EXPECT_EQ(events[2].phase, 'E');
+    EXPECT_EQ(events[3].name, "trace_root");
+    EXPECT_EQ(events[3].phase, 'E');
+
+    EXPECT_EQ(events[0].tid, events[3].tid);
+    EXPECT_EQ(events[1].tid, events[2].tid);
+    EXPECT_NE(events[0].tid, events[1].tid);
+}
+
+// Enabling tracing for another profiler does not discard the recorded events
+TEST_F(ProfilerTrace, SecondEnableKeepsEvents)
+{
+    Profiler* other;
+    ASSERT_TRUE(register_profiler("trace_other", other));
+
+    ASSERT_TRUE(trace_enable(root, 2, false));
+    for(int i = 0; i < 6; ++i)
+    {
+        trace_record_event(root, (i % 2 == 0) ? TraceEventType::Begin : TraceEventType::End, i * 1000);
+    }
+    EXPECT_EQ(trace_dropped_count(), 4U);
+
+    // Same size
+    ASSERT_TRUE(trace_enable(other, 2));
+    EXPECT_EQ(trace_capacity(), 2U);
+    EXPECT_EQ(trace_event_count(), 2U);
+    EXPECT_EQ(trace_dropped_count(), 4U);
+
+    // Smaller size
+    ASSERT_TRUE(trace_enable(other, 1));
+    EXPECT_EQ(trace_capacity(), 2U);
+    EXPECT_EQ(trace_event_count(), 2U);
+
+    // Larger size, the ring buffer is grown
+    ASSERT_TRUE(trace_enable(other, 8));
+    EXPECT_EQ(trace_capacity(), 8U);
+    EXPECT_EQ(trace_event_count(), 2U);
+    EXPECT_EQ(trace_dropped_count(), 4U);
+
+    trace_record_event(other, TraceEventType::Begin, 6000);
+    trace_record_event(other, TraceEventType::End, 7000);
+    EXPECT_EQ(trace_event_count(), 4U);
+    EXPECT_EQ(trace_dropped_count(), 4U);
+
+    const auto events = export_events();
+    ASSERT_EQ(events.size(), 4U);
+    EXPECT_EQ(events[0].name, "trace_root");
+    EXPECT_EQ(events[0].phase, 'B');
+    EXPECT_DOUBLE_EQ(events[0].ts, 0.0);
+    EXPECT_EQ(events[1].name, "trace_root");
+    EXPECT_EQ(events[1].phase, 'E');
+    EXPECT_DOUBLE_EQ(events[1].ts, 1.0);
+    EXPECT_EQ(events[2].name, "trace_other");
+    EXPECT_EQ(events[2].phase, 'B');
+    EXPECT_DOUBLE_EQ(events[2].ts, 2.0);
+    EXPECT_EQ(events[3].name, "trace_other");
+    EXPECT_EQ(events[3].phase, 'E');
+    EXPECT_DOUBLE_EQ(events[3].ts, 3.0);
+
+    unregister(other);
+}
+
+// The ring buffer may be grown or freed while other threads record events
+TEST_F(ProfilerTrace, ResizeWhileRecording)
+{
+    ASSERT_TRUE(trace_enable(root, 4));
+
+    std::atomic<bool> running(true);
+    std::vector<std::thread> threads;
+    for(int i = 0; i < 4; ++i)
+    {
+        threads.emplace_back([this, &running]()
+        {
+            counter_t timestamp = 0;
+            while(running)
+            {
+                trace_record_event(child, TraceEventType::Begin, ++timestamp);
+                trace_record_event(child, TraceEventType::End, ++timestamp);
+            }
+        });
+    }
+
+    for(uint32_t max_events = 8; max_events <= 4096; max_events *= 2)
+    {
+        ASSERT_TRUE(trace_enable(root, max_events));
+        EXPECT_LE(trace_event_count(), trace_capacity());
+        if(max_events == 256)
+        {
+            trace_disable();
+            EXPECT_FALSE(trace_is_enabled());
+        }
+    }
+    running = false;
+    for(auto& t : threads)
+    {
+        t.join();
+    }
+
+    EXPECT_EQ(trace_capacity(), 4096U);
+    EXPECT_LE(trace_event_count(), 4096U);
+}
+
+TEST_F(ProfilerTrace, UnregisteredProfilerEventsAreSkipped)
+{
+    Profiler* removed;
+    ASSERT_TRUE(register_profiler("trace_removed", removed, root));
+    ASSERT_TRUE(trace_enable(root, 16));
+
+    trace_record_event(removed, TraceEventType::Begin, 0);
+    trace_record_event(child, TraceEventType::Begin, 1000);
+    trace_record_event(child, TraceEventType::End, 2000);
+    trace_record_event(removed, TraceEventType::End, 3000);
+    unregister(removed);
+
+    const auto events = export_events();
+    ASSERT_EQ(events.size(), 2U);
+    EXPECT_EQ(events[0].name, "trace_child");
+    EXPECT_EQ(events[1].name, "trace_child");
+}
+
+TEST_F(ProfilerTrace, ProfilerRecordsEvents)
+{
+    ASSERT_TRUE(trace_enable(root, 16));
+
+    root->start();
+    child->start();
+    child->stop();
+    root->stop();
+
+    const auto events = export_events();
+    ASSERT_EQ(events.size(), 4U);
+    EXPECT_EQ(events[0].name, "trace_root");
+    EXPECT_EQ(events[0].phase, 'B');
+    EXPECT_EQ(events[1].name, "trace_child");
+    EXPECT_EQ(events[1].phase, 'B');
+    EXPECT_EQ(events[2].name, "trace_child");
+    EXPECT_EQ(events[2].phase, 'E');
+    EXPECT_EQ(events[3].name, "trace_root");
+    EXPECT_EQ(events[3].phase, 'E');
+    for(size_t i = 1; i < events.size(); ++i)
+    {
+        EXPECT_GE(events[i].ts, events[i-1].ts);
+    }
+}
+
+
+} // namespace
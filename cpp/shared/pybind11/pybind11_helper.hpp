@@ -137,6 +137,59 @@ static inline py::array tflite_tensor_to_array(const TfliteTensorView& tensor)
 }
 
 
+/*************************************************************************************************
+ * Validate the given batch of samples for the given model input tensor,
+ * the batch must have the tensor's data type and the shape: N x <tensor shape>
+ *
+ * Return the batch as a C-contiguous array so each sample can be copied directly into the input tensor
+ */
+static inline py::array input_batch_to_contiguous_array(const py::array& inputs, const TfliteTensorView& input_tensor)
+{
+    const auto input_shape = input_tensor.shape();
+    const auto input_dtype = py::dtype(tflite_type_to_format_descriptor(input_tensor.type));
+
+    if(inputs.dtype().kind() != input_dtype.kind() || inputs.dtype().itemsize() != input_dtype.itemsize())
+    {
+        throw std::invalid_argument("Input batch data type does not match the model input tensor's data type");
+    }
+    if(inputs.ndim() != input_shape.length + 1)
+    {
+        throw std::invalid_argument("Input batch must have shape: N x <model input shape>");
+    }
+    for(int i = 0; i < input_shape.length; ++i)
+    {
+        if(inputs.shape(i+1) != (ssize_t)input_shape[i])
+        {
+            throw std::invalid_argument("Input batch must have shape: N x <model input shape>");
+        }
+    }
+
+    const auto contiguous_inputs = py::array::ensure(inputs, py::array::c_style);
+    if(!contiguous_inputs)
+    {
+        throw std::invalid_argument("Failed to convert input batch to a contiguous array");
+    }
+
+    return contiguous_inputs;
+}
+
+
+/*************************************************************************************************
+ * Return an uninitialized batch with the shape: batch_size x <output tensor shape>
+ */
+static inline py::array create_output_batch(ssize_t batch_size, const TfliteTensorView& output_tensor)
+{
+    const auto output_shape = output_tensor.shape();
+    std::vector<ssize_t> output_dims{batch_size};
+    for(int i = 0; i < output_shape.length; ++i)
+    {
+        output_dims.push_back(output_shape[i]);
+    }
+
+    return py::array(py::dtype(tflite_type_to_format_descriptor(output_tensor.type)), output_dims);
+}
+
+
 /*************************************************************************************************/
 template<typename dtype>
 py::array create_1d_array(int length, dtype* data)
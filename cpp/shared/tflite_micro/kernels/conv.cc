@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/padding.h"
 #include "tensorflow/lite/micro/kernels/kernel_util.h"
 #include "CMSIS/NN/Include/arm_nnfunctions.h"
+#include "mltk_tflite_micro_host_kernels.hpp"
 
 
 namespace tflite {
@@ -165,7 +166,7 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
     }
     case kTfLiteInt8: {
       context->GetScratchBuffer(context, cmsis_data.buffer_idx);
-      reference_integer_ops::ConvPerChannel(
+      mltk::host_kernels::ConvPerChannel(
           ConvParamsQuantized(params, data), data.per_channel_output_multiplier,
           data.per_channel_output_shift, tflite::micro::GetTensorShape(input),
           tflite::micro::GetTensorData<int8_t>(input),
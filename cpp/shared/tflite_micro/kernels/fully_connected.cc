@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
 #include "tensorflow/lite/micro/kernels/kernel_util.h"
+#include "mltk_tflite_micro_host_kernels.hpp"
 
 namespace tflite {
 namespace {
@@ -120,7 +121,7 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
           nullptr != bias ? tflite::micro::GetTensorData<int32_t>(bias)
                           : nullptr;
 
-      tflite::reference_integer_ops::FullyConnected(
+      mltk::host_kernels::FullyConnected(
           FullyConnectedParamsQuantized(data),
           tflite::micro::GetTensorShape(input),
           tflite::micro::GetTensorData<int8_t>(input),
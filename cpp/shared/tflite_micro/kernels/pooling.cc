@@ -19,6 +19,7 @@ limitations under the License.
 #include "tensorflow/lite/micro/kernels/kernel_util.h"
 #include "tensorflow/lite/micro/kernels/pooling.h"
 #include "CMSIS/NN/Include/arm_nnfunctions.h"
+#include "mltk_tflite_micro_host_kernels.hpp"
 
 
 namespace tflite {
@@ -32,6 +33,20 @@ struct CmisOpDataPooling
   int buffer_idx;
 };
 
+PoolParams QuantizedPoolParams(const TfLitePoolParams* params,
+                               const OpDataPooling* data) {
+  PoolParams op_params;
+  op_params.stride_height = params->stride_height;
+  op_params.stride_width = params->stride_width;
+  op_params.filter_height = params->filter_height;
+  op_params.filter_width = params->filter_width;
+  op_params.padding_values.height = data->padding.height;
+  op_params.padding_values.width = data->padding.width;
+  op_params.quantized_activation_min = data->activation_min;
+  op_params.quantized_activation_max = data->activation_max;
+  return op_params;
+}
+
 
 TfLiteStatus AveragePoolingPrepare(TfLiteContext* context, TfLiteNode* node) {
   TfLiteStatus status = PoolingPrepare(context, node);
@@ -90,7 +105,12 @@ TfLiteStatus AverageEval(TfLiteContext* context, TfLiteNode* node) {
       break;
     case kTfLiteInt8:
       context->GetScratchBuffer(context, cmsis_data->buffer_idx);
-      AveragePoolingEvalQuantized(context, node, params, data, input, output);
+      TF_LITE_ENSURE(context, mltk::host_kernels::AveragePool(
+                                  QuantizedPoolParams(params, data),
+                                  micro::GetTensorShape(input),
+                                  micro::GetTensorData<int8_t>(input),
+                                  micro::GetTensorShape(output),
+                                  micro::GetTensorData<int8_t>(output)));
       break;
     default:
       TF_LITE_KERNEL_LOG(context, "Input type %s is not currently supported",
@@ -118,7 +138,11 @@ TfLiteStatus MaxEval(TfLiteContext* context, TfLiteNode* node) {
       MaxPoolingEvalFloat(context, node, params, data, input, output);
       break;
     case kTfLiteInt8:
-      MaxPoolingEvalQuantized(context, node, params, data, input, output);
+      mltk::host_kernels::MaxPool(QuantizedPoolParams(params, data),
+                                  micro::GetTensorShape(input),
+                                  micro::GetTensorData<int8_t>(input),
+                                  micro::GetTensorShape(output),
+                                  micro::GetTensorData<int8_t>(output));
       break;
     default:
       TF_LITE_KERNEL_LOG(context, "Type %s not currently supported.",
@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/internal/compatibility.h"
 #include "tensorflow/lite/micro/flatbuffer_utils.h"
 #include "tensorflow/lite/micro/memory_helpers.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
 #include "tensorflow/lite/micro/micro_log.h"
 #include "tensorflow/lite/micro/micro_profiler.h"
 #include "tensorflow/lite/schema/schema_generated.h"
@@ -37,6 +38,62 @@ const char* OpNameFromRegistration(const TfLiteRegistration* registration) {
   }
 }
 
+// Patched by MLTK: The operator loop of MicroGraph::InvokeSubgraph(),
+// this is shared with mltk::invoke_subgraph_range()
+TfLiteStatus InvokeOperators(TfLiteContext* context, MicroAllocator* allocator,
+                             SubgraphAllocations* subgraph_allocations,
+                             int subgraph_idx, size_t first_op,
+                             size_t end_op) {
+  DECLARE_OP_PROFILER_CONTEXT()
+  for (size_t i = first_op; i < end_op; ++i) {
+    TfLiteNode* node =
+        &(subgraph_allocations[subgraph_idx].node_and_registrations[i].node);
+    const TfLiteRegistration* registration = subgraph_allocations[subgraph_idx]
+                                                 .node_and_registrations[i]
+                                                 .registration;
+
+// This ifdef is needed (even though ScopedMicroProfiler itself is a no-op with
+// -DTF_LITE_STRIP_ERROR_STRINGS) because the function OpNameFromRegistration is
+// only defined for builds with the error strings.
+#if !defined(TF_LITE_STRIP_ERROR_STRINGS)
+    ScopedMicroProfiler scoped_profiler(
+        OpNameFromRegistration(registration),
+        reinterpret_cast<MicroProfiler*>(context->profiler));
+#endif
+
+    TFLITE_DCHECK(registration->invoke);
+    TFLITE_MICRO_RECORD_INPUTS(i, context, node)
+    if (subgraph_idx == 0) {
+      TFLITE_MICRO_DIFFERENTIAL_BEGIN_LAYER(i, context, node)
+    }
+    START_OP_PROFILER(subgraph_idx, i, registration->builtin_code)
+    TfLiteStatus invoke_status = registration->invoke(context, node);
+    STOP_OP_PROFILER(subgraph_idx, i)
+    TFLITE_MICRO_RECORD_OUTPUTS(i, context, node)
+    if (subgraph_idx == 0 && invoke_status == kTfLiteOk) {
+      TFLITE_MICRO_DIFFERENTIAL_END_LAYER(i, context, node, registration)
+    }
+
+    // All TfLiteTensor structs used in the kernel are allocated from temp
+    // memory in the allocator. This creates a chain of allocations in the
+    // temp section. The call below resets the chain of allocations to
+    // prepare for the next call.
+    allocator->ResetTempAllocations();
+
+    if (invoke_status == kTfLiteError) {
+      MicroPrintf("Node %s (number %d) failed to invoke with status %d",
+                  OpNameFromRegistration(registration), i, invoke_status);
+      return kTfLiteError;
+    } else if (invoke_status != kTfLiteOk) {
+      return invoke_status;
+    }
+
+    INVOKE_PROCESSING_CALLBACK();
+  }
+
+  return kTfLiteOk;
+}
+
 }  // namespace
 
 MicroGraph::MicroGraph(TfLiteContext* context, const Model* model,
@@ -119,6 +176,7 @@ TfLiteStatus MicroGraph::PrepareSubgraphs() {
       REGISTER_PROFILER(subgraph_idx, i, registration->builtin_code, context_, subgraph_allocations_[subgraph_idx].node_and_registrations[i])
     }
   }
+  SAVE_SCRATCH_BUFFER_REQUESTS(allocator_)
   current_subgraph_index_ = previous_subgraph_idx;
 
   return kTfLiteOk;
@@ -162,44 +220,11 @@ TfLiteStatus MicroGraph::InvokeSubgraph(int subgraph_idx) {
   INVOKE_PROCESSING_CALLBACK();
   START_INFERENCE_PROFILER(subgraph_idx)
   uint32_t operators_size = NumSubgraphOperators(model_, subgraph_idx);
-  for (size_t i = 0; i < operators_size; ++i) {
-    TfLiteNode* node =
-        &(subgraph_allocations_[subgraph_idx].node_and_registrations[i].node);
-    const TfLiteRegistration* registration = subgraph_allocations_[subgraph_idx]
-                                                 .node_and_registrations[i]
-                                                 .registration;
-
-// This ifdef is needed (even though ScopedMicroProfiler itself is a no-op with
-// -DTF_LITE_STRIP_ERROR_STRINGS) because the function OpNameFromRegistration is
-// only defined for builds with the error strings.
-#if !defined(TF_LITE_STRIP_ERROR_STRINGS)
-    ScopedMicroProfiler scoped_profiler(
-        OpNameFromRegistration(registration),
-        reinterpret_cast<MicroProfiler*>(context_->profiler));
-#endif
-
-    TFLITE_DCHECK(registration->invoke);
-    TFLITE_MICRO_RECORD_INPUTS(i, context_, node)
-    START_OP_PROFILER(subgraph_idx, i, registration->builtin_code)
-    TfLiteStatus invoke_status = registration->invoke(context_, node);
-    STOP_OP_PROFILER(subgraph_idx, i)
-    TFLITE_MICRO_RECORD_OUTPUTS(i, context_, node)
-
-    // All TfLiteTensor structs used in the kernel are allocated from temp
-    // memory in the allocator. This creates a chain of allocations in the
-    // temp section. The call below resets the chain of allocations to
-    // prepare for the next call.
-    allocator_->ResetTempAllocations();
-
-    if (invoke_status == kTfLiteError) {
-      MicroPrintf("Node %s (number %d) failed to invoke with status %d",
-                  OpNameFromRegistration(registration), i, invoke_status);
-      return kTfLiteError;
-    } else if (invoke_status != kTfLiteOk) {
-      return invoke_status;
-    }
-
-    INVOKE_PROCESSING_CALLBACK();
+  TfLiteStatus invoke_status =
+      InvokeOperators(context_, allocator_, subgraph_allocations_,
+                      subgraph_idx, 0, operators_size);
+  if (invoke_status != kTfLiteOk) {
+    return invoke_status;
   }
   STOP_INFERENCE_PROFILER(subgraph_idx)
   current_subgraph_index_ = previous_subgraph_idx;
@@ -263,3 +288,33 @@ TfLiteEvalTensor* MicroGraph::GetSubgraphOutput(int subgraph_idx,
 }
 
 }  // namespace tflite
+
+
+namespace mltk {
+
+// Patched by MLTK: Invoke the operators [first_op, last_op] of the
+// interpreter's main subgraph, the remaining operators are not executed
+TfLiteStatus invoke_subgraph_range(tflite::MicroInterpreter& interpreter,
+                                   int first_op, int last_op) {
+  const int operators_size =
+      tflite::NumSubgraphOperators(interpreter.model_, 0);
+  if (first_op < 0 || last_op < first_op || last_op >= operators_size) {
+    MicroPrintf("Invalid operator range [%d, %d], the subgraph has %d operators",
+                first_op, last_op, operators_size);
+    return kTfLiteError;
+  }
+
+  INVOKE_PROCESSING_CALLBACK();
+  START_INFERENCE_PROFILER(0)
+  TfLiteStatus invoke_status = tflite::InvokeOperators(
+      &interpreter.context_, &interpreter.allocator_,
+      interpreter.graph_.GetAllocations(), 0, first_op, last_op + 1);
+  if (invoke_status != kTfLiteOk) {
+    return invoke_status;
+  }
+  STOP_INFERENCE_PROFILER(0)
+
+  return kTfLiteOk;
+}
+
+}  // namespace mltk
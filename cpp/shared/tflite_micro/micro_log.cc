@@ -12,19 +12,13 @@
 
 #include "logging/logging.hpp"
 #include "mltk_tflite_micro_helper.hpp"
-
-
-namespace mltk 
-{
-    bool model_error_reporter_enabled = true;
-}
-
+#include "mltk_tflite_micro_context.hpp"
 
 
 
 void Log(const char* format, va_list args) {
 #if !defined(TF_LITE_STRIP_ERROR_STRINGS)
-  if(mltk::model_error_reporter_enabled)
+  if(mltk::get_runtime_context().error_reporter_enabled)
   {
     auto& logger = mltk::get_logger();
     const auto orig_flags = logger.flags();
@@ -0,0 +1,325 @@
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+
+#include "mltk_tflite_micro_activation_stats.hpp"
+#include "mltk_tflite_micro_context.hpp"
+
+
+namespace mltk
+{
+
+// Bound on the number of times the histogram range may be doubled for a single tensor update.
+// A float's exponent range is smaller than this, so this only guards against the range overflowing
+#define MAX_HISTOGRAM_EXPANSIONS 300
+
+
+// Convert a tensor's value to its real value
+template<typename T>
+struct Dequantizer
+{
+  float scale;
+  int32_t zero_point;
+
+  inline float operator()(T value) const
+  {
+    return scale * (float)((int32_t)value - zero_point);
+  }
+};
+
+template<>
+struct Dequantizer<float>
+{
+  inline float operator()(float value) const
+  {
+    return value;
+  }
+};
+
+
+static void update_stats(TfliteMicroActivationStats& stats, uint32_t n_bins, const TfLiteTensor& tensor);
+template<typename T>
+static void update_stats(TfliteMicroActivationStats& stats, uint32_t n_bins, const T* data, int count, const Dequantizer<T>& dequantize);
+static void expand_histogram(TfliteMicroActivationStats& stats, uint32_t n_bins, float min_value, float max_value);
+
+
+/*************************************************************************************************/
+bool init_activation_stats(TfliteMicroRuntimeContext& context, int32_t tensor_count, uint32_t n_bins)
+{
+  deinit_activation_stats(context);
+
+  // The histogram range is doubled by merging pairs of bins,
+  // so the bin count must be even
+  n_bins = (n_bins < 2) ? 2 : (n_bins + 1) & ~1U;
+
+  auto collector = static_cast<TfliteMicroActivationStatsCollector*>(malloc(sizeof(TfliteMicroActivationStatsCollector)));
+  if(collector == nullptr)
+  {
+    return false;
+  }
+
+  collector->n_bins = n_bins;
+  collector->tensor_count = tensor_count;
+  collector->stats = static_cast<TfliteMicroActivationStats*>(malloc(sizeof(TfliteMicroActivationStats) * tensor_count));
+  if(collector->stats == nullptr)
+  {
+    free(collector);
+    return false;
+  }
+  for(int i = 0; i < tensor_count; ++i)
+  {
+    collector->stats[i].histogram = nullptr;
+  }
+
+  context.activation_stats = collector;
+  reset_activation_stats(context);
+
+  return true;
+}
+
+/*************************************************************************************************/
+void deinit_activation_stats(TfliteMicroRuntimeContext& context)
+{
+  auto collector = context.activation_stats;
+  if(collector == nullptr)
+  {
+    return;
+  }
+
+  for(int i = 0; i < collector->tensor_count; ++i)
+  {
+    free(collector->stats[i].histogram);
+  }
+  free(collector->stats);
+  free(collector);
+  context.activation_stats = nullptr;
+}
+
+/*************************************************************************************************/
+void reset_activation_stats(TfliteMicroRuntimeContext& context)
+{
+  auto collector = context.activation_stats;
+  if(collector == nullptr)
+  {
+    return;
+  }
+
+  // The histograms are kept allocated so that
+  // collecting the statistics again does not allocate
+  for(int i = 0; i < collector->tensor_count; ++i)
+  {
+    auto& stats = collector->stats[i];
+    stats.op_index = -1;
+    stats.count = 0;
+    stats.min = 0;
+    stats.max = 0;
+    stats.mean = 0;
+    stats.m2 = 0;
+    stats.histogram_min = 0;
+    stats.histogram_bin_width = 0;
+    if(stats.histogram != nullptr)
+    {
+      memset(stats.histogram, 0, sizeof(uint32_t) * collector->n_bins);
+    }
+  }
+}
+
+/*************************************************************************************************/
+void record_activation_stats(int op_idx, const TfLiteContext& context, const TfLiteNode &node)
+{
+  auto collector = get_runtime_context().activation_stats;
+  if(collector == nullptr)
+  {
+    return;
+  }
+
+  for(int i = 0; i < node.outputs->size; ++i)
+  {
+    const int tensor_idx = node.outputs->data[i];
+    if(tensor_idx < 0 || tensor_idx >= collector->tensor_count)
+    {
+      continue;
+    }
+
+    auto& stats = collector->stats[tensor_idx];
+    if(stats.histogram == nullptr)
+    {
+      stats.histogram = static_cast<uint32_t*>(calloc(collector->n_bins, sizeof(uint32_t)));
+      if(stats.histogram == nullptr)
+      {
+        continue;
+      }
+    }
+
+    stats.op_index = op_idx;
+    update_stats(stats, collector->n_bins, *context.GetTensor(&context, tensor_idx));
+  }
+}
+
+/*************************************************************************************************/
+static void update_stats(TfliteMicroActivationStats& stats, uint32_t n_bins, const TfLiteTensor& tensor)
+{
+  const float scale = (tensor.quantization.type == kTfLiteAffineQuantization) ? tensor.params.scale : 1.0f;
+  const int32_t zero_point = (tensor.quantization.type == kTfLiteAffineQuantization) ? tensor.params.zero_point : 0;
+
+  switch(tensor.type)
+  {
+  case kTfLiteFloat32:
+    update_stats(stats, n_bins, tensor.data.f, tensor.bytes / sizeof(float), Dequantizer<float>());
+    break;
+  case kTfLiteInt8:
+    update_stats(stats, n_bins, tensor.data.int8, tensor.bytes, Dequantizer<int8_t>{scale, zero_point});
+    break;
+  case kTfLiteUInt8:
+    update_stats(stats, n_bins, tensor.data.uint8, tensor.bytes, Dequantizer<uint8_t>{scale, zero_point});
+    break;
+  case kTfLiteInt16:
+    update_stats(stats, n_bins, tensor.data.i16, tensor.bytes / sizeof(int16_t), Dequantizer<int16_t>{scale, zero_point});
+    break;
+  case kTfLiteInt32:
+    update_stats(stats, n_bins, tensor.data.i32, tensor.bytes / sizeof(int32_t), Dequantizer<int32_t>{scale, zero_point});
+    break;
+  default:
+    // Other tensor types (e.g. bool, string) do not have meaningful statistics
+    break;
+  }
+}
+
+/*************************************************************************************************/
+template<typename T>
+static void update_stats(TfliteMicroActivationStats& stats, uint32_t n_bins, const T* data, int count, const Dequantizer<T>& dequantize)
+{
+  if(count <= 0)
+  {
+    return;
+  }
+
+  // Non-finite values (inf/nan) are excluded from all of the statistics,
+  // they do not have a meaningful range and would corrupt the histogram
+  int first_finite = 0;
+  while(first_finite < count && !std::isfinite(dequantize(data[first_finite])))
+  {
+    ++first_finite;
+  }
+  if(first_finite == count)
+  {
+    return;
+  }
+
+  // First pass: min/max and the sums used to merge this tensor's mean and variance.
+  // The values are shifted by the first value to reduce the cancellation error of the variance
+  const float shift = dequantize(data[first_finite]);
+  float min_value = shift;
+  float max_value = shift;
+  double sum = 0;
+  double sum_squares = 0;
+  int finite_count = 0;
+  for(int i = first_finite; i < count; ++i)
+  {
+    const float value = dequantize(data[i]);
+    if(!std::isfinite(value))
+    {
+      continue;
+    }
+    min_value = (value < min_value) ? value : min_value;
+    max_value = (value > max_value) ? value : max_value;
+    const double diff = (double)value - shift;
+    sum += diff;
+    sum_squares += diff * diff;
+    ++finite_count;
+  }
+
+  // Merge this tensor's mean and variance into the running values (Chan et al.)
+  const double batch_mean = shift + sum / finite_count;
+  const double batch_m2 = sum_squares - (sum * sum) / finite_count;
+  const double total_count = (double)stats.count + finite_count;
+  const double delta = batch_mean - stats.mean;
+  stats.mean += delta * finite_count / total_count;
+  stats.m2 += batch_m2 + delta * delta * (double)stats.count * finite_count / total_count;
+  if(stats.count == 0)
+  {
+    stats.min = min_value;
+    stats.max = max_value;
+  }
+  else
+  {
+    stats.min = (min_value < stats.min) ? min_value : stats.min;
+    stats.max = (max_value > stats.max) ? max_value : stats.max;
+  }
+  stats.count += finite_count;
+
+  // Second pass: ensure the histogram covers the values then bin them
+  expand_histogram(stats, n_bins, min_value, max_value);
+  const float inv_bin_width = 1.0f / stats.histogram_bin_width;
+  const float histogram_min = stats.histogram_min;
+  const int32_t last_bin = n_bins - 1;
+  for(int i = first_finite; i < count; ++i)
+  {
+    const float value = dequantize(data[i]);
+    if(!std::isfinite(value))
+    {
+      continue;
+    }
+    // Clamp before converting to an integer,
+    // the position may be out of the int32 range (or nan) if the range overflowed
+    const float position = (value - histogram_min) * inv_bin_width;
+    const int32_t bin = (position > 0) ? ((position < (float)last_bin) ? (int32_t)position : last_bin) : 0;
+    stats.histogram[bin] += 1;
+  }
+}
+
+/*************************************************************************************************/
+static void expand_histogram(TfliteMicroActivationStats& stats, uint32_t n_bins, float min_value, float max_value)
+{
+  const uint32_t half_n_bins = n_bins / 2;
+
+  // The first update sets the histogram range to the tensor's range
+  if(stats.histogram_bin_width == 0)
+  {
+    stats.histogram_min = min_value;
+    stats.histogram_bin_width = (max_value - min_value) / n_bins;
+    if(!(stats.histogram_bin_width > 0))
+    {
+      // All of the values are the same, use a narrow range around the value
+      stats.histogram_bin_width = fmaxf(fabsf(min_value), 1.0f) * 1e-6f;
+    }
+    // Ensure the rounded range covers the max value,
+    // otherwise the loop below would needlessly double the range
+    while(stats.histogram_min + stats.histogram_bin_width * n_bins < max_value)
+    {
+      stats.histogram_bin_width = nextafterf(stats.histogram_bin_width, INFINITY);
+    }
+  }
+
+  for(int i = 0; i < MAX_HISTOGRAM_EXPANSIONS; ++i)
+  {
+    const float histogram_max = stats.histogram_min + stats.histogram_bin_width * n_bins;
+    if(min_value < stats.histogram_min)
+    {
+      // Extend the range downwards, the current bins are merged into the upper half
+      for(uint32_t b = 0; b < half_n_bins; ++b)
+      {
+        stats.histogram[n_bins - 1 - b] = stats.histogram[n_bins - 2 - 2*b] + stats.histogram[n_bins - 1 - 2*b];
+      }
+      memset(stats.histogram, 0, sizeof(uint32_t) * half_n_bins);
+      stats.histogram_min -= stats.histogram_bin_width * n_bins;
+    }
+    else if(max_value > histogram_max)
+    {
+      // Extend the range upwards, the current bins are merged into the lower half
+      for(uint32_t b = 0; b < half_n_bins; ++b)
+      {
+        stats.histogram[b] = stats.histogram[2*b] + stats.histogram[2*b + 1];
+      }
+      memset(&stats.histogram[half_n_bins], 0, sizeof(uint32_t) * half_n_bins);
+    }
+    else
+    {
+      break;
+    }
+    stats.histogram_bin_width *= 2;
+  }
+}
+
+
+} // namespace mltk
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+
+#include "tensorflow/lite/c/common.h"
+
+
+namespace mltk
+{
+
+struct TfliteMicroRuntimeContext;
+
+
+/**
+ * @brief Running statistics of a layer's output tensor
+ *
+ * The statistics are accumulated over every invocation of the model
+ * since the collector was enabled or reset.
+ * Quantized tensors are dequantized with the tensor's scale and zero point,
+ * so all values are real (i.e. float) values.
+ * Non-finite values (i.e. inf and nan) are excluded from all of the statistics.
+ *
+ * The histogram has a fixed number of bins with a uniform width.
+ * When a value falls outside the histogram's range, the bin width is doubled
+ * (i.e. adjacent bins are merged) until the range covers the value.
+ */
+struct TfliteMicroActivationStats
+{
+  /** Index of the layer that outputs the tensor, -1 if the tensor has no statistics */
+  int32_t op_index;
+  /** Number of values accumulated */
+  uint64_t count;
+  /** Minimum value */
+  float min;
+  /** Maximum value */
+  float max;
+  /** Mean of the values */
+  double mean;
+  /** Sum of the squared differences from the mean, variance = m2 / count */
+  double m2;
+  /** Lower edge of the first histogram bin */
+  float histogram_min;
+  /** Width of each histogram bin */
+  float histogram_bin_width;
+  /** Histogram bin counts, see @ref TfliteMicroActivationStatsCollector::n_bins */
+  uint32_t* histogram;
+};
+
+
+/**
+ * @brief Per-layer activation statistics collector
+ *
+ * This is used to calculate the activation ranges for quantization calibration
+ * without recording the tensors.
+ */
+struct TfliteMicroActivationStatsCollector
+{
+  /** Number of histogram bins for each tensor */
+  uint32_t n_bins;
+  /** Number of tensors in the model */
+  int32_t tensor_count;
+  /** Statistics of each tensor, indexed by the model tensor index */
+  TfliteMicroActivationStats* stats;
+};
+
+
+bool init_activation_stats(TfliteMicroRuntimeContext& context, int32_t tensor_count, uint32_t n_bins);
+void deinit_activation_stats(TfliteMicroRuntimeContext& context);
+void reset_activation_stats(TfliteMicroRuntimeContext& context);
+void record_activation_stats(int op_idx, const TfLiteContext& context, const TfLiteNode &node);
+
+
+} // namespace mltk
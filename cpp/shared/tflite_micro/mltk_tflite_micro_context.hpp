@@ -0,0 +1,114 @@
+#pragma once
+
+#include "profiling/profiler.hpp"
+#include "msgpack.hpp"
+#include "mltk_tflite_micro_helper.hpp"
+#include "mltk_tflite_micro_recorder.hpp"
+#include "mltk_tflite_micro_activation_stats.hpp"
+#include "mltk_tflite_micro_differential.hpp"
+
+
+// Thread-local storage is only used on hosted builds.
+// Embedded builds only ever run a single thread of inference.
+#ifdef __arm__
+#define MLTK_THREAD_LOCAL
+#else
+#define MLTK_THREAD_LOCAL thread_local
+#endif
+
+
+namespace mltk
+{
+
+/**
+ * @brief Kernel scratch buffer request
+ *
+ * The TFLM allocator discards its scratch buffer requests once the arena is planned,
+ * so they are saved while the model is prepared, see @ref TfliteMicroModel::get_memory_plan()
+ */
+struct TfliteMicroScratchBufferRequest
+{
+    uint32_t bytes;
+    int32_t op_index;
+};
+
+
+/**
+ * @brief Per-model runtime state
+ *
+ * This holds all of the state used by the MLTK hooks in the TFLM interpreter
+ * (profiling, recording, current kernel, processing callback, etc.).
+ * Each @ref TfliteMicroModel owns one of these and activates it on the
+ * calling thread while the model is loaded, invoked or unloaded.
+ * This way, multiple models may be loaded and invoked concurrently on different threads.
+ */
+struct TfliteMicroRuntimeContext
+{
+    bool profiler_enabled = false;
+    bool tensor_recorder_enabled = false;
+    bool error_reporter_enabled = true;
+
+    const TfliteMicroAccelerator* accelerator = nullptr;
+
+    profiling::Profiler *inference_profiler = nullptr;
+    profiling::Profiler **kernel_profilers = nullptr;
+
+    int current_kernel_index = -1;
+    int current_kernel_op_code = -1;
+    bool issued_unsupported_msg = false;
+
+    void (*processing_callback)(void*) = nullptr;
+    void* processing_callback_arg = nullptr;
+
+    TfliteMicroRecorderConfig recorder_config;
+    msgpack_context_t* recorder_msgpack = nullptr;
+    msgpack_context_t* recorder_layer_msgpack = nullptr;
+    bool recorder_root_array_finalized = false;
+    bool recorder_layer_started = false;
+
+    TfliteMicroScratchBufferRequest* scratch_buffer_requests = nullptr;
+    int scratch_buffer_request_count = 0;
+
+    TfliteMicroActivationStatsCollector* activation_stats = nullptr;
+
+    TfliteMicroDifferentialExecutor* differential = nullptr;
+
+    // Run the TFLM reference kernels instead of the host-optimized kernels,
+    // see mltk_tflite_micro_host_kernels.hpp
+    bool reference_kernels_only = false;
+};
+
+
+/**
+ * @brief Activate a runtime context on the calling thread
+ *
+ * The given context is active until this object goes out of scope,
+ * at which point the previously active context (if any) is restored.
+ */
+class ScopedRuntimeContext
+{
+public:
+    ScopedRuntimeContext(TfliteMicroRuntimeContext* context);
+    ~ScopedRuntimeContext();
+
+    MAKE_CLASS_NON_ASSIGNABLE(ScopedRuntimeContext);
+
+private:
+    TfliteMicroRuntimeContext* _previous;
+};
+
+
+/**
+ * Return the runtime context active on the calling thread.
+ * If no model context is active then a process-wide default context is returned.
+ */
+TfliteMicroRuntimeContext& get_runtime_context();
+
+/**
+ * Return the runtime context active on the calling thread,
+ * or null if no model context is active.
+ */
+TfliteMicroRuntimeContext* get_active_runtime_context();
+
+
+} // namespace mltk
@@ -0,0 +1,422 @@
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#ifndef __arm__
+#include <mutex>
+#endif
+
+#include "tensorflow/lite/micro/kernels/kernel_runner.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+#include "mltk_tflite_micro_differential.hpp"
+#include "mltk_tflite_micro_context.hpp"
+
+
+namespace mltk
+{
+
+#ifndef __arm__
+// The KernelRunner allocates from a static buffer,
+// so only one reference kernel may execute at a time
+static std::mutex _kernel_runner_lock;
+#endif
+
+
+static bool reserve_shadow_buffer(TfliteMicroDifferentialExecutor& diff, uint32_t size);
+static bool reserve_tensors(TfliteMicroDifferentialExecutor& diff, int32_t count);
+static const TfLiteRegistration* find_reference_kernel(const tflite::MicroOpResolver& resolver, const TfLiteRegistration& registration);
+static bool is_saved_input(const TfLiteTensor* tensor);
+static void compare_outputs(const TfLiteTensor& actual, const void* expected, float tolerance, TfliteMicroDifferentialLayerResult& result);
+
+static inline uint32_t align4(uint32_t size)
+{
+  return (size + 3) & ~3U;
+}
+
+
+/*************************************************************************************************/
+bool init_differential_execution(
+  TfliteMicroRuntimeContext& context,
+  const tflite::MicroOpResolver& reference_op_resolver,
+  int32_t op_count,
+  float tolerance
+)
+{
+  deinit_differential_execution(context);
+
+  auto diff = static_cast<TfliteMicroDifferentialExecutor*>(calloc(1, sizeof(TfliteMicroDifferentialExecutor)));
+  if(diff == nullptr)
+  {
+    return false;
+  }
+
+  diff->layers = static_cast<TfliteMicroDifferentialLayerResult*>(malloc(sizeof(TfliteMicroDifferentialLayerResult) * op_count));
+  if(diff->layers == nullptr)
+  {
+    free(diff);
+    return false;
+  }
+  diff->reference_op_resolver = &reference_op_resolver;
+  diff->tolerance = tolerance;
+  diff->op_count = op_count;
+
+  context.differential = diff;
+  reset_differential_execution(context);
+
+  return true;
+}
+
+/*************************************************************************************************/
+void deinit_differential_execution(TfliteMicroRuntimeContext& context)
+{
+  auto diff = context.differential;
+  if(diff == nullptr)
+  {
+    return;
+  }
+
+  free(diff->layers);
+  free(diff->shadow_buffer);
+  free(diff->tensors);
+  free(diff->tensor_indices);
+  free(diff);
+  context.differential = nullptr;
+}
+
+/*************************************************************************************************/
+void reset_differential_execution(TfliteMicroRuntimeContext& context)
+{
+  auto diff = context.differential;
+  if(diff == nullptr)
+  {
+    return;
+  }
+
+  memset(diff->layers, 0, sizeof(TfliteMicroDifferentialLayerResult) * diff->op_count);
+  diff->first_mismatch_op_index = -1;
+  diff->current_op_index = -1;
+}
+
+/*************************************************************************************************/
+void differential_begin_layer(int op_idx, const TfLiteContext& context, const TfLiteNode& node)
+{
+  auto diff = get_runtime_context().differential;
+  if(diff == nullptr || op_idx >= diff->op_count)
+  {
+    return;
+  }
+
+  diff->current_op_index = -1;
+
+  // The layer's kernel may overwrite its inputs (e.g. if the arena buffers are forced to overlap)
+  // so the inputs are saved before the kernel executes
+  uint32_t inputs_size = 0;
+  for(int i = 0; i < node.inputs->size; ++i)
+  {
+    const int tensor_idx = node.inputs->data[i];
+    if(tensor_idx < 0)
+    {
+      continue;
+    }
+    const auto tensor = context.GetTensor(&context, tensor_idx);
+    if(is_saved_input(tensor))
+    {
+      inputs_size += align4(tensor->bytes);
+    }
+  }
+  if(!reserve_shadow_buffer(*diff, inputs_size))
+  {
+    diff->layers[op_idx].reference_failed = true;
+    return;
+  }
+
+  uint8_t* dst = diff->shadow_buffer;
+  for(int i = 0; i < node.inputs->size; ++i)
+  {
+    const int tensor_idx = node.inputs->data[i];
+    if(tensor_idx < 0)
+    {
+      continue;
+    }
+    const auto tensor = context.GetTensor(&context, tensor_idx);
+    if(is_saved_input(tensor))
+    {
+      memcpy(dst, tensor->data.raw, tensor->bytes);
+      dst += align4(tensor->bytes);
+    }
+  }
+
+  diff->current_op_index = op_idx;
+}
+
+/*************************************************************************************************/
+void differential_end_layer(int op_idx, TfLiteContext& context, const TfLiteNode& node, const TfLiteRegistration& registration)
+{
+  auto diff = get_runtime_context().differential;
+  if(diff == nullptr || diff->current_op_index != op_idx)
+  {
+    return;
+  }
+  diff->current_op_index = -1;
+
+  auto& result = diff->layers[op_idx];
+  const auto reference = find_reference_kernel(*diff->reference_op_resolver, registration);
+  if(reference == nullptr || reference->invoke == nullptr)
+  {
+    result.reference_failed = true;
+    return;
+  }
+
+  const int input_count = node.inputs->size;
+  const int output_count = node.outputs->size;
+  if(!reserve_tensors(*diff, input_count + output_count))
+  {
+    result.reference_failed = true;
+    return;
+  }
+
+  // Populate the reference kernel's tensors
+  auto tensors = diff->tensors;
+  auto inputs_array = reinterpret_cast<TfLiteIntArray*>(&diff->tensor_indices[0]);
+  auto outputs_array = reinterpret_cast<TfLiteIntArray*>(&diff->tensor_indices[input_count + 1]);
+  uint32_t inputs_size = 0;
+  uint32_t outputs_size = 0;
+  int n_tensors = 0;
+
+  inputs_array->size = input_count;
+  for(int i = 0; i < input_count; ++i)
+  {
+    const int tensor_idx = node.inputs->data[i];
+    if(tensor_idx < 0)
+    {
+      inputs_array->data[i] = -1;
+      continue;
+    }
+    tensors[n_tensors] = *context.GetTensor(&context, tensor_idx);
+    if(is_saved_input(&tensors[n_tensors]))
+    {
+      inputs_size += align4(tensors[n_tensors].bytes);
+    }
+    inputs_array->data[i] = n_tensors++;
+  }
+
+  outputs_array->size = output_count;
+  for(int i = 0; i < output_count; ++i)
+  {
+    tensors[n_tensors] = *context.GetTensor(&context, node.outputs->data[i]);
+    outputs_size += align4(tensors[n_tensors].bytes);
+    outputs_array->data[i] = n_tensors++;
+  }
+
+  // The saved inputs are at the start of the shadow buffer, followed by the shadow outputs.
+  // The inputs point to the saved inputs (constant tensors point to the flatbuffer)
+  // and the outputs point to the shadow outputs
+  if(!reserve_shadow_buffer(*diff, inputs_size + outputs_size))
+  {
+    result.reference_failed = true;
+    return;
+  }
+  uint8_t* shadow = diff->shadow_buffer;
+  for(int i = 0; i < n_tensors; ++i)
+  {
+    auto& tensor = tensors[i];
+    if(i >= n_tensors - output_count || is_saved_input(&tensor))
+    {
+      tensor.data.raw = reinterpret_cast<char*>(shadow);
+      shadow += align4(tensor.bytes);
+    }
+  }
+
+  const char* init_data;
+  size_t init_data_size;
+  if(registration.builtin_code == tflite::BuiltinOperator_CUSTOM)
+  {
+    init_data = reinterpret_cast<const char*>(node.custom_initial_data);
+    init_data_size = node.custom_initial_data_size;
+  }
+  else
+  {
+    init_data = reinterpret_cast<const char*>(node.builtin_data);
+    init_data_size = 0;
+  }
+
+  TfLiteStatus status;
+  {
+    // Execute the reference kernel with an empty runtime context
+    // so that it is not recorded, profiled or accelerated.
+    // The resolver's kernels use the host-optimized kernels when they are enabled,
+    // so force them to execute the TFLM reference kernels
+    TfliteMicroRuntimeContext reference_context;
+    reference_context.reference_kernels_only = true;
+    ScopedRuntimeContext runtime_context_scope(&reference_context);
+#ifndef __arm__
+    std::lock_guard<std::mutex> lock(_kernel_runner_lock);
+#endif
+
+    tflite::micro::KernelRunner runner(
+      *reference,
+      tensors,
+      n_tensors,
+      inputs_array,
+      outputs_array,
+      node.builtin_data
+    );
+    status = runner.InitAndPrepare(init_data, init_data_size);
+    if(status == kTfLiteOk)
+    {
+      status = runner.Invoke();
+    }
+    if(reference->free != nullptr)
+    {
+      reference->free(&runner.context_, runner.node_.user_data);
+    }
+  }
+
+  if(status != kTfLiteOk)
+  {
+    result.reference_failed = true;
+    return;
+  }
+
+  const uint64_t prev_mismatch_count = result.mismatch_count;
+  shadow = diff->shadow_buffer + inputs_size;
+  for(int i = 0; i < output_count; ++i)
+  {
+    const auto& actual = *context.GetTensor(&context, node.outputs->data[i]);
+    compare_outputs(actual, shadow, diff->tolerance, result);
+    shadow += align4(actual.bytes);
+  }
+  result.invoke_count += 1;
+
+  if(result.mismatch_count > prev_mismatch_count &&
+    (diff->first_mismatch_op_index == -1 || op_idx < diff->first_mismatch_op_index))
+  {
+    diff->first_mismatch_op_index = op_idx;
+  }
+}
+
+/*************************************************************************************************/
+static bool reserve_shadow_buffer(TfliteMicroDifferentialExecutor& diff, uint32_t size)
+{
+  if(size <= diff.shadow_buffer_size)
+  {
+    return true;
+  }
+
+  // The saved inputs at the start of the buffer are preserved.
+  // NOTE: realloc() is not used so this does not depend on the embedded heap wrapping it
+  auto buffer = static_cast<uint8_t*>(malloc(size));
+  if(buffer == nullptr)
+  {
+    return false;
+  }
+  if(diff.shadow_buffer != nullptr)
+  {
+    memcpy(buffer, diff.shadow_buffer, diff.shadow_buffer_size);
+    free(diff.shadow_buffer);
+  }
+  diff.shadow_buffer = buffer;
+  diff.shadow_buffer_size = size;
+
+  return true;
+}
+
+/*************************************************************************************************/
+static bool reserve_tensors(TfliteMicroDifferentialExecutor& diff, int32_t count)
+{
+  if(count <= diff.tensors_capacity)
+  {
+    return true;
+  }
+
+  auto tensors = static_cast<TfLiteTensor*>(malloc(sizeof(TfLiteTensor) * count));
+  // The input and output index arrays each have a leading size element
+  auto tensor_indices = static_cast<int*>(malloc(sizeof(int) * (count + 2)));
+  if(tensors == nullptr || tensor_indices == nullptr)
+  {
+    free(tensors);
+    free(tensor_indices);
+    return false;
+  }
+
+  free(diff.tensors);
+  free(diff.tensor_indices);
+  diff.tensors = tensors;
+  diff.tensor_indices = tensor_indices;
+  diff.tensors_capacity = count;
+
+  return true;
+}
+
+/*************************************************************************************************/
+static const TfLiteRegistration* find_reference_kernel(const tflite::MicroOpResolver& resolver, const TfLiteRegistration& registration)
+{
+  const TfLiteRegistration* reference;
+
+  if(registration.builtin_code == tflite::BuiltinOperator_CUSTOM)
+  {
+    reference = (registration.custom_name != nullptr) ? resolver.FindOp(registration.custom_name) : nullptr;
+  }
+  else
+  {
+    reference = resolver.FindOp(static_cast<tflite::BuiltinOperator>(registration.builtin_code));
+  }
+
+  return reference;
+}
+
+/*************************************************************************************************/
+static bool is_saved_input(const TfLiteTensor* tensor)
+{
+  // Constant tensors are stored in the flatbuffer and cannot be modified
+  return tensor != nullptr && tensor->data.raw != nullptr && tensor->allocation_type != kTfLiteMmapRo;
+}
+
+/*************************************************************************************************/
+template<typename T>
+static void compare_values(const T* actual, const T* expected, uint32_t count, float tolerance, TfliteMicroDifferentialLayerResult& result)
+{
+  uint64_t mismatch_count = 0;
+  double max_abs_error = result.max_abs_error;
+
+  for(uint32_t i = 0; i < count; ++i)
+  {
+    const double error = fabs((double)actual[i] - (double)expected[i]);
+    if(error > tolerance || std::isnan(error))
+    {
+      ++mismatch_count;
+    }
+    max_abs_error = (error > max_abs_error) ? error : max_abs_error;
+  }
+
+  result.element_count += count;
+  result.mismatch_count += mismatch_count;
+  result.max_abs_error = (float)max_abs_error;
+}
+
+/*************************************************************************************************/
+static void compare_outputs(const TfLiteTensor& actual, const void* expected, float tolerance, TfliteMicroDifferentialLayerResult& result)
+{
+  switch(actual.type)
+  {
+  case kTfLiteFloat32:
+    compare_values(actual.data.f, static_cast<const float*>(expected), actual.bytes / sizeof(float), tolerance, result);
+    break;
+  case kTfLiteInt8:
+    compare_values(actual.data.int8, static_cast<const int8_t*>(expected), actual.bytes, tolerance, result);
+    break;
+  case kTfLiteInt16:
+    compare_values(actual.data.i16, static_cast<const int16_t*>(expected), actual.bytes / sizeof(int16_t), tolerance, result);
+    break;
+  case kTfLiteInt32:
+    compare_values(actual.data.i32, static_cast<const int32_t*>(expected), actual.bytes / sizeof(int32_t), tolerance, result);
+    break;
+  default:
+    // Compare the other types byte-wise
+    compare_values(actual.data.uint8, static_cast<const uint8_t*>(expected), actual.bytes, tolerance, result);
+    break;
+  }
+}
+
+
+} // namespace mltk
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstdint>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/micro_op_resolver.h"
+
+
+namespace mltk
+{
+
+struct TfliteMicroRuntimeContext;
+
+
+/**
+ * @brief Differential execution result of a layer
+ *
+ * The results are accumulated over every invocation of the model
+ * since differential execution was enabled or reset.
+ * The errors are in the units of the output tensor's data type
+ * (i.e. quantized tensors are NOT dequantized).
+ */
+struct TfliteMicroDifferentialLayerResult
+{
+  /** Number of times the layer was compared against the reference kernel */
+  uint32_t invoke_count;
+  /** Number of output elements that were compared */
+  uint64_t element_count;
+  /** Number of output elements whose absolute error exceeds the tolerance */
+  uint64_t mismatch_count;
+  /** Maximum absolute error between the kernel and reference kernel outputs */
+  float max_abs_error;
+  /** Set if the reference kernel could not be executed for this layer, e.g. the op is not in the reference resolver */
+  bool reference_failed;
+};
+
+
+/**
+ * @brief Differential execution of the model's kernels against reference kernels
+ *
+ * When enabled, each layer's input tensors are saved before the layer executes.
+ * After the layer's kernel (e.g. an accelerated kernel) executes, the reference kernel
+ * is executed on the saved inputs into shadow output buffers and the outputs are compared.
+ *
+ * The model continues with the kernel's outputs, so the error of each layer is
+ * measured independently of the error of the previous layers.
+ */
+struct TfliteMicroDifferentialExecutor
+{
+  /** Resolver of the reference kernels */
+  const tflite::MicroOpResolver* reference_op_resolver;
+  /** Output elements whose absolute error is greater than this are counted as mismatches */
+  float tolerance;
+  /** Number of layers in the model */
+  int32_t op_count;
+  /** Result of each layer, indexed by the layer index */
+  TfliteMicroDifferentialLayerResult* layers;
+  /** Index of the first layer that had a mismatch, -1 if all layers matched */
+  int32_t first_mismatch_op_index;
+
+  /** Index of the layer whose inputs are saved in the shadow buffer, -1 if none */
+  int32_t current_op_index;
+  /** Buffer holding the saved inputs followed by the shadow outputs of the current layer */
+  uint8_t* shadow_buffer;
+  uint32_t shadow_buffer_size;
+  /** Tensors given to the reference kernel, followed by their index arrays */
+  TfLiteTensor* tensors;
+  int* tensor_indices;
+  int32_t tensors_capacity;
+};
+
+
+bool init_differential_execution(
+  TfliteMicroRuntimeContext& context,
+  const tflite::MicroOpResolver& reference_op_resolver,
+  int32_t op_count,
+  float tolerance
+);
+void deinit_differential_execution(TfliteMicroRuntimeContext& context);
+void reset_differential_execution(TfliteMicroRuntimeContext& context);
+void differential_begin_layer(int op_idx, const TfLiteContext& context, const TfLiteNode& node);
+void differential_end_layer(int op_idx, TfLiteContext& context, const TfLiteNode& node, const TfLiteRegistration& registration);
+
+
+} // namespace mltk
+
+
+
+#ifdef TFLITE_MICRO_RECORDER_ENABLED
+
+#define TFLITE_MICRO_DIFFERENTIAL_BEGIN_LAYER(op_idx, context, node) \
+  mltk::differential_begin_layer(op_idx, *context, *node);
+#define TFLITE_MICRO_DIFFERENTIAL_END_LAYER(op_idx, context, node, registration) \
+  mltk::differential_end_layer(op_idx, *context, *node, *registration);
+
+#else
+
+#define TFLITE_MICRO_DIFFERENTIAL_BEGIN_LAYER(...)
+#define TFLITE_MICRO_DIFFERENTIAL_END_LAYER(...)
+
+#endif // TFLITE_MICRO_RECORDER_ENABLED
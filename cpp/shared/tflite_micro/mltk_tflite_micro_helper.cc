@@ -4,12 +4,24 @@
 #include "tensorflow/lite/schema/schema_generated.h"
 #include "mltk_tflite_micro_internal.hpp"
 
+#ifndef __arm__
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+#endif
+
 
 namespace mltk
 {
 
 static Logger *mltk_logger =  nullptr;
-bool model_profiler_enabled = false;
 
 #ifdef TFLITE_MICRO_VERSION_STR
 const char* TFLITE_MICRO_VERSION = TFLITE_MICRO_VERSION_STR;
@@ -33,16 +45,18 @@ TfLiteStatus allocate_scratch_buffer(TfLiteContext *ctx, unsigned size_bytes, in
 #ifndef MLTK_DLL_IMPORT 
 extern "C" void issue_unsupported_kernel_message(const char* fmt, ...)
 {
-  if(_current_kernel_index == -1 || _issued_unsupported_msg || !model_error_reporter_enabled)
+  auto& context = get_runtime_context();
+
+  if(context.current_kernel_index == -1 || context.issued_unsupported_msg || !context.error_reporter_enabled)
   {
     return;
   }
 
-  _issued_unsupported_msg = true;
+  context.issued_unsupported_msg = true;
 
   char buffer[256];
   char op_name[92];
-  const int l = snprintf(buffer, sizeof(buffer), "%s not supported: ", op_to_str(_current_kernel_index, (tflite::BuiltinOperator)_current_kernel_op_code));
+  const int l = snprintf(buffer, sizeof(buffer), "%s not supported: ", op_to_str(context.current_kernel_index, (tflite::BuiltinOperator)context.current_kernel_op_code));
 
   va_list args;
   va_start(args, fmt);
@@ -55,8 +69,9 @@ extern "C" void issue_unsupported_kernel_message(const char* fmt, ...)
 /*************************************************************************************************/
 extern "C" void mltk_tflite_micro_get_current_layer_opcode_and_index(int* opcode, int* index)
 {
-    *opcode = mltk::_current_kernel_op_code;
-    *index = mltk::_current_kernel_index;
+    const auto& context = get_runtime_context();
+    *opcode = context.current_kernel_op_code;
+    *index = context.current_kernel_index;
 }
 
 #endif // MLTK_DLL_IMPORT
@@ -96,6 +111,13 @@ extern "C" void mltk_tflite_micro_set_accelerator(const TfliteMicroAccelerator*
 #ifndef MLTK_DLL_IMPORT 
 extern "C" const TfliteMicroAccelerator* mltk_tflite_micro_get_registered_accelerator()
 {
+    // If a model is active on this thread, 
+    // then return the accelerator the model was loaded with
+    auto context = get_active_runtime_context();
+    if(context != nullptr)
+    {
+        return context->accelerator;
+    }
     return _registered_accelerator;
 }
 #endif
@@ -217,6 +239,105 @@ bool verify_model_flatbuffer(const void* flatbuffer, int flatbuffer_length)
     return tflite::VerifyModelBuffer(verifier);
 }
 
+#ifndef __arm__
+/*************************************************************************************************/
+bool map_model_flatbuffer(const char* path, const uint8_t** flatbuffer, uint32_t* length)
+{
+    void* mapping = nullptr;
+    uint32_t file_size = 0;
+
+    *flatbuffer = nullptr;
+    *length = 0;
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if(file == INVALID_HANDLE_VALUE)
+    {
+        MLTK_ERROR("Failed to open model file: %s", path);
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if(!GetFileSizeEx(file, &size) || size.QuadPart == 0 || size.QuadPart > UINT32_MAX)
+    {
+        MLTK_ERROR("Invalid model file size: %s", path);
+        CloseHandle(file);
+        return false;
+    }
+    file_size = (uint32_t)size.QuadPart;
+
+    HANDLE file_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if(file_mapping == nullptr)
+    {
+        MLTK_ERROR("Failed to map model file: %s", path);
+        return false;
+    }
+
+    // The view keeps a reference to the mapping object, so its handle may be closed now
+    mapping = MapViewOfFile(file_mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(file_mapping);
+    if(mapping == nullptr)
+    {
+        MLTK_ERROR("Failed to map model file: %s", path);
+        return false;
+    }
+#else
+    const int fd = open(path, O_RDONLY);
+    if(fd < 0)
+    {
+        MLTK_ERROR("Failed to open model file: %s", path);
+        return false;
+    }
+
+    struct stat st;
+    if(fstat(fd, &st) != 0 || st.st_size == 0 || (uint64_t)st.st_size > UINT32_MAX)
+    {
+        MLTK_ERROR("Invalid model file size: %s", path);
+        close(fd);
+        return false;
+    }
+    file_size = (uint32_t)st.st_size;
+
+    // The mapping remains valid after the file descriptor is closed
+    mapping = mmap(nullptr, file_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if(mapping == MAP_FAILED)
+    {
+        MLTK_ERROR("Failed to map model file: %s", path);
+        return false;
+    }
+#endif
+
+    if(!verify_model_flatbuffer(mapping, file_size))
+    {
+        MLTK_ERROR("Model file is not a valid .tflite flatbuffer: %s", path);
+        unmap_model_flatbuffer((const uint8_t*)mapping, file_size);
+        return false;
+    }
+
+    *flatbuffer = (const uint8_t*)mapping;
+    *length = file_size;
+
+    return true;
+}
+
+/*************************************************************************************************/
+void unmap_model_flatbuffer(const uint8_t* flatbuffer, uint32_t length)
+{
+    if(flatbuffer == nullptr)
+    {
+        return;
+    }
+
+#ifdef _WIN32
+    UnmapViewOfFile(flatbuffer);
+#else
+    munmap((void*)flatbuffer, length);
+#endif
+}
+#endif // __arm__
+
 
 
 } // namespace mltk
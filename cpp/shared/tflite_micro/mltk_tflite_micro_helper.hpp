@@ -88,9 +88,6 @@ struct TfliteMicroAccelerator
 };
 
 
-extern bool model_profiler_enabled;
-extern bool model_tensor_recorder_enabled;
-extern bool model_error_reporter_enabled;
 extern const char* TFLITE_MICRO_VERSION;
 
 
@@ -170,5 +167,22 @@ inline int div_floor(const int numerator, const int denominator, int upper_limit
 
 bool verify_model_flatbuffer(const void* flatbuffer, int flatbuffer_length);
 
+#ifndef __arm__
+/**
+ * Memory-map the given .tflite model file as read-only
+ *
+ * The model is not copied into the heap, the pages of the mapping
+ * are shared by all processes that map the same file (through the OS page cache).
+ * The flatbuffer is verified before this returns successfully.
+ * Use unmap_model_flatbuffer() to release the mapping.
+ */
+bool map_model_flatbuffer(const char* path, const uint8_t** flatbuffer, uint32_t* length);
+
+/**
+ * Release a .tflite model file mapped with map_model_flatbuffer()
+ */
+void unmap_model_flatbuffer(const uint8_t* flatbuffer, uint32_t length);
+#endif
+
 
 } // namespace mltk
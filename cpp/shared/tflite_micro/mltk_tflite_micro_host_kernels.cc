@@ -0,0 +1,542 @@
+#ifdef TFLITE_MICRO_HOST_KERNELS_ENABLED
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include "ruy/ruy.h"
+#include "tensorflow/lite/kernels/internal/common.h"
+#include "mltk_tflite_micro_host_kernels.hpp"
+#include "mltk_tflite_micro_context.hpp"
+
+
+namespace mltk
+{
+namespace host_kernels
+{
+
+// Each thread gets its own ruy context and scratch buffers
+// so that separate model instances may execute concurrently
+// NOTE: These are NOT allocated from the tensor arena
+static thread_local ruy::Context ruy_context;
+static thread_local std::vector<int8_t> im2col_buffer;
+static thread_local std::vector<int32_t> accumulator_buffer;
+
+
+/*************************************************************************************************
+ * Return true if the reference kernels should be executed instead,
+ * e.g. while differential execution compares a layer against the reference kernels
+ */
+static inline bool use_reference_kernels()
+{
+  return get_runtime_context().reference_kernels_only;
+}
+
+
+/*************************************************************************************************
+ * Compute: dst[rows x cols] = (lhs[rows x depth] - lhs_zero_point) * (rhs[depth x cols] - rhs_zero_point)
+ *
+ * lhs is row-major, rhs and dst are column-major.
+ */
+static void gemm_s8_s32(
+  const int8_t* lhs_data,
+  int8_t lhs_zero_point,
+  const int8_t* rhs_data,
+  int8_t rhs_zero_point,
+  int32_t* dst_data,
+  int rows,
+  int depth,
+  int cols
+)
+{
+  ruy::Matrix<int8_t> lhs;
+  ruy::MakeSimpleLayout(rows, depth, ruy::Order::kRowMajor, lhs.mutable_layout());
+  lhs.set_data(lhs_data);
+  lhs.set_zero_point(lhs_zero_point);
+  // NOTE: ruy's prepacked cache is keyed by the data pointer and layout, not the contents.
+  // A model loaded at the same address as a previously unloaded model would use
+  // stale packed filters, so the filters are never cached
+  lhs.set_cache_policy(ruy::CachePolicy::kNeverCache);
+
+  ruy::Matrix<int8_t> rhs;
+  ruy::MakeSimpleLayout(depth, cols, ruy::Order::kColMajor, rhs.mutable_layout());
+  rhs.set_data(rhs_data);
+  rhs.set_zero_point(rhs_zero_point);
+
+  ruy::Matrix<int32_t> dst;
+  ruy::MakeSimpleLayout(rows, cols, ruy::Order::kColMajor, dst.mutable_layout());
+  dst.set_data(dst_data);
+
+  // NOTE: With an int32 destination, ruy returns the raw accumulators
+  ruy::MulParams<int32_t, int32_t> mul_params;
+  ruy::Mul(lhs, rhs, mul_params, &ruy_context, &dst);
+}
+
+/*************************************************************************************************
+ * Add the bias and re-quantize the int32 accumulators to int8,
+ * exactly as the reference kernels do
+ */
+static inline int8_t requantize(
+  int32_t acc,
+  const int32_t* bias_data,
+  int channel,
+  int32_t output_multiplier,
+  int32_t output_shift,
+  int32_t output_offset,
+  int32_t output_activation_min,
+  int32_t output_activation_max
+)
+{
+  if (bias_data != nullptr)
+  {
+    acc += bias_data[channel];
+  }
+  acc = tflite::MultiplyByQuantizedMultiplier(acc, output_multiplier, output_shift);
+  acc += output_offset;
+  acc = std::max(acc, output_activation_min);
+  acc = std::min(acc, output_activation_max);
+  return static_cast<int8_t>(acc);
+}
+
+/*************************************************************************************************/
+void ConvPerChannel(
+  const tflite::ConvParams& params,
+  const int32_t* output_multiplier,
+  const int32_t* output_shift,
+  const tflite::RuntimeShape& input_shape,
+  const int8_t* input_data,
+  const tflite::RuntimeShape& filter_shape,
+  const int8_t* filter_data,
+  const tflite::RuntimeShape& bias_shape,
+  const int32_t* bias_data,
+  const tflite::RuntimeShape& output_shape,
+  int8_t* output_data
+)
+{
+  if (use_reference_kernels())
+  {
+    tflite::reference_integer_ops::ConvPerChannel(
+      params, output_multiplier, output_shift, input_shape, input_data,
+      filter_shape, filter_data, bias_shape, bias_data, output_shape, output_data
+    );
+    return;
+  }
+
+  const int32_t input_offset = params.input_offset;
+  const int stride_width = params.stride_width;
+  const int stride_height = params.stride_height;
+  const int dilation_width_factor = params.dilation_width_factor;
+  const int dilation_height_factor = params.dilation_height_factor;
+  const int pad_width = params.padding_values.width;
+  const int pad_height = params.padding_values.height;
+
+  const int batches = tflite::MatchingDim(input_shape, 0, output_shape, 0);
+  const int input_depth = input_shape.Dims(3);
+  const int output_depth = tflite::MatchingDim(filter_shape, 0, output_shape, 3);
+  const int input_height = input_shape.Dims(1);
+  const int input_width = input_shape.Dims(2);
+  const int filter_height = filter_shape.Dims(1);
+  const int filter_width = filter_shape.Dims(2);
+  const int filter_input_depth = filter_shape.Dims(3);
+  const int output_height = output_shape.Dims(1);
+  const int output_width = output_shape.Dims(2);
+
+  // Grouped convolutions, and input offsets that do not fit in the
+  // ruy int8 zero point, use the reference kernel
+  if (filter_input_depth != input_depth || input_offset < -127 || input_offset > 128)
+  {
+    tflite::reference_integer_ops::ConvPerChannel(
+      params, output_multiplier, output_shift,
+      input_shape, input_data, filter_shape, filter_data,
+      bias_shape, bias_data, output_shape, output_data
+    );
+    return;
+  }
+
+  // The reference kernel skips the padded input values.
+  // Padding the im2col buffer with the input zero point is equivalent
+  // as (input_val + input_offset) is then 0
+  const int8_t input_zero_point = static_cast<int8_t>(-input_offset);
+  const int patch_size = filter_height * filter_width * input_depth;
+  const int n_pixels = output_height * output_width;
+  const bool is_pointwise = filter_height == 1 && filter_width == 1 &&
+                            stride_height == 1 && stride_width == 1 &&
+                            pad_height == 0 && pad_width == 0;
+
+  accumulator_buffer.resize((size_t)output_depth * n_pixels);
+  if (!is_pointwise)
+  {
+    im2col_buffer.resize((size_t)patch_size * n_pixels);
+  }
+
+  for (int batch = 0; batch < batches; ++batch)
+  {
+    const int8_t* batch_input = input_data + (size_t)batch * input_height * input_width * input_depth;
+    const int8_t* rhs_data = batch_input;
+
+    if (!is_pointwise)
+    {
+      int8_t* col = im2col_buffer.data();
+      for (int out_y = 0; out_y < output_height; ++out_y)
+      {
+        const int in_y_origin = (out_y * stride_height) - pad_height;
+        for (int out_x = 0; out_x < output_width; ++out_x)
+        {
+          const int in_x_origin = (out_x * stride_width) - pad_width;
+          for (int filter_y = 0; filter_y < filter_height; ++filter_y)
+          {
+            const int in_y = in_y_origin + dilation_height_factor * filter_y;
+            for (int filter_x = 0; filter_x < filter_width; ++filter_x)
+            {
+              const int in_x = in_x_origin + dilation_width_factor * filter_x;
+              if (in_x >= 0 && in_x < input_width && in_y >= 0 && in_y < input_height)
+              {
+                std::copy_n(&batch_input[((size_t)in_y * input_width + in_x) * input_depth], input_depth, col);
+              }
+              else
+              {
+                std::fill_n(col, input_depth, input_zero_point);
+              }
+              col += input_depth;
+            }
+          }
+        }
+      }
+      rhs_data = im2col_buffer.data();
+    }
+
+    int32_t* acc = accumulator_buffer.data();
+    gemm_s8_s32(filter_data, 0, rhs_data, input_zero_point, acc, output_depth, patch_size, n_pixels);
+
+    int8_t* batch_output = output_data + (size_t)batch * n_pixels * output_depth;
+    for (int pixel = 0; pixel < n_pixels; ++pixel)
+    {
+      for (int out_channel = 0; out_channel < output_depth; ++out_channel)
+      {
+        *batch_output++ = requantize(
+          *acc++, bias_data, out_channel,
+          output_multiplier[out_channel], output_shift[out_channel],
+          params.output_offset,
+          params.quantized_activation_min, params.quantized_activation_max
+        );
+      }
+    }
+  }
+}
+
+/*************************************************************************************************/
+void DepthwiseConvPerChannel(
+  const tflite::DepthwiseParams& params,
+  const int32_t* output_multiplier,
+  const int32_t* output_shift,
+  const tflite::RuntimeShape& input_shape,
+  const int8_t* input_data,
+  const tflite::RuntimeShape& filter_shape,
+  const int8_t* filter_data,
+  const tflite::RuntimeShape& bias_shape,
+  const int32_t* bias_data,
+  const tflite::RuntimeShape& output_shape,
+  int8_t* output_data
+)
+{
+  if (use_reference_kernels())
+  {
+    tflite::reference_integer_ops::DepthwiseConvPerChannel(
+      params, output_multiplier, output_shift, input_shape, input_data,
+      filter_shape, filter_data, bias_shape, bias_data, output_shape, output_data
+    );
+    return;
+  }
+
+  const int stride_width = params.stride_width;
+  const int stride_height = params.stride_height;
+  const int dilation_width_factor = params.dilation_width_factor;
+  const int dilation_height_factor = params.dilation_height_factor;
+  const int pad_width = params.padding_values.width;
+  const int pad_height = params.padding_values.height;
+  const int depth_multiplier = params.depth_multiplier;
+  const int32_t input_offset = params.input_offset;
+
+  const int batches = tflite::MatchingDim(input_shape, 0, output_shape, 0);
+  const int output_depth = tflite::MatchingDim(filter_shape, 3, output_shape, 3);
+  const int input_height = input_shape.Dims(1);
+  const int input_width = input_shape.Dims(2);
+  const int input_depth = input_shape.Dims(3);
+  const int filter_height = filter_shape.Dims(1);
+  const int filter_width = filter_shape.Dims(2);
+  const int output_height = output_shape.Dims(1);
+  const int output_width = output_shape.Dims(2);
+
+  // The output channels are the innermost loop
+  // so the compiler can vectorize the accumulation
+  accumulator_buffer.resize(output_depth);
+  int32_t* acc = accumulator_buffer.data();
+
+  for (int batch = 0; batch < batches; ++batch)
+  {
+    for (int out_y = 0; out_y < output_height; ++out_y)
+    {
+      const int in_y_origin = (out_y * stride_height) - pad_height;
+      for (int out_x = 0; out_x < output_width; ++out_x)
+      {
+        const int in_x_origin = (out_x * stride_width) - pad_width;
+        std::fill_n(acc, output_depth, 0);
+
+        for (int filter_y = 0; filter_y < filter_height; ++filter_y)
+        {
+          const int in_y = in_y_origin + dilation_height_factor * filter_y;
+          if (in_y < 0 || in_y >= input_height)
+          {
+            continue;
+          }
+          for (int filter_x = 0; filter_x < filter_width; ++filter_x)
+          {
+            const int in_x = in_x_origin + dilation_width_factor * filter_x;
+            if (in_x < 0 || in_x >= input_width)
+            {
+              continue;
+            }
+            const int8_t* input_ptr = &input_data[tflite::Offset(input_shape, batch, in_y, in_x, 0)];
+            const int8_t* filter_ptr = &filter_data[tflite::Offset(filter_shape, 0, filter_y, filter_x, 0)];
+            if (depth_multiplier == 1)
+            {
+              for (int c = 0; c < output_depth; ++c)
+              {
+                acc[c] += filter_ptr[c] * (input_ptr[c] + input_offset);
+              }
+            }
+            else
+            {
+              for (int in_channel = 0; in_channel < input_depth; ++in_channel)
+              {
+                const int32_t input_val = input_ptr[in_channel] + input_offset;
+                for (int m = 0; m < depth_multiplier; ++m)
+                {
+                  const int c = m + in_channel * depth_multiplier;
+                  acc[c] += filter_ptr[c] * input_val;
+                }
+              }
+            }
+          }
+        }
+
+        int8_t* output_ptr = &output_data[tflite::Offset(output_shape, batch, out_y, out_x, 0)];
+        for (int c = 0; c < output_depth; ++c)
+        {
+          output_ptr[c] = requantize(
+            acc[c], bias_data, c,
+            output_multiplier[c], output_shift[c],
+            params.output_offset,
+            params.quantized_activation_min, params.quantized_activation_max
+          );
+        }
+      }
+    }
+  }
+}
+
+/*************************************************************************************************/
+void FullyConnected(
+  const tflite::FullyConnectedParams& params,
+  const tflite::RuntimeShape& input_shape,
+  const int8_t* input_data,
+  const tflite::RuntimeShape& filter_shape,
+  const int8_t* filter_data,
+  const tflite::RuntimeShape& bias_shape,
+  const int32_t* bias_data,
+  const tflite::RuntimeShape& output_shape,
+  int8_t* output_data
+)
+{
+  if (use_reference_kernels())
+  {
+    tflite::reference_integer_ops::FullyConnected(
+      params, input_shape, input_data, filter_shape, filter_data,
+      bias_shape, bias_data, output_shape, output_data
+    );
+    return;
+  }
+
+  const int32_t input_offset = params.input_offset;
+  const int32_t filter_offset = params.weights_offset;
+  const int filter_dim_count = filter_shape.DimensionsCount();
+  const int output_dim_count = output_shape.DimensionsCount();
+  const int batches = tflite::FlatSizeSkipDim(output_shape, output_dim_count - 1);
+  const int output_depth = output_shape.Dims(output_dim_count - 1);
+  const int accum_depth = filter_shape.Dims(filter_dim_count - 1);
+
+  // Offsets that do not fit in the ruy int8 zero points use the reference kernel
+  if (input_offset < -127 || input_offset > 128 || filter_offset < -127 || filter_offset > 128)
+  {
+    tflite::reference_integer_ops::FullyConnected(
+      params, input_shape, input_data, filter_shape, filter_data,
+      bias_shape, bias_data, output_shape, output_data
+    );
+    return;
+  }
+
+  accumulator_buffer.resize((size_t)output_depth * batches);
+  int32_t* acc = accumulator_buffer.data();
+  gemm_s8_s32(
+    filter_data, static_cast<int8_t>(-filter_offset),
+    input_data, static_cast<int8_t>(-input_offset),
+    acc, output_depth, accum_depth, batches
+  );
+
+  for (int b = 0; b < batches; ++b)
+  {
+    for (int out_c = 0; out_c < output_depth; ++out_c)
+    {
+      *output_data++ = requantize(
+        *acc++, bias_data, out_c,
+        params.output_multiplier, params.output_shift,
+        params.output_offset,
+        params.quantized_activation_min, params.quantized_activation_max
+      );
+    }
+  }
+}
+
+/*************************************************************************************************/
+bool AveragePool(
+  const tflite::PoolParams& params,
+  const tflite::RuntimeShape& input_shape,
+  const int8_t* input_data,
+  const tflite::RuntimeShape& output_shape,
+  int8_t* output_data
+)
+{
+  if (use_reference_kernels())
+  {
+    return tflite::reference_integer_ops::AveragePool(
+      params, input_shape, input_data, output_shape, output_data
+    );
+  }
+
+  const int batches = tflite::MatchingDim(input_shape, 0, output_shape, 0);
+  const int depth = tflite::MatchingDim(input_shape, 3, output_shape, 3);
+  const int input_height = input_shape.Dims(1);
+  const int input_width = input_shape.Dims(2);
+  const int output_height = output_shape.Dims(1);
+  const int output_width = output_shape.Dims(2);
+
+  accumulator_buffer.resize(depth);
+  int32_t* acc = accumulator_buffer.data();
+
+  for (int batch = 0; batch < batches; ++batch)
+  {
+    for (int out_y = 0; out_y < output_height; ++out_y)
+    {
+      for (int out_x = 0; out_x < output_width; ++out_x)
+      {
+        const int in_x_origin = (out_x * params.stride_width) - params.padding_values.width;
+        const int in_y_origin = (out_y * params.stride_height) - params.padding_values.height;
+        const int filter_x_start = std::max(0, -in_x_origin);
+        const int filter_x_end = std::min(params.filter_width, input_width - in_x_origin);
+        const int filter_y_start = std::max(0, -in_y_origin);
+        const int filter_y_end = std::min(params.filter_height, input_height - in_y_origin);
+        const int filter_count = (filter_x_end - filter_x_start) * (filter_y_end - filter_y_start);
+        if (filter_count <= 0)
+        {
+          return false;
+        }
+
+        std::fill_n(acc, depth, 0);
+        for (int filter_y = filter_y_start; filter_y < filter_y_end; ++filter_y)
+        {
+          for (int filter_x = filter_x_start; filter_x < filter_x_end; ++filter_x)
+          {
+            const int8_t* input_ptr = &input_data[tflite::Offset(input_shape, batch, in_y_origin + filter_y, in_x_origin + filter_x, 0)];
+            for (int c = 0; c < depth; ++c)
+            {
+              acc[c] += input_ptr[c];
+            }
+          }
+        }
+
+        int8_t* output_ptr = &output_data[tflite::Offset(output_shape, batch, out_y, out_x, 0)];
+        for (int c = 0; c < depth; ++c)
+        {
+          // Round to the closest integer value, the same as the reference kernel
+          int32_t value = acc[c] > 0 ? (acc[c] + filter_count / 2) / filter_count
+                                     : (acc[c] - filter_count / 2) / filter_count;
+          value = std::max(value, params.quantized_activation_min);
+          value = std::min(value, params.quantized_activation_max);
+          output_ptr[c] = static_cast<int8_t>(value);
+        }
+      }
+    }
+  }
+
+  return true;
+}
+
+/*************************************************************************************************/
+void MaxPool(
+  const tflite::PoolParams& params,
+  const tflite::RuntimeShape& input_shape,
+  const int8_t* input_data,
+  const tflite::RuntimeShape& output_shape,
+  int8_t* output_data
+)
+{
+  if (use_reference_kernels())
+  {
+    tflite::reference_integer_ops::MaxPool(
+      params, input_shape, input_data, output_shape, output_data
+    );
+    return;
+  }
+
+  const int batches = tflite::MatchingDim(input_shape, 0, output_shape, 0);
+  const int depth = tflite::MatchingDim(input_shape, 3, output_shape, 3);
+  const int input_height = input_shape.Dims(1);
+  const int input_width = input_shape.Dims(2);
+  const int output_height = output_shape.Dims(1);
+  const int output_width = output_shape.Dims(2);
+
+  for (int batch = 0; batch < batches; ++batch)
+  {
+    for (int out_y = 0; out_y < output_height; ++out_y)
+    {
+      for (int out_x = 0; out_x < output_width; ++out_x)
+      {
+        const int in_x_origin = (out_x * params.stride_width) - params.padding_values.width;
+        const int in_y_origin = (out_y * params.stride_height) - params.padding_values.height;
+        const int filter_x_start = std::max(0, -in_x_origin);
+        const int filter_x_end = std::min(params.filter_width, input_width - in_x_origin);
+        const int filter_y_start = std::max(0, -in_y_origin);
+        const int filter_y_end = std::min(params.filter_height, input_height - in_y_origin);
+
+        int8_t* output_ptr = &output_data[tflite::Offset(output_shape, batch, out_y, out_x, 0)];
+        std::fill_n(output_ptr, depth, std::numeric_limits<int8_t>::lowest());
+
+        for (int filter_y = filter_y_start; filter_y < filter_y_end; ++filter_y)
+        {
+          for (int filter_x = filter_x_start; filter_x < filter_x_end; ++filter_x)
+          {
+            const int8_t* input_ptr = &input_data[tflite::Offset(input_shape, batch, in_y_origin + filter_y, in_x_origin + filter_x, 0)];
+            for (int c = 0; c < depth; ++c)
+            {
+              output_ptr[c] = std::max(output_ptr[c], input_ptr[c]);
+            }
+          }
+        }
+
+        for (int c = 0; c < depth; ++c)
+        {
+          int32_t value = output_ptr[c];
+          value = std::max(value, params.quantized_activation_min);
+          value = std::min(value, params.quantized_activation_max);
+          output_ptr[c] = static_cast<int8_t>(value);
+        }
+      }
+    }
+  }
+}
+
+
+} // namespace host_kernels
+} // namespace mltk
+
+#endif // TFLITE_MICRO_HOST_KERNELS_ENABLED
@@ -0,0 +1,51 @@
+
+
+###########################################################################
+# Host-Optimized Kernels
+#
+# These use ruy and vectorizable loops to accelerate the int8
+# CONV_2D, DEPTHWISE_CONV_2D, FULLY_CONNECTED and pooling kernels
+# when running on Windows/Linux. They are bit-exact with the reference kernels.
+#
+mltk_get(MLTK_PLATFORM_IS_EMBEDDED)
+mltk_get(TFLITE_MICRO_HOST_KERNELS_ENABLED)
+
+if(NOT DEFINED TFLITE_MICRO_HOST_KERNELS_ENABLED)
+  set(TFLITE_MICRO_HOST_KERNELS_ENABLED ON)
+endif()
+
+string(TOLOWER "${CMAKE_SYSTEM_PROCESSOR}" _host_kernels_processor)
+if(MLTK_PLATFORM_IS_EMBEDDED OR NOT _host_kernels_processor MATCHES "^(x86_64|amd64|aarch64|arm64)$")
+  set(TFLITE_MICRO_HOST_KERNELS_ENABLED OFF)
+endif()
+
+if(TFLITE_MICRO_HOST_KERNELS_ENABLED AND NOT TARGET ruy)
+  mltk_warn("ruy library target not found, using the reference kernels instead of the host-optimized kernels")
+  set(TFLITE_MICRO_HOST_KERNELS_ENABLED OFF)
+endif()
+
+if(TFLITE_MICRO_HOST_KERNELS_ENABLED)
+
+mltk_info("TFLITE_MICRO_HOST_KERNELS_ENABLED=ON, Using host-optimized kernels")
+add_library(mltk_tflite_micro_host_kernels)
+add_library(mltk::tflite_micro_host_kernels ALIAS mltk_tflite_micro_host_kernels)
+
+target_sources(mltk_tflite_micro_host_kernels
+PRIVATE 
+  ${CMAKE_CURRENT_LIST_DIR}/mltk_tflite_micro_host_kernels.cc
+)
+
+target_link_libraries(mltk_tflite_micro_host_kernels
+PRIVATE 
+  ruy
+  mltk::tflite_micro
+)
+
+target_compile_definitions(mltk_tflite_micro 
+PUBLIC 
+  TFLITE_MICRO_HOST_KERNELS_ENABLED
+)
+
+list(APPEND tflm_kernels_target mltk_tflite_micro_host_kernels)
+
+endif() # TFLITE_MICRO_HOST_KERNELS_ENABLED
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "tensorflow/lite/kernels/internal/types.h"
+#include "tensorflow/lite/kernels/internal/reference/integer_ops/conv.h"
+#include "tensorflow/lite/kernels/internal/reference/integer_ops/depthwise_conv.h"
+#include "tensorflow/lite/kernels/internal/reference/integer_ops/fully_connected.h"
+#include "tensorflow/lite/kernels/internal/reference/integer_ops/pooling.h"
+
+
+/**
+ * Host-optimized int8 kernels
+ *
+ * These have the same signatures as the TFLM reference_integer_ops kernels
+ * and generate bit-exact results.
+ *
+ * When TFLITE_MICRO_HOST_KERNELS_ENABLED is defined (Windows/Linux x86_64/aarch64 builds),
+ * CONV_2D and FULLY_CONNECTED use the ruy int8 GEMM to calculate the accumulators
+ * and DEPTHWISE_CONV_2D and pooling use vectorizable loops.
+ * The int32 accumulators are then re-quantized exactly as the reference kernels do.
+ *
+ * Any temporary buffers are allocated from the heap (not the tensor arena),
+ * so the required runtime memory size is the same as the reference kernels.
+ *
+ * If TfliteMicroRuntimeContext::reference_kernels_only is set in the calling thread's
+ * runtime context, the reference kernels are called instead (e.g. by differential execution).
+ *
+ * Otherwise, these directly call the reference kernels.
+ */
+namespace mltk
+{
+namespace host_kernels
+{
+
+#ifdef TFLITE_MICRO_HOST_KERNELS_ENABLED
+
+void ConvPerChannel(
+  const tflite::ConvParams& params,
+  const int32_t* output_multiplier,
+  const int32_t* output_shift,
+  const tflite::RuntimeShape& input_shape,
+  const int8_t* input_data,
+  const tflite::RuntimeShape& filter_shape,
+  const int8_t* filter_data,
+  const tflite::RuntimeShape& bias_shape,
+  const int32_t* bias_data,
+  const tflite::RuntimeShape& output_shape,
+  int8_t* output_data
+);
+
+void DepthwiseConvPerChannel(
+  const tflite::DepthwiseParams& params,
+  const int32_t* output_multiplier,
+  const int32_t* output_shift,
+  const tflite::RuntimeShape& input_shape,
+  const int8_t* input_data,
+  const tflite::RuntimeShape& filter_shape,
+  const int8_t* filter_data,
+  const tflite::RuntimeShape& bias_shape,
+  const int32_t* bias_data,
+  const tflite::RuntimeShape& output_shape,
+  int8_t* output_data
+);
+
+void FullyConnected(
+  const tflite::FullyConnectedParams& params,
+  const tflite::RuntimeShape& input_shape,
+  const int8_t* input_data,
+  const tflite::RuntimeShape& filter_shape,
+  const int8_t* filter_data,
+  const tflite::RuntimeShape& bias_shape,
+  const int32_t* bias_data,
+  const tflite::RuntimeShape& output_shape,
+  int8_t* output_data
+);
+
+bool AveragePool(
+  const tflite::PoolParams& params,
+  const tflite::RuntimeShape& input_shape,
+  const int8_t* input_data,
+  const tflite::RuntimeShape& output_shape,
+  int8_t* output_data
+);
+
+void MaxPool(
+  const tflite::PoolParams& params,
+  const tflite::RuntimeShape& input_shape,
+  const int8_t* input_data,
+  const tflite::RuntimeShape& output_shape,
+  int8_t* output_data
+);
+
+#else // TFLITE_MICRO_HOST_KERNELS_ENABLED
+
+using tflite::reference_integer_ops::ConvPerChannel;
+using tflite::reference_integer_ops::DepthwiseConvPerChannel;
+using tflite::reference_integer_ops::FullyConnected;
+using tflite::reference_integer_ops::AveragePool;
+using tflite::reference_integer_ops::MaxPool;
+
+#endif // TFLITE_MICRO_HOST_KERNELS_ENABLED
+
+} // namespace host_kernels
+} // namespace mltk
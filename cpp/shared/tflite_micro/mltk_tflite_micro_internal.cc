@@ -1,4 +1,5 @@
 #include <cstdarg>
+#include <cstring>
 
 #include "mltk_tflite_micro_internal.hpp"
 
@@ -6,30 +7,66 @@
 namespace mltk
 {
 
-profiling::Profiler *_inference_profiler = nullptr;
-profiling::Profiler **_kernel_profilers = nullptr;
-int _current_kernel_index = -1;
-int _current_kernel_op_code = -1;
-bool _issued_unsupported_msg = false;
-void (*_processing_callback)(void*) = nullptr;
-void* _processing_callback_arg = nullptr;;
+static TfliteMicroRuntimeContext _default_runtime_context;
+static MLTK_THREAD_LOCAL TfliteMicroRuntimeContext* _active_runtime_context = nullptr;
+static int _inference_profiler_count = 0;
 
 
+/*************************************************************************************************/
+ScopedRuntimeContext::ScopedRuntimeContext(TfliteMicroRuntimeContext* context)
+{
+  _previous = _active_runtime_context;
+  _active_runtime_context = context;
+}
+
+/*************************************************************************************************/
+ScopedRuntimeContext::~ScopedRuntimeContext()
+{
+  _active_runtime_context = _previous;
+}
+
+/*************************************************************************************************/
+TfliteMicroRuntimeContext& get_runtime_context()
+{
+  return (_active_runtime_context != nullptr) ? *_active_runtime_context : _default_runtime_context;
+}
+
+/*************************************************************************************************/
+TfliteMicroRuntimeContext* get_active_runtime_context()
+{
+  return _active_runtime_context;
+}
+
 
 /*************************************************************************************************/
 void allocate_profilers(int subgraph_index, int op_count)
 {
-  if(subgraph_index > 0 || !model_profiler_enabled)
+  auto& context = get_runtime_context();
+
+  if(subgraph_index > 0 || !context.profiler_enabled)
   {
     return;
   }
-  if(!profiling::register_profiler("Inference", _inference_profiler))
+
+  // The first model uses the "Inference" profiler name,
+  // any other concurrently loaded models use a unique name
+  char name[32];
+  if(!profiling::exists("Inference"))
+  {
+    strcpy(name, "Inference");
+  }
+  else 
+  {
+    snprintf(name, sizeof(name), "Inference%d", ++_inference_profiler_count);
+  }
+
+  if(!profiling::register_profiler(name, context.inference_profiler))
   {
     return;
   }
-  _inference_profiler->flags(profiling::Flag::ReportTotalChildrenCycles|profiling::Flag::ReportsFreeRunningCpuCycles);
-  _kernel_profilers = static_cast<profiling::Profiler**>(malloc(sizeof(profiling::Profiler*)*op_count));
-  if(_kernel_profilers == nullptr)
+  context.inference_profiler->flags(profiling::Flag::ReportTotalChildrenCycles|profiling::Flag::ReportsFreeRunningCpuCycles);
+  context.kernel_profilers = static_cast<profiling::Profiler**>(malloc(sizeof(profiling::Profiler*)*op_count));
+  if(context.kernel_profilers == nullptr)
   {
     return;
   }
@@ -38,16 +75,18 @@ void allocate_profilers(int subgraph_index, int op_count)
 /*************************************************************************************************/
 void free_profilers()
 {
-    if(_inference_profiler != nullptr)
+    auto& context = get_runtime_context();
+
+    if(context.inference_profiler != nullptr)
     {
         // Unregister the inference profiler and all its children profilers
-        profiling::unregister(_inference_profiler);
-        _inference_profiler = nullptr;
+        profiling::unregister(context.inference_profiler);
+        context.inference_profiler = nullptr;
     }
-    if(_kernel_profilers != nullptr)
+    if(context.kernel_profilers != nullptr)
     {
-        free(_kernel_profilers);
-        _kernel_profilers = nullptr;
+        free(context.kernel_profilers);
+        context.kernel_profilers = nullptr;
     }
 }
 
@@ -60,21 +99,65 @@ void register_profiler(
   const tflite::NodeAndRegistration& node_and_registration 
 )
 {
-  if(subgraph_idx > 0 || _kernel_profilers == nullptr)
+  auto& runtime_context = get_runtime_context();
+
+  if(subgraph_idx > 0 || runtime_context.kernel_profilers == nullptr)
   {
     return;
   }
   profiling::Profiler* profiler;
-  profiling::register_profiler(op_to_str(op_idx, op_type), profiler, _inference_profiler);
+  profiling::register_profiler(op_to_str(op_idx, op_type), profiler, runtime_context.inference_profiler);
   if(profiler == nullptr)
   {
     return;
   }
   profiler->flags().set(profiling::Flag::TimeMeasuredBetweenStartAndStop);
-  _kernel_profilers[op_idx] = profiler;
+  runtime_context.kernel_profilers[op_idx] = profiler;
   calculate_op_metrics(context, node_and_registration, profiler->metrics());
 }
 
+/*************************************************************************************************/
+void save_scratch_buffer_requests(tflite::MicroAllocator* allocator)
+{
+  auto& context = get_runtime_context();
+
+  free_scratch_buffer_requests();
+
+  const int count = allocator->scratch_buffer_request_count_;
+  if(count == 0)
+  {
+    return;
+  }
+
+  context.scratch_buffer_requests = static_cast<TfliteMicroScratchBufferRequest*>(malloc(sizeof(TfliteMicroScratchBufferRequest)*count));
+  if(context.scratch_buffer_requests == nullptr)
+  {
+    return;
+  }
+
+  // The requests are stored in the arena head until the memory plan is committed
+  const auto requests = allocator->GetScratchBufferRequests();
+  for(int i = 0; i < count; ++i)
+  {
+    context.scratch_buffer_requests[i].bytes = requests[i].bytes;
+    context.scratch_buffer_requests[i].op_index = requests[i].node_idx;
+  }
+  context.scratch_buffer_request_count = count;
+}
+
+/*************************************************************************************************/
+void free_scratch_buffer_requests()
+{
+  auto& context = get_runtime_context();
+
+  if(context.scratch_buffer_requests != nullptr)
+  {
+    free(context.scratch_buffer_requests);
+    context.scratch_buffer_requests = nullptr;
+  }
+  context.scratch_buffer_request_count = 0;
+}
+
 /*************************************************************************************************/
 const char* to_str(tflite::BuiltinOperator op_type) 
 {
@@ -88,7 +171,7 @@ const char* to_str(tflite::BuiltinOperator op_type)
 /*************************************************************************************************/
 const char* op_to_str(int op_idx, tflite::BuiltinOperator op_type)
 {
-  static char op_name_buffer[64];
+  static MLTK_THREAD_LOCAL char op_name_buffer[64];
   snprintf(op_name_buffer, sizeof(op_name_buffer), "Op%d-%s", op_idx, to_str(op_type));
   return op_name_buffer;
 }
@@ -8,16 +8,24 @@
 #include "logging/logger.hpp"
 
 #include "mltk_tflite_micro_helper.hpp"
+#include "mltk_tflite_micro_context.hpp"
 #include "mltk_tflite_micro_recorder.hpp"
+#include "mltk_tflite_micro_differential.hpp"
+
+
+namespace tflite
+{
+class MicroInterpreter;
+} // namespace tflite
 
 
 #define SET_CURRENT_KERNEL(op_idx, op_code) \
-mltk::_current_kernel_index = op_idx; \
-mltk::_current_kernel_op_code = op_code; \
-mltk::_issued_unsupported_msg = false;
+mltk::get_runtime_context().current_kernel_index = op_idx; \
+mltk::get_runtime_context().current_kernel_op_code = op_code; \
+mltk::get_runtime_context().issued_unsupported_msg = false;
 #define CLEAR_CURRENT_KERNEL() \
-mltk::_current_kernel_index = -1; \
-mltk::_current_kernel_op_code = -1;
+mltk::get_runtime_context().current_kernel_index = -1; \
+mltk::get_runtime_context().current_kernel_op_code = -1;
 
 
 
@@ -33,33 +41,39 @@ mltk::_current_kernel_op_code = -1;
 #define FREE_PROFILERS() mltk::free_profilers();
 
 #define START_INFERENCE_PROFILER(subgraph_idx) \
+auto& _runtime_context = mltk::get_runtime_context(); \
 if(subgraph_idx == 0) \
 { \
-  if(mltk::_inference_profiler != nullptr) mltk::_inference_profiler->start(); \
-  if(mltk::mltk_tflite_micro_get_registered_accelerator() != nullptr) mltk::mltk_tflite_micro_get_registered_accelerator()->start_profiler(-1); \
+  if(_runtime_context.inference_profiler != nullptr) _runtime_context.inference_profiler->start(); \
+  if(_runtime_context.accelerator != nullptr) _runtime_context.accelerator->start_profiler(-1); \
 }
 
 #define STOP_INFERENCE_PROFILER(subgraph_idx) \
 if(subgraph_idx == 0) \
 { \
-  if(mltk::mltk_tflite_micro_get_registered_accelerator() != nullptr) mltk::mltk_tflite_micro_get_registered_accelerator()->stop_profiler(-1); \
-  if(mltk::_inference_profiler != nullptr) mltk::_inference_profiler->stop(); \
+  if(_runtime_context.accelerator != nullptr) _runtime_context.accelerator->stop_profiler(-1); \
+  if(_runtime_context.inference_profiler != nullptr) _runtime_context.inference_profiler->stop(); \
 }
 
+// The op profiler macros use the runtime context declared by START_INFERENCE_PROFILER(),
+// this declares it in functions that only invoke operators
+#define DECLARE_OP_PROFILER_CONTEXT() \
+auto& _runtime_context = mltk::get_runtime_context();
+
 #define START_OP_PROFILER(subgraph_idx, op_idx, op_code) \
 SET_CURRENT_KERNEL(op_idx, op_code) \
 if(subgraph_idx == 0) \
 { \
-  if(mltk::_kernel_profilers != nullptr) mltk::_kernel_profilers[op_idx]->start(); \
-  if(mltk::mltk_tflite_micro_get_registered_accelerator() != nullptr) mltk::mltk_tflite_micro_get_registered_accelerator()->start_op_profiler(op_idx, (mltk::_kernel_profilers != nullptr) ? mltk::_kernel_profilers[op_idx] : nullptr); \
+  if(_runtime_context.kernel_profilers != nullptr) _runtime_context.kernel_profilers[op_idx]->start(); \
+  if(_runtime_context.accelerator != nullptr) _runtime_context.accelerator->start_op_profiler(op_idx, (_runtime_context.kernel_profilers != nullptr) ? _runtime_context.kernel_profilers[op_idx] : nullptr); \
 }
 
 #define STOP_OP_PROFILER(subgraph_idx, op_idx) \
 CLEAR_CURRENT_KERNEL() \
 if(subgraph_idx == 0) \
 { \
-  if(mltk::mltk_tflite_micro_get_registered_accelerator() != nullptr) mltk::mltk_tflite_micro_get_registered_accelerator()->stop_op_profiler(op_idx, (mltk::_kernel_profilers != nullptr) ? mltk::_kernel_profilers[op_idx] : nullptr); \
-  if(mltk::_kernel_profilers != nullptr) mltk::_kernel_profilers[op_idx]->stop(); \
+  if(_runtime_context.accelerator != nullptr) _runtime_context.accelerator->stop_op_profiler(op_idx, (_runtime_context.kernel_profilers != nullptr) ? _runtime_context.kernel_profilers[op_idx] : nullptr); \
+  if(_runtime_context.kernel_profilers != nullptr) _runtime_context.kernel_profilers[op_idx]->stop(); \
 }
 
 
@@ -70,6 +84,7 @@ if(subgraph_idx == 0) \
 #define FREE_PROFILERS(...)
 #define START_INFERENCE_PROFILER(...)
 #define STOP_INFERENCE_PROFILER(...)
+#define DECLARE_OP_PROFILER_CONTEXT(...)
 #define START_OP_PROFILER(subgraph_idx, op_idx, op_code) SET_CURRENT_KERNEL(op_idx, op_code)
 #define STOP_OP_PROFILER(subgraph_idx, op_idx) CLEAR_CURRENT_KERNEL()
 
@@ -82,15 +97,16 @@ if(subgraph_idx == 0) \
 #undef STOP_INFERENCE_PROFILER
 
 #define START_INFERENCE_PROFILER(subgraph_idx) \
-  const int _accelerator_loop_count = (mltk::mltk_tflite_micro_get_registered_accelerator() != nullptr) ? mltk::mltk_tflite_micro_get_registered_accelerator()->get_profiler_loop_count() : 1; \
+  auto& _runtime_context = mltk::get_runtime_context(); \
+  const int _accelerator_loop_count = (_runtime_context.accelerator != nullptr) ? _runtime_context.accelerator->get_profiler_loop_count() : 1; \
   for(int _accelerator_loop = 0; _accelerator_loop < _accelerator_loop_count; ++_accelerator_loop) \
   { \
-  if(_accelerator_loop == 0) if(mltk::_inference_profiler != nullptr) mltk::_inference_profiler->start(); \
-  if(mltk::mltk_tflite_micro_get_registered_accelerator() != nullptr) mltk::mltk_tflite_micro_get_registered_accelerator()->start_profiler(_accelerator_loop);
+  if(_accelerator_loop == 0) if(_runtime_context.inference_profiler != nullptr) _runtime_context.inference_profiler->start(); \
+  if(_runtime_context.accelerator != nullptr) _runtime_context.accelerator->start_profiler(_accelerator_loop);
 
 #define STOP_INFERENCE_PROFILER(subgraph_idx) \
-  if(mltk::mltk_tflite_micro_get_registered_accelerator() != nullptr) mltk::mltk_tflite_micro_get_registered_accelerator()->stop_profiler(_accelerator_loop); \
-  if(_accelerator_loop == 0) if(mltk::_inference_profiler != nullptr)  mltk::_inference_profiler->stop(); \
+  if(_runtime_context.accelerator != nullptr) _runtime_context.accelerator->stop_profiler(_accelerator_loop); \
+  if(_accelerator_loop == 0) if(_runtime_context.inference_profiler != nullptr)  _runtime_context.inference_profiler->stop(); \
   }
 
 
@@ -98,8 +114,14 @@ if(subgraph_idx == 0) \
 #endif // TFLITE_MICRO_ACCELERATOR_PROFILER_ENABLED
 
 
+#define SAVE_SCRATCH_BUFFER_REQUESTS(allocator) mltk::save_scratch_buffer_requests(allocator);
+
+
 #define INVOKE_PROCESSING_CALLBACK() \
-if(mltk::_processing_callback != nullptr) mltk::_processing_callback(mltk::_processing_callback_arg)
+{ \
+  auto& _callback_context = mltk::get_runtime_context(); \
+  if(_callback_context.processing_callback != nullptr) _callback_context.processing_callback(_callback_context.processing_callback_arg); \
+}
 
 
 
@@ -109,15 +131,6 @@ namespace mltk
 
 
 
-extern profiling::Profiler *_inference_profiler;
-extern profiling::Profiler **_kernel_profilers;
-extern int _current_kernel_index;
-extern int _current_kernel_op_code;
-extern bool _issued_unsupported_msg;
-extern void (*_processing_callback)(void*);
-extern void* _processing_callback_arg;
-
-
 void allocate_profilers(int subgraph_index, int op_count);
 
 void register_profiler(
@@ -131,6 +144,13 @@ void register_profiler(
 void free_profilers();
 
 
+TfLiteStatus invoke_subgraph_range(tflite::MicroInterpreter& interpreter, int first_op, int last_op);
+
+
+void save_scratch_buffer_requests(tflite::MicroAllocator* allocator);
+void free_scratch_buffer_requests();
+
+
 bool calculate_op_metrics(
   const TfLiteContext* context,
   const tflite::NodeAndRegistration& node_and_registration,
@@ -2,6 +2,7 @@
 
 #include "mltk_tflite_micro_recorder.hpp"
 #include "mltk_tflite_micro_helper.hpp"
+#include "mltk_tflite_micro_context.hpp"
 
 
 namespace mltk
@@ -9,34 +10,55 @@ namespace mltk
 
 
 static int padding_to_tflite_schema(tflite::PaddingType padding);
-
-
-bool model_tensor_recorder_enabled = false;
-static msgpack_context_t* _msgpack_context = nullptr;
-static bool _root_array_finalized = false;
-static bool _layer_started = false;
+static void write_tensor_list(
+  msgpack_context_t* msgpack, 
+  const char* key,
+  int op_idx, 
+  const TfLiteContext& context, 
+  const TfLiteIntArray* tensor_indices, 
+  bool is_input
+);
 
 
 /*************************************************************************************************/
 void reset_recorder()
 {
-  msgpack_buffered_writer_deinit(_msgpack_context, true);
-  _msgpack_context = nullptr;
-  _layer_started = false;
-  _root_array_finalized = false;
+  auto& context = get_runtime_context();
+  msgpack_buffered_writer_deinit(context.recorder_msgpack, true);
+  msgpack_buffered_writer_deinit(context.recorder_layer_msgpack, true);
+  context.recorder_msgpack = nullptr;
+  context.recorder_layer_msgpack = nullptr;
+  context.recorder_layer_started = false;
+  context.recorder_root_array_finalized = false;
 }
 
 /*************************************************************************************************/
 bool start_recording()
 {
+  auto& context = get_runtime_context();
   reset_recorder();
-  if(msgpack_buffered_writer_init(&_msgpack_context, 32*1024) != 0)
+
+  // The layer buffer only holds the current layer's inputs and kernel parameters.
+  // It is re-used for each layer so it only grows to the size of the largest layer.
+  if(msgpack_buffered_writer_init(&context.recorder_layer_msgpack, 32*1024) != 0)
   {
     return false;
   }
-  msgpack_write_array_marker(_msgpack_context, -1);
-  _root_array_finalized = false;
-  _layer_started = false;
+
+  // When streaming, each layer's record is sent directly to the writer
+  // so there is no root array to buffer
+  if(context.recorder_config.writer == nullptr)
+  {
+    if(msgpack_buffered_writer_init(&context.recorder_msgpack, 32*1024) != 0)
+    {
+      reset_recorder();
+      return false;
+    }
+    msgpack_write_array_marker(context.recorder_msgpack, -1);
+  }
+
+  context.recorder_root_array_finalized = false;
+  context.recorder_layer_started = false;
 
   return true;
 }
@@ -44,13 +66,21 @@ bool start_recording()
 /*************************************************************************************************/
 bool get_recorded_data(const uint8_t** data_ptr, uint32_t* length_ptr)
 {
-  if(!_root_array_finalized)
+  auto& context = get_runtime_context();
+  if(context.recorder_msgpack == nullptr)
   {
-    _root_array_finalized = true;
-    msgpack_finalize_dynamic(_msgpack_context);
+    *data_ptr = nullptr;
+    *length_ptr = 0;
+    return false;
   }
 
-  return msgpack_buffered_writer_get_buffer(_msgpack_context, (uint8_t**)data_ptr, length_ptr) == 0;
+  if(!context.recorder_root_array_finalized)
+  {
+    context.recorder_root_array_finalized = true;
+    msgpack_finalize_dynamic(context.recorder_msgpack);
+  }
+
+  return msgpack_buffered_writer_get_buffer(context.recorder_msgpack, (uint8_t**)data_ptr, length_ptr) == 0;
 }
 
 /*************************************************************************************************/
@@ -61,7 +91,11 @@ void record_layer(
   bool record_input
 )
 {
-  if(_msgpack_context == nullptr)
+  auto& runtime_context = get_runtime_context();
+  const auto& config = runtime_context.recorder_config;
+  const bool record_tensors = runtime_context.tensor_recorder_enabled;
+
+  if(runtime_context.recorder_layer_msgpack == nullptr)
   {
     if(!start_recording())
     {
@@ -69,68 +103,91 @@ void record_layer(
     }
   }
 
+  auto layer_msgpack = runtime_context.recorder_layer_msgpack;
+
   if(record_input)
   {
-    _layer_started = true;
-    msgpack_write_dict_marker(_msgpack_context, -1);
+    runtime_context.recorder_layer_started = false;
+    if(config.layer_filter != nullptr && !config.layer_filter(op_idx, config.filter_arg))
+    {
+      return;
+    }
 
-    if(model_tensor_recorder_enabled)
+    // The inputs are copied into the layer buffer now as the kernel may overwrite them
+    // (e.g. in-place ops or overlapping buffers)
+    msgpack_buffered_writer_reset(layer_msgpack);
+    msgpack_write_dict_marker(layer_msgpack, -1);
+    if(record_tensors && config.record_inputs)
     {
-      msgpack_write_dict_array(_msgpack_context, "inputs", node.inputs->size);
-
-      for(int i = 0; i < node.inputs->size; ++i)
-      {
-        TfLiteTensor *tensor = nullptr;
-        const int tensor_idx = node.inputs->data[i];
-        if(tensor_idx >= 0)
-        {
-          tensor = context.GetTensor(&context, tensor_idx);
-          msgpack_write_bin(_msgpack_context, tensor->data.raw, tensor->bytes);
-        }
-        else 
-        {
-          msgpack_write_nil(_msgpack_context);
-        }
-      }
+      write_tensor_list(layer_msgpack, "inputs", op_idx, context, node.inputs, true);
     }
+    runtime_context.recorder_layer_started = true;
+    return;
+  }
+
+  if(!runtime_context.recorder_layer_started)
+  {
+    return;
+  }
+  runtime_context.recorder_layer_started = false;
+
+  // The layer buffer is a dynamic dict containing the inputs and any kernel parameters.
+  // Finalize it and retrieve its entry count from its 16-bit map header
+  uint8_t* layer_buffer;
+  uint32_t layer_length;
+  msgpack_finalize_dynamic(layer_msgpack);
+  if(msgpack_buffered_writer_get_buffer(layer_msgpack, &layer_buffer, &layer_length) != 0 || layer_length < 3)
+  {
+    return;
+  }
+  const int32_t n_layer_entries = ((int32_t)layer_buffer[1] << 8) | layer_buffer[2];
+  const bool record_outputs = record_tensors && config.record_outputs;
+
+  msgpack_context_t stream_msgpack;
+  msgpack_context_t* msgpack;
+  if(config.writer != nullptr)
+  {
+    stream_msgpack = msgpack_init_with_writer(config.writer, config.writer_arg);
+    msgpack = &stream_msgpack;
   }
   else 
   {
-    if(model_tensor_recorder_enabled)
-    {
-      msgpack_write_dict_array(_msgpack_context, "outputs", node.outputs->size);
-
-      for(int i = 0; i < node.outputs->size; ++i)
-      {
-        TfLiteTensor *tensor = nullptr;
-        const int tensor_idx = node.outputs->data[i];
-        if(tensor_idx >= 0)
-        {
-          tensor = context.GetTensor(&context, tensor_idx);
-          msgpack_write_bin(_msgpack_context, tensor->data.raw, tensor->bytes);
-        }
-        else 
-        {
-          msgpack_write_nil(_msgpack_context);
-        }
-      }
-    }
+    msgpack = runtime_context.recorder_msgpack;
+  }
+
+  // The record is written as a fixed-size dict so that it can be streamed.
+  // The output tensors are written directly from the tensor arena to the writer
+  const int32_t container_index = msgpack->container_index;
+  msgpack_write_dict_marker(msgpack, 1 + (record_outputs ? 1 : 0) + n_layer_entries);
+  msgpack_write_dict_int(msgpack, "index", op_idx);
+  if(record_outputs)
+  {
+    write_tensor_list(msgpack, "outputs", op_idx, context, node.outputs, false);
+  }
 
-    msgpack_finalize_dynamic(_msgpack_context);
-    _layer_started = false;
+  // Then append the layer buffer's entries (without its map header).
+  // These entries are raw bytes to the msgpack context, 
+  // so manually close the record's dict once they're written
+  if(n_layer_entries > 0)
+  {
+    msgpack_context_t layer_entries = msgpack_init_with_buffer(layer_buffer + 3, layer_length - 3);
+    layer_entries.buffer.ptr = layer_entries.buffer.end;
+    msgpack_write_context(msgpack, &layer_entries);
   }
+  msgpack->container_index = container_index;
 }
 
 /*************************************************************************************************/
 #ifndef MLTK_DLL_IMPORT 
 extern "C"  msgpack_context_t* get_layer_recording_context(bool force)
 {
-  if(!force && !model_tensor_recorder_enabled)
+  auto& context = get_runtime_context();
+  if(!force && !context.tensor_recorder_enabled)
   {
     return nullptr;
   }
 
-  return _layer_started ? _msgpack_context : nullptr;
+  return context.recorder_layer_started ? context.recorder_layer_msgpack : nullptr;
 }
 #endif
 
@@ -239,6 +296,49 @@ void record_layer_pool_params(
 
 
 
+/*************************************************************************************************/
+static void write_tensor_list(
+  msgpack_context_t* msgpack, 
+  const char* key,
+  int op_idx, 
+  const TfLiteContext& context, 
+  const TfLiteIntArray* tensor_indices, 
+  bool is_input
+)
+{
+  const auto& config = get_runtime_context().recorder_config;
+
+  msgpack_write_dict_array(msgpack, key, tensor_indices->size);
+
+  for(int i = 0; i < tensor_indices->size; ++i)
+  {
+    const int tensor_idx = tensor_indices->data[i];
+    if(tensor_idx < 0 || 
+      (config.tensor_filter != nullptr && !config.tensor_filter(op_idx, tensor_idx, is_input, config.filter_arg)))
+    {
+      msgpack_write_nil(msgpack);
+      continue;
+    }
+
+    const TfLiteTensor *tensor = context.GetTensor(&context, tensor_idx);
+    if(!config.metadata_only)
+    {
+      msgpack_write_bin(msgpack, tensor->data.raw, tensor->bytes);
+      continue;
+    }
+
+    const int n_dims = (tensor->dims != nullptr) ? tensor->dims->size : 0;
+    msgpack_write_dict_marker(msgpack, 3);
+    msgpack_write_dict_int(msgpack, "type", tensor->type);
+    msgpack_write_dict_uint(msgpack, "bytes", tensor->bytes);
+    msgpack_write_dict_array(msgpack, "shape", n_dims);
+    for(int d = 0; d < n_dims; ++d)
+    {
+      msgpack_write_int(msgpack, tensor->dims->data[d]);
+    }
+  }
+}
+
 /*************************************************************************************************/
 static int padding_to_tflite_schema(tflite::PaddingType padding)
 {
@@ -4,11 +4,52 @@
 #include "tensorflow/lite/kernels/internal/types.h"
 #include "cpputils/helpers.hpp"
 #include "msgpack.hpp"
+#include "mltk_tflite_micro_activation_stats.hpp"
 
 
 namespace mltk
 {
 
+/**
+ * @brief Tensor recorder configuration
+ *
+ * By default, each layer's record is appended to an in-memory msgpack array
+ * which is retrieved with @ref get_recorded_data() after inference.
+ *
+ * If a `writer` is given, then each layer's record is instead streamed to the writer
+ * as a separate, top-level msgpack dict as soon as the layer finishes executing.
+ * In this case, nothing is retained after the layer completes and @ref get_recorded_data() is unavailable.
+ *
+ * Each record is a dict containing:
+ * - index: The layer's index in the model
+ * - inputs: List of the layer's input tensors (if record_inputs=true)
+ * - outputs: List of the layer's output tensors (if record_outputs=true)
+ * - Any parameters recorded by the layer's kernel or accelerator
+ *
+ * Each tensor is recorded as its binary data, or if `metadata_only=true`, as a dict: {type, bytes, shape}.
+ * Tensors rejected by the `tensor_filter` are recorded as nil.
+ */
+struct TfliteMicroRecorderConfig
+{
+  /** Optional writer to stream each layer's record to, if null then the records are buffered in RAM */
+  msgpack_writer_t writer = nullptr;
+  /** Optional argument to pass to the writer */
+  void* writer_arg = nullptr;
+  /** Optional callback to select which layers are recorded, return true to record the layer */
+  bool (*layer_filter)(int op_idx, void* arg) = nullptr;
+  /** Optional callback to select which tensors are recorded, tensor_idx is the index of the tensor in the model */
+  bool (*tensor_filter)(int op_idx, int tensor_idx, bool is_input, void* arg) = nullptr;
+  /** Optional argument to pass to the filter callbacks */
+  void* filter_arg = nullptr;
+  /** Record the layer input tensors */
+  bool record_inputs = true;
+  /** Record the layer output tensors */
+  bool record_outputs = true;
+  /** Only record each tensor's type, size and shape, not its data */
+  bool metadata_only = false;
+};
+
+
 extern "C" 
 {
 
@@ -47,7 +88,8 @@ void record_layer(int op_idx, const TfLiteContext& context, const TfLiteNode &no
 
 #define TFLITE_MICRO_RESET_RECORDER() mltk::reset_recorder();
 #define TFLITE_MICRO_RECORD_INPUTS(op_idx, context, node) mltk::record_layer(op_idx, *context, *node, true);
-#define TFLITE_MICRO_RECORD_OUTPUTS(op_idx, context, node)  mltk::record_layer(op_idx, *context, *node, false);
+#define TFLITE_MICRO_RECORD_OUTPUTS(op_idx, context, node)  mltk::record_layer(op_idx, *context, *node, false); \
+   mltk::record_activation_stats(op_idx, *context, *node);
 #define TFLITE_MICRO_RECORD_CONV_PARAMS(op_params, per_channel_output_multiplier, per_channel_output_shift, n_channels) \
    mltk::record_layer_conv_params(op_params, per_channel_output_multiplier, per_channel_output_shift, n_channels)
 #define TFLITE_MICRO_RECORD_DEPTHWISE_CONV_PARAMS(op_params, per_channel_output_multiplier, per_channel_output_shift, n_channels) \
@@ -147,13 +147,21 @@ def process_single_arena_buffer_allocator_cc(lineno: int, line: str, arg: object
 
 
 def process_greedy_memory_planner_cc(lineno: int, line: str, arg: object) -> str:
+    # Remove any previously patched lines so they are re-generated below
     if arg['state'] == 0 and line.strip() == '// Patched by MLTK':
+        arg['previously_patched'] = True
+        return None
+    if arg['state'] == 0 and arg.get('previously_patched', False) and 'namespace tflite' not in line:
         return None
 
     if arg['state'] == 0 and 'namespace tflite' in line:
         arg['state'] = 1
         line = '// Patched by MLTK\n'
-        line += 'bool mltk_tflm_force_buffer_overlap = false;\n\n\n'
+        line += '#ifdef __arm__\n'
+        line += 'bool mltk_tflm_force_buffer_overlap = false;\n'
+        line += '#else\n'
+        line += 'thread_local bool mltk_tflm_force_buffer_overlap = false;\n'
+        line += '#endif\n\n\n'
         line += 'namespace tflite {\n'
         return line
 
@@ -165,6 +173,14 @@ def process_greedy_memory_planner_cc(lineno: int, line: str, arg: object) -> str
         line += '\n'
         line += '  // Patched by MLTK\n'
         line += '  if(mltk_tflm_force_buffer_overlap) return false;\n\n'
+        return line
+
+    # Remove the previously patched lines in DoesEntryOverlapInTime()
+    if arg['state'] == 3:
+        if line.strip() in ('// Patched by MLTK', 'if(mltk_tflm_force_buffer_overlap) return false;'):
+            return None
+        if line.strip():
+            arg['state'] = 4
 
     return line
 
@@ -0,0 +1,240 @@
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "mltk_tflite_micro_context.hpp"
+#include "mltk_tflite_micro_activation_stats.hpp"
+
+
+/**
+ * Verify the per-layer activation statistics collector
+ *
+ * Each test records the given values as the output tensor of a single layer
+ * the same way the TFLM interpreter does after the layer executes.
+ */
+namespace {
+
+
+constexpr uint32_t N_BINS = 64;
+
+
+TfLiteTensor output_tensor;
+
+TfLiteTensor* get_tensor(const TfLiteContext* context, int tensor_index)
+{
+    return &output_tensor;
+}
+
+
+class ActivationStats : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        ASSERT_TRUE(mltk::init_activation_stats(runtime_context, 1, N_BINS));
+        tflite_context.GetTensor = get_tensor;
+        node.outputs = reinterpret_cast<TfLiteIntArray*>(outputs_data);
+    }
+
+    void TearDown() override
+    {
+        mltk::deinit_activation_stats(runtime_context);
+    }
+
+    void record(std::vector<float>& values)
+    {
+        output_tensor = TfLiteTensor();
+        output_tensor.type = kTfLiteFloat32;
+        output_tensor.data.f = values.data();
+        output_tensor.bytes = values.size() * sizeof(float);
+        record_tensor();
+    }
+
+    void record(std::vector<int8_t>& values, float scale, int32_t zero_point)
+    {
+        output_tensor = TfLiteTensor();
+        output_tensor.type = kTfLiteInt8;
+        output_tensor.data.int8 = values.data();
+        output_tensor.bytes = values.size();
+        output_tensor.quantization.type = kTfLiteAffineQuantization;
+        output_tensor.params.scale = scale;
+        output_tensor.params.zero_point = zero_point;
+        record_tensor();
+    }
+
+    void record_tensor()
+    {
+        mltk::ScopedRuntimeContext scoped_context(&runtime_context);
+        mltk::record_activation_stats(0, tflite_context, node);
+    }
+
+    const mltk::TfliteMicroActivationStats& stats() const
+    {
+        return runtime_context.activation_stats->stats[0];
+    }
+
+    uint64_t histogram_total() const
+    {
+        uint64_t total = 0;
+        for(uint32_t i = 0; i < N_BINS; ++i)
+        {
+            total += stats().histogram[i];
+        }
+        return total;
+    }
+
+    // The first invocation's values fill the whole histogram,
+    // i.e. the range was not doubled
+    void expect_histogram_fills_range(float min_value, float max_value)
+    {
+        const auto& s = stats();
+        EXPECT_EQ(s.histogram_min, min_value);
+        EXPECT_GE(s.histogram_min + s.histogram_bin_width * N_BINS, max_value);
+        EXPECT_LE(s.histogram_bin_width, (max_value - min_value) / N_BINS * 1.0001f);
+        EXPECT_GT(s.histogram[0], 0U);
+        EXPECT_GT(s.histogram[N_BINS-1], 0U);
+        EXPECT_EQ(histogram_total(), s.count);
+    }
+
+    mltk::TfliteMicroRuntimeContext runtime_context;
+    TfLiteContext tflite_context = {};
+    TfLiteNode node = {};
+    int outputs_data[2] = {1, 0};
+};
+
+
+TEST_F(ActivationStats, FirstFloatInvocationFillsRange)
+{
+    const float ranges[][2] =
+    {
+        {0.0f, 1.0f},
+        {-1.0f, 1.0f},
+        {-3.7f, 12.9f},
+        {0.1f, 0.3f},
+        {-1000.0f, 25.5f},
+        {1e-6f, 3e-6f},
+    };
+
+    for(const auto& range : ranges)
+    {
+        SCOPED_TRACE(testing::Message() << range[0] << " to " << range[1]);
+        mltk::reset_activation_stats(runtime_context);
+
+        std::vector<float> values;
+        for(int i = 0; i < 1000; ++i)
+        {
+            values.push_back(range[0] + (range[1] - range[0]) * i / 999.0f);
+        }
+        values.back() = range[1];
+
+        record(values);
+        EXPECT_EQ(stats().min, range[0]);
+        EXPECT_EQ(stats().max, range[1]);
+        expect_histogram_fills_range(range[0], range[1]);
+    }
+}
+
+TEST_F(ActivationStats, FirstInt8InvocationFillsRange)
+{
+    std::vector<int8_t> values;
+    for(int i = -128; i <= 127; ++i)
+    {
+        values.push_back((int8_t)i);
+    }
+
+    const float scale = 0.0235294f;
+    const int32_t zero_point = -128;
+    record(values, scale, zero_point);
+
+    const float min_value = scale * (float)(-128 - zero_point);
+    const float max_value = scale * (float)(127 - zero_point);
+    EXPECT_EQ(stats().min, min_value);
+    EXPECT_EQ(stats().max, max_value);
+    expect_histogram_fills_range(min_value, max_value);
+
+    // Each bin holds 4 of the 256 values
+    for(uint32_t i = 0; i < N_BINS; ++i)
+    {
+        EXPECT_EQ(stats().histogram[i], 4U) << i;
+    }
+}
+
+TEST_F(ActivationStats, RangeIsDoubledForLargerValues)
+{
+    std::vector<float> values = {0.0f, 1.0f};
+    record(values);
+    const float bin_width = stats().histogram_bin_width;
+
+    // A value at the max of the current range does not expand the histogram
+    values = {0.5f, stats().histogram_min + bin_width * N_BINS};
+    record(values);
+    EXPECT_EQ(stats().histogram_bin_width, bin_width);
+
+    values = {1.5f};
+    record(values);
+    EXPECT_EQ(stats().histogram_bin_width, bin_width * 2);
+    EXPECT_EQ(stats().histogram_min, 0.0f);
+    EXPECT_EQ(histogram_total(), 5U);
+    EXPECT_EQ(stats().count, 5U);
+
+    values = {-0.5f};
+    record(values);
+    EXPECT_EQ(stats().histogram_bin_width, bin_width * 4);
+    EXPECT_LE(stats().histogram_min, -0.5f);
+    EXPECT_EQ(histogram_total(), 6U);
+}
+
+TEST_F(ActivationStats, NonFiniteValuesAreIgnored)
+{
+    const float inf = std::numeric_limits<float>::infinity();
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    std::vector<float> values = {nan, -inf, 1.0f, inf, 3.0f, nan, 2.0f, -inf};
+    record(values);
+
+    const auto& s = stats();
+    EXPECT_EQ(s.count, 3U);
+    EXPECT_EQ(s.min, 1.0f);
+    EXPECT_EQ(s.max, 3.0f);
+    EXPECT_DOUBLE_EQ(s.mean, 2.0);
+    EXPECT_DOUBLE_EQ(s.m2 / s.count, 2.0 / 3.0);
+    EXPECT_TRUE(std::isfinite(s.histogram_min));
+    EXPECT_TRUE(std::isfinite(s.histogram_bin_width));
+    expect_histogram_fills_range(1.0f, 3.0f);
+}
+
+TEST_F(ActivationStats, AllNonFiniteValuesAreIgnored)
+{
+    const float inf = std::numeric_limits<float>::infinity();
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    std::vector<float> values = {nan, inf, -inf};
+    record(values);
+
+    EXPECT_EQ(stats().count, 0U);
+    EXPECT_EQ(stats().histogram_bin_width, 0.0f);
+    EXPECT_EQ(histogram_total(), 0U);
+
+    // The next finite values set the range
+    values = {-2.0f, 2.0f};
+    record(values);
+    EXPECT_EQ(stats().count, 2U);
+    expect_histogram_fills_range(-2.0f, 2.0f);
+}
+
+TEST_F(ActivationStats, HugeRangeDoesNotOverflowBins)
+{
+    const float max = std::numeric_limits<float>::max();
+    std::vector<float> values = {-max, 0.0f, max};
+    record(values);
+    EXPECT_EQ(stats().count, 3U);
+    EXPECT_EQ(histogram_total(), 3U);
+
+    values = {-max, max, 1.0f};
+    record(values);
+    EXPECT_EQ(stats().count, 6U);
+    EXPECT_EQ(histogram_total(), 6U);
+}
+
+
+} // namespace
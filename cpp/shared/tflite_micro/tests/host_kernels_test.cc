@@ -0,0 +1,403 @@
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "tensorflow/lite/kernels/internal/quantization_util.h"
+#include "mltk_tflite_micro_host_kernels.hpp"
+
+
+/**
+ * Verify the host-optimized kernels are bit-exact with the TFLM reference_integer_ops kernels
+ *
+ * Each test executes a host kernel and the reference kernel with the same random
+ * inputs, weights and quantization parameters and compares the outputs.
+ */
+namespace {
+
+
+std::mt19937 rng(42);
+
+
+std::vector<int8_t> random_int8(size_t count)
+{
+    std::uniform_int_distribution<int> dist(-128, 127);
+    std::vector<int8_t> values(count);
+    for(auto& v : values)
+    {
+        v = static_cast<int8_t>(dist(rng));
+    }
+    return values;
+}
+
+std::vector<int32_t> random_bias(size_t count)
+{
+    std::uniform_int_distribution<int32_t> dist(-20000, 20000);
+    std::vector<int32_t> values(count);
+    for(auto& v : values)
+    {
+        v = dist(rng);
+    }
+    return values;
+}
+
+void random_multiplier(int32_t& multiplier, int32_t& shift)
+{
+    std::uniform_real_distribution<double> dist(0.0002, 0.02);
+    int exponent;
+    tflite::QuantizeMultiplier(dist(rng), &multiplier, &exponent);
+    shift = exponent;
+}
+
+// Return the index of the first element that differs, -1 if the outputs are equal
+int first_mismatch(const std::vector<int8_t>& expected, const std::vector<int8_t>& actual)
+{
+    for(size_t i = 0; i < expected.size(); ++i)
+    {
+        if(expected[i] != actual[i])
+        {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+int output_size(int input_size, int filter_size, int stride, int dilation, int padding)
+{
+    const int effective_filter_size = dilation * (filter_size - 1) + 1;
+    return (input_size + 2*padding - effective_filter_size) / stride + 1;
+}
+
+
+/*************************************************************************************************/
+struct ConvCase
+{
+    int batches;
+    int input_height, input_width, input_depth;
+    int output_depth;
+    int filter_height, filter_width;
+    int stride, dilation, padding;
+    int groups;
+    int32_t input_offset;
+    int32_t activation_min, activation_max;
+};
+
+class HostKernelsConv : public ::testing::TestWithParam<ConvCase> {};
+
+TEST_P(HostKernelsConv, BitExact)
+{
+    const auto& c = GetParam();
+    const int output_height = output_size(c.input_height, c.filter_height, c.stride, c.dilation, c.padding);
+    const int output_width = output_size(c.input_width, c.filter_width, c.stride, c.dilation, c.padding);
+    const int filter_input_depth = c.input_depth / c.groups;
+
+    const tflite::RuntimeShape input_shape({c.batches, c.input_height, c.input_width, c.input_depth});
+    const tflite::RuntimeShape filter_shape({c.output_depth, c.filter_height, c.filter_width, filter_input_depth});
+    const tflite::RuntimeShape bias_shape({c.output_depth});
+    const tflite::RuntimeShape output_shape({c.batches, output_height, output_width, c.output_depth});
+
+    const auto input = random_int8(input_shape.FlatSize());
+    const auto filter = random_int8(filter_shape.FlatSize());
+    const auto bias = random_bias(c.output_depth);
+    std::vector<int32_t> output_multiplier(c.output_depth);
+    std::vector<int32_t> output_shift(c.output_depth);
+    for(int i = 0; i < c.output_depth; ++i)
+    {
+        random_multiplier(output_multiplier[i], output_shift[i]);
+    }
+
+    tflite::ConvParams params = {};
+    params.padding_type = tflite::PaddingType::kSame;
+    params.padding_values.height = c.padding;
+    params.padding_values.width = c.padding;
+    params.stride_height = c.stride;
+    params.stride_width = c.stride;
+    params.dilation_height_factor = c.dilation;
+    params.dilation_width_factor = c.dilation;
+    params.input_offset = c.input_offset;
+    params.output_offset = -5;
+    params.quantized_activation_min = c.activation_min;
+    params.quantized_activation_max = c.activation_max;
+
+    std::vector<int8_t> expected(output_shape.FlatSize());
+    std::vector<int8_t> actual(output_shape.FlatSize());
+
+    tflite::reference_integer_ops::ConvPerChannel(
+        params, output_multiplier.data(), output_shift.data(),
+        input_shape, input.data(), filter_shape, filter.data(),
+        bias_shape, bias.data(), output_shape, expected.data()
+    );
+    mltk::host_kernels::ConvPerChannel(
+        params, output_multiplier.data(), output_shift.data(),
+        input_shape, input.data(), filter_shape, filter.data(),
+        bias_shape, bias.data(), output_shape, actual.data()
+    );
+
+    EXPECT_EQ(-1, first_mismatch(expected, actual));
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Shapes,
+    HostKernelsConv,
+    ::testing::Values(
+        // Pointwise
+        ConvCase{1, 8, 8, 16, 32, 1, 1, 1, 1, 0, 1, 128, -128, 127},
+        // 3x3 with padding
+        ConvCase{1, 10, 12, 8, 16, 3, 3, 1, 1, 1, 1, 128, -128, 127},
+        // Strided, multiple batches, ReLU6-like activation range
+        ConvCase{2, 15, 15, 3, 24, 3, 3, 2, 1, 1, 1, 3, -128, 50},
+        // Dilated
+        ConvCase{1, 16, 16, 4, 8, 3, 3, 1, 2, 2, 1, -7, -128, 127},
+        // Non-square filter, odd depths
+        ConvCase{1, 9, 7, 5, 7, 5, 2, 1, 1, 1, 1, 0, -128, 127},
+        // Input offset that does not fit the ruy zero point (reference fallback)
+        ConvCase{1, 6, 6, 4, 4, 3, 3, 1, 1, 1, 1, -128, -128, 127},
+        // Grouped convolution (reference fallback)
+        ConvCase{1, 6, 6, 8, 8, 3, 3, 1, 1, 1, 2, 128, -128, 127}
+    )
+);
+
+
+/*************************************************************************************************/
+struct DepthwiseConvCase
+{
+    int batches;
+    int input_height, input_width, input_depth;
+    int depth_multiplier;
+    int filter_height, filter_width;
+    int stride, dilation, padding;
+    int32_t input_offset;
+    int32_t activation_min, activation_max;
+};
+
+class HostKernelsDepthwiseConv : public ::testing::TestWithParam<DepthwiseConvCase> {};
+
+TEST_P(HostKernelsDepthwiseConv, BitExact)
+{
+    const auto& c = GetParam();
+    const int output_depth = c.input_depth * c.depth_multiplier;
+    const int output_height = output_size(c.input_height, c.filter_height, c.stride, c.dilation, c.padding);
+    const int output_width = output_size(c.input_width, c.filter_width, c.stride, c.dilation, c.padding);
+
+    const tflite::RuntimeShape input_shape({c.batches, c.input_height, c.input_width, c.input_depth});
+    const tflite::RuntimeShape filter_shape({1, c.filter_height, c.filter_width, output_depth});
+    const tflite::RuntimeShape bias_shape({output_depth});
+    const tflite::RuntimeShape output_shape({c.batches, output_height, output_width, output_depth});
+
+    const auto input = random_int8(input_shape.FlatSize());
+    const auto filter = random_int8(filter_shape.FlatSize());
+    const auto bias = random_bias(output_depth);
+    std::vector<int32_t> output_multiplier(output_depth);
+    std::vector<int32_t> output_shift(output_depth);
+    for(int i = 0; i < output_depth; ++i)
+    {
+        random_multiplier(output_multiplier[i], output_shift[i]);
+    }
+
+    tflite::DepthwiseParams params = {};
+    params.padding_type = tflite::PaddingType::kSame;
+    params.padding_values.height = c.padding;
+    params.padding_values.width = c.padding;
+    params.stride_height = c.stride;
+    params.stride_width = c.stride;
+    params.dilation_height_factor = c.dilation;
+    params.dilation_width_factor = c.dilation;
+    params.depth_multiplier = c.depth_multiplier;
+    params.input_offset = c.input_offset;
+    params.output_offset = 9;
+    params.quantized_activation_min = c.activation_min;
+    params.quantized_activation_max = c.activation_max;
+
+    std::vector<int8_t> expected(output_shape.FlatSize());
+    std::vector<int8_t> actual(output_shape.FlatSize());
+
+    tflite::reference_integer_ops::DepthwiseConvPerChannel(
+        params, output_multiplier.data(), output_shift.data(),
+        input_shape, input.data(), filter_shape, filter.data(),
+        bias_shape, bias.data(), output_shape, expected.data()
+    );
+    mltk::host_kernels::DepthwiseConvPerChannel(
+        params, output_multiplier.data(), output_shift.data(),
+        input_shape, input.data(), filter_shape, filter.data(),
+        bias_shape, bias.data(), output_shape, actual.data()
+    );
+
+    EXPECT_EQ(-1, first_mismatch(expected, actual));
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Shapes,
+    HostKernelsDepthwiseConv,
+    ::testing::Values(
+        DepthwiseConvCase{1, 10, 10, 16, 1, 3, 3, 1, 1, 1, 128, -128, 127},
+        DepthwiseConvCase{2, 11, 9, 8, 1, 3, 3, 2, 1, 1, 3, -128, 40},
+        DepthwiseConvCase{1, 8, 8, 4, 2, 3, 3, 1, 1, 1, 128, -128, 127},
+        DepthwiseConvCase{1, 12, 12, 3, 3, 5, 5, 1, 2, 4, -128, -128, 127},
+        DepthwiseConvCase{1, 7, 13, 6, 1, 1, 4, 1, 1, 0, 0, -128, 127}
+    )
+);
+
+
+/*************************************************************************************************/
+struct FullyConnectedCase
+{
+    int batches;
+    int input_depth;
+    int output_depth;
+    int32_t input_offset;
+    int32_t weights_offset;
+    int32_t activation_min, activation_max;
+};
+
+class HostKernelsFullyConnected : public ::testing::TestWithParam<FullyConnectedCase> {};
+
+void run_fully_connected(const FullyConnectedCase& c, const std::vector<int8_t>& filter)
+{
+    const tflite::RuntimeShape input_shape({c.batches, c.input_depth});
+    const tflite::RuntimeShape filter_shape({c.output_depth, c.input_depth});
+    const tflite::RuntimeShape bias_shape({c.output_depth});
+    const tflite::RuntimeShape output_shape({c.batches, c.output_depth});
+
+    const auto input = random_int8(input_shape.FlatSize());
+    const auto bias = random_bias(c.output_depth);
+
+    tflite::FullyConnectedParams params = {};
+    params.input_offset = c.input_offset;
+    params.weights_offset = c.weights_offset;
+    params.output_offset = -3;
+    random_multiplier(params.output_multiplier, params.output_shift);
+    params.quantized_activation_min = c.activation_min;
+    params.quantized_activation_max = c.activation_max;
+
+    std::vector<int8_t> expected(output_shape.FlatSize());
+    std::vector<int8_t> actual(output_shape.FlatSize());
+
+    tflite::reference_integer_ops::FullyConnected(
+        params, input_shape, input.data(), filter_shape, filter.data(),
+        bias_shape, bias.data(), output_shape, expected.data()
+    );
+    mltk::host_kernels::FullyConnected(
+        params, input_shape, input.data(), filter_shape, filter.data(),
+        bias_shape, bias.data(), output_shape, actual.data()
+    );
+
+    EXPECT_EQ(-1, first_mismatch(expected, actual));
+}
+
+TEST_P(HostKernelsFullyConnected, BitExact)
+{
+    const auto& c = GetParam();
+    run_fully_connected(c, random_int8((size_t)c.output_depth * c.input_depth));
+}
+
+// A new filter at the same address as a previous filter
+// (e.g. a model loaded after another model was unloaded) must not use the previous filter
+TEST_P(HostKernelsFullyConnected, FilterReloadedAtSameAddress)
+{
+    const auto& c = GetParam();
+    std::vector<int8_t> filter = random_int8((size_t)c.output_depth * c.input_depth);
+    run_fully_connected(c, filter);
+
+    const auto new_filter = random_int8(filter.size());
+    std::copy(new_filter.begin(), new_filter.end(), filter.begin());
+    run_fully_connected(c, filter);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Shapes,
+    HostKernelsFullyConnected,
+    ::testing::Values(
+        FullyConnectedCase{1, 64, 10, 128, 0, -128, 127},
+        FullyConnectedCase{4, 33, 17, 5, 0, -128, 60},
+        FullyConnectedCase{1, 1024, 256, 128, 0, -128, 127},
+        FullyConnectedCase{3, 20, 12, 128, 7, -128, 127},
+        // Offsets that do not fit the ruy zero points (reference fallback)
+        FullyConnectedCase{2, 16, 8, -128, 0, -128, 127},
+        FullyConnectedCase{2, 16, 8, 0, -128, -128, 127}
+    )
+);
+
+
+/*************************************************************************************************/
+struct PoolCase
+{
+    int batches;
+    int input_height, input_width, depth;
+    int filter_height, filter_width;
+    int stride, padding;
+    int32_t activation_min, activation_max;
+};
+
+class HostKernelsPool : public ::testing::TestWithParam<PoolCase>
+{
+protected:
+    void SetUp() override
+    {
+        const auto& c = GetParam();
+        const int output_height = output_size(c.input_height, c.filter_height, c.stride, 1, c.padding);
+        const int output_width = output_size(c.input_width, c.filter_width, c.stride, 1, c.padding);
+
+        input_shape = tflite::RuntimeShape({c.batches, c.input_height, c.input_width, c.depth});
+        output_shape = tflite::RuntimeShape({c.batches, output_height, output_width, c.depth});
+        input = random_int8(input_shape.FlatSize());
+        expected.resize(output_shape.FlatSize());
+        actual.resize(output_shape.FlatSize());
+
+        params = {};
+        params.padding_type = tflite::PaddingType::kSame;
+        params.padding_values.height = c.padding;
+        params.padding_values.width = c.padding;
+        params.stride_height = c.stride;
+        params.stride_width = c.stride;
+        params.filter_height = c.filter_height;
+        params.filter_width = c.filter_width;
+        params.quantized_activation_min = c.activation_min;
+        params.quantized_activation_max = c.activation_max;
+    }
+
+    tflite::PoolParams params;
+    tflite::RuntimeShape input_shape;
+    tflite::RuntimeShape output_shape;
+    std::vector<int8_t> input;
+    std::vector<int8_t> expected;
+    std::vector<int8_t> actual;
+};
+
+TEST_P(HostKernelsPool, AveragePoolBitExact)
+{
+    const bool expected_status = tflite::reference_integer_ops::AveragePool(
+        params, input_shape, input.data(), output_shape, expected.data()
+    );
+    const bool actual_status = mltk::host_kernels::AveragePool(
+        params, input_shape, input.data(), output_shape, actual.data()
+    );
+
+    ASSERT_EQ(expected_status, actual_status);
+    EXPECT_EQ(-1, first_mismatch(expected, actual));
+}
+
+TEST_P(HostKernelsPool, MaxPoolBitExact)
+{
+    tflite::reference_integer_ops::MaxPool(
+        params, input_shape, input.data(), output_shape, expected.data()
+    );
+    mltk::host_kernels::MaxPool(
+        params, input_shape, input.data(), output_shape, actual.data()
+    );
+
+    EXPECT_EQ(-1, first_mismatch(expected, actual));
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Shapes,
+    HostKernelsPool,
+    ::testing::Values(
+        PoolCase{1, 8, 8, 16, 2, 2, 2, 0, -128, 127},
+        PoolCase{2, 9, 11, 5, 3, 3, 2, 1, -128, 127},
+        PoolCase{1, 7, 7, 8, 7, 7, 1, 0, -128, 127},
+        PoolCase{1, 10, 6, 3, 3, 2, 1, 1, -20, 30}
+    )
+);
+
+
+} // namespace
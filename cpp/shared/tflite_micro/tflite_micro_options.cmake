@@ -28,3 +28,15 @@ mltk_define(TFLITE_MICRO_EXCLUDED_REF_KERNELS
 mltk_define(TFLITE_MICRO_SIMULATOR_ENABLED
 "Enable the accelerator simulator"
 )
+
+mltk_define(TFLITE_MICRO_MVP_ANALYTIC_ESTIMATOR_ENABLED
+"Estimate the MVP accelerator cycles with an analytic cost model instead of the MVP simulator library on Windows/Linux"
+)
+
+mltk_define(TFLITE_MICRO_MVP_PROGRAM_CACHE_MAX_PROGRAMS
+"Maximum number of MVP programs cached per Conv2D layer, each uses about 280 bytes of the tensor arena (default: 0, disabled)"
+)
+
+mltk_define(TFLITE_MICRO_HOST_KERNELS_ENABLED
+"Use the ruy-based host-optimized int8 kernels on Windows/Linux (default: ON)"
+)
@@ -0,0 +1,165 @@
+#include <cstdlib>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "flatbuffers/flatbuffers.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+#include "tensorflow/lite/micro/micro_mutable_op_resolver.h"
+#include "tflite_micro_model/tflite_micro_model.hpp"
+
+
+namespace {
+
+
+constexpr int RUNTIME_BUFFER_ALIGNMENT = 16;
+
+
+// Build a float model with a stack of FULLY_CONNECTED layers
+// with the given layer widths, the first width is the model input
+void build_model(flatbuffers::FlatBufferBuilder& fbb, const std::vector<int32_t>& widths)
+{
+    std::vector<flatbuffers::Offset<tflite::Buffer>> buffers;
+    std::vector<flatbuffers::Offset<tflite::Tensor>> tensors;
+    std::vector<flatbuffers::Offset<tflite::Operator>> operators;
+
+    // Buffer 0 is the empty buffer used by the non-constant tensors
+    buffers.push_back(tflite::CreateBuffer(fbb));
+
+    auto add_tensor = [&](const std::vector<int32_t>& shape, uint32_t buffer) -> int32_t
+    {
+        tensors.push_back(tflite::CreateTensor(
+            fbb,
+            fbb.CreateVector(shape),
+            tflite::TensorType_FLOAT32,
+            buffer
+        ));
+        return (int32_t)tensors.size() - 1;
+    };
+    auto add_constant_tensor = [&](const std::vector<int32_t>& shape, int32_t element_count) -> int32_t
+    {
+        const std::vector<float> values(element_count, 0.5f);
+        buffers.push_back(tflite::CreateBuffer(
+            fbb,
+            fbb.CreateVector(reinterpret_cast<const uint8_t*>(values.data()), values.size()*sizeof(float))
+        ));
+        return add_tensor(shape, buffers.size() - 1);
+    };
+
+    const int32_t input_index = add_tensor({1, widths[0]}, 0);
+    int32_t layer_input_index = input_index;
+    for(size_t i = 1; i < widths.size(); ++i)
+    {
+        const int32_t weights_index = add_constant_tensor({widths[i], widths[i-1]}, widths[i]*widths[i-1]);
+        const int32_t bias_index = add_constant_tensor({widths[i]}, widths[i]);
+        const int32_t output_index = add_tensor({1, widths[i]}, 0);
+        const std::vector<int32_t> inputs = {layer_input_index, weights_index, bias_index};
+        const std::vector<int32_t> outputs = {output_index};
+
+        operators.push_back(tflite::CreateOperator(
+            fbb,
+            0,
+            fbb.CreateVector(inputs),
+            fbb.CreateVector(outputs),
+            tflite::BuiltinOptions_FullyConnectedOptions,
+            tflite::CreateFullyConnectedOptions(fbb).Union()
+        ));
+        layer_input_index = output_index;
+    }
+
+    const std::vector<int32_t> subgraph_inputs = {input_index};
+    const std::vector<int32_t> subgraph_outputs = {layer_input_index};
+    const auto subgraph = tflite::CreateSubGraph(
+        fbb,
+        fbb.CreateVector(tensors),
+        fbb.CreateVector(subgraph_inputs),
+        fbb.CreateVector(subgraph_outputs),
+        fbb.CreateVector(operators)
+    );
+    const auto opcode = tflite::CreateOperatorCode(
+        fbb,
+        static_cast<int8_t>(tflite::BuiltinOperator_FULLY_CONNECTED),
+        0,
+        1,
+        tflite::BuiltinOperator_FULLY_CONNECTED
+    );
+
+    const std::vector<flatbuffers::Offset<tflite::OperatorCode>> opcodes = {opcode};
+    const std::vector<flatbuffers::Offset<tflite::SubGraph>> subgraphs = {subgraph};
+    const auto model = tflite::CreateModel(
+        fbb,
+        TFLITE_SCHEMA_VERSION,
+        fbb.CreateVector(opcodes),
+        fbb.CreateVector(subgraphs),
+        fbb.CreateString("runtime_buffer_size_test"),
+        fbb.CreateVector(buffers)
+    );
+    tflite::FinishModelBuffer(fbb, model);
+}
+
+
+class RuntimeBufferSize : public ::testing::TestWithParam<std::vector<int32_t>>
+{
+protected:
+    void SetUp() override
+    {
+        op_resolver.AddFullyConnected();
+    }
+
+    tflite::MicroMutableOpResolver<1> op_resolver;
+};
+
+
+// The size found by find_optimal_buffer_size() loads the model
+// and the next smaller size does not
+TEST_P(RuntimeBufferSize, OptimalSizeIsMinimal)
+{
+    flatbuffers::FlatBufferBuilder fbb;
+    build_model(fbb, GetParam());
+    const void* flatbuffer = fbb.GetBufferPointer();
+
+    mltk::TfliteMicroModel model;
+    unsigned buffer_size = 0;
+    ASSERT_TRUE(model.find_optimal_buffer_size(flatbuffer, op_resolver, buffer_size));
+    ASSERT_GT(buffer_size, (unsigned)RUNTIME_BUFFER_ALIGNMENT);
+    EXPECT_EQ(buffer_size % RUNTIME_BUFFER_ALIGNMENT, 0);
+
+    uint8_t* buffer = static_cast<uint8_t*>(malloc(buffer_size));
+    ASSERT_NE(buffer, nullptr);
+
+    EXPECT_TRUE(model.load(flatbuffer, op_resolver, buffer, buffer_size));
+    model.unload();
+
+    EXPECT_FALSE(model.load(flatbuffer, op_resolver, buffer, buffer_size - RUNTIME_BUFFER_ALIGNMENT));
+    model.unload();
+
+    free(buffer);
+}
+
+// The model cannot be loaded while searching for its size
+TEST_P(RuntimeBufferSize, LoadedModelFails)
+{
+    flatbuffers::FlatBufferBuilder fbb;
+    build_model(fbb, GetParam());
+    const void* flatbuffer = fbb.GetBufferPointer();
+
+    mltk::TfliteMicroModel model;
+    ASSERT_TRUE(model.load(flatbuffer, op_resolver));
+
+    unsigned buffer_size = 0;
+    EXPECT_FALSE(model.find_optimal_buffer_size(flatbuffer, op_resolver, buffer_size));
+    EXPECT_TRUE(model.is_loaded());
+}
+
+
+INSTANTIATE_TEST_SUITE_P(
+    Models,
+    RuntimeBufferSize,
+    ::testing::Values(
+        std::vector<int32_t>{8, 4},
+        std::vector<int32_t>{32, 64, 16},
+        std::vector<int32_t>{256, 1024, 512, 10}
+    )
+);
+
+
+} // namespace
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+
+#include "cpputils/typed_list.hpp"
+
+
+namespace mltk
+{
+
+/**
+ * @brief Tensor arena region saved in a @ref TfliteMicroArenaSnapshot
+ */
+struct TfliteMicroArenaSnapshotRegion
+{
+    /** Index of the tensor in the model */
+    int32_t tensor_index;
+    /** Offset of the tensor from the start of the tensor arena */
+    uint32_t offset;
+    /** Size of the tensor in bytes */
+    uint32_t size;
+};
+
+
+/**
+ * @brief Snapshot of the live tensors in the tensor arena at a layer boundary
+ *
+ * This contains the arena contents of the tensors that are live before the layer
+ * at @ref op_index executes, i.e. the tensors written by a previous layer (or the model inputs)
+ * that are read by this layer or a later layer, and the variable tensors.
+ *
+ * Restoring the snapshot then invoking the layers from @ref op_index
+ * gives the same result as invoking the whole model, so a shared model prefix
+ * can be computed once and many suffixes evaluated from it.
+ *
+ * See @ref TfliteMicroModel::snapshot_arena() and @ref TfliteMicroModel::restore_arena()
+ */
+struct TfliteMicroArenaSnapshot
+{
+    /** Index of the layer that executes next when the snapshot is restored, -1 if the snapshot is empty */
+    int32_t op_index = -1;
+    /** The saved tensor regions */
+    cpputils::TypedList<TfliteMicroArenaSnapshotRegion> regions;
+    /** Contents of the regions, stored in the same order as the regions */
+    uint8_t* data = nullptr;
+    /** Size of the data in bytes */
+    uint32_t size = 0;
+
+    TfliteMicroArenaSnapshot() = default;
+    TfliteMicroArenaSnapshot(const TfliteMicroArenaSnapshot&) = delete;
+    TfliteMicroArenaSnapshot& operator=(const TfliteMicroArenaSnapshot&) = delete;
+
+    ~TfliteMicroArenaSnapshot()
+    {
+        clear();
+    }
+
+    /**
+     * Free the snapshot data
+     */
+    void clear()
+    {
+        free(data);
+        data = nullptr;
+        size = 0;
+        op_index = -1;
+        regions.clear();
+    }
+};
+
+
+} // namespace mltk
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+
+#include "cpputils/typed_list.hpp"
+
+
+namespace mltk
+{
+
+/**
+ * @brief Type of a buffer in the tensor arena
+ */
+enum class TfliteMicroMemoryPlanBufferType : uint8_t
+{
+    /** Intermediate tensor, its memory is planned in the arena head and shared with other buffers that are not used at the same time */
+    Activation,
+    /** Model input tensor, planned in the arena head */
+    Input,
+    /** Model output tensor, planned in the arena head */
+    Output,
+    /** Kernel scratch buffer, planned in the arena head and only used by the requesting layer */
+    Scratch,
+    /** Tensor (e.g. variable tensor) allocated in the arena tail for the lifetime of the model */
+    Persistent,
+};
+
+
+/**
+ * @brief Buffer in the tensor arena memory plan
+ */
+struct TfliteMicroMemoryPlanBuffer
+{
+    /** Type of buffer */
+    TfliteMicroMemoryPlanBufferType type;
+    /** Tensor index in the model, or for scratch buffers, the scratch buffer index */
+    int32_t index;
+    /** For scratch buffers, the index of the layer that requested the buffer, -1 otherwise */
+    int32_t op_index;
+    /** Offset of the buffer from the start of the tensor arena */
+    uint32_t offset;
+    /** Size of the buffer in bytes */
+    uint32_t size;
+    /** Index of the first layer that uses the buffer */
+    int32_t first_use;
+    /** Index of the last layer that uses the buffer */
+    int32_t last_use;
+};
+
+
+/**
+ * @brief Tensor arena memory plan
+ *
+ * The tensor arena is split into:
+ * - head: the planned (i.e. overlapping) activation, input/output and scratch buffers
+ * - tail: the buffers that persist for the lifetime of the model, this includes the TFLM runtime structures
+ *
+ * @note On 64-bit hosts, the tail is larger than on a 32-bit MCU due to the larger pointers in the TFLM runtime structures
+ */
+struct TfliteMicroMemoryPlan
+{
+    /** Size of the tensor arena buffer given to the interpreter */
+    uint32_t arena_size = 0;
+    /** Number of bytes used by the arena head */
+    uint32_t head_size = 0;
+    /** Number of bytes used by the arena tail */
+    uint32_t tail_size = 0;
+    /** The tensor and scratch buffers in the arena */
+    cpputils::TypedList<TfliteMicroMemoryPlanBuffer> buffers;
+};
+
+
+/**
+ * Return the given buffer type as a string
+ */
+static inline const char* to_str(TfliteMicroMemoryPlanBufferType type)
+{
+    switch(type)
+    {
+    case TfliteMicroMemoryPlanBufferType::Activation: return "activation";
+    case TfliteMicroMemoryPlanBufferType::Input: return "input";
+    case TfliteMicroMemoryPlanBufferType::Output: return "output";
+    case TfliteMicroMemoryPlanBufferType::Scratch: return "scratch";
+    case TfliteMicroMemoryPlanBufferType::Persistent: return "persistent";
+    default: return "unknown";
+    }
+}
+
+
+} // namespace mltk
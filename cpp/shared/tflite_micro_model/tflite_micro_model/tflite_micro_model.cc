@@ -1,8 +1,11 @@
 #include <new>
 #include <cstdlib>
+#include <cstring>
+#include <algorithm>
 #include "em_device.h"
 
 #include "tensorflow/lite/schema/schema_generated.h"
+#include "tensorflow/lite/micro/memory_helpers.h"
 #include "cpputils/string.hpp"
 #include "tflite_micro_model/tflite_micro_model.hpp"
 #include "tflite_micro_model/tflite_micro_utils.hpp"
@@ -13,6 +16,8 @@
 
 #ifdef __arm__
 extern "C" uint32_t __heap_size;
+#else
+#include <mutex>
 #endif
 
 namespace mltk
@@ -25,6 +30,28 @@ int adjust_required_tensor_arena_bytes_from_64bit_to_32bit(
 );
 
 
+// The runtime buffer sizes tried by search_optimal_buffer_size() are multiples of this
+static constexpr int RUNTIME_BUFFER_ALIGNMENT = 16;
+
+
+#ifndef __arm__
+/**
+ * Serialize loading and unloading models across threads.
+ * This is necessary as the profiler registry is process-wide.
+ * Invoking models does not require this lock.
+ * NOTE: The lock may be re-acquired by the same thread (e.g. load() calls unload() on failure)
+ */
+static std::recursive_mutex _load_lock;
+
+struct ScopedLoadLock
+{
+    std::lock_guard<std::recursive_mutex> guard{_load_lock};
+};
+#else 
+struct ScopedLoadLock {};
+#endif
+
+
 /*************************************************************************************************/
 TfliteMicroModel::~TfliteMicroModel()
 {
@@ -47,7 +74,13 @@ bool TfliteMicroModel::load(
         MLTK_INFO("Using Tensorflow-Lite Micro version: %s", TFLITE_MICRO_VERSION);
     }
 
-    auto accelerator = mltk_tflite_micro_get_registered_accelerator();
+    // The model uses whichever accelerator is registered at load time
+    // for the rest of its lifetime
+    _runtime_context.accelerator = mltk_tflite_micro_get_registered_accelerator();
+    ScopedLoadLock load_lock;
+    ScopedRuntimeContext runtime_context_scope(&_runtime_context);
+
+    auto accelerator = _runtime_context.accelerator;
     if(accelerator != nullptr)
     {
         accelerator->init();
@@ -144,7 +177,7 @@ bool TfliteMicroModel::load(
         if(runtime_buffer == nullptr)
         {
             // Find the optimal buffer size
-            if(!find_optimal_buffer_size(flatbuffer, op_resolver, runtime_buffer_size))
+            if(!search_optimal_buffer_size(flatbuffer, op_resolver, runtime_buffer_size))
             {
                 // On failure, just return
                 MLTK_ERROR("Failed to allocate buffer for model (likely heap memory overflow)");
@@ -152,6 +185,9 @@ bool TfliteMicroModel::load(
                 return false;
             }
 
+            // Add some additional memory for any padding or invoking the context.GetTensor() APIs.
+            runtime_buffer_size += 256;
+
             allocated_buffer_size = runtime_buffer_size;
 
 #if INTPTR_MAX == INT64_MAX
@@ -165,7 +201,7 @@ bool TfliteMicroModel::load(
             runtime_buffer = static_cast<uint8_t*>(malloc(allocated_buffer_size));
             if(runtime_buffer == nullptr)
             {
-                // If this fails, something is wrong with find_optimal_buffer_size() 
+                // If this fails, something is wrong with search_optimal_buffer_size() 
                 MLTK_WARN("Failed to allocate buffer with size: %d", allocated_buffer_size);
                 unload();
                 return false;
@@ -173,7 +209,7 @@ bool TfliteMicroModel::load(
             // Load the model with the buffer
             else if(!load_interpreter(flatbuffer, op_resolver, runtime_buffer, allocated_buffer_size))
             {
-                // If this fails, something is wrong with find_optimal_buffer_size() 
+                // If this fails, something is wrong with search_optimal_buffer_size() 
                 MLTK_WARN("Failed to allocate buffer with size: %d", allocated_buffer_size);
                 unload();
                 return false;
@@ -231,7 +267,9 @@ bool TfliteMicroModel::load(
 /*************************************************************************************************/
 void TfliteMicroModel::unload()
 {
-    auto accelerator = mltk_tflite_micro_get_registered_accelerator();
+    ScopedLoadLock load_lock;
+    ScopedRuntimeContext runtime_context_scope(&_runtime_context);
+    auto accelerator = _runtime_context.accelerator;
 
     if(accelerator != nullptr)
     {
@@ -240,9 +278,14 @@ void TfliteMicroModel::unload()
 
     _flatbuffer = nullptr;
     _ops_resolver = nullptr;
+    _arena_buffer = nullptr;
+    _arena_buffer_size = 0;
     parameters.unload();
     _model_details.unload();
     TFLITE_MICRO_RESET_RECORDER();
+    free_scratch_buffer_requests();
+    deinit_activation_stats(_runtime_context);
+    deinit_differential_execution(_runtime_context);
     if(_interpreter != nullptr)
     {
         _interpreter->~MicroInterpreter();
@@ -266,7 +309,7 @@ bool TfliteMicroModel::is_loaded() const
 bool TfliteMicroModel::invoke() const
 {
     bool retval;
-    auto accelerator = mltk_tflite_micro_get_registered_accelerator();
+    auto accelerator = _runtime_context.accelerator;
 
     if(!is_loaded())
     {
@@ -274,6 +317,8 @@ bool TfliteMicroModel::invoke() const
         return false;
     }
 
+    ScopedRuntimeContext runtime_context_scope(&_runtime_context);
+
     TFLITE_MICRO_RESET_RECORDER();
     
     if(profiler_is_enabled())
@@ -281,14 +326,14 @@ bool TfliteMicroModel::invoke() const
         profiling::reset(this->profiler());
     }
 
-    mltk::_processing_callback = this->_processing_callback;
-    mltk::_processing_callback_arg = this->_processing_callback_arg;
-
 #ifdef TFLITE_MICRO_SIMULATOR_ENABLED
     if(accelerator != nullptr)
     {
         retval = accelerator->invoke_simulator([this]() -> bool
         {
+            // The simulator may execute this on a different thread
+            // so ensure this model's context is active
+            ScopedRuntimeContext runtime_context_scope(&_runtime_context);
             return _interpreter->Invoke() == kTfLiteOk;
         });
     }
@@ -300,8 +345,51 @@ bool TfliteMicroModel::invoke() const
     retval = (_interpreter->Invoke() == kTfLiteOk);
 #endif
 
-    mltk::_processing_callback = nullptr;
-    mltk::_processing_callback_arg = nullptr;
+    return retval;
+}
+
+/*************************************************************************************************/
+bool TfliteMicroModel::invoke_range(int first_op, int last_op) const
+{
+    bool retval;
+    auto accelerator = _runtime_context.accelerator;
+
+    if(!is_loaded())
+    {
+        MLTK_ERROR("Model not loaded");
+        return false;
+    }
+
+    if(last_op == -1)
+    {
+        last_op = tflite::GetModel(_flatbuffer)->subgraphs()->Get(0)->operators()->size() - 1;
+    }
+
+    ScopedRuntimeContext runtime_context_scope(&_runtime_context);
+
+    TFLITE_MICRO_RESET_RECORDER();
+    
+    if(profiler_is_enabled())
+    {
+        profiling::reset(this->profiler());
+    }
+
+#ifdef TFLITE_MICRO_SIMULATOR_ENABLED
+    if(accelerator != nullptr)
+    {
+        retval = accelerator->invoke_simulator([this, first_op, last_op]() -> bool
+        {
+            ScopedRuntimeContext runtime_context_scope(&_runtime_context);
+            return invoke_subgraph_range(*_interpreter, first_op, last_op) == kTfLiteOk;
+        });
+    }
+    else
+    {
+        retval = (invoke_subgraph_range(*_interpreter, first_op, last_op) == kTfLiteOk);
+    }
+#else 
+    retval = (invoke_subgraph_range(*_interpreter, first_op, last_op) == kTfLiteOk);
+#endif
 
     return retval;
 }
@@ -419,7 +507,7 @@ bool TfliteMicroModel::enable_profiler()
         MLTK_ERROR("Model already loaded");
         return false;
     }
-    model_profiler_enabled = true;
+    _runtime_context.profiler_enabled = true;
     return true;
 #else
     MLTK_ERROR("C++ library not build with profiling support");
@@ -430,13 +518,13 @@ bool TfliteMicroModel::enable_profiler()
 /*************************************************************************************************/
 bool TfliteMicroModel::profiler_is_enabled() const
 {
-    return model_profiler_enabled;
+    return _runtime_context.profiler_enabled;
 }
 
 /*************************************************************************************************/
 profiling::Profiler* TfliteMicroModel::profiler() const
 {
-    return profiling::get("Inference");
+    return _runtime_context.inference_profiler;
 }
 
 /*************************************************************************************************/
@@ -448,7 +536,7 @@ bool TfliteMicroModel::enable_tensor_recorder()
         MLTK_ERROR("Model already loaded");
         return false;
     }
-    model_tensor_recorder_enabled = true;
+    _runtime_context.tensor_recorder_enabled = true;
     return true;
 #else
     MLTK_ERROR("C++ library not build with recording support");
@@ -459,22 +547,134 @@ bool TfliteMicroModel::enable_tensor_recorder()
 /*************************************************************************************************/
 bool TfliteMicroModel::is_tensor_recorder_enabled() const
 {
-    return model_tensor_recorder_enabled;
+    return _runtime_context.tensor_recorder_enabled;
+}
+
+/*************************************************************************************************/
+bool TfliteMicroModel::set_tensor_recorder_config(const TfliteMicroRecorderConfig& config)
+{
+#if TFLITE_MICRO_RECORDER_ENABLED
+    ScopedRuntimeContext runtime_context_scope(&_runtime_context);
+    // Discard any data recorded with the previous config
+    reset_recorder();
+    _runtime_context.recorder_config = config;
+    return true;
+#else
+    MLTK_ERROR("C++ library not build with recording support");
+    return false;
+#endif
 }
 
 /*************************************************************************************************/
 #ifdef TFLITE_MICRO_RECORDER_ENABLED
 bool TfliteMicroModel::recorded_data(const uint8_t** buffer_ptr, uint32_t* length_ptr) const
 {
+    ScopedRuntimeContext runtime_context_scope(&_runtime_context);
     return get_recorded_data(buffer_ptr, length_ptr);
 }
 #endif
 
+/*************************************************************************************************/
+bool TfliteMicroModel::enable_activation_stats(uint32_t n_bins)
+{
+#if TFLITE_MICRO_RECORDER_ENABLED
+    if(!is_loaded())
+    {
+        MLTK_ERROR("Model not loaded");
+        return false;
+    }
+
+    const auto tflite_model = tflite::GetModel(_flatbuffer);
+    const int tensor_count = tflite_model->subgraphs()->Get(0)->tensors()->size();
+    if(!init_activation_stats(_runtime_context, tensor_count, n_bins))
+    {
+        MLTK_ERROR("Failed to allocate activation stats");
+        return false;
+    }
+    return true;
+#else
+    MLTK_ERROR("C++ library not build with recording support");
+    return false;
+#endif
+}
+
+/*************************************************************************************************/
+void TfliteMicroModel::disable_activation_stats()
+{
+    deinit_activation_stats(_runtime_context);
+}
+
+/*************************************************************************************************/
+bool TfliteMicroModel::is_activation_stats_enabled() const
+{
+    return _runtime_context.activation_stats != nullptr;
+}
+
+/*************************************************************************************************/
+void TfliteMicroModel::reset_activation_stats()
+{
+    mltk::reset_activation_stats(_runtime_context);
+}
+
+/*************************************************************************************************/
+const TfliteMicroActivationStatsCollector* TfliteMicroModel::activation_stats() const
+{
+    return _runtime_context.activation_stats;
+}
+
+/*************************************************************************************************/
+bool TfliteMicroModel::enable_differential_execution(const tflite::MicroOpResolver& reference_op_resolver, float tolerance)
+{
+#if TFLITE_MICRO_RECORDER_ENABLED
+    if(!is_loaded())
+    {
+        MLTK_ERROR("Model not loaded");
+        return false;
+    }
+
+    const auto tflite_model = tflite::GetModel(_flatbuffer);
+    const int op_count = tflite_model->subgraphs()->Get(0)->operators()->size();
+    if(!init_differential_execution(_runtime_context, reference_op_resolver, op_count, tolerance))
+    {
+        MLTK_ERROR("Failed to allocate differential execution");
+        return false;
+    }
+    return true;
+#else
+    MLTK_ERROR("C++ library not build with recording support");
+    return false;
+#endif
+}
+
+/*************************************************************************************************/
+void TfliteMicroModel::disable_differential_execution()
+{
+    deinit_differential_execution(_runtime_context);
+}
+
+/*************************************************************************************************/
+bool TfliteMicroModel::is_differential_execution_enabled() const
+{
+    return _runtime_context.differential != nullptr;
+}
+
+/*************************************************************************************************/
+void TfliteMicroModel::reset_differential_execution()
+{
+    mltk::reset_differential_execution(_runtime_context);
+}
+
+/*************************************************************************************************/
+const TfliteMicroDifferentialExecutor* TfliteMicroModel::differential_execution() const
+{
+    return _runtime_context.differential;
+}
+
 /*************************************************************************************************/
 void TfliteMicroModel::set_processing_callback(void (*callback)(void*), void *arg)
 {
-    _processing_callback = callback;
-    _processing_callback_arg = arg;
+    _runtime_context.processing_callback = callback;
+    _runtime_context.processing_callback_arg = arg;
 }
 
 /*************************************************************************************************/
@@ -483,6 +683,275 @@ const void* TfliteMicroModel::find_metadata(const char* tag, uint32_t* length) c
     return get_metadata_from_tflite_flatbuffer(this->_flatbuffer, tag, length);
 }
 
+/*************************************************************************************************/
+bool TfliteMicroModel::get_memory_plan(TfliteMicroMemoryPlan& plan) const
+{
+    plan.buffers.clear();
+    plan.arena_size = 0;
+    plan.head_size = 0;
+    plan.tail_size = 0;
+
+    if(!is_loaded())
+    {
+        MLTK_ERROR("Model not loaded");
+        return false;
+    }
+
+    const auto tflite_model = tflite::GetModel(_flatbuffer);
+    const auto& subgraph = *tflite_model->subgraphs()->Get(0);
+    const int tensor_count = subgraph.tensors()->size();
+    const int op_count = subgraph.operators()->size();
+    const auto eval_tensors = _interpreter->graph_.GetAllocations()[0].tensors;
+    const uintptr_t arena_start = (uintptr_t)_arena_buffer;
+    const uintptr_t arena_end = arena_start + _arena_buffer_size;
+
+    auto lifetimes = static_cast<int32_t*>(malloc(sizeof(int32_t) * 2 * tensor_count));
+    if(lifetimes == nullptr)
+    {
+        MLTK_ERROR("Failed to allocate memory plan lifetimes");
+        return false;
+    }
+    int32_t* first_use = &lifetimes[0];
+    int32_t* last_use = &lifetimes[tensor_count];
+    for(int i = 0; i < tensor_count; ++i)
+    {
+        first_use[i] = -1;
+        last_use[i] = -1;
+    }
+
+    // Calculate the tensor lifetimes the same way the TFLM allocator does when planning the arena
+    for(auto index : *subgraph.inputs())
+    {
+        first_use[index] = 0;
+    }
+    for(auto index : *subgraph.outputs())
+    {
+        last_use[index] = op_count - 1;
+    }
+    for(int op_idx = 0; op_idx < op_count; ++op_idx)
+    {
+        const auto op = subgraph.operators()->Get(op_idx);
+        if(op->inputs() != nullptr)
+        {
+            for(auto index : *op->inputs())
+            {
+                if(index >= 0 && last_use[index] < op_idx)
+                {
+                    last_use[index] = op_idx;
+                }
+            }
+        }
+        if(op->outputs() != nullptr)
+        {
+            for(auto index : *op->outputs())
+            {
+                if(first_use[index] == -1 || first_use[index] > op_idx)
+                {
+                    first_use[index] = op_idx;
+                }
+                if(last_use[index] < op_idx)
+                {
+                    last_use[index] = op_idx;
+                }
+            }
+        }
+    }
+
+    uint32_t head_size = 0;
+
+    for(int i = 0; i < tensor_count; ++i)
+    {
+        const uintptr_t data = (uintptr_t)eval_tensors[i].data.data;
+        size_t size;
+
+        // Constant tensors are stored in the flatbuffer
+        if(data < arena_start || data >= arena_end)
+        {
+            continue;
+        }
+        if(tflite::TfLiteEvalTensorByteLength(&eval_tensors[i], &size) != kTfLiteOk)
+        {
+            size = 0;
+        }
+
+        TfliteMicroMemoryPlanBuffer buffer;
+        buffer.index = i;
+        buffer.op_index = -1;
+        buffer.offset = data - arena_start;
+        buffer.size = size;
+        buffer.first_use = first_use[i];
+        buffer.last_use = last_use[i];
+
+        if(subgraph.tensors()->Get(i)->is_variable())
+        {
+            buffer.type = TfliteMicroMemoryPlanBufferType::Persistent;
+            buffer.first_use = 0;
+            buffer.last_use = op_count - 1;
+        }
+        else
+        {
+            if(std::find(subgraph.inputs()->begin(), subgraph.inputs()->end(), i) != subgraph.inputs()->end())
+            {
+                buffer.type = TfliteMicroMemoryPlanBufferType::Input;
+            }
+            else if(std::find(subgraph.outputs()->begin(), subgraph.outputs()->end(), i) != subgraph.outputs()->end())
+            {
+                buffer.type = TfliteMicroMemoryPlanBufferType::Output;
+            }
+            else
+            {
+                buffer.type = TfliteMicroMemoryPlanBufferType::Activation;
+            }
+            head_size = std::max(head_size, buffer.offset + buffer.size);
+        }
+
+        plan.buffers.append(buffer);
+    }
+
+    free(lifetimes);
+
+    auto context = &_interpreter->context_;
+    for(int i = 0; i < _runtime_context.scratch_buffer_request_count; ++i)
+    {
+        const auto& request = _runtime_context.scratch_buffer_requests[i];
+        const uintptr_t data = (uintptr_t)context->GetScratchBuffer(context, i);
+        if(data < arena_start || data >= arena_end)
+        {
+            continue;
+        }
+
+        TfliteMicroMemoryPlanBuffer buffer;
+        buffer.type = TfliteMicroMemoryPlanBufferType::Scratch;
+        buffer.index = i;
+        buffer.op_index = request.op_index;
+        buffer.offset = data - arena_start;
+        buffer.size = request.bytes;
+        buffer.first_use = request.op_index;
+        buffer.last_use = request.op_index;
+        head_size = std::max(head_size, buffer.offset + buffer.size);
+
+        plan.buffers.append(buffer);
+    }
+
+    const uint32_t used_bytes = _interpreter->arena_used_bytes();
+    plan.arena_size = _arena_buffer_size;
+    plan.head_size = head_size;
+    plan.tail_size = (used_bytes > head_size) ? used_bytes - head_size : 0;
+
+    return true;
+}
+
+/*************************************************************************************************/
+bool TfliteMicroModel::snapshot_arena(int op_index, TfliteMicroArenaSnapshot& snapshot) const
+{
+    snapshot.clear();
+
+    TfliteMicroMemoryPlan plan;
+    if(!get_memory_plan(plan))
+    {
+        return false;
+    }
+
+    const int op_count = tflite::GetModel(_flatbuffer)->subgraphs()->Get(0)->operators()->size();
+    if(op_index < 0 || op_index >= op_count)
+    {
+        MLTK_ERROR("Invalid snapshot layer index: %d, the model has %d layers", op_index, op_count);
+        return false;
+    }
+
+    // A tensor is live at the boundary if it was written before the layer at op_index
+    // and is read by this layer or a later layer.
+    // The model inputs are written before the first layer.
+    // Scratch buffers are only used while their layer executes.
+    uint32_t size = 0;
+    for(const auto& buffer : plan.buffers)
+    {
+        bool is_live;
+        switch(buffer.type)
+        {
+        case TfliteMicroMemoryPlanBufferType::Persistent:
+            is_live = true;
+            break;
+        case TfliteMicroMemoryPlanBufferType::Input:
+            is_live = buffer.last_use >= op_index;
+            break;
+        case TfliteMicroMemoryPlanBufferType::Scratch:
+            is_live = false;
+            break;
+        default:
+            is_live = buffer.first_use < op_index && buffer.last_use >= op_index;
+            break;
+        }
+        if(!is_live || buffer.size == 0)
+        {
+            continue;
+        }
+
+        TfliteMicroArenaSnapshotRegion region;
+        region.tensor_index = buffer.index;
+        region.offset = buffer.offset;
+        region.size = buffer.size;
+        if(!snapshot.regions.append(region))
+        {
+            MLTK_ERROR("Failed to allocate snapshot regions");
+            snapshot.clear();
+            return false;
+        }
+        size += buffer.size;
+    }
+
+    if(size > 0)
+    {
+        snapshot.data = static_cast<uint8_t*>(malloc(size));
+        if(snapshot.data == nullptr)
+        {
+            MLTK_ERROR("Failed to allocate snapshot, size: %d", size);
+            snapshot.clear();
+            return false;
+        }
+    }
+
+    uint8_t* dst = snapshot.data;
+    for(const auto& region : snapshot.regions)
+    {
+        memcpy(dst, &_arena_buffer[region.offset], region.size);
+        dst += region.size;
+    }
+    snapshot.size = size;
+    snapshot.op_index = op_index;
+
+    return true;
+}
+
+/*************************************************************************************************/
+bool TfliteMicroModel::restore_arena(const TfliteMicroArenaSnapshot& snapshot) const
+{
+    if(!is_loaded())
+    {
+        MLTK_ERROR("Model not loaded");
+        return false;
+    }
+    if(snapshot.op_index < 0)
+    {
+        MLTK_ERROR("Snapshot is empty");
+        return false;
+    }
+
+    const uint8_t* src = snapshot.data;
+    for(const auto& region : snapshot.regions)
+    {
+        if(region.offset + region.size > _arena_buffer_size)
+        {
+            MLTK_ERROR("Snapshot was not taken from this model");
+            return false;
+        }
+        memcpy(&_arena_buffer[region.offset], src, region.size);
+        src += region.size;
+    }
+
+    return true;
+}
+
 /*************************************************************************************************/
 bool TfliteMicroModel::load_model_parameters(const void* flatbuffer)
 {
@@ -529,6 +998,11 @@ bool TfliteMicroModel::load_interpreter(
         _interpreter = nullptr;
         retval = false;
     }
+    else
+    {
+        _arena_buffer = runtime_buffer;
+        _arena_buffer_size = runtime_buffer_size;
+    }
 
     if(disable_logs)
     {
@@ -545,81 +1019,184 @@ bool TfliteMicroModel::find_optimal_buffer_size(
     tflite::MicroOpResolver& op_resolver,
     unsigned &runtime_buffer_size 
 )
+{
+    if(is_loaded())
+    {
+        MLTK_ERROR("Model already loaded");
+        return false;
+    }
+
+    _runtime_context.accelerator = mltk_tflite_micro_get_registered_accelerator();
+    ScopedLoadLock load_lock;
+    ScopedRuntimeContext runtime_context_scope(&_runtime_context);
+
+    auto accelerator = _runtime_context.accelerator;
+    if(accelerator != nullptr)
+    {
+        accelerator->init();
+    }
+
+    const bool retval = search_optimal_buffer_size(flatbuffer, op_resolver, runtime_buffer_size);
+
+    if(accelerator != nullptr)
+    {
+        accelerator->deinit();
+    }
+
+    return retval;
+}
+
+/*************************************************************************************************/
+bool TfliteMicroModel::search_optimal_buffer_size(
+    const void* flatbuffer, 
+    tflite::MicroOpResolver& op_resolver,
+    unsigned &runtime_buffer_size 
+)
 {
 #ifdef __arm__
     int upper_limit = (uint32_t)&__heap_size - 8*1024;
 #else 
     int upper_limit = SRAM_SIZE;
 #endif
-    int lower_limit = 1024;
-    int last_working_buffer_size = -1;
+    upper_limit = (upper_limit / RUNTIME_BUFFER_ALIGNMENT) * RUNTIME_BUFFER_ALIGNMENT;
+    const int lower_limit = 1024;
+    // The largest buffer size the model failed to load with
+    // and the smallest buffer size the model loaded with.
+    // All the sizes are multiples of RUNTIME_BUFFER_ALIGNMENT
+    int failed_buffer_size = 0;
+    int working_buffer_size = -1;
+    int planned_buffer_size = -1;
 
     MLTK_INFO("Searching for optimal runtime memory size ...");
 
     // Don't print error while find the optimal size
-    model_error_reporter_enabled = false;
+    _runtime_context.error_reporter_enabled = false;
 
-    // Try to get the optimal buffer size to within 128 bytes
-    while((upper_limit - lower_limit) > 128)
+    // Load the model with a buffer of the given size then unload it.
+    // Return 1 if the model loaded, 0 if it failed to load, -1 if the buffer could not be allocated
+    auto try_load = [&](int buffer_size, int* used_bytes) -> int
     {
-        // Get the midpoint between the update and lower limits
-        int buffer_size = (upper_limit + lower_limit) / 2;
-        buffer_size = ((buffer_size + 16 - 1) / 16) * 16; // align to 16-bytes
-
-        // Allocate the buffer
         uint8_t* buffer = static_cast<uint8_t*>(malloc(buffer_size));
         if(buffer == nullptr)
+        {
+            return -1;
+        }
+
+        const bool loaded = load_interpreter(flatbuffer, op_resolver, buffer, buffer_size, true);
+        if(loaded)
+        {
+            if(used_bytes != nullptr)
+            {
+                *used_bytes = _interpreter->arena_used_bytes();
+            }
+            _interpreter->~MicroInterpreter();
+            _interpreter = nullptr;
+        }
+        free(buffer);
+
+        return loaded ? 1 : 0;
+    };
+
+    // First, load the model once with the largest buffer possible
+    // and retrieve the number of bytes actually used by the allocator.
+    // This includes all the persistent allocations
+    // plus the tensor arena high-water mark computed by the memory planner.
+    while(upper_limit > lower_limit)
+    {
+        const int status = try_load(upper_limit, &planned_buffer_size);
+        if(status < 0)
         {
             // If we failed to malloc, then we don't have enough heap memory
             // So decrease the upper limit by 8k and try again
-            // (This should only happen when we first start this algorithm)
             upper_limit -= 8*1024;
             continue;
         }
-
-        // Try to load the model with the new buffer
-        if(load_interpreter(flatbuffer, op_resolver, buffer, buffer_size, true))
+        if(status > 0)
         {
-            // The model was successfully loaded
-            // Save the buffer size
-            last_working_buffer_size = buffer_size;
-
-            // And set the upper limit to the working buffer size
-            // (the goal is to find the smallest possible buffer size)
-            upper_limit = buffer_size;
+            working_buffer_size = upper_limit;
+        }
+        break;
+    }
 
-            // Also unload the interpreter so we can load it again
-            _interpreter->~MicroInterpreter();
-            _interpreter = nullptr;
+    // If the model does not load with the largest buffer, 
+    // then it will not load with any smaller buffer either
+    if(working_buffer_size != -1)
+    {
+        // Next, verify the model loads with the planned size.
+        // The planned size does not include temporary allocations made while preparing the kernels,
+        // so if necessary, grow the size by 1k increments a couple of times.
+        int buffer_size = ((planned_buffer_size + RUNTIME_BUFFER_ALIGNMENT - 1) / RUNTIME_BUFFER_ALIGNMENT) * RUNTIME_BUFFER_ALIGNMENT;
+        for(int attempt = 0; attempt < 4 && buffer_size < working_buffer_size; ++attempt, buffer_size += 1024)
+        {
+            const int status = try_load(buffer_size, nullptr);
+            if(status < 0)
+            {
+                break;
+            }
+            if(status > 0)
+            {
+                working_buffer_size = buffer_size;
+                break;
+            }
+            // The planned size is a lower bound of the required size
+            failed_buffer_size = buffer_size;
         }
-        else 
+
+        // If the first size tried worked, then verify the next smaller size does not.
+        // This is typically the case, so the bisection below is skipped.
+        if(failed_buffer_size == 0 && working_buffer_size > RUNTIME_BUFFER_ALIGNMENT)
         {
-            // Otherwise, the buffer size is too small,
-            // So the new lower limit is the buffer size+1
-            lower_limit = buffer_size+1;
+            const int smaller_buffer_size = working_buffer_size - RUNTIME_BUFFER_ALIGNMENT;
+            const int status = try_load(smaller_buffer_size, nullptr);
+            if(status == 0)
+            {
+                failed_buffer_size = smaller_buffer_size;
+            }
+            else if(status > 0)
+            {
+                working_buffer_size = smaller_buffer_size;
+            }
         }
 
-        // Free the buffer for the next iteration
-        free(buffer);
+        // Finally, bisect between the largest failed size and the smallest working size.
+        // After growing the planned size, this refines the size within the last 1k increment.
+        while(working_buffer_size - failed_buffer_size > RUNTIME_BUFFER_ALIGNMENT)
+        {
+            const int step_count = (working_buffer_size - failed_buffer_size) / RUNTIME_BUFFER_ALIGNMENT;
+            const int buffer_size = failed_buffer_size + (step_count / 2) * RUNTIME_BUFFER_ALIGNMENT;
+
+            const int status = try_load(buffer_size, nullptr);
+            if(status < 0)
+            {
+                // The working size was already allocated, so this should not happen.
+                // Just keep the working size if it does
+                break;
+            }
+            else if(status > 0)
+            {
+                working_buffer_size = buffer_size;
+            }
+            else 
+            {
+                failed_buffer_size = buffer_size;
+            }
+        }
     }
 
-    model_error_reporter_enabled = true;
+    _runtime_context.error_reporter_enabled = true;
 
-    if(last_working_buffer_size == -1)
+    if(working_buffer_size == -1)
     {
         runtime_buffer_size = 0;
         // Return false if we failed to find a working buffer size
         return false;
     }
 
-    // Add some additional memory for any padding or invoking the context.GetTensor() APIs.
-    last_working_buffer_size += 256;
-
-    MLTK_INFO("Determined optimal runtime memory size to be %d", last_working_buffer_size);
+    MLTK_INFO("Determined optimal runtime memory size to be %d", working_buffer_size);
 
     // Otherwise, we found a good buffer size
     // So return success
-    runtime_buffer_size = last_working_buffer_size;
+    runtime_buffer_size = working_buffer_size;
     return true;
 }
 
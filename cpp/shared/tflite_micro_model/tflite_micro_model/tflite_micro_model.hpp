@@ -8,8 +8,11 @@
 #include "tflite_model_parameters/tflite_model_parameters.hpp"
 #include "tflite_micro_model/tflite_micro_model_details.hpp"
 #include "tflite_micro_model/tflite_micro_tensor.hpp"
+#include "tflite_micro_model/tflite_micro_memory_plan.hpp"
+#include "tflite_micro_model/tflite_micro_arena_snapshot.hpp"
 
 #include "mltk_tflite_micro_helper.hpp"
+#include "mltk_tflite_micro_context.hpp"
 
 
 namespace mltk
@@ -57,6 +60,27 @@ public:
       unsigned runtime_buffer_size = 0 
     );
 
+    /**
+     * @brief Find the smallest runtime buffer size the model loads with
+     * 
+     * This searches for the size that @ref load() allocates when the runtime buffer size is not specified,
+     * less the additional memory load() reserves for padding and context.GetTensor().
+     * The size is a multiple of 16 bytes and is specific to this platform,
+     * i.e. on a 64-bit host it includes the 64-bit pointer overhead.
+     * 
+     * @note The model must not be loaded
+     * 
+     * @param flatbuffer Model flatbuffer (.tflite) binary data
+     * @param op_resolver @ref tflite::MicroOpResolver with reigstered kernels
+     * @param runtime_buffer_size Populated with the smallest runtime buffer size in bytes
+     * @return true if the size was found, false if the model does not load with any buffer size
+     */
+    bool find_optimal_buffer_size(
+      const void* flatbuffer, 
+      tflite::MicroOpResolver& op_resolver,
+      unsigned &runtime_buffer_size 
+    );
+
     /**
      * @brief Unload model
      * 
@@ -80,6 +104,20 @@ public:
      */
     bool invoke() const;
 
+    /**
+     * @brief Invoke a range of model layers
+     * 
+     * Execute the layers first_op to last_op (inclusive) of the loaded model.
+     * The other layers are not executed, so the inputs of first_op must already be
+     * in the tensor arena, e.g. from a previous invoke_range() that ended at first_op-1
+     * or from a restored @ref TfliteMicroArenaSnapshot.
+     * 
+     * @param first_op Index of the first layer to execute
+     * @param last_op Index of the last layer to execute, -1 to execute until the end of the model
+     * @return true if the layers executed successfully, false else
+     */
+    bool invoke_range(int first_op, int last_op = -1) const;
+
     /**
      * @brief Return model details
      * 
@@ -143,6 +181,41 @@ public:
      */
     const void* find_metadata(const char* tag, uint32_t* length = nullptr) const;
 
+    /**
+     * @brief Return the tensor arena memory plan
+     * 
+     * Populate the given @ref TfliteMicroMemoryPlan with the arena offset, size and lifetime
+     * of each tensor and scratch buffer, and the arena head/tail sizes.
+     * This is useful for determining which layers drive the peak RAM usage.
+     * 
+     * @param plan The memory plan to populate
+     * @return true if the plan was populated, false else
+     */
+    bool get_memory_plan(TfliteMicroMemoryPlan& plan) const;
+
+    /**
+     * @brief Save the live tensors at a layer boundary
+     * 
+     * Copy the arena contents of the tensors that are live before the layer at op_index executes.
+     * The live tensors are determined from the tensor lifetimes of the arena memory plan,
+     * see @ref get_memory_plan().
+     * 
+     * @param op_index Index of the layer that executes next, i.e. the previous layers must have already executed
+     * @param snapshot The snapshot to populate, any previous data is freed
+     * @return true if the snapshot was populated, false else
+     */
+    bool snapshot_arena(int op_index, TfliteMicroArenaSnapshot& snapshot) const;
+
+    /**
+     * @brief Restore the live tensors saved by @ref snapshot_arena()
+     * 
+     * After this returns, invoke_range(snapshot.op_index) resumes the model from the snapshot.
+     * 
+     * @param snapshot Snapshot previously populated by this model
+     * @return true if the snapshot was restored, false else
+     */
+    bool restore_arena(const TfliteMicroArenaSnapshot& snapshot) const;
+
 
    /**
      * Enable profiling of the ML model
@@ -183,12 +256,111 @@ public:
      */
     bool is_tensor_recorder_enabled() const;
 
+    /**
+     * Configure the tensor recorder
+     * 
+     * This may be used to stream the recorded data to a writer (e.g. file or callback)
+     * instead of buffering it in RAM, and to only record specific layers/tensors.
+     * See @ref TfliteMicroRecorderConfig
+     * 
+     * @note This should be called before invoking the model
+     * 
+     * @return true if the config was applied, false else
+     */
+    bool set_tensor_recorder_config(const TfliteMicroRecorderConfig& config);
+
     /**
      * Return the recorded data from the previous inference
      * The returned data is msgpack formatted.
+     * 
+     * @note This returns false if the recorder is streaming to a writer
      */
     bool recorded_data(const uint8_t** buffer_ptr, uint32_t* length_ptr) const;
 
+    /**
+     * Enable the per-layer activation statistics collector
+     * 
+     * When enabled, the running min/max/mean/variance and a histogram
+     * of each layer's output tensors are accumulated across every model inference.
+     * This is used for quantization calibration without recording the tensors.
+     * See @ref TfliteMicroActivationStats
+     * 
+     * @note The model must be loaded before calling this.
+     *       Any previously collected statistics are discarded.
+     * 
+     * @param n_bins Number of histogram bins for each tensor, this is rounded up to an even number
+     * @return true if the collector was enabled, false else
+     */
+    bool enable_activation_stats(uint32_t n_bins = 256);
+
+    /**
+     * Disable the activation statistics collector and free its memory
+     */
+    void disable_activation_stats();
+
+    /**
+     * Return if the activation statistics collector is enabled
+     */
+    bool is_activation_stats_enabled() const;
+
+    /**
+     * Discard the collected activation statistics
+     */
+    void reset_activation_stats();
+
+    /**
+     * Return the collected activation statistics
+     * 
+     * @return The collector, its stats are indexed by the model tensor index.
+     *         Tensors that are not a layer output have an op_index of -1.
+     *         Null if the collector is not enabled.
+     */
+    const TfliteMicroActivationStatsCollector* activation_stats() const;
+
+    /**
+     * Enable differential execution of the model's kernels against reference kernels
+     * 
+     * When enabled, after each layer's kernel (e.g. an accelerated kernel) executes,
+     * the reference kernel from the given resolver is executed on the same inputs
+     * and the outputs are compared. The resolver's kernels execute with the TFLM reference
+     * implementations, i.e. the host-optimized kernels are bypassed (see mltk_tflite_micro_host_kernels.hpp). The per-layer max absolute error and mismatch counts
+     * are accumulated across every model inference. This validates the kernels
+     * in a single inference without recording the tensors.
+     * See @ref TfliteMicroDifferentialExecutor
+     * 
+     * @note The model must be loaded before calling this.
+     *       The reference_op_resolver must persist while this is enabled.
+     *       Any previous results are discarded.
+     * 
+     * @param reference_op_resolver Resolver of the reference kernels, e.g. tflite::AllOpsResolver
+     * @param tolerance Output elements whose absolute error is greater than this are counted as mismatches
+     * @return true if differential execution was enabled, false else
+     */
+    bool enable_differential_execution(const tflite::MicroOpResolver& reference_op_resolver, float tolerance = 0);
+
+    /**
+     * Disable differential execution and free its memory
+     */
+    void disable_differential_execution();
+
+    /**
+     * Return if differential execution is enabled
+     */
+    bool is_differential_execution_enabled() const;
+
+    /**
+     * Discard the differential execution results
+     */
+    void reset_differential_execution();
+
+    /**
+     * Return the differential execution results
+     * 
+     * @return The executor, its results are indexed by the layer index.
+     *         Null if differential execution is not enabled.
+     */
+    const TfliteMicroDifferentialExecutor* differential_execution() const;
+
 
     /**
      * Return a pointer to the TfliteMicroInterpreter
@@ -221,9 +393,10 @@ private:
   tflite::MicroOpResolver* _ops_resolver = nullptr;
   TfliteMicroModelDetails _model_details;
   const void* _flatbuffer = nullptr;
-  void (*_processing_callback)(void*) = nullptr;
-  void* _processing_callback_arg = nullptr;
   uint8_t* _runtime_buffer = nullptr;
+  uint8_t* _arena_buffer = nullptr;
+  unsigned _arena_buffer_size = 0;
+  mutable TfliteMicroRuntimeContext _runtime_context;
 
   bool load_interpreter(
       const void* flatbuffer, 
@@ -232,7 +405,7 @@ private:
       unsigned runtime_buffer_size,
       bool disable_logs = false
   );
-  bool find_optimal_buffer_size(
+  bool search_optimal_buffer_size(
       const void* flatbuffer, 
       tflite::MicroOpResolver& op_resolver,
       unsigned &runtime_buffer_size 
@@ -0,0 +1,157 @@
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "flatbuffers/flatbuffers.h"
+#include "tflite_model_parameters/tflite_model_parameters.hpp"
+
+
+using namespace mltk;
+
+
+namespace {
+
+
+typedef std::vector<std::pair<std::string, int32_t>> EntryList;
+
+
+// Build a parameters dictionary with the given i32 entries,
+// in the given order (i.e. the entries are NOT sorted by key)
+void build_dictionary(flatbuffers::FlatBufferBuilder& fbb, const EntryList& entries)
+{
+    std::vector<flatbuffers::Offset<schema::Entry>> fb_entries;
+    for(const auto& entry : entries)
+    {
+        const auto value = schema::CreateInt32Value(fbb, entry.second);
+        fb_entries.push_back(schema::CreateEntryDirect(fbb, entry.first.c_str(), schema::Value::i32, value.Union()));
+    }
+    fbb.Finish(schema::CreateDictionaryDirect(fbb, 1, &fb_entries));
+}
+
+// Return the index of the first entry with the given key,
+// this is what the linear scan used to return
+int first_index_of(const EntryList& entries, const std::string& key)
+{
+    for(size_t i = 0; i < entries.size(); ++i)
+    {
+        if(entries[i].first == key)
+        {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+// Verify every key of the given entries resolves to its first occurrence
+void expect_lookups(const TfliteModelParameters& params, const EntryList& entries)
+{
+    for(const auto& entry : entries)
+    {
+        const char* key = entry.first.c_str();
+        const int expected_index = first_index_of(entries, entry.first);
+
+        EXPECT_EQ(params.index_of(key), expected_index) << key;
+        EXPECT_TRUE(params.contains(key)) << key;
+
+        const auto handle = params.find(key);
+        ASSERT_NE(handle, nullptr) << key;
+        EXPECT_STREQ(handle->key(), key);
+
+        int32_t value = 0;
+        EXPECT_TRUE(TfliteModelParameters::get(handle, value)) << key;
+        EXPECT_EQ(value, entries[expected_index].second) << key;
+
+        value = 0;
+        EXPECT_TRUE(params.get(key, value)) << key;
+        EXPECT_EQ(value, entries[expected_index].second) << key;
+    }
+
+    EXPECT_EQ(params.index_of("not_a_key"), -1);
+    EXPECT_EQ(params.index_of(""), -1);
+    EXPECT_EQ(params.index_of(nullptr), -1);
+    EXPECT_EQ(params.find("not_a_key"), nullptr);
+    EXPECT_FALSE(params.contains("not_a_key"));
+
+    int32_t value = 0;
+    EXPECT_FALSE(params.get("not_a_key", value));
+}
+
+
+class TfliteModelParametersLookup : public ::testing::TestWithParam<EntryList>
+{
+};
+
+
+TEST_P(TfliteModelParametersLookup, KeysResolveToFirstEntry)
+{
+    const auto& entries = GetParam();
+    flatbuffers::FlatBufferBuilder fbb;
+    build_dictionary(fbb, entries);
+
+    TfliteModelParameters params;
+    ASSERT_TRUE(params.load(fbb.GetBufferPointer()));
+    EXPECT_EQ(params.size(), entries.size());
+    expect_lookups(params, entries);
+}
+
+// A copy builds its own index and the original's index
+// remains valid after the copy is unloaded
+TEST_P(TfliteModelParametersLookup, CopyHasOwnIndex)
+{
+    const auto& entries = GetParam();
+    flatbuffers::FlatBufferBuilder fbb;
+    build_dictionary(fbb, entries);
+
+    TfliteModelParameters params;
+    ASSERT_TRUE(params.load(fbb.GetBufferPointer()));
+    {
+        TfliteModelParameters copy(params);
+        expect_lookups(copy, entries);
+
+        TfliteModelParameters assigned;
+        assigned = params;
+        expect_lookups(assigned, entries);
+    }
+    expect_lookups(params, entries);
+
+    params.unload();
+    EXPECT_FALSE(params.is_loaded());
+    EXPECT_EQ(params.index_of(entries[0].first.c_str()), -1);
+}
+
+
+// Return many entries whose keys are in descending order
+EntryList reversed_entries(int count)
+{
+    EntryList entries;
+    for(int i = count - 1; i >= 0; --i)
+    {
+        char key[16];
+        snprintf(key, sizeof(key), "key%04d", i);
+        entries.emplace_back(key, i);
+    }
+    return entries;
+}
+
+
+INSTANTIATE_TEST_SUITE_P(
+    Entries,
+    TfliteModelParametersLookup,
+    ::testing::Values(
+        // Sorted, binary searched in place
+        EntryList{{"a", 1}, {"b", 2}, {"c", 3}},
+        EntryList{{"samplerate", 16000}},
+        // Unsorted, an index is built
+        EntryList{{"zeta", 1}, {"alpha", 2}, {"mid", 3}, {"Beta", 4}, {"alph", 5}},
+        reversed_entries(300),
+        // Duplicate keys, the first entry is returned
+        EntryList{{"a", 1}, {"a", 2}, {"b", 3}},
+        EntryList{{"b", 1}, {"a", 2}, {"b", 3}, {"a", 4}, {"c", 5}, {"b", 6}},
+        EntryList{{"dup", 1}, {"dup", 2}, {"dup", 3}}
+    )
+);
+
+
+} // namespace
@@ -1,3 +1,7 @@
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
 #include "tflite_model_parameters/tflite_model_parameters.hpp"
 #include "mltk_tflite_micro_helper.hpp"
 
@@ -40,7 +44,12 @@ bool TfliteModelParameters::load(const schema::Dictionary *fb_dictionary)
     }
     else
     {
-        _fb_dictionary = fb_dictionary;
+        if(fb_dictionary != _fb_dictionary)
+        {
+            unload();
+            _fb_dictionary = fb_dictionary;
+            build_index();
+        }
 
         return true;
     }
@@ -56,9 +65,18 @@ bool TfliteModelParameters::load(const void *flatbuffer)
 /*************************************************************************************************/
 void TfliteModelParameters::unload()
 {
+    free(_index);
+    _index = nullptr;
+    _is_sorted = false;
     _fb_dictionary = nullptr;
 }
 
+/*************************************************************************************************/
+TfliteModelParameters::~TfliteModelParameters()
+{
+    unload();
+}
+
 /*************************************************************************************************/
 TfliteModelParameters::TfliteModelParameters(const TfliteModelParameters& other)
 {
@@ -68,54 +86,153 @@ TfliteModelParameters::TfliteModelParameters(const TfliteModelParameters& other)
 /*************************************************************************************************/
 TfliteModelParameters& TfliteModelParameters::operator=(const TfliteModelParameters& other)
 {
-    load(other._fb_dictionary);
+    if(this != &other)
+    {
+        if(other._fb_dictionary == nullptr)
+        {
+            unload();
+        }
+        else
+        {
+            load(other._fb_dictionary);
+        }
+    }
     return *this;
 }
 
 /*************************************************************************************************/
-const TfliteModelParameters::Value *TfliteModelParameters::get(const char *key) const
+bool TfliteModelParameters::build_index()
 {
-    const TfliteModelParameters::Value *retval = nullptr;
+    const auto entries = _fb_dictionary->entries();
+    const unsigned n_entries = entries->size();
 
-    if (_fb_dictionary != nullptr)
+    // Models generated by the MLTK have their entries sorted by key,
+    // in which case they can be binary searched directly
+    _is_sorted = true;
+    for(unsigned i = 1; i < n_entries; ++i)
     {
-        for (auto entry : *this)
+        if(strcmp(entries->Get(i-1)->key()->c_str(), entries->Get(i)->key()->c_str()) >= 0)
         {
-            if (strcmp(entry->key(), key) == 0)
-            {
-                retval = entry;
-                break;
-            }
+            _is_sorted = false;
+            break;
         }
     }
 
-    return retval;
+    if(_is_sorted)
+    {
+        return true;
+    }
+
+    // Otherwise, sort the entry positions by key
+    if(n_entries > UINT16_MAX)
+    {
+        return false;
+    }
+
+    _index = static_cast<uint16_t*>(malloc(sizeof(uint16_t) * n_entries));
+    if(_index == nullptr)
+    {
+        return false;
+    }
+
+    for(unsigned i = 0; i < n_entries; ++i)
+    {
+        _index[i] = i;
+    }
+    std::stable_sort(_index, _index + n_entries, [entries](uint16_t lhs, uint16_t rhs)
+    {
+        return strcmp(entries->Get(lhs)->key()->c_str(), entries->Get(rhs)->key()->c_str()) < 0;
+    });
+
+    return true;
 }
 
 /*************************************************************************************************/
-bool TfliteModelParameters::contains(const char *key) const
+const char* TfliteModelParameters::key_at(unsigned sorted_index) const
+{
+    const auto entries = _fb_dictionary->entries();
+    const unsigned i = (_index != nullptr) ? _index[sorted_index] : sorted_index;
+    return entries->Get(i)->key()->c_str();
+}
+
+/*************************************************************************************************/
+int TfliteModelParameters::index_of(const char *key) const
 {
-    bool retval = false;
+    if (_fb_dictionary == nullptr || key == nullptr)
+    {
+        return -1;
+    }
 
-    if (_fb_dictionary != nullptr)
+    const auto entries = _fb_dictionary->entries();
+    const unsigned n_entries = entries->size();
+
+    if(!_is_sorted && _index == nullptr)
     {
-        for (auto entry : *this)
+        // The index could not be allocated, so just scan the entries
+        for(unsigned i = 0; i < n_entries; ++i)
         {
-            if (strcmp(entry->key(), key) == 0)
+            if (strcmp(entries->Get(i)->key()->c_str(), key) == 0)
             {
-                retval = true;
-                break;
+                return i;
             }
         }
+        return -1;
+    }
+
+    // Find the first entry whose key is >= the given key.
+    // This returns the first occurrence if the model has duplicate keys,
+    // which is the same entry the previous linear scan returned
+    unsigned lo = 0;
+    unsigned hi = n_entries;
+    while(lo < hi)
+    {
+        const unsigned mid = lo + (hi - lo) / 2;
+        if(strcmp(key_at(mid), key) < 0)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+
+    if(lo < n_entries && strcmp(key_at(lo), key) == 0)
+    {
+        return (_index != nullptr) ? _index[lo] : lo;
     }
 
-    return retval;
+    return -1;
+}
+
+/*************************************************************************************************/
+TfliteModelParameters::Handle TfliteModelParameters::find(const char *key) const
+{
+    const int index = index_of(key);
+    if(index < 0)
+    {
+        return nullptr;
+    }
+
+    return reinterpret_cast<Handle>(_fb_dictionary->entries()->Get(index));
+}
+
+/*************************************************************************************************/
+const TfliteModelParameters::Value *TfliteModelParameters::get(const char *key) const
+{
+    return find(key);
+}
+
+/*************************************************************************************************/
+bool TfliteModelParameters::contains(const char *key) const
+{
+    return index_of(key) >= 0;
 }
 
 /*************************************************************************************************/
 const TfliteModelParameters::Value *TfliteModelParameters::operator[](const char *key) const
 {
-    return get(key);
+    return find(key);
 }
 
 /*************************************************************************************************/
@@ -133,7 +250,42 @@ TfliteModelParameters::Iterator TfliteModelParameters::end() const
 /*************************************************************************************************/
 bool TfliteModelParameters::get(const char *key, const char *&value) const
 {
-    auto entry = get(key);
+    return get(find(key), value);
+}
+
+/*************************************************************************************************/
+bool TfliteModelParameters::get(const char *key, const uint8_t *&value) const
+{
+    return get(find(key), value);
+}
+
+/*************************************************************************************************/
+bool TfliteModelParameters::get(const char *key, StringList &value) const
+{
+    return get(find(key), value);
+}
+
+/*************************************************************************************************/
+bool TfliteModelParameters::get(const char *key, Int32List &value) const
+{
+    return get(find(key), value);
+}
+
+/*************************************************************************************************/
+bool TfliteModelParameters::get(const char *key, FloatList &value) const
+{
+    return get(find(key), value);
+}
+
+/*************************************************************************************************/
+bool TfliteModelParameters::get(const char* key, const uint8_t* &data, uint32_t &length) const
+{
+    return get(find(key), data, length);
+}
+
+/*************************************************************************************************/
+bool TfliteModelParameters::get(Handle entry, const char *&value)
+{
     if (entry != nullptr && entry->type() == schema::Value::str)
     {
         value = entry->str();
@@ -146,9 +298,8 @@ bool TfliteModelParameters::get(const char *key, const char *&value) const
 }
 
 /*************************************************************************************************/
-bool TfliteModelParameters::get(const char *key, const uint8_t *&value) const
+bool TfliteModelParameters::get(Handle entry, const uint8_t *&value)
 {
-    auto entry = get(key);
     if (entry != nullptr && entry->type() == schema::Value::bin)
     {
         value = entry->bin();
@@ -161,9 +312,8 @@ bool TfliteModelParameters::get(const char *key, const uint8_t *&value) const
 }
 
 /*************************************************************************************************/
-bool TfliteModelParameters::get(const char *key, StringList &value) const
+bool TfliteModelParameters::get(Handle entry, StringList &value)
 {
-    auto entry = get(key);
     if (entry != nullptr && entry->type() == schema::Value::str_list)
     {
         value = entry->str_list();
@@ -176,9 +326,8 @@ bool TfliteModelParameters::get(const char *key, StringList &value) const
 }
 
 /*************************************************************************************************/
-bool TfliteModelParameters::get(const char *key, Int32List &value) const
+bool TfliteModelParameters::get(Handle entry, Int32List &value)
 {
-    auto entry = get(key);
     if (entry != nullptr && entry->type() == schema::Value::int32_list)
     {
         value = entry->int32_list();
@@ -191,9 +340,8 @@ bool TfliteModelParameters::get(const char *key, Int32List &value) const
 }
 
 /*************************************************************************************************/
-bool TfliteModelParameters::get(const char *key, FloatList &value) const
+bool TfliteModelParameters::get(Handle entry, FloatList &value)
 {
-    auto entry = get(key);
     if (entry != nullptr && entry->type() == schema::Value::float_list)
     {
         value = entry->float_list();
@@ -206,10 +354,8 @@ bool TfliteModelParameters::get(const char *key, FloatList &value) const
 }
 
 /*************************************************************************************************/
-bool TfliteModelParameters::get(const char* key, const uint8_t* &data, uint32_t &length) const
+bool TfliteModelParameters::get(Handle entry, const uint8_t* &data, uint32_t &length)
 {
-    auto entry = get(key);
-
     if (entry == nullptr || entry->type() != schema::Value::bin)
     {
         return false;
@@ -16,6 +16,14 @@ namespace mltk
  * This provides access to application parameters stored in a .tflite model flatbuffer's metadata.
  * Application parameters are things like audio sampling rate, FFT bins, etc.
  * 
+ * Key lookups are O(log n):
+ * - If the flatbuffer's entries are sorted by key (which the MLTK Python package does when serializing),
+ *   then the entries are binary searched directly and no additional memory is used
+ * - Otherwise, load() allocates a sorted index of the entries (2 bytes per entry) from the heap.
+ *   If the allocation fails then lookups fall back to a linear scan
+ * 
+ * For parameters that are accessed repeatedly, use find() to resolve the key
+ * into a @ref Handle once, then use get(handle, value) to read the value.
  */
 class TfliteModelParameters
 {
@@ -166,6 +174,15 @@ public:
     };
 
 
+    /**
+     * A resolved parameter entry, see find()
+     * 
+     * This is nullptr if the key was not found.
+     * The handle is valid as long as the model flatbuffer is loaded.
+     */
+    typedef const Value* Handle;
+
+
     static bool load_from_tflite_flatbuffer(const void* flatbuffer, TfliteModelParameters& parameters);
     bool load(const schema::Dictionary *fb_dictionary);
     bool load(const void *flatbuffer);
@@ -192,6 +209,17 @@ public:
         return _fb_dictionary;
     }
 
+    /**
+     * Return the index of the given key in the flatbuffer's entries vector,
+     * or -1 if the key was not found
+     */
+    int index_of(const char* key) const;
+
+    /**
+     * Resolve the given key into a handle, return nullptr if the key was not found
+     */
+    Handle find(const char* key) const;
+
     const Value* get(const char* key) const;
     bool get(const char* key, const char* &value) const;
     bool get(const char* key, const uint8_t* &value) const;
@@ -202,7 +230,18 @@ public:
     template<typename T>
     bool get(const char* key, T &value) const
     {
-        auto entry = get(key);
+        return get(find(key), value);
+    }
+
+    static bool get(Handle entry, const char* &value);
+    static bool get(Handle entry, const uint8_t* &value);
+    static bool get(Handle entry, StringList &value);
+    static bool get(Handle entry, Int32List &value);
+    static bool get(Handle entry, FloatList &value);
+    static bool get(Handle entry, const uint8_t* &data, uint32_t &length);
+    template<typename T>
+    static bool get(Handle entry, T &value)
+    {
         if(entry != nullptr)
         {
             const auto entry_type = entry->type();
@@ -229,11 +268,19 @@ public:
     }
 
     TfliteModelParameters() = default;
+    ~TfliteModelParameters();
     TfliteModelParameters(const TfliteModelParameters&);
     TfliteModelParameters& operator=(const TfliteModelParameters&);
 
 private:
     const schema::Dictionary *_fb_dictionary = nullptr;
+    // Entry positions sorted by key,
+    // nullptr if the entries are already sorted or the index could not be allocated
+    uint16_t *_index = nullptr;
+    bool _is_sorted = false;
+
+    bool build_index();
+    const char* key_at(unsigned sorted_index) const;
 };
 
 
@@ -0,0 +1,216 @@
+#include <exception>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <atomic>
+
+#include "tensorflow/lite/micro/all_ops_resolver.h"
+#include "tflite_micro_model_pool_wrapper.hpp"
+#include "mltk_tflite_micro_helper.hpp"
+#include "pybind11_helper.hpp"
+
+
+namespace mltk
+{
+
+static tflite::AllOpsResolver pool_ops_resolver;
+
+
+/**
+ * Per-worker queue of sample indices
+ *
+ * The owning worker pops from the front while
+ * idle workers steal from the back.
+ */
+struct WorkStealingQueue
+{
+    std::deque<ssize_t> indices;
+    std::mutex lock;
+
+    bool pop(ssize_t& index)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if(indices.empty())
+        {
+            return false;
+        }
+        index = indices.front();
+        indices.pop_front();
+        return true;
+    }
+
+    bool steal(ssize_t& index)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if(indices.empty())
+        {
+            return false;
+        }
+        index = indices.back();
+        indices.pop_back();
+        return true;
+    }
+};
+
+
+/*************************************************************************************************/
+TfliteMicroModelPoolWrapper::~TfliteMicroModelPoolWrapper()
+{
+    unload();
+}
+
+/*************************************************************************************************/
+bool TfliteMicroModelPoolWrapper::load(
+    const std::string& flatbuffer_data,
+    int n_instances,
+    int runtime_memory_size
+)
+{
+    unload();
+
+    if(n_instances <= 0)
+    {
+        n_instances = std::max((int)std::thread::hardware_concurrency(), 1);
+    }
+
+    get_logger().debug("Loading model pool with %d instances ...", n_instances);
+
+    // The flatbuffer is stored once and shared by all instances
+    this->_flatbuffer_data = flatbuffer_data;
+
+    // The pool only uses the reference kernels,
+    // the accelerator simulators only support a single model instance.
+    // The instances load with the (null) accelerator of this load context
+    // rather than the process-wide registered accelerator, see TfliteMicroModelWrapper::load_flatbuffer()
+    TfliteMicroRuntimeContext load_context;
+    ScopedRuntimeContext load_context_scope(&load_context);
+
+    for(int i = 0; i < n_instances; ++i)
+    {
+        std::unique_ptr<TfliteMicroModel> model(new TfliteMicroModel());
+
+        if(!model->load(
+            this->_flatbuffer_data.c_str(),
+            pool_ops_resolver,
+            nullptr,
+            runtime_memory_size
+        ))
+        {
+            unload();
+            return false;
+        }
+
+        // Re-use the runtime memory size of the first instance for the other instances
+        // so that the optimal size is only searched for once
+        if(runtime_memory_size <= 0)
+        {
+            runtime_memory_size = model->details().runtime_memory_size();
+        }
+
+        _models.push_back(std::move(model));
+    }
+
+    return true;
+}
+
+/*************************************************************************************************/
+void TfliteMicroModelPoolWrapper::unload()
+{
+    _models.clear();
+    _flatbuffer_data.clear();
+}
+
+/*************************************************************************************************/
+int TfliteMicroModelPoolWrapper::size() const
+{
+    return (int)_models.size();
+}
+
+/*************************************************************************************************/
+py::array TfliteMicroModelPoolWrapper::map(const py::array& inputs)
+{
+    if(_models.empty())
+    {
+        throw std::runtime_error("Model pool not loaded");
+    }
+
+    auto input_tensor = _models[0]->input(0);
+    auto output_tensor = _models[0]->output(0);
+    const auto contiguous_inputs = input_batch_to_contiguous_array(inputs, *input_tensor);
+    const ssize_t batch_size = inputs.shape(0);
+    py::array outputs = create_output_batch(batch_size, *output_tensor);
+
+    const auto input_bytes = input_tensor->bytes;
+    const auto output_bytes = output_tensor->bytes;
+    const uint8_t* src = static_cast<const uint8_t*>(contiguous_inputs.data());
+    uint8_t* dst = static_cast<uint8_t*>(outputs.mutable_data());
+    const int n_workers = (int)std::min((ssize_t)_models.size(), std::max(batch_size, (ssize_t)1));
+    std::atomic<bool> success(true);
+
+    {
+        // Release the Python Global Interpreter Lock (GIL)
+        // while the workers process the batch
+        py::gil_scoped_release release;
+
+        // Initially give each worker a contiguous range of the batch
+        std::vector<WorkStealingQueue> queues(n_workers);
+        for(ssize_t i = 0; i < batch_size; ++i)
+        {
+            queues[(i * n_workers) / batch_size].indices.push_back(i);
+        }
+
+        auto worker = [&](int worker_index)
+        {
+            auto& model = *_models[worker_index];
+            auto model_input = model.input(0);
+            auto model_output = model.output(0);
+            ssize_t index;
+
+            while(success)
+            {
+                // Process this worker's samples first,
+                // then steal samples from the other workers
+                bool found = queues[worker_index].pop(index);
+                for(int i = 1; !found && i < n_workers; ++i)
+                {
+                    found = queues[(worker_index + i) % n_workers].steal(index);
+                }
+                if(!found)
+                {
+                    break;
+                }
+
+                memcpy(model_input->data.raw, src + index*input_bytes, input_bytes);
+                if(!model.invoke())
+                {
+                    success = false;
+                    break;
+                }
+                memcpy(dst + index*output_bytes, model_output->data.raw, output_bytes);
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for(int i = 1; i < n_workers; ++i)
+        {
+            threads.emplace_back(worker, i);
+        }
+        // The calling thread also acts as a worker
+        worker(0);
+        for(auto& t : threads)
+        {
+            t.join();
+        }
+    }
+
+    if(!success)
+    {
+        throw std::runtime_error("Failed to invoke model");
+    }
+
+    return outputs;
+}
+
+
+} // namespace mltk
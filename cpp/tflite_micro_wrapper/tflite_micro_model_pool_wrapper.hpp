@@ -0,0 +1,47 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+
+
+#include "tflite_micro_model/tflite_micro_model.hpp"
+
+
+namespace py = pybind11;
+
+
+namespace mltk
+{
+
+/**
+ * Pool of TfliteMicroModel instances that all share the same .tflite flatbuffer
+ *
+ * The flatbuffer is only stored once and is never modified by the interpreter,
+ * so each instance only requires its own runtime memory (tensor arena).
+ * Inference is distributed across the instances with a work-stealing queue,
+ * each instance is invoked on its own native thread.
+ */
+class TfliteMicroModelPoolWrapper
+{
+public:
+    ~TfliteMicroModelPoolWrapper();
+    bool load(
+        const std::string& flatbuffer_data,
+        int n_instances,
+        int runtime_memory_size
+    );
+    void unload();
+
+    int size() const;
+    py::array map(const py::array& inputs);
+
+private:
+    std::string _flatbuffer_data;
+    std::vector<std::unique_ptr<TfliteMicroModel>> _models;
+};
+
+
+} // namespace mltk
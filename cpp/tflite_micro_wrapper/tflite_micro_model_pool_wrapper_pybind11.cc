@@ -0,0 +1,22 @@
+#include <pybind11/pybind11.h>
+#include <pybind11/functional.h>
+#include <pybind11/stl.h>
+
+#include "tflite_micro_model_pool_wrapper.hpp"
+
+
+namespace py = pybind11;
+using namespace mltk;
+
+
+
+void init_tflite_micro_model_pool(py::module &m)
+{
+    py::class_<TfliteMicroModelPoolWrapper>(m, "TfliteMicroModelPoolWrapper")
+    .def(py::init<>())
+    .def("load", &TfliteMicroModelPoolWrapper::load)
+    .def("unload", &TfliteMicroModelPoolWrapper::unload)
+    .def("size", &TfliteMicroModelPoolWrapper::size)
+    .def("map", &TfliteMicroModelPoolWrapper::map)
+    ;
+}
@@ -1,4 +1,6 @@
 #include <exception>
+#include <cstring>
+#include <algorithm>
 
 #include "tensorflow/lite/micro/all_ops_resolver.h"
 #include "tflite_micro_model_wrapper.hpp"
@@ -7,18 +9,23 @@
 #include "pybind11_helper.hpp"
 
 
-extern bool mltk_tflm_force_buffer_overlap;
+extern thread_local bool mltk_tflm_force_buffer_overlap;
 
 namespace mltk
 {
 
 static tflite::AllOpsResolver reference_ops_resolver;
 
+static int recorder_file_writer(void *user, const void *data, uint32_t length);
+static bool recorder_layer_filter(int op_idx, void* arg);
+static bool recorder_tensor_filter(int op_idx, int tensor_idx, bool is_input, void* arg);
+
 /*************************************************************************************************/
 TfliteMicroModelWrapper::~TfliteMicroModelWrapper()
 {
     unload();
-    mltk_tflite_micro_set_accelerator(nullptr);
+    unmap_flatbuffer();
+    close_recorder_file();
 }
 
 /*************************************************************************************************/
@@ -33,8 +40,72 @@ bool TfliteMicroModelWrapper::load(
 {
     get_logger().debug("Loading model ...");
 
-    tflite::MicroOpResolver *op_resolver;
+    unload();
+    unmap_flatbuffer();
     this->_flatbuffer_data = flatbuffer_data;
+
+    return load_flatbuffer(
+        this->_flatbuffer_data.c_str(),
+        accelerator,
+        enable_profiler,
+        enable_tensor_recorder,
+        force_buffer_overlap,
+        runtime_memory_size
+    );
+}
+
+/*************************************************************************************************/
+bool TfliteMicroModelWrapper::load_from_file(
+    const std::string& flatbuffer_path, 
+    void* accelerator,
+    bool enable_profiler,
+    bool enable_tensor_recorder,
+    bool force_buffer_overlap,
+    int runtime_memory_size
+)
+{
+    get_logger().debug("Loading model from %s ...", flatbuffer_path.c_str());
+
+    // Memory-map the .tflite instead of copying it into the heap.
+    // The mapped pages are shared with any other process that loads the same file
+    unload();
+    unmap_flatbuffer();
+    this->_flatbuffer_data.clear();
+    if(!map_model_flatbuffer(flatbuffer_path.c_str(), &_mapped_flatbuffer, &_mapped_flatbuffer_length))
+    {
+        return false;
+    }
+
+    // The accelerator simulator maps a fixed-size "flash" region starting at the flatbuffer,
+    // which may extend past the end of the file mapping.
+    // So copy the flatbuffer into the heap when an accelerator is used
+    if(accelerator != nullptr)
+    {
+        this->_flatbuffer_data.assign((const char*)_mapped_flatbuffer, _mapped_flatbuffer_length);
+        unmap_flatbuffer();
+    }
+
+    return load_flatbuffer(
+        (_mapped_flatbuffer != nullptr) ? (const void*)_mapped_flatbuffer : (const void*)this->_flatbuffer_data.c_str(),
+        accelerator,
+        enable_profiler,
+        enable_tensor_recorder,
+        force_buffer_overlap,
+        runtime_memory_size
+    );
+}
+
+/*************************************************************************************************/
+bool TfliteMicroModelWrapper::load_flatbuffer(
+    const void* flatbuffer, 
+    void* accelerator,
+    bool enable_profiler,
+    bool enable_tensor_recorder,
+    bool force_buffer_overlap,
+    int runtime_memory_size
+)
+{
+    tflite::MicroOpResolver *op_resolver;
     this->_accelerator_wrapper = accelerator;
 
     if(enable_profiler)
@@ -46,6 +117,10 @@ bool TfliteMicroModelWrapper::load(
         this->enable_tensor_recorder();
     }
 
+    // The model uses this accelerator for the rest of its lifetime,
+    // it is given to the model with the load context below
+    TfliteMicroRuntimeContext load_context;
+
     // If no accelerator is provided,
     // then just use the reference kernels
     if(accelerator == nullptr)
@@ -56,8 +131,14 @@ bool TfliteMicroModelWrapper::load(
     {
         auto acc = (TfliteMicroAcceleratorWrapper*)accelerator;
         op_resolver = acc->load();
+        load_context.accelerator = acc->accelerator;
     }
 
+    // The model loads with the accelerator of the calling thread's active runtime context
+    // (see mltk_tflite_micro_get_registered_accelerator()) instead of the process-wide registered accelerator.
+    // This way, models loaded concurrently on other threads do not affect each other's accelerator
+    ScopedRuntimeContext load_context_scope(&load_context);
+
     mltk_tflm_force_buffer_overlap = force_buffer_overlap;
 
     uint8_t* runtime_buffer = nullptr;
@@ -68,7 +149,7 @@ bool TfliteMicroModelWrapper::load(
     }
 
     bool retval = TfliteMicroModel::load(
-        this->_flatbuffer_data.c_str(),
+        flatbuffer,
         *op_resolver,
         runtime_buffer, 
         runtime_memory_size
@@ -79,20 +160,116 @@ bool TfliteMicroModelWrapper::load(
     return retval;
 }
 
+/*************************************************************************************************/
+void TfliteMicroModelWrapper::unmap_flatbuffer()
+{
+    if(_mapped_flatbuffer != nullptr)
+    {
+        unmap_model_flatbuffer(_mapped_flatbuffer, _mapped_flatbuffer_length);
+        _mapped_flatbuffer = nullptr;
+        _mapped_flatbuffer_length = 0;
+    }
+}
+
 /*************************************************************************************************/
 bool TfliteMicroModelWrapper::invoke() const
 {
-    if(this->_accelerator_wrapper != nullptr)
+    // NOTE: The accelerator used by the model was captured when the model was loaded
+    // so there is no need to register it again here.
+    // This allows for multiple models to be invoked concurrently.
+    const bool retval = TfliteMicroModel::invoke();
+
+    // Ensure the streamed records are readable once invoke() returns
+    if(_recorder_file != nullptr)
+    {
+        fflush(_recorder_file);
+    }
+
+    return retval;
+}
+
+/*************************************************************************************************/
+bool TfliteMicroModelWrapper::invoke_range(int first_op, int last_op) const
+{
+    const bool retval = TfliteMicroModel::invoke_range(first_op, last_op);
+
+    if(_recorder_file != nullptr)
+    {
+        fflush(_recorder_file);
+    }
+
+    return retval;
+}
+
+/*************************************************************************************************/
+py::array TfliteMicroModelWrapper::invoke_batch(const py::array& inputs)
+{
+    auto input_tensor = this->input(0);
+    auto output_tensor = this->output(0);
+
+    if(input_tensor == nullptr || output_tensor == nullptr)
+    {
+        throw std::runtime_error("Model not loaded");
+    }
+
+    const auto contiguous_inputs = input_batch_to_contiguous_array(inputs, *input_tensor);
+    const ssize_t batch_size = inputs.shape(0);
+    py::array outputs = create_output_batch(batch_size, *output_tensor);
+
+    const auto input_bytes = input_tensor->bytes;
+    const auto output_bytes = output_tensor->bytes;
+    const uint8_t* src = static_cast<const uint8_t*>(contiguous_inputs.data());
+    uint8_t* dst = static_cast<uint8_t*>(outputs.mutable_data());
+    bool success = true;
+
+    {
+        // Release the Python Global Interpreter Lock (GIL)
+        // while running the batch
+        // This way, other Python threads may execute concurrently
+        py::gil_scoped_release release;
+
+        for(ssize_t i = 0; i < batch_size; ++i)
+        {
+            memcpy(input_tensor->data.raw, src, input_bytes);
+            if(!invoke())
+            {
+                success = false;
+                break;
+            }
+            memcpy(dst, output_tensor->data.raw, output_bytes);
+            src += input_bytes;
+            dst += output_bytes;
+        }
+    }
+
+    if(!success)
+    {
+        throw std::runtime_error("Failed to invoke model");
+    }
+
+    return outputs;
+}
+
+/*************************************************************************************************/
+std::unique_ptr<TfliteMicroArenaSnapshot> TfliteMicroModelWrapper::snapshot_arena(int op_index) const
+{
+    std::unique_ptr<TfliteMicroArenaSnapshot> snapshot(new TfliteMicroArenaSnapshot());
+
+    if(!TfliteMicroModel::snapshot_arena(op_index, *snapshot))
+    {
+        throw std::runtime_error("Failed to snapshot the tensor arena");
+    }
+
+    return snapshot;
+}
+
+/*************************************************************************************************/
+void TfliteMicroModelWrapper::restore_arena(const TfliteMicroArenaSnapshot& snapshot) const
+{
+    if(!TfliteMicroModel::restore_arena(snapshot))
     {
-        // Technically, this should not be required as the accelerator should have already 
-        // been set by the accelerator wrapper when calling mltk_tflite_micro_register_accelerator() in the load() 
-        // However, for some reason the pointer is being cleared on Linux in some instances.
-        // So, as a failsafe we set the accelerator pointer again before invoking the simulator.
-        auto accelerator_wrapper = (const TfliteMicroAcceleratorWrapper*)this->_accelerator_wrapper;
-        mltk_tflite_micro_set_accelerator(accelerator_wrapper->accelerator);
+        throw std::runtime_error("Failed to restore the tensor arena snapshot");
     }
-    
-    return TfliteMicroModel::invoke();
 }
 
 /*************************************************************************************************/
@@ -115,9 +292,43 @@ py::dict TfliteMicroModelWrapper::get_details() const
     }
     details_dict["classes"] = classes;
 
+    TfliteMicroMemoryPlan memory_plan;
+    if(this->is_loaded() && this->get_memory_plan(memory_plan))
+    {
+        py::dict plan_dict;
+        py::list buffers;
+
+        for(const auto& buffer : memory_plan.buffers)
+        {
+            py::dict buffer_dict;
+            buffer_dict["type"] = to_str(buffer.type);
+            buffer_dict["index"] = buffer.index;
+            buffer_dict["op_index"] = buffer.op_index;
+            buffer_dict["offset"] = buffer.offset;
+            buffer_dict["size"] = buffer.size;
+            buffer_dict["first_use"] = buffer.first_use;
+            buffer_dict["last_use"] = buffer.last_use;
+            buffers.append(buffer_dict);
+        }
+
+        plan_dict["arena_size"] = memory_plan.arena_size;
+        plan_dict["head_size"] = memory_plan.head_size;
+        plan_dict["tail_size"] = memory_plan.tail_size;
+        plan_dict["buffers"] = buffers;
+        details_dict["memory_plan"] = plan_dict;
+    }
+
     // These are used internally for debugging
-    details_dict["tflite_buffer_addr"] = (uint32_t)((uintptr_t)this->_flatbuffer_data.c_str());
-    details_dict["tflite_buffer_Length"] = this->_flatbuffer_data.length();
+    if(_mapped_flatbuffer != nullptr)
+    {
+        details_dict["tflite_buffer_addr"] = (uint32_t)((uintptr_t)_mapped_flatbuffer);
+        details_dict["tflite_buffer_Length"] = _mapped_flatbuffer_length;
+    }
+    else 
+    {
+        details_dict["tflite_buffer_addr"] = (uint32_t)((uintptr_t)this->_flatbuffer_data.c_str());
+        details_dict["tflite_buffer_Length"] = this->_flatbuffer_data.length();
+    }
 
 
     return details_dict;
@@ -162,6 +373,7 @@ py::list TfliteMicroModelWrapper::get_profiling_results() const
 
     cpputils::TypedList<profiling::Profiler*> profiler_list;
     profiling::get_all(model_profiler->name(), profiler_list);
+    const int custom_stat_count = profiling::get_custom_stat_count();
     for(const auto profiler : profiler_list)
     {
         // Only return model layer profilers which have name like:
@@ -178,12 +390,19 @@ py::list TfliteMicroModelWrapper::get_profiling_results() const
         result["macs"] = metrics.macs;
         result["ops"] = metrics.ops;
         result["accelerator_cycles"] = stats.accelerator_cycles;
-        result["cpu_cycles"] = 0; // stats.cpu_cycles;  CPU cycles and time are not currently measured in the simulator
-        result["time"] = 0; // (float)stats.time_us / 1e6;
-        for(auto item_it = profiler->custom_stats.items(); item_it != profiler->custom_stats.enditems(); ++item_it)
+        // NOTE: cpu_cycles and time are for the embedded device and are estimated by the Python API.
+        //       The host_* values are measured on this Windows/Linux host
+        result["cpu_cycles"] = 0;
+        result["time"] = 0;
+        result["host_time"] = (double)stats.time_ns / 1e9;
+        result["host_cpu_cycles"] = stats.cpu_cycles;
+        result["host_instructions"] = stats.instructions;
+        for(profiling::CustomStatId id = 0; id < custom_stat_count; ++id)
         {
-            const auto item = item_it.current;
-            result[item->key] = *item->value;
+            if(profiler->has_custom_stat(id))
+            {
+                result[profiling::get_custom_stat_name(id)] = profiler->get_custom_stat(id);
+            }
         }
 
         results.append(result);
@@ -207,6 +426,170 @@ py::bytes TfliteMicroModelWrapper::get_recorded_data()
     return py::none();
 }
 
+/*************************************************************************************************/
+bool TfliteMicroModelWrapper::set_tensor_recorder_config(
+    const std::string& output_path,
+    const std::vector<int>& layers,
+    const std::vector<int>& tensors,
+    bool record_inputs,
+    bool record_outputs,
+    bool metadata_only
+)
+{
+    TfliteMicroRecorderConfig config;
+
+    close_recorder_file();
+    if(!output_path.empty())
+    {
+        _recorder_file = fopen(output_path.c_str(), "wb");
+        if(_recorder_file == nullptr)
+        {
+            throw std::runtime_error("Failed to open tensor recorder output file: " + output_path);
+        }
+        config.writer = recorder_file_writer;
+        config.writer_arg = _recorder_file;
+    }
+
+    // The filters use binary searches, so sort the indices
+    _recorder_layers = layers;
+    _recorder_tensors = tensors;
+    std::sort(_recorder_layers.begin(), _recorder_layers.end());
+    std::sort(_recorder_tensors.begin(), _recorder_tensors.end());
+
+    config.layer_filter = _recorder_layers.empty() ? nullptr : recorder_layer_filter;
+    config.tensor_filter = _recorder_tensors.empty() ? nullptr : recorder_tensor_filter;
+    config.filter_arg = this;
+    config.record_inputs = record_inputs;
+    config.record_outputs = record_outputs;
+    config.metadata_only = metadata_only;
+
+    return TfliteMicroModel::set_tensor_recorder_config(config);
+}
+
+/*************************************************************************************************/
+bool TfliteMicroModelWrapper::enable_activation_stats(int n_bins)
+{
+    if(n_bins <= 0)
+    {
+        throw std::invalid_argument("n_bins must be greater than 0");
+    }
+    return TfliteMicroModel::enable_activation_stats(n_bins);
+}
+
+/*************************************************************************************************/
+py::list TfliteMicroModelWrapper::get_activation_stats() const
+{
+    py::list results;
+
+    const auto collector = activation_stats();
+    if(collector == nullptr)
+    {
+        return results;
+    }
+
+    for(int tensor_idx = 0; tensor_idx < collector->tensor_count; ++tensor_idx)
+    {
+        const auto& stats = collector->stats[tensor_idx];
+        if(stats.op_index < 0 || stats.count == 0)
+        {
+            continue;
+        }
+
+        py::dict result;
+        result["tensor_index"] = tensor_idx;
+        result["layer_index"] = stats.op_index;
+        result["count"] = stats.count;
+        result["min"] = stats.min;
+        result["max"] = stats.max;
+        result["mean"] = stats.mean;
+        result["variance"] = stats.m2 / (double)stats.count;
+        result["histogram"] = py::array_t<uint32_t>(collector->n_bins, stats.histogram);
+        result["histogram_min"] = stats.histogram_min;
+        result["histogram_max"] = stats.histogram_min + stats.histogram_bin_width * collector->n_bins;
+        results.append(result);
+    }
+
+    return results;
+}
+
+/*************************************************************************************************/
+bool TfliteMicroModelWrapper::enable_differential_execution(float tolerance)
+{
+    if(tolerance < 0)
+    {
+        throw std::invalid_argument("tolerance must be non-negative");
+    }
+
+    // The model's kernels (e.g. the accelerator's kernels or the host-optimized kernels)
+    // are compared against this library's kernels. The differential executor forces those
+    // to use the TFLM reference implementations instead of the host-optimized kernels
+    return TfliteMicroModel::enable_differential_execution(reference_ops_resolver, tolerance);
+}
+
+/*************************************************************************************************/
+py::dict TfliteMicroModelWrapper::get_differential_results() const
+{
+    py::dict results;
+    py::list layers;
+
+    auto diff = this->differential_execution();
+    if(diff == nullptr)
+    {
+        throw std::runtime_error("Differential execution not enabled");
+    }
+
+    for(int op_idx = 0; op_idx < diff->op_count; ++op_idx)
+    {
+        const auto& layer = diff->layers[op_idx];
+        py::dict layer_dict;
+        layer_dict["index"] = op_idx;
+        layer_dict["invoke_count"] = layer.invoke_count;
+        layer_dict["element_count"] = layer.element_count;
+        layer_dict["mismatch_count"] = layer.mismatch_count;
+        layer_dict["max_abs_error"] = layer.max_abs_error;
+        layer_dict["reference_failed"] = layer.reference_failed;
+        layers.append(layer_dict);
+    }
+
+    results["first_mismatch_layer"] = diff->first_mismatch_op_index;
+    results["layers"] = layers;
+
+    return results;
+}
+
+/*************************************************************************************************/
+void TfliteMicroModelWrapper::close_recorder_file()
+{
+    if(_recorder_file != nullptr)
+    {
+        // Ensure the recorder no longer references the file
+        TfliteMicroModel::set_tensor_recorder_config(TfliteMicroRecorderConfig());
+        fclose(_recorder_file);
+        _recorder_file = nullptr;
+    }
+}
+
+/*************************************************************************************************/
+static int recorder_file_writer(void *user, const void *data, uint32_t length)
+{
+    auto fp = (FILE*)user;
+    return (fwrite(data, 1, length, fp) == length) ? 0 : -1;
+}
+
+/*************************************************************************************************/
+static bool recorder_layer_filter(int op_idx, void* arg)
+{
+    auto& layers = ((TfliteMicroModelWrapper*)arg)->recorder_layers();
+    return std::binary_search(layers.begin(), layers.end(), op_idx);
+}
+
+/*************************************************************************************************/
+static bool recorder_tensor_filter(int op_idx, int tensor_idx, bool is_input, void* arg)
+{
+    auto& tensors = ((TfliteMicroModelWrapper*)arg)->recorder_tensors();
+    return std::binary_search(tensors.begin(), tensors.end(), tensor_idx);
+}
+
 
 
 
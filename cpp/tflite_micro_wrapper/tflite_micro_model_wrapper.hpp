@@ -1,5 +1,8 @@
 #include <string>
+#include <vector>
+#include <cstdio>
 #include <map>
+#include <memory>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 #include <pybind11/numpy.h>
@@ -26,18 +29,66 @@ public:
         bool force_buffer_overlap,
         int runtime_memory_size
     );
+    bool load_from_file(
+        const std::string& flatbuffer_path, 
+        void* accelerator,
+        bool enable_profiler,
+        bool enable_tensor_recorder,
+        bool force_buffer_overlap,
+        int runtime_memory_size
+    );
 
     bool invoke() const;
+    bool invoke_range(int first_op, int last_op) const;
+    py::array invoke_batch(const py::array& inputs);
+    std::unique_ptr<TfliteMicroArenaSnapshot> snapshot_arena(int op_index) const;
+    void restore_arena(const TfliteMicroArenaSnapshot& snapshot) const;
     py::dict get_details() const;
     py::array get_input(int index);
     py::array get_output(int index);
     py::list get_profiling_results() const;
     py::bytes get_recorded_data();
+    bool set_tensor_recorder_config(
+        const std::string& output_path,
+        const std::vector<int>& layers,
+        const std::vector<int>& tensors,
+        bool record_inputs,
+        bool record_outputs,
+        bool metadata_only
+    );
+    bool enable_activation_stats(int n_bins);
+    py::list get_activation_stats() const;
+    bool enable_differential_execution(float tolerance);
+    py::dict get_differential_results() const;
+    const std::vector<int>& recorder_layers() const
+    {
+        return _recorder_layers;
+    }
+    const std::vector<int>& recorder_tensors() const
+    {
+        return _recorder_tensors;
+    }
 
 private:
     const void* _accelerator_wrapper;
     std::string _flatbuffer_data;
+    const uint8_t* _mapped_flatbuffer = nullptr;
+    uint32_t _mapped_flatbuffer_length = 0;
     std::string _runtime_memory;
+    FILE* _recorder_file = nullptr;
+    std::vector<int> _recorder_layers;
+    std::vector<int> _recorder_tensors;
+
+    bool load_flatbuffer(
+        const void* flatbuffer, 
+        void* accelerator,
+        bool enable_profiler,
+        bool enable_tensor_recorder,
+        bool force_buffer_overlap,
+        int runtime_memory_size
+    );
+    void unmap_flatbuffer();
+    void close_recorder_file();
 };
 
 
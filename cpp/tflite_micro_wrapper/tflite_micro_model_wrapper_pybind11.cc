@@ -12,18 +12,39 @@ using namespace mltk;
 
 void init_tflite_micro_model(py::module &m)
 {
+    py::class_<TfliteMicroArenaSnapshot>(m, "TfliteMicroArenaSnapshot")
+    .def_readonly("op_index", &TfliteMicroArenaSnapshot::op_index)
+    .def_readonly("size", &TfliteMicroArenaSnapshot::size)
+    ;
+
     py::class_<TfliteMicroModelWrapper>(m, "TfliteMicroModelWrapper")
     .def(py::init<>())
     .def("load", &TfliteMicroModelWrapper::load)
+    .def("load_from_file", &TfliteMicroModelWrapper::load_from_file)
     .def("get_details", &TfliteMicroModelWrapper::get_details)
     .def("get_input_size", &TfliteMicroModelWrapper::input_size)
     .def("get_input", &TfliteMicroModelWrapper::get_input)
     .def("get_output_size", &TfliteMicroModelWrapper::output_size)
     .def("get_output", &TfliteMicroModelWrapper::get_output)
     .def("invoke", &TfliteMicroModelWrapper::invoke)
+    .def("invoke_range", &TfliteMicroModelWrapper::invoke_range)
+    .def("invoke_batch", &TfliteMicroModelWrapper::invoke_batch)
+    .def("snapshot_arena", &TfliteMicroModelWrapper::snapshot_arena)
+    .def("restore_arena", &TfliteMicroModelWrapper::restore_arena)
     .def("is_profiler_enabled", &TfliteMicroModelWrapper::profiler_is_enabled)
     .def("get_profiling_results", &TfliteMicroModelWrapper::get_profiling_results)
     .def("is_tensor_recorder_enabled", &TfliteMicroModelWrapper::is_tensor_recorder_enabled)
     .def("get_recorded_data", &TfliteMicroModelWrapper::get_recorded_data)
+    .def("set_tensor_recorder_config", &TfliteMicroModelWrapper::set_tensor_recorder_config)
+    .def("enable_activation_stats", &TfliteMicroModelWrapper::enable_activation_stats)
+    .def("disable_activation_stats", &TfliteMicroModelWrapper::disable_activation_stats)
+    .def("is_activation_stats_enabled", &TfliteMicroModelWrapper::is_activation_stats_enabled)
+    .def("reset_activation_stats", &TfliteMicroModelWrapper::reset_activation_stats)
+    .def("get_activation_stats", &TfliteMicroModelWrapper::get_activation_stats)
+    .def("enable_differential_execution", &TfliteMicroModelWrapper::enable_differential_execution)
+    .def("disable_differential_execution", &TfliteMicroModelWrapper::disable_differential_execution)
+    .def("is_differential_execution_enabled", &TfliteMicroModelWrapper::is_differential_execution_enabled)
+    .def("reset_differential_execution", &TfliteMicroModelWrapper::reset_differential_execution)
+    .def("get_differential_results", &TfliteMicroModelWrapper::get_differential_results)
     ;
 }
\ No newline at end of file
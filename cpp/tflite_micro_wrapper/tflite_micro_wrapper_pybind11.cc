@@ -12,12 +12,14 @@
 namespace py = pybind11;
 
 extern void init_tflite_micro_model(py::module &);
+extern void init_tflite_micro_model_pool(py::module &);
 
 
 
 PYBIND11_MODULE(MODULE_NAME, m) 
 {
     init_tflite_micro_model(m);
+    init_tflite_micro_model_pool(m);
 
     /*************************************************************************************************
      * API version number of the wrapper 
@@ -62,6 +62,77 @@ class AudioFeatureGenerator:
         return spectrogram
 
 
+    def process_batch(self, samples: np.ndarray, dtype=np.float32, n_threads:int=0) -> np.ndarray:
+        """Convert a batch of 1D audio samples to 2D spectrograms using the AudioFeatureGenerator
+
+        This is equivalent to calling :py:meth:`~process_sample` on each sample in the batch,
+        however, the spectrograms are generated in parallel on native threads
+        without holding the Python Global Interpreter Lock (GIL).
+
+        .. note:: This resets the streaming state, see :py:meth:`~push`
+
+        Args:
+            samples: [n_samples, sample_length] int16 audio samples
+            dtype: Output data type, must be int8, uint16, or float32
+            n_threads: Number of threads to use, if <= 0 then use all CPU cores
+
+        Returns:
+            [n_samples, n_features, n_channels] int8, uint16, or float32 spectrograms
+        """
+        samples = np.ascontiguousarray(samples, dtype=np.int16)
+        spectrograms = np.zeros((len(samples),) + tuple(self._spectrogram_shape), dtype=dtype)
+        self._wrapper.process_batch(samples, spectrograms, n_threads)
+        return spectrograms
+
+
     def activity_was_detected(self) -> bool:
         """Return if activity was detected in the previously processed sample"""
-        return self._wrapper.activity_was_detected()
\ No newline at end of file
+        return self._wrapper.activity_was_detected()
+
+
+    def reset(self):
+        """Reset the streaming state
+
+        This clears the internal spectrogram ring buffer and any buffered audio samples.
+
+        .. note:: :py:meth:`~process_sample` also resets the streaming state
+        """
+        self._wrapper.reset()
+
+
+    def push(self, samples: np.ndarray, dtype=np.float32) -> np.ndarray:
+        """Process the given audio samples and return the newly generated spectrogram slices
+
+        This processes a continuous audio stream, similar to how the AudioFeatureGenerator
+        runs on an embedded device. Only the newly pushed samples are processed, samples that
+        do not yet complete a window are buffered until the next call.
+        The generated slices are also stored in an internal ring buffer of ``n_features`` slices
+        which may be retrieved with :py:meth:`~get_features`.
+
+        This allows for processing long audio recordings with a sliding window
+        without re-generating the entire spectrogram for each window step.
+
+        Args:
+            samples: [n_samples] int16 audio samples, may be any length
+            dtype: Output data type, must be int8, uint16, or float32.
+                NOTE: int8 is not supported if dynamic quantization is enabled, use :py:meth:`~get_features` instead
+
+        Returns:
+            [n_new_slices, n_channels] spectrogram slices generated from the pushed samples
+        """
+        samples = np.asarray(samples, dtype=np.int16)
+        return self._wrapper.push(samples, np.dtype(dtype))
+
+
+    def get_features(self, dtype=np.float32) -> np.ndarray:
+        """Return the spectrogram ring buffer populated by :py:meth:`~push`
+
+        Args:
+            dtype: Output data type, must be int8, uint16, or float32
+
+        Returns:
+            [n_features, n_channels] spectrogram of the most recently pushed audio, oldest slice first
+        """
+        spectrogram = np.zeros(self._spectrogram_shape, dtype=dtype)
+        self._wrapper.get_features(spectrogram)
+        return spectrogram
\ No newline at end of file
@@ -31,3 +31,44 @@ def test_no_samples():
 
     assert np.allclose(calculated, expected)
 
+
+def test_batch_samples():
+    settings = DEFAULT_SETTINGS
+    mfe = AudioFeatureGenerator(settings)
+    yes_sample = np.asarray(YES_INPUT_AUDIO, dtype=np.int16)
+    no_sample = np.asarray(NO_INPUT_AUDIO, dtype=np.int16)
+    batch = np.stack([yes_sample, no_sample] * 5)
+
+    for dtype in (np.int8, np.uint16, np.float32):
+        calculated = mfe.process_batch(batch, dtype=dtype, n_threads=3)
+        assert calculated.shape == (len(batch),) + tuple(settings.spectrogram_shape)
+        expected_yes = mfe.process_sample(yes_sample, dtype=dtype)
+        expected_no = mfe.process_sample(no_sample, dtype=dtype)
+        for i in range(0, len(batch), 2):
+            assert np.array_equal(calculated[i], expected_yes)
+            assert np.array_equal(calculated[i+1], expected_no)
+
+
+def test_streaming_samples():
+    settings = DEFAULT_SETTINGS
+    mfe = AudioFeatureGenerator(settings)
+    sample = np.asarray(YES_INPUT_AUDIO, dtype=np.int16)
+    expected = mfe.process_sample(sample, dtype=np.uint16)
+
+    # Push the sample in arbitrary sized chunks,
+    # the generated slices should be the same as processing the entire sample
+    mfe.reset()
+    slices = []
+    for chunk in np.array_split(sample, [100, 1234, 1300, 5000, 9999]):
+        slices.append(mfe.push(chunk, dtype=np.uint16))
+    calculated = np.concatenate(slices)
+    assert np.array_equal(calculated, expected)
+    assert np.array_equal(mfe.get_features(dtype=np.uint16), expected)
+
+    # Pushing one more window step should slide the ring buffer by one slice
+    window_step = (settings.window_step_ms * settings.sample_rate_hz) // 1000
+    new_slices = mfe.push(sample[:window_step], dtype=np.uint16)
+    assert new_slices.shape == (1, expected.shape[1])
+    features = mfe.get_features(dtype=np.uint16)
+    assert np.array_equal(features[:-1], expected[1:])
+    assert np.array_equal(features[-1], new_slices[0])
@@ -97,6 +97,24 @@ class ProfilingLayerResult(defaultdict):
         """
         return self['energy']
     @property
+    def host_time(self) -> float:
+        """Time in seconds this layer took to execute on the Windows/Linux host
+        NOTE: This is the measured latency of the simulator's kernels, NOT the embedded device
+        """
+        return self['host_time']
+    @property
+    def host_cpu_cycles(self) -> int:
+        """Number of host CPU cycles this layer took to execute
+        This is 0 if no cycle counter is available on the host
+        """
+        return self['host_cpu_cycles']
+    @property
+    def host_instructions(self) -> int:
+        """Number of host CPU instructions this layer retired
+        This is only available on Linux hosts that allow perf_event_open()
+        """
+        return self['host_instructions']
+    @property
     def options_str(self) -> str:
         """Layer configuration options as a string"""
         return f'{self.tflite_layer.options}'
@@ -1,6 +1,7 @@
 from .tflite_micro  import TfliteMicro
 from .tflite_micro_model import (
     TfliteMicroModel, 
+    TfliteMicroModelPool,
     TfliteMicroLayerError, 
     TfliteMicroModelDetails,
     TfliteMicroProfiledLayerResult,
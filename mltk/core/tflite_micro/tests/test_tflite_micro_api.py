@@ -1,5 +1,6 @@
 
 import os
+import threading
 
 import numpy as np
 from mltk.core import TfliteModel
@@ -63,11 +64,219 @@ def test_load_tflite_model_mvp():
     TfliteMicro.unload_model(tflm_model)
 
 
+def test_load_tflite_model_mmap():
+    tflm_model = TfliteMicro.load_tflite_model(IMAGE_EXAMPLE1_TFLITE_PATH, use_mmap=True)
+    assert isinstance(tflm_model, TfliteMicroModel)
+
+    ref_model = TfliteMicro.load_tflite_model(IMAGE_EXAMPLE1_TFLITE_PATH)
+    batch = np.random.uniform(low=-127, high=128, size=(2,) + ref_model.input().shape).astype(np.int8)
+    assert np.array_equal(tflm_model.invoke_batch(batch), ref_model.invoke_batch(batch))
+
+    TfliteMicro.unload_model(ref_model)
+    TfliteMicro.unload_model(tflm_model)
+
+
+def test_memory_plan():
+    tflm_model = TfliteMicro.load_tflite_model(IMAGE_EXAMPLE1_TFLITE_PATH)
+    plan = tflm_model.details.memory_plan
+    assert plan['head_size'] > 0
+    assert plan['head_size'] + plan['tail_size'] <= plan['arena_size']
+
+    buffers = plan['buffers']
+    assert len([b for b in buffers if b['type'] == 'input']) == tflm_model.input_size
+    assert len([b for b in buffers if b['type'] == 'output']) == tflm_model.output_size
+    for b in buffers:
+        assert b['offset'] + b['size'] <= plan['arena_size']
+        assert b['first_use'] <= b['last_use']
+
+    # Planned buffers that are used at the same time must not overlap
+    planned = [b for b in buffers if b['type'] != 'persistent']
+    for i, a in enumerate(planned):
+        for b in planned[i+1:]:
+            if a['last_use'] < b['first_use'] or b['last_use'] < a['first_use']:
+                continue
+            assert a['offset'] + a['size'] <= b['offset'] or b['offset'] + b['size'] <= a['offset']
+
+    TfliteMicro.unload_model(tflm_model)
+
+
+def test_activation_stats():
+    tflm_model = TfliteMicro.load_tflite_model(IMAGE_EXAMPLE1_TFLITE_PATH)
+    tflite_model = TfliteModel.load_flatbuffer_file(IMAGE_EXAMPLE1_TFLITE_PATH)
+    tflm_model.enable_activation_stats(n_bins=64)
+    assert tflm_model.is_activation_stats_enabled
+
+    input_shape = tflm_model.input().shape
+    batch = np.random.uniform(low=-127, high=128, size=(6,) + input_shape).astype(np.int8)
+    outputs = tflm_model.invoke_batch(batch)
+
+    stats = tflm_model.get_activation_stats()
+    assert len(stats) == len(tflite_model.layers)
+    for s in stats:
+        assert s['min'] <= s['mean'] <= s['max']
+        assert s['variance'] >= 0
+        assert s['histogram_min'] <= s['min'] and s['max'] <= s['histogram_max']
+        assert s['histogram'].sum() == s['count']
+
+    # The model output's statistics should match the dequantized outputs
+    output_tensor = tflite_model.outputs[0]
+    output_stats = [s for s in stats if s['tensor_index'] == output_tensor.index][0]
+    values = (outputs.astype(np.float32) - output_tensor.quantization.zeropoint[0]) * output_tensor.quantization.scale[0]
+    assert output_stats['count'] == values.size
+    assert np.isclose(output_stats['min'], values.min())
+    assert np.isclose(output_stats['max'], values.max())
+    assert np.isclose(output_stats['mean'], values.mean(), rtol=1e-4, atol=1e-6)
+    assert np.isclose(output_stats['variance'], values.var(), rtol=1e-3, atol=1e-6)
+
+    tflm_model.reset_activation_stats()
+    assert len(tflm_model.get_activation_stats()) == 0
+    tflm_model.disable_activation_stats()
+    assert not tflm_model.is_activation_stats_enabled
+    TfliteMicro.unload_model(tflm_model)
+
+
+def test_differential_execution():
+    # Without an accelerator, the model's kernels (i.e. the host-optimized kernels if enabled)
+    # are compared against the reference kernels, they must be bit-exact
+    tflm_model = TfliteMicro.load_tflite_model(IMAGE_EXAMPLE1_TFLITE_PATH)
+    tflite_model = TfliteModel.load_flatbuffer_file(IMAGE_EXAMPLE1_TFLITE_PATH)
+    tflm_model.enable_differential_execution()
+    assert tflm_model.is_differential_execution_enabled
+
+    input_shape = tflm_model.input().shape
+    batch = np.random.uniform(low=-127, high=128, size=(3,) + input_shape).astype(np.int8)
+    expected = tflm_model.invoke_batch(batch)
+
+    results = tflm_model.get_differential_results()
+    assert results['first_mismatch_layer'] == -1
+    assert len(results['layers']) == len(tflite_model.layers)
+    for i, layer in enumerate(results['layers']):
+        assert layer['index'] == i
+        assert not layer['reference_failed']
+        assert layer['invoke_count'] == 3
+        assert layer['element_count'] > 0
+        assert layer['mismatch_count'] == 0
+        assert layer['max_abs_error'] == 0
+
+    tflm_model.disable_differential_execution()
+    assert not tflm_model.is_differential_execution_enabled
+    TfliteMicro.unload_model(tflm_model)
+
+    # The MVP kernels are compared against the reference kernels,
+    # the model outputs must not be affected
+    tflm_model = TfliteMicro.load_tflite_model(IMAGE_EXAMPLE1_TFLITE_PATH, accelerator='mvp')
+    expected = tflm_model.invoke_batch(batch)
+    tflm_model.enable_differential_execution(tolerance=1)
+    assert np.array_equal(tflm_model.invoke_batch(batch), expected)
+
+    results = tflm_model.get_differential_results()
+    mismatched = [l['index'] for l in results['layers'] if l['mismatch_count'] > 0]
+    assert results['first_mismatch_layer'] == (mismatched[0] if mismatched else -1)
+    for layer in results['layers']:
+        assert not layer['reference_failed']
+        assert layer['invoke_count'] == 3
+
+    tflm_model.reset_differential_execution()
+    results = tflm_model.get_differential_results()
+    assert all(layer['invoke_count'] == 0 for layer in results['layers'])
+    TfliteMicro.unload_model(tflm_model)
+
+
+def test_invoke_batch():
+    tflm_model = TfliteMicro.load_tflite_model(IMAGE_EXAMPLE1_TFLITE_PATH)
+    input_shape = tflm_model.input().shape
+    batch = np.random.uniform(low=-127, high=128, size=(4,) + input_shape).astype(np.int8)
+    outputs = tflm_model.invoke_batch(batch)
+    assert outputs.shape == (4,) + tflm_model.output().shape
+
+    for i in range(4):
+        tflm_model.input(value=batch[i])
+        tflm_model.invoke()
+        assert np.array_equal(outputs[i], tflm_model.output())
+    TfliteMicro.unload_model(tflm_model)
+
+
+def test_invoke_range_snapshot():
+    tflm_model = TfliteMicro.load_tflite_model(IMAGE_EXAMPLE1_TFLITE_PATH)
+    input_shape = tflm_model.input().shape
+    batch = np.random.uniform(low=-127, high=128, size=(2,) + input_shape).astype(np.int8)
+    expected = tflm_model.invoke_batch(batch)
+
+    # Running the layers in two ranges should give the same output as invoke()
+    tflm_model.input(value=batch[0])
+    tflm_model.invoke_range(0, 3)
+    snapshot = tflm_model.snapshot_arena(4)
+    assert snapshot.op_index == 4
+    assert snapshot.size > 0
+    tflm_model.invoke_range(4)
+    assert np.array_equal(tflm_model.output(), expected[0])
+
+    # Invoking another sample overwrites the arena,
+    # restoring the snapshot should resume from the first sample's activations
+    tflm_model.input(value=batch[1])
+    tflm_model.invoke()
+    assert np.array_equal(tflm_model.output(), expected[1])
+    tflm_model.restore_arena(snapshot)
+    tflm_model.invoke_range(4, -1)
+    assert np.array_equal(tflm_model.output(), expected[0])
+
+    TfliteMicro.unload_model(tflm_model)
+
+
+def test_invoke_concurrent_models():
+    n_models = 4
+    tflm_models = [TfliteMicro.load_tflite_model(IMAGE_EXAMPLE1_TFLITE_PATH) for _ in range(n_models)]
+    input_shape = tflm_models[0].input().shape
+    batches = [
+        np.random.uniform(low=-127, high=128, size=(8,) + input_shape).astype(np.int8) 
+        for _ in range(n_models)
+    ]
+
+    # Run each batch serially to get the expected outputs
+    expected = [tflm_models[0].invoke_batch(batch) for batch in batches]
+
+    # Then run each batch on a different model in parallel
+    # (invoke_batch() releases the GIL so the models execute concurrently)
+    results = [None] * n_models
+    def _run(i):
+        results[i] = tflm_models[i].invoke_batch(batches[i])
+
+    threads = [threading.Thread(target=_run, args=(i,)) for i in range(n_models)]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+
+    for i in range(n_models):
+        assert np.array_equal(results[i], expected[i])
+
+    for tflm_model in tflm_models:
+        TfliteMicro.unload_model(tflm_model)
+
+
+def test_model_pool_map():
+    tflm_model = TfliteMicro.load_tflite_model(IMAGE_EXAMPLE1_TFLITE_PATH)
+    pool = TfliteMicro.load_tflite_model_pool(IMAGE_EXAMPLE1_TFLITE_PATH, n_instances=3)
+    assert pool.n_instances == 3
+
+    input_shape = tflm_model.input().shape
+    batch = np.random.uniform(low=-127, high=128, size=(10,) + input_shape).astype(np.int8)
+    expected = tflm_model.invoke_batch(batch)
+    outputs = pool.map(batch)
+    assert np.array_equal(outputs, expected)
+
+    pool.unload()
+    TfliteMicro.unload_model(tflm_model)
+
+
 def test_profile_model():
     results = TfliteMicro.profile_model(IMAGE_EXAMPLE1_TFLITE_PATH)
     assert results.n_layers == 8
     assert results.accelerator_cycles == 0
     assert results.macs > 0
+    # The host latency is measured for each layer
+    assert sum(layer.host_time for layer in results.layers) > 0
+    assert all(layer.host_time >= 0 for layer in results.layers)
 
 
 def test_profile_model_mvp():
@@ -91,4 +300,42 @@ def test_profile_model_mvp_unsupported_layer():
 def test_record_model():
     input_data = np.random.uniform(low=-127, high=128, size=(96,96,1)).astype(np.int8)
     layers = TfliteMicro.record_model(IMAGE_EXAMPLE1_TFLITE_PATH, input_data)
-    assert len(layers) == 8
\ No newline at end of file
+    assert len(layers) == 8
+
+def test_record_model_stream(tmp_path):
+    input_data = np.random.uniform(low=-127, high=128, size=(96,96,1)).astype(np.int8)
+    expected_layers = TfliteMicro.record_model(IMAGE_EXAMPLE1_TFLITE_PATH, input_data)
+
+    output_path = str(tmp_path / 'recorded.msgpack')
+    layers = TfliteMicro.record_model(
+        IMAGE_EXAMPLE1_TFLITE_PATH, 
+        input_data,
+        layers=[1, 3],
+        output_path=output_path
+    )
+    assert os.path.exists(output_path)
+    assert [l.index for l in layers] == [1, 3]
+    for layer in layers:
+        expected = expected_layers[layer.index]
+        assert np.array_equal(layer.outputs[0].data, expected.outputs[0].data)
+        assert np.array_equal(layer.inputs[0].data, expected.inputs[0].data)
+
+
+def test_tensor_recorder_metadata_only(tmp_path):
+    tflm_model = TfliteMicro.load_tflite_model(IMAGE_EXAMPLE1_TFLITE_PATH, enable_tensor_recorder=True)
+    output_path = str(tmp_path / 'recorded.msgpack')
+    tflm_model.set_tensor_recorder_config(
+        output_path=output_path, 
+        record_inputs=False,
+        metadata_only=True
+    )
+    tflm_model.invoke()
+
+    records = list(TfliteMicroModel.read_recorded_file(output_path))
+    assert [r['index'] for r in records] == list(range(8))
+    for r in records:
+        assert 'inputs' not in r
+        output = r['outputs'][0]
+        assert output['bytes'] == int(np.prod(output['shape']))
+
+    TfliteMicro.unload_model(tflm_model)
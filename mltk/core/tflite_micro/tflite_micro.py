@@ -15,7 +15,7 @@ from mltk.utils.python import (as_list, get_case_insensitive, import_module_at_p
 from mltk.utils.path import (fullpath, get_user_setting)
 from ..profiling_results import ProfilingModelResults, ProfilingLayerResult
 from .tflite_micro_accelerator import TfliteMicroAccelerator
-from .tflite_micro_model import TfliteMicroModel, TfliteMicroModelDetails
+from .tflite_micro_model import TfliteMicroModel, TfliteMicroModelDetails, TfliteMicroModelPool
 
 
 
@@ -126,13 +126,17 @@ class TfliteMicro:
         enable_tensor_recorder=False,
         force_buffer_overlap=False,
         runtime_buffer_size=0,
+        use_mmap=False,
         **kwargs
     ) -> TfliteMicroModel:
         """Load the TF-Lite Micro interpreter with the given .tflite model
         
         NOTE: 
-        - Only 1 model may be loaded at a time
+        - Multiple models using the reference kernels may be loaded (and invoked from different threads) at the same time
+        - Only 1 model using an accelerator may be loaded at a time
         - You must call unload_model() when the model is no longer needed
+        - If use_mmap=True and model is a file path, then the .tflite file is memory-mapped
+          instead of copied. The mapped pages are shared by all processes that load the same file.
         
         """
         wrapper = TfliteMicro._load_wrapper()
@@ -142,25 +146,70 @@ class TfliteMicro:
         else:
             tflm_accelerator = None
 
-        TfliteMicro._model_lock.acquire()
+        # The accelerator simulators only support one model at a time
+        if tflm_accelerator is not None:
+            TfliteMicro._model_lock.acquire()
+
+        try:
+            if use_mmap and isinstance(model, str):
+                if not model.endswith('.tflite') or not os.path.exists(model):
+                    raise ValueError('Provided model must be a path to an existing .tflite file')
+                flatbuffer_data = None
+                flatbuffer_path = model
+            else:
+                flatbuffer_data = _load_tflite_model(model).flatbuffer_data
+                flatbuffer_path = None
+
+            tflm_model = TfliteMicroModel(
+                tflm_wrapper=wrapper,
+                tflm_accelerator=tflm_accelerator,
+                flatbuffer_data=flatbuffer_data,
+                flatbuffer_path=flatbuffer_path,
+                enable_profiler=enable_profiler,
+                enable_tensor_recorder=enable_tensor_recorder,
+                force_buffer_overlap=force_buffer_overlap,
+                runtime_buffer_size=runtime_buffer_size,
+            )
+        except:
+            if tflm_accelerator is not None:
+                TfliteMicro._model_lock.release()
+            raise
+
+        return tflm_model
+
+    @staticmethod
+    def load_tflite_model_pool(
+        model: Union[str, TfliteModel],
+        n_instances:int=0,
+        runtime_buffer_size=0,
+    ) -> TfliteMicroModelPool:
+        """Load a pool of TF-Lite Micro interpreters with the given .tflite model
+
+        The returned pool's map() method distributes a batch of samples across
+        all of the interpreters which run in parallel on separate threads.
+
+        NOTE: Only the reference kernels are supported
+
+        Args:
+            model: .tflite model file path or TfliteModel instance
+            n_instances: Number of interpreters to load, if <= 0 then use the number of CPU cores
+            runtime_buffer_size: Size of each interpreter's runtime buffer, if 0 then automatically determine the size
+        """
+        wrapper = TfliteMicro._load_wrapper()
         tflite_model = _load_tflite_model(model)
-        tflm_model = TfliteMicroModel(
+        return TfliteMicroModelPool(
             tflm_wrapper=wrapper,
-            tflm_accelerator=tflm_accelerator,
             flatbuffer_data=tflite_model.flatbuffer_data,
-            enable_profiler=enable_profiler,
-            enable_tensor_recorder=enable_tensor_recorder,
-            force_buffer_overlap=force_buffer_overlap,
+            n_instances=n_instances,
             runtime_buffer_size=runtime_buffer_size,
         )
 
-        return tflm_model
-
     @staticmethod
     def unload_model(model: TfliteModel):
         """Unload a previously loaded model"""
+        if model.accelerator is not None:
+            TfliteMicro._model_lock.release()
         del model
-        TfliteMicro._model_lock.release()
 
 
 
@@ -222,6 +271,7 @@ class TfliteMicro:
                     error_msg=layer_err_msg,
                     **tflm_layer_result
                 )
+                recorded_layer_data.pop('index', None)
                 layer_result.update(recorded_layer_data)
                 layer_results.append(layer_result)
 
@@ -260,7 +310,9 @@ class TfliteMicro:
         accelerator:str=None,
         enable_accelerator_recorder = False,
         disable_simulator_backend=False,
-        return_model_details=False
+        return_model_details=False,
+        layers:List[int]=None,
+        output_path:str=None
     ) -> Union[List[TfliteLayer], Tuple[List[TfliteLayer],TfliteMicroModelDetails]]:
         """Run one inference and record each model layer's input/output tensors
         
@@ -274,6 +326,9 @@ class TfliteMicro:
             disable_simulator_backend: Disable the simulator backend while running the accelerator recorder.
                 This can greatly improve execution time, however, the generated data output (i.e. output tensors) is invalid
             return_model_details: Also return the recorded model's TfliteMicroModelDetails
+            layers: Optional list of layer indices to record, if omitted then all layers are recorded
+            output_path: Optional file path to stream the recorded data to. 
+                This reduces the recorder's RAM usage as the layer records are not buffered during inference.
         Return:
             Return a list of TfliteLayers with the tensor data
             updated with the recorded values from the previous inference
@@ -299,6 +354,12 @@ class TfliteMicro:
     
 
         try:
+            if layers is not None or output_path is not None:
+                tflm_model.set_tensor_recorder_config(
+                    output_path=output_path,
+                    layers=layers
+                )
+
             if input_data is not None:
                 if isinstance(input_data, list):
                     for i, v in enumerate(input_data):
@@ -307,18 +368,22 @@ class TfliteMicro:
                     tflm_model.input(value=input_data)
 
             tflm_model.invoke()
-            recorded_data = tflm_model.get_recorded_data()
+            if output_path is not None:
+                recorded_data = TfliteMicroModel.read_recorded_file(output_path)
+            else:
+                recorded_data = tflm_model.get_recorded_data()
         
             if reenable_simulator_backend:
                 tflm_model.accelerator.set_simulator_backend_enabled(True)
 
             retval = []
 
-            for layer_index, recorded_layer_data in enumerate(recorded_data):
+            for recorded_layer_data in recorded_data:
                 # pylint: disable=protected-access
+                layer_index = recorded_layer_data['index']
                 tf_layer = copy.deepcopy(tflite_model.layers[layer_index])
                 retval.append(tf_layer)
-                for input_index, input_bytes in enumerate(recorded_layer_data['inputs']):
+                for input_index, input_bytes in enumerate(recorded_layer_data.get('inputs', [])):
                     if input_index >= tf_layer.n_inputs:
                         break
                     input_tensor = tf_layer.inputs[input_index]
@@ -328,7 +393,7 @@ class TfliteMicro:
                     else:
                         tf_layer.inputs[input_index]._data = input_buf
 
-                for output_index, output_bytes in enumerate(recorded_layer_data['outputs']):
+                for output_index, output_bytes in enumerate(recorded_layer_data.get('outputs', [])):
                     output_tensor = tf_layer.outputs[output_index]
                     output_buf = np.frombuffer(output_bytes, dtype=output_tensor.dtype)
                     if output_tensor.shape.flat_size > 0:
@@ -337,7 +402,7 @@ class TfliteMicro:
                         tf_layer.outputs[output_index]._data = output_buf
 
                 for key, value in recorded_layer_data.items():
-                    if key not in ('inputs', 'outputs'):
+                    if key not in ('index', 'inputs', 'outputs'):
                         tf_layer.metadata[key] = value
 
             if return_model_details:
@@ -1,4 +1,4 @@
-from typing import List, Dict
+from typing import List, Dict, Iterator
 import re
 import collections
 import numpy as np
@@ -48,6 +48,22 @@ class TfliteMicroModelDetails:
     def runtime_memory_size(self)-> int:
         """Total amount of RAM required at runtime to run model"""
         return self._details['runtime_memory_size']
+    @property
+    def memory_plan(self) -> dict:
+        """Tensor arena memory plan
+
+        This is a dictionary with the keys:
+
+        - **arena_size** - Size of the tensor arena buffer in bytes
+        - **head_size** - Bytes used by the planned buffers at the head of the arena
+        - **tail_size** - Bytes used by the persistent buffers and runtime structures at the tail of the arena
+        - **buffers** - List of dictionaries, one per tensor/scratch buffer in the arena, with the keys:
+          type (activation, input, output, scratch or persistent), index, op_index,
+          offset, size, first_use, last_use
+
+        .. note:: On 64-bit hosts, the tail is larger than on a 32-bit MCU
+        """
+        return self._details.get('memory_plan', None)
 
 
     def __str__(self):
@@ -148,6 +164,7 @@ class TfliteMicroModel:
         enable_tensor_recorder:bool=False,
         force_buffer_overlap:bool=False,
         runtime_buffer_size:int=0,
+        flatbuffer_path:str=None,
     ):
         # pylint: disable=protected-access
         from .tflite_micro import TfliteMicro
@@ -155,8 +172,11 @@ class TfliteMicroModel:
         TfliteMicro._clear_logged_errors()
         accelerator_wrapper = None if tflm_accelerator is None else tflm_accelerator.accelerator_wrapper
         self._model_wrapper = tflm_wrapper.TfliteMicroModelWrapper()
-        if not self._model_wrapper.load(
-            flatbuffer_data,
+        # If a file path is given, then the wrapper memory-maps the .tflite file
+        # instead of copying the flatbuffer
+        load_func = self._model_wrapper.load if flatbuffer_path is None else self._model_wrapper.load_from_file
+        if not load_func(
+            flatbuffer_data if flatbuffer_path is None else flatbuffer_path,
             accelerator_wrapper, 
             enable_profiler,
             enable_tensor_recorder,
@@ -168,6 +188,7 @@ class TfliteMicroModel:
             )
 
         self._tflm_accelerator = tflm_accelerator
+        self._recorder_output_path:str = None
         self._layer_errors:List[TfliteMicroLayerError] = []
         for msg in TfliteMicro._get_logged_errors():
             err = TfliteMicroLayerError._parse_error_log(msg)
@@ -234,6 +255,82 @@ class TfliteMicroModel:
             raise Exception(f'Failed to invoke model, additional info:\n{TfliteMicro._get_logged_errors_str()}')
 
 
+    def invoke_range(self, first_layer:int, last_layer:int=-1):
+        """Invoke a range of the model's layers
+
+        Only the layers first_layer to last_layer (inclusive) are executed.
+        The inputs of first_layer must already be in the tensor arena,
+        e.g. from a previous :py:meth:`~invoke_range` that ended at first_layer-1
+        or from a snapshot restored with :py:meth:`~restore_arena`.
+
+        Args:
+            first_layer: Index of the first layer to execute
+            last_layer: Index of the last layer to execute, -1 to execute until the end of the model
+        """
+        # pylint: disable=protected-access
+        from .tflite_micro import TfliteMicro
+
+        TfliteMicro._clear_logged_errors() 
+        if not self._model_wrapper.invoke_range(first_layer, last_layer):
+            raise Exception(f'Failed to invoke model layers {first_layer} to {last_layer}, additional info:\n{TfliteMicro._get_logged_errors_str()}')
+
+
+    def snapshot_arena(self, layer_index:int) -> object:
+        """Save the tensors that are live before the given layer executes
+
+        This allows for computing a shared model prefix once then evaluating
+        the remaining layers many times, e.g.:
+
+        .. highlight:: python
+        .. code-block:: python
+
+            tflm_model.input(value=x)
+            tflm_model.invoke_range(0, 4)
+            snapshot = tflm_model.snapshot_arena(5)
+            for variant in variants:
+                tflm_model.restore_arena(snapshot)
+                ...
+                tflm_model.invoke_range(5)
+
+        Args:
+            layer_index: Index of the layer that executes next, the previous layers must have already executed
+
+        Returns:
+            An opaque snapshot object, its ``op_index`` and ``size`` (in bytes) attributes may be read
+        """
+        return self._model_wrapper.snapshot_arena(layer_index)
+
+
+    def restore_arena(self, snapshot:object):
+        """Restore the tensors saved by :py:meth:`~snapshot_arena`
+
+        Afterwards, ``invoke_range(snapshot.op_index)`` resumes the model from the snapshot.
+        """
+        self._model_wrapper.restore_arena(snapshot)
+
+
+    def invoke_batch(self, inputs:np.ndarray) -> np.ndarray:
+        """Invoke the model once for each sample in the given batch
+
+        The entire batch is processed in C++ with the Python GIL released,
+        which avoids the per-sample Python overhead of calling :py:meth:`invoke`.
+
+        Args:
+            inputs: Array with shape N x <input tensor shape> and the input tensor's data type
+
+        Returns:
+            Array with shape N x <output tensor shape> containing the model output of each sample
+        """
+        # pylint: disable=protected-access
+        from .tflite_micro import TfliteMicro
+
+        TfliteMicro._clear_logged_errors() 
+        try:
+            return self._model_wrapper.invoke_batch(inputs)
+        except RuntimeError as e:
+            raise Exception(f'Failed to invoke model, additional info:\n{TfliteMicro._get_logged_errors_str()}') from e
+
+
     @property
     def is_profiler_enabled(self) -> bool:
         """Return if the profiler is enabled"""
@@ -267,6 +364,12 @@ class TfliteMicroModel:
             A list where each entry contains the input/output tensors
             of the associated model layer
         """
+        if self._recorder_output_path is not None:
+            raise RuntimeError(
+                f'The tensor recorder is streaming to {self._recorder_output_path}, ' \
+                'use TfliteMicroModel.read_recorded_file() to read the recorded data'
+            )
+
         results_bin = self._model_wrapper.get_recorded_data()
         if results_bin is None:
             raise RuntimeError('Failed to retrieve recorded model data from Tensorflow-Lite Micro')
@@ -278,6 +381,160 @@ class TfliteMicroModel:
 
         return recorded_data
 
+    def set_tensor_recorder_config(
+        self,
+        output_path:str=None,
+        layers:List[int]=None,
+        tensors:List[int]=None,
+        record_inputs:bool=True,
+        record_outputs:bool=True,
+        metadata_only:bool=False
+    ):
+        """Configure the tensor recorder
+
+        By default, every layer's tensors are buffered in RAM and returned by
+        :py:meth:`~get_recorded_data` after inference.
+
+        Args:
+            output_path: If given, each layer's record is streamed to this file as it executes (instead of being buffered in RAM).
+                The file is overwritten and each subsequent call to :py:meth:`~invoke` appends to it.
+                Use :py:meth:`~read_recorded_file` to read the records.
+            layers: Optional list of layer indices to record, if omitted then all layers are recorded
+            tensors: Optional list of model tensor indices to record, other tensors are recorded as ``None``
+            record_inputs: Record each layer's input tensors
+            record_outputs: Record each layer's output tensors
+            metadata_only: Only record each tensor's type, byte size and shape, not its data
+        """
+        if not self._model_wrapper.set_tensor_recorder_config(
+            output_path or '',
+            layers or [],
+            tensors or [],
+            record_inputs,
+            record_outputs,
+            metadata_only
+        ):
+            raise RuntimeError('Failed to configure tensor recorder')
+        self._recorder_output_path = output_path
+
+
+    @staticmethod
+    def read_recorded_file(path:str) -> Iterator[Dict[str,object]]:
+        """Iterate the layer records streamed to a file by the tensor recorder
+
+        See :py:meth:`~set_tensor_recorder_config`
+
+        Returns:
+            An iterator of each recorded layer's dict
+        """
+        with open(path, 'rb') as f:
+            yield from msgpack.Unpacker(f)
+
+
+    def enable_activation_stats(self, n_bins:int=256):
+        """Enable the per-layer activation statistics collector
+
+        When enabled, the running statistics of each layer's output tensors are accumulated
+        in native code across every subsequent call to :py:meth:`~invoke` and :py:meth:`~invoke_batch`.
+        This is used for quantization calibration without recording the tensors,
+        see :py:meth:`~get_activation_stats`.
+
+        Any previously collected statistics are discarded.
+
+        Args:
+            n_bins: Number of histogram bins for each tensor, this is rounded up to an even number
+        """
+        if not self._model_wrapper.enable_activation_stats(n_bins):
+            raise RuntimeError('Failed to enable the activation statistics collector')
+
+    def disable_activation_stats(self):
+        """Disable the activation statistics collector and free its memory"""
+        self._model_wrapper.disable_activation_stats()
+
+    @property
+    def is_activation_stats_enabled(self) -> bool:
+        """Return if the activation statistics collector is enabled"""
+        return self._model_wrapper.is_activation_stats_enabled()
+
+    def reset_activation_stats(self):
+        """Discard the collected activation statistics"""
+        self._model_wrapper.reset_activation_stats()
+
+    def get_activation_stats(self) -> List[Dict[str,object]]:
+        """Return the activation statistics collected since the collector was enabled or reset
+
+        Quantized tensors are dequantized, so all of the statistics are real values.
+
+        Returns:
+            A list with an entry for each layer output tensor, each entry is a dictionary with the keys:
+
+            - **tensor_index** - Index of the tensor in the model
+            - **layer_index** - Index of the layer that outputs the tensor
+            - **count** - Number of values accumulated
+            - **min**, **max**, **mean**, **variance** - Statistics of the values
+            - **histogram** - ``np.ndarray`` of the bin counts, the bins have a uniform width
+            - **histogram_min**, **histogram_max** - Range covered by the histogram bins
+        """
+        return self._model_wrapper.get_activation_stats()
+
+
+    def enable_differential_execution(self, tolerance:float=0):
+        """Enable differential execution of the model's kernels against the reference kernels
+
+        When enabled, after each layer's kernel (e.g. an accelerated kernel) executes,
+        the matching kernel of the wrapper's built-in op resolver is executed in native code on the same inputs
+        and the outputs are compared. This validates the accelerated kernels in a single inference
+        without recording the tensors, see :py:meth:`~get_differential_results`.
+
+        .. note::
+           On Windows/Linux, the built-in int8 CONV_2D, DEPTHWISE_CONV_2D, FULLY_CONNECTED and pooling kernels
+           are host-optimized. While a layer is compared, these execute the TF-Lite Micro reference implementations instead,
+           so the comparison is always against the reference kernels.
+           Without an accelerator, this compares the host-optimized kernels against the reference kernels.
+
+        The results accumulate across every subsequent call to :py:meth:`~invoke` and :py:meth:`~invoke_batch`.
+        Any previous results are discarded.
+
+        Args:
+            tolerance: Output elements whose absolute error is greater than this are counted as mismatches
+        """
+        if not self._model_wrapper.enable_differential_execution(tolerance):
+            raise RuntimeError('Failed to enable differential execution')
+
+    def disable_differential_execution(self):
+        """Disable differential execution and free its memory"""
+        self._model_wrapper.disable_differential_execution()
+
+    @property
+    def is_differential_execution_enabled(self) -> bool:
+        """Return if differential execution is enabled"""
+        return self._model_wrapper.is_differential_execution_enabled()
+
+    def reset_differential_execution(self):
+        """Discard the differential execution results"""
+        self._model_wrapper.reset_differential_execution()
+
+    def get_differential_results(self) -> Dict[str,object]:
+        """Return the differential execution results since it was enabled or reset
+
+        The errors are in the units of each layer's output data type, i.e. quantized outputs are NOT dequantized.
+        Each layer is compared on the same inputs, so the error of a layer does not include the error of the previous layers.
+
+        Returns:
+            A dictionary with the keys:
+
+            - **first_mismatch_layer** - Index of the first layer with a mismatch, -1 if all layers matched
+            - **layers** - List with an entry for each layer, each entry is a dictionary with the keys:
+
+              - **index** - Index of the layer
+              - **invoke_count** - Number of times the layer was compared
+              - **element_count** - Number of output elements that were compared
+              - **mismatch_count** - Number of output elements whose absolute error exceeds the tolerance
+              - **max_abs_error** - Maximum absolute error between the kernel and reference kernel outputs
+              - **reference_failed** - True if the reference kernel could not be executed for the layer
+        """
+        return self._model_wrapper.get_differential_results()
+
+
     def get_layer_error(self, index:int) -> TfliteMicroLayerError:
         """Return the TfliteMicroLayerError at the given layer index if found else return None"""
         for err in self._layer_errors:
@@ -287,4 +544,67 @@ class TfliteMicroModel:
 
     
     def __str__(self) -> str:
-        return f'{self.details}'
\ No newline at end of file
+        return f'{self.details}'
+
+
+class TfliteMicroModelPool:
+    """This class wraps a pool of TF-Lite Micro interpreters all loaded with the same .tflite model
+
+    Each interpreter instance has its own runtime memory but shares the .tflite flatbuffer.
+    This allows for evaluating a large dataset across all CPU cores.
+
+    NOTE: Only the reference kernels are supported.
+    """
+
+    def __init__(
+        self,
+        tflm_wrapper,
+        flatbuffer_data:bytes,
+        n_instances:int=0,
+        runtime_buffer_size:int=0,
+    ):
+        # pylint: disable=protected-access
+        from .tflite_micro import TfliteMicro
+
+        TfliteMicro._clear_logged_errors()
+        self._pool_wrapper = tflm_wrapper.TfliteMicroModelPoolWrapper()
+        if not self._pool_wrapper.load(
+            flatbuffer_data,
+            n_instances,
+            runtime_buffer_size
+        ):
+            raise Exception(
+                f'Failed to load model pool, additional info:\n{TfliteMicro._get_logged_errors_str()}'
+            )
+
+    @property
+    def n_instances(self) -> int:
+        """Number of interpreter instances in the pool"""
+        return self._pool_wrapper.size()
+
+
+    def map(self, inputs:np.ndarray) -> np.ndarray:
+        """Invoke the model once for each sample in the given batch
+
+        The samples are distributed across the interpreter instances,
+        each instance runs on its own thread with the Python GIL released.
+
+        Args:
+            inputs: Array with shape N x <input tensor shape> and the input tensor's data type
+
+        Returns:
+            Array with shape N x <output tensor shape> containing the model output of each sample
+        """
+        # pylint: disable=protected-access
+        from .tflite_micro import TfliteMicro
+
+        TfliteMicro._clear_logged_errors()
+        try:
+            return self._pool_wrapper.map(inputs)
+        except RuntimeError as e:
+            raise Exception(f'Failed to invoke model pool, additional info:\n{TfliteMicro._get_logged_errors_str()}') from e
+
+
+    def unload(self):
+        """Unload all of the interpreter instances"""
+        self._pool_wrapper.unload()
@@ -86,8 +86,10 @@ class FlatbufferDictionary(dict):
 
         builder = flatbuffers.Builder(0)
         
+        # The entries are sorted by their UTF-8 encoded key
+        # so the C++ TfliteModelParameters can binary search them directly
         entry_offsets = []
-        for key, value in self.items():
+        for key, value in sorted(self.items(), key=lambda x: x[0].encode('utf-8')):
             key_offset = builder.CreateString(key)
             try:
                 value_type, value_offset = _generate_value(builder, value)
@@ -79,6 +79,19 @@ def test_add_to_tflite_model_api():
     assert params == new_params
 
 
+def test_serialize_sorts_keys():
+    params = TfliteModelParameters(dict(
+        zeta=1,
+        Beta='b',
+        alpha=3,
+        alpha_2=True
+    ))
+
+    new_params = TfliteModelParameters.deserialize(params.serialize())
+    assert list(new_params.keys()) == ['Beta', 'alpha', 'alpha_2', 'zeta']
+    assert params == new_params
+
+
 def test_setitem_api_with_good_data():
     params = TfliteModelParameters()
 